@@ -0,0 +1,108 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_ipa_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief IPA configuration blob object handle
+ *
+ * A blob is generated from JSON configuration files by "tools/config/esp_ipa_blob.py" and
+ * contains one or more target configurations, for example "SC2336" and "SC2336_NIGHT".
+ */
+typedef struct esp_ipa_blob *esp_ipa_blob_handle_t;
+
+/**
+ * @brief Load IPA configuration blob from memory, the data is copied so the
+ *        input buffer can be released after this function returns.
+ *
+ * @param data   Blob data pointer
+ * @param size   Blob data size in bytes
+ * @param handle Blob object handle pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_ipa_blob_load(const void *data, size_t size, esp_ipa_blob_handle_t *handle);
+
+/**
+ * @brief Load IPA configuration blob from a data partition.
+ *
+ * @param label  Partition label
+ * @param handle Blob object handle pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_ipa_blob_load_from_partition(const char *label, esp_ipa_blob_handle_t *handle);
+
+/**
+ * @brief Load IPA configuration blob from a file of a mounted file system.
+ *
+ * @param path   File path
+ * @param handle Blob object handle pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_ipa_blob_load_from_file(const char *path, esp_ipa_blob_handle_t *handle);
+
+/**
+ * @brief Get IPA configuration pointer by target name from blob.
+ *
+ * @note The configuration stays valid until the blob is unloaded, so the blob must
+ *       not be unloaded before the IPA pipeline using this configuration is destroyed.
+ *
+ * @param handle Blob object handle
+ * @param name   Target name
+ *
+ * @return Target IPA configuration pointer if found or null if target is not in blob.
+ */
+const esp_ipa_config_t *esp_ipa_blob_get_config(esp_ipa_blob_handle_t handle, const char *name);
+
+/**
+ * @brief Get the number of target configurations in blob.
+ *
+ * @param handle Blob object handle
+ *
+ * @return Number of target configurations
+ */
+size_t esp_ipa_blob_get_config_num(esp_ipa_blob_handle_t handle);
+
+/**
+ * @brief Get the target name of configuration by index.
+ *
+ * @param handle Blob object handle
+ * @param index  Configuration index, in range [0, esp_ipa_blob_get_config_num())
+ *
+ * @return Target name if index is valid or null if not.
+ */
+const char *esp_ipa_blob_get_name(esp_ipa_blob_handle_t handle, size_t index);
+
+/**
+ * @brief Unload IPA configuration blob and free its resources.
+ *
+ * @param handle Blob object handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_ipa_blob_unload(esp_ipa_blob_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,352 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_partition.h"
+#include "esp_rom_crc.h"
+#include "esp_ipa_blob.h"
+
+#define ESP_IPA_BLOB_MAGIC          0x42415049  /* 'IPAB' */
+#define ESP_IPA_BLOB_VERSION        1
+#define ESP_IPA_BLOB_DATA_ALIGN     8
+
+#if defined(__riscv)
+#define ESP_IPA_BLOB_MACHINE        243         /* EM_RISCV */
+#elif defined(__XTENSA__)
+#define ESP_IPA_BLOB_MACHINE        94          /* EM_XTENSA */
+#else
+#define ESP_IPA_BLOB_MACHINE        3           /* EM_386, for host test */
+#endif
+
+/**
+ * @brief IPA configuration blob header, must be the same as BLOB_HEADER in "tools/config/esp_ipa_blob.py"
+ */
+typedef struct esp_ipa_blob_header {
+    uint32_t magic;                 /*!< Blob magic number, ESP_IPA_BLOB_MAGIC */
+    uint16_t version;               /*!< Blob format version */
+    uint16_t param_version;         /*!< IPA JSON configuration parameters version */
+    uint16_t machine;               /*!< ELF machine type of the compiler which generated the configuration */
+    uint16_t pointer_size;          /*!< Pointer size in bytes */
+    uint32_t size;                  /*!< Blob total size in bytes, including this header */
+    uint32_t crc32;                 /*!< CRC32 of all data after this header */
+    uint32_t entry_num;             /*!< Number of target configurations */
+    uint32_t entry_offset;          /*!< Target configuration entries offset from blob start */
+    uint32_t reloc_num;             /*!< Number of pointers to relocate */
+    uint32_t reloc_offset;          /*!< Relocation table offset from blob start */
+    uint32_t data_offset;           /*!< Configuration data offset from blob start */
+    uint32_t data_size;             /*!< Configuration data size in bytes */
+} esp_ipa_blob_header_t;
+
+/**
+ * @brief IPA configuration blob target entry, offsets are from configuration data start
+ */
+typedef struct esp_ipa_blob_entry {
+    uint32_t name_offset;           /*!< Target name offset */
+    uint32_t config_offset;         /*!< Target configuration offset */
+    uint32_t config_size;           /*!< Target configuration size, must be sizeof(esp_ipa_config_t) */
+} esp_ipa_blob_entry_t;
+
+struct esp_ipa_blob {
+    uint8_t *buffer;
+    size_t size;
+    const esp_ipa_blob_entry_t *entries;
+    uint32_t entry_num;
+    uint8_t *data;
+};
+
+static const char *TAG = "esp_ipa_blob";
+
+static esp_err_t blob_check_header(const esp_ipa_blob_header_t *header, size_t size)
+{
+    ESP_RETURN_ON_FALSE(header->magic == ESP_IPA_BLOB_MAGIC, ESP_ERR_INVALID_ARG, TAG, "invalid magic %" PRIx32, header->magic);
+    ESP_RETURN_ON_FALSE(header->version == ESP_IPA_BLOB_VERSION, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "blob version %u is not supported", header->version);
+    ESP_RETURN_ON_FALSE(header->param_version == CONFIG_ESP_IPA_CONFIG_PARAM_VERSION, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "parameters version %u should be %d", header->param_version, CONFIG_ESP_IPA_CONFIG_PARAM_VERSION);
+    ESP_RETURN_ON_FALSE(header->machine == ESP_IPA_BLOB_MACHINE && header->pointer_size == sizeof(void *),
+                        ESP_ERR_NOT_SUPPORTED, TAG, "blob is generated for machine %u", header->machine);
+    ESP_RETURN_ON_FALSE(header->size >= sizeof(esp_ipa_blob_header_t) && header->size <= size,
+                        ESP_ERR_INVALID_SIZE, TAG, "blob size %" PRIu32 " is out of %zu", header->size, size);
+
+    return ESP_OK;
+}
+
+static esp_err_t blob_parse(esp_ipa_blob_handle_t blob)
+{
+    const esp_ipa_blob_header_t *header = (const esp_ipa_blob_header_t *)blob->buffer;
+
+    ESP_RETURN_ON_ERROR(blob_check_header(header, blob->size), TAG, "invalid header");
+
+    uint32_t crc = esp_rom_crc32_le(0, blob->buffer + sizeof(esp_ipa_blob_header_t),
+                                    header->size - sizeof(esp_ipa_blob_header_t));
+    ESP_RETURN_ON_FALSE(crc == header->crc32, ESP_ERR_INVALID_CRC, TAG, "CRC %" PRIx32 " should be %" PRIx32, crc, header->crc32);
+
+    ESP_RETURN_ON_FALSE(header->entry_num > 0 &&
+                        header->entry_offset + (uint64_t)header->entry_num * sizeof(esp_ipa_blob_entry_t) <= header->size &&
+                        header->reloc_offset + (uint64_t)header->reloc_num * sizeof(uint32_t) <= header->size &&
+                        header->data_offset % ESP_IPA_BLOB_DATA_ALIGN == 0 &&
+                        (uint64_t)header->data_offset + header->data_size <= header->size,
+                        ESP_ERR_INVALID_SIZE, TAG, "invalid layout");
+
+    uint8_t *data = blob->buffer + header->data_offset;
+    const uint32_t *relocs = (const uint32_t *)(blob->buffer + header->reloc_offset);
+    const esp_ipa_blob_entry_t *entries = (const esp_ipa_blob_entry_t *)(blob->buffer + header->entry_offset);
+
+    for (uint32_t i = 0; i < header->entry_num; i++) {
+        const esp_ipa_blob_entry_t *e = &entries[i];
+
+        ESP_RETURN_ON_FALSE(e->config_size == sizeof(esp_ipa_config_t), ESP_ERR_INVALID_SIZE, TAG,
+                            "configuration %" PRIu32 " size %" PRIu32 " should be %zu", i, e->config_size, sizeof(esp_ipa_config_t));
+        ESP_RETURN_ON_FALSE(e->config_offset % sizeof(void *) == 0 &&
+                            (uint64_t)e->config_offset + e->config_size <= header->data_size &&
+                            e->name_offset < header->data_size &&
+                            memchr(data + e->name_offset, '\0', header->data_size - e->name_offset),
+                            ESP_ERR_INVALID_SIZE, TAG, "configuration %" PRIu32 " is out of data", i);
+    }
+
+    /* Pointers are stored as offsets from data start, rebase them to the load address */
+    for (uint32_t i = 0; i < header->reloc_num; i++) {
+        uint32_t offset = relocs[i];
+
+        ESP_RETURN_ON_FALSE(offset % sizeof(void *) == 0 && (uint64_t)offset + sizeof(void *) <= header->data_size,
+                            ESP_ERR_INVALID_SIZE, TAG, "relocation %" PRIu32 " is out of data", i);
+
+        uintptr_t *slot = (uintptr_t *)(data + offset);
+        ESP_RETURN_ON_FALSE(*slot <= header->data_size, ESP_ERR_INVALID_SIZE, TAG,
+                            "relocation %" PRIu32 " target is out of data", i);
+        *slot += (uintptr_t)data;
+    }
+
+    blob->entries = entries;
+    blob->entry_num = header->entry_num;
+    blob->data = data;
+
+    ESP_LOGD(TAG, "loaded %" PRIu32 " configurations, %" PRIu32 " relocations", header->entry_num, header->reloc_num);
+
+    return ESP_OK;
+}
+
+static esp_err_t blob_alloc(size_t size, esp_ipa_blob_handle_t *handle)
+{
+    esp_ipa_blob_handle_t blob = heap_caps_calloc(1, sizeof(struct esp_ipa_blob), MALLOC_CAP_8BIT);
+    ESP_RETURN_ON_FALSE(blob, ESP_ERR_NO_MEM, TAG, "failed to malloc blob");
+
+    blob->buffer = heap_caps_aligned_alloc(ESP_IPA_BLOB_DATA_ALIGN, size, MALLOC_CAP_8BIT);
+    if (!blob->buffer) {
+        heap_caps_free(blob);
+        ESP_LOGE(TAG, "failed to malloc blob buffer with size %zu", size);
+        return ESP_ERR_NO_MEM;
+    }
+    blob->size = size;
+
+    *handle = blob;
+    return ESP_OK;
+}
+
+static esp_err_t blob_init(esp_ipa_blob_handle_t blob, esp_ipa_blob_handle_t *handle)
+{
+    esp_err_t ret = blob_parse(blob);
+    if (ret != ESP_OK) {
+        esp_ipa_blob_unload(blob);
+        return ret;
+    }
+
+    *handle = blob;
+    return ESP_OK;
+}
+
+/**
+ * @brief Load IPA configuration blob from memory, the data is copied so the
+ *        input buffer can be released after this function returns.
+ *
+ * @param data   Blob data pointer
+ * @param size   Blob data size in bytes
+ * @param handle Blob object handle pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_ipa_blob_load(const void *data, size_t size, esp_ipa_blob_handle_t *handle)
+{
+    esp_ipa_blob_header_t header;
+    esp_ipa_blob_handle_t blob;
+
+    ESP_RETURN_ON_FALSE(data && handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(size >= sizeof(header), ESP_ERR_INVALID_SIZE, TAG, "blob is too small");
+
+    /* Input data may be not aligned, e.g. embedded by EMBED_FILES */
+    memcpy(&header, data, sizeof(header));
+    ESP_RETURN_ON_ERROR(blob_check_header(&header, size), TAG, "invalid header");
+
+    ESP_RETURN_ON_ERROR(blob_alloc(header.size, &blob), TAG, "failed to allocate blob");
+    memcpy(blob->buffer, data, header.size);
+
+    return blob_init(blob, handle);
+}
+
+/**
+ * @brief Load IPA configuration blob from a data partition.
+ *
+ * @param label  Partition label
+ * @param handle Blob object handle pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_ipa_blob_load_from_partition(const char *label, esp_ipa_blob_handle_t *handle)
+{
+    esp_err_t ret;
+    esp_ipa_blob_header_t header;
+    esp_ipa_blob_handle_t blob;
+
+    ESP_RETURN_ON_FALSE(label && handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+    ESP_RETURN_ON_FALSE(part, ESP_ERR_NOT_FOUND, TAG, "partition %s is not found", label);
+
+    ESP_RETURN_ON_ERROR(esp_partition_read(part, 0, &header, sizeof(header)), TAG, "failed to read header");
+    ESP_RETURN_ON_ERROR(blob_check_header(&header, part->size), TAG, "invalid header in partition %s", label);
+
+    /*
+     * The blob is read into RAM instead of esp_partition_mmap(), because the pointers inside it
+     * are rebased in place and the memory-mapped flash is read-only.
+     */
+    ESP_RETURN_ON_ERROR(blob_alloc(header.size, &blob), TAG, "failed to allocate blob");
+    ret = esp_partition_read(part, 0, blob->buffer, header.size);
+    if (ret != ESP_OK) {
+        esp_ipa_blob_unload(blob);
+        ESP_LOGE(TAG, "failed to read partition %s", label);
+        return ret;
+    }
+
+    return blob_init(blob, handle);
+}
+
+/**
+ * @brief Load IPA configuration blob from a file of a mounted file system.
+ *
+ * @param path   File path
+ * @param handle Blob object handle pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_ipa_blob_load_from_file(const char *path, esp_ipa_blob_handle_t *handle)
+{
+    esp_err_t ret = ESP_OK;
+    esp_ipa_blob_header_t header;
+    esp_ipa_blob_handle_t blob = NULL;
+
+    ESP_RETURN_ON_FALSE(path && handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    FILE *fp = fopen(path, "rb");
+    ESP_RETURN_ON_FALSE(fp, ESP_ERR_NOT_FOUND, TAG, "failed to open %s", path);
+
+    ESP_GOTO_ON_FALSE(fseek(fp, 0, SEEK_END) == 0, ESP_FAIL, exit, TAG, "failed to seek %s", path);
+    long size = ftell(fp);
+    ESP_GOTO_ON_FALSE(size >= (long)sizeof(header), ESP_ERR_INVALID_SIZE, exit, TAG, "%s is too small", path);
+    rewind(fp);
+
+    ESP_GOTO_ON_FALSE(fread(&header, sizeof(header), 1, fp) == 1, ESP_FAIL, exit, TAG, "failed to read header");
+    ESP_GOTO_ON_ERROR(blob_check_header(&header, size), exit, TAG, "invalid header in %s", path);
+
+    ESP_GOTO_ON_ERROR(blob_alloc(header.size, &blob), exit, TAG, "failed to allocate blob");
+    memcpy(blob->buffer, &header, sizeof(header));
+    ESP_GOTO_ON_FALSE(fread(blob->buffer + sizeof(header), header.size - sizeof(header), 1, fp) == 1,
+                      ESP_FAIL, exit, TAG, "failed to read %s", path);
+
+    fclose(fp);
+    return blob_init(blob, handle);
+
+exit:
+    if (blob) {
+        esp_ipa_blob_unload(blob);
+    }
+    fclose(fp);
+    return ret;
+}
+
+/**
+ * @brief Get IPA configuration pointer by target name from blob.
+ *
+ * @note The configuration stays valid until the blob is unloaded, so the blob must
+ *       not be unloaded before the IPA pipeline using this configuration is destroyed.
+ *
+ * @param handle Blob object handle
+ * @param name   Target name
+ *
+ * @return Target IPA configuration pointer if found or null if target is not in blob.
+ */
+const esp_ipa_config_t *esp_ipa_blob_get_config(esp_ipa_blob_handle_t handle, const char *name)
+{
+    if (!handle || !name) {
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < handle->entry_num; i++) {
+        if (!strcmp(name, (const char *)handle->data + handle->entries[i].name_offset)) {
+            return (const esp_ipa_config_t *)(handle->data + handle->entries[i].config_offset);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Get the number of target configurations in blob.
+ *
+ * @param handle Blob object handle
+ *
+ * @return Number of target configurations
+ */
+size_t esp_ipa_blob_get_config_num(esp_ipa_blob_handle_t handle)
+{
+    return handle ? handle->entry_num : 0;
+}
+
+/**
+ * @brief Get the target name of configuration by index.
+ *
+ * @param handle Blob object handle
+ * @param index  Configuration index, in range [0, esp_ipa_blob_get_config_num())
+ *
+ * @return Target name if index is valid or null if not.
+ */
+const char *esp_ipa_blob_get_name(esp_ipa_blob_handle_t handle, size_t index)
+{
+    if (!handle || index >= handle->entry_num) {
+        return NULL;
+    }
+
+    return (const char *)handle->data + handle->entries[index].name_offset;
+}
+
+/**
+ * @brief Unload IPA configuration blob and free its resources.
+ *
+ * @param handle Blob object handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_ipa_blob_unload(esp_ipa_blob_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    heap_caps_free(handle->buffer);
+    heap_caps_free(handle);
+
+    return ESP_OK;
+}
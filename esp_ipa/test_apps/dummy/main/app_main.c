@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -11,7 +12,9 @@
 #include "unity_test_utils.h"
 #include "unity_test_utils_memory.h"
 
+#include "esp_rom_crc.h"
 #include "esp_ipa.h"
+#include "esp_ipa_blob.h"
 #include "esp_ipa_detect.h"
 
 #define TEST_MEMORY_LEAK_THRESHOLD (-256)
@@ -2196,6 +2199,132 @@ TEST_CASE("IOCTL multiple threads test", "[IPA]")
     TEST_ESP_OK(esp_ipa_pipeline_destroy(handle));
 }
 
+/**
+ * @brief The same as esp_ipa_blob_header_t in "src/esp_ipa_blob.c"
+ */
+typedef struct test_blob_header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t param_version;
+    uint16_t machine;
+    uint16_t pointer_size;
+    uint32_t size;
+    uint32_t crc32;
+    uint32_t entry_num;
+    uint32_t entry_offset;
+    uint32_t reloc_num;
+    uint32_t reloc_offset;
+    uint32_t data_offset;
+    uint32_t data_size;
+} test_blob_header_t;
+
+/* Blob generated by "tools/config/esp_ipa_blob.py" from test_apps_dummy.json and test_apps_dummy_2.json */
+extern const uint8_t test_blob_start[] asm("_binary_esp_ipa_config_bin_start");
+extern const uint8_t test_blob_end[] asm("_binary_esp_ipa_config_bin_end");
+
+static uint8_t *test_blob_copy(size_t *size)
+{
+    *size = test_blob_end - test_blob_start;
+    uint8_t *blob = malloc(*size);
+    TEST_ASSERT_NOT_NULL(blob);
+    memcpy(blob, test_blob_start, *size);
+
+    return blob;
+}
+
+static void test_blob_update_crc(uint8_t *blob)
+{
+    test_blob_header_t *header = (test_blob_header_t *)blob;
+
+    header->crc32 = esp_rom_crc32_le(0, blob + sizeof(test_blob_header_t), header->size - sizeof(test_blob_header_t));
+}
+
+TEST_CASE("Load IPA configuration blob", "[IPA][blob]")
+{
+    esp_ipa_blob_handle_t blob;
+    esp_ipa_pipeline_handle_t handle = NULL;
+    esp_ipa_metadata_t metadata = {0};
+    esp_ipa_stats_t stats = {0};
+    const char *targets[] = {IPA_TARGET_NAME, IPA_TARGET_NAME_2};
+
+    TEST_ESP_OK(esp_ipa_blob_load(test_blob_start, test_blob_end - test_blob_start, &blob));
+    TEST_ASSERT_EQUAL(2, esp_ipa_blob_get_config_num(blob));
+    TEST_ASSERT_NULL(esp_ipa_blob_get_name(blob, 2));
+
+    for (int i = 0; i < 2; i++) {
+        const esp_ipa_config_t *config = esp_ipa_blob_get_config(blob, targets[i]);
+        const esp_ipa_config_t *builtin = esp_ipa_pipeline_get_config(targets[i]);
+
+        TEST_ASSERT_NOT_NULL(config);
+        TEST_ASSERT_NOT_NULL(builtin);
+        TEST_ASSERT_EQUAL(builtin->version, config->version);
+        TEST_ASSERT_EQUAL(builtin->nums, config->nums);
+        for (int j = 0; j < config->nums; j++) {
+            TEST_ASSERT_EQUAL_STRING(builtin->names[j], config->names[j]);
+        }
+        TEST_ASSERT_EQUAL(builtin->awb == NULL, config->awb == NULL);
+        if (config->awb) {
+            TEST_ASSERT_EQUAL(builtin->awb->model, config->awb->model);
+            TEST_ASSERT_EQUAL(builtin->awb->min_counted, config->awb->min_counted);
+            TEST_ASSERT_EQUAL_MEMORY(&builtin->awb->range, &config->awb->range, sizeof(esp_ipa_awb_range_t));
+        }
+    }
+    TEST_ASSERT_NULL(esp_ipa_blob_get_config(blob, "unknown"));
+    TEST_ASSERT_NULL(esp_ipa_blob_get_config(NULL, IPA_TARGET_NAME));
+
+    /* Configuration from blob runs IPA pipeline the same as the built-in one */
+    TEST_ESP_OK(esp_ipa_pipeline_create(esp_ipa_blob_get_config(blob, IPA_TARGET_NAME_2), &handle));
+    TEST_ESP_OK(esp_ipa_pipeline_init(handle, &s_esp_ipa_sensor, &metadata));
+    TEST_ESP_OK(esp_ipa_pipeline_process(handle, &stats, &s_esp_ipa_sensor, &metadata));
+    TEST_ESP_OK(esp_ipa_pipeline_destroy(handle));
+
+    TEST_ESP_OK(esp_ipa_blob_unload(blob));
+}
+
+TEST_CASE("Reject invalid IPA configuration blob", "[IPA][blob]")
+{
+    size_t size;
+    uint8_t *data;
+    test_blob_header_t *header;
+    esp_ipa_blob_handle_t blob = NULL;
+
+    /* Data is changed but CRC isn't */
+    data = test_blob_copy(&size);
+    header = (test_blob_header_t *)data;
+    data[header->data_offset] ^= 0xff;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_CRC, esp_ipa_blob_load(data, size, &blob));
+    free(data);
+
+    /* Blob is generated for a different pointer size */
+    data = test_blob_copy(&size);
+    header = (test_blob_header_t *)data;
+    header->pointer_size = sizeof(void *) * 2;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, esp_ipa_blob_load(data, size, &blob));
+    free(data);
+
+    /* Blob is generated for a different parameters version */
+    data = test_blob_copy(&size);
+    header = (test_blob_header_t *)data;
+    header->param_version++;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, esp_ipa_blob_load(data, size, &blob));
+    free(data);
+
+    /* Blob is generated with a different esp_ipa_config_t, CRC is valid */
+    data = test_blob_copy(&size);
+    header = (test_blob_header_t *)data;
+    ((uint32_t *)(data + header->entry_offset))[2] = sizeof(esp_ipa_config_t) + sizeof(void *);
+    test_blob_update_crc(data);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_ipa_blob_load(data, size, &blob));
+    free(data);
+
+    /* Blob is truncated */
+    data = test_blob_copy(&size);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_ipa_blob_load(data, size - 1, &blob));
+    free(data);
+
+    TEST_ASSERT_NULL(blob);
+}
+
 void app_main(void)
 {
     /**
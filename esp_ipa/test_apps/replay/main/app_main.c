@@ -0,0 +1,156 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+
+#include "esp_ipa.h"
+#include "esp_ipa_replay_trace.h"
+
+#define REPLAY_LUMINANCE_MAX    255
+
+static const char *TAG = "ipa_replay";
+
+static void apply_metadata(esp_ipa_sensor_t *sensor, const esp_ipa_metadata_t *metadata)
+{
+    if (metadata->flags & IPA_METADATA_FLAGS_ET) {
+        sensor->cur_exposure = MIN(MAX(metadata->exposure, sensor->min_exposure), sensor->max_exposure);
+    }
+
+    if (metadata->flags & IPA_METADATA_FLAGS_GN) {
+        sensor->cur_gain = MIN(MAX(metadata->gain, sensor->min_gain), sensor->max_gain);
+    }
+
+    if (metadata->flags & IPA_METADATA_FLAGS_AETL) {
+        sensor->cur_ae_target_level = metadata->ae_target_level;
+    }
+
+    if ((metadata->flags & IPA_METADATA_FLAGS_FP) && sensor->focus_info) {
+        sensor->focus_info->cur_pos = metadata->focus_pos;
+        sensor->focus_info->start_time = esp_timer_get_time();
+    }
+}
+
+/**
+ * In closed-loop mode, the recorded luminance is scaled by the ratio of the exposure
+ * and gain selected by IPA to the exposure and gain used when recording, so that AGC
+ * sees the effect of its own decisions and its convergence time can be measured.
+ */
+static void scale_stats(esp_ipa_stats_t *stats, const esp_ipa_replay_frame_t *frame, const esp_ipa_sensor_t *sensor)
+{
+    float ratio = ((float)sensor->cur_exposure * sensor->cur_gain) / ((float)frame->exposure * frame->gain);
+
+    for (int i = 0; i < ISP_AE_REGIONS; i++) {
+        float luma = stats->ae_stats[i].luminance * ratio;
+
+        stats->ae_stats[i].luminance = MIN((uint32_t)luma, REPLAY_LUMINANCE_MAX);
+    }
+}
+
+void app_main(void)
+{
+    esp_err_t ret;
+    int64_t latency_min = INT64_MAX;
+    int64_t latency_max = 0;
+    int64_t latency_sum = 0;
+    esp_ipa_pipeline_handle_t handle = NULL;
+    const esp_ipa_replay_trace_t *trace = &g_esp_ipa_replay_trace;
+    const esp_ipa_config_t *ipa_config = esp_ipa_pipeline_get_config(ESP_IPA_REPLAY_TARGET);
+    esp_ipa_sensor_t sensor = trace->sensor;
+    esp_ipa_metadata_t *metadata = heap_caps_calloc(1, sizeof(esp_ipa_metadata_t), MALLOC_CAP_8BIT);
+    esp_ipa_stats_t *stats = heap_caps_calloc(1, sizeof(esp_ipa_stats_t), MALLOC_CAP_8BIT);
+
+    if (!metadata || !stats) {
+        ESP_LOGE(TAG, "failed to allocate memory");
+        goto exit_0;
+    }
+
+    if (!ipa_config) {
+        ESP_LOGE(TAG, "failed to get IPA configuration of %s", ESP_IPA_REPLAY_TARGET);
+        goto exit_0;
+    }
+
+    sensor.cur_exposure = trace->frames[0].exposure;
+    sensor.cur_gain = trace->frames[0].gain;
+    sensor.cur_ae_target_level = trace->frames[0].ae_target_level;
+    if (sensor.focus_info) {
+        sensor.focus_info->cur_pos = trace->frames[0].focus_pos;
+    }
+
+    ret = esp_ipa_pipeline_create(ipa_config, &handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to create IPA pipeline");
+        goto exit_0;
+    }
+
+    ret = esp_ipa_pipeline_init(handle, &sensor, metadata);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize IPA pipeline");
+        goto exit_1;
+    }
+
+    if (trace->closed_loop) {
+        apply_metadata(&sensor, metadata);
+    }
+
+    printf("IPA_REPLAY_START,%s,%" PRIu32 ",%d\n", ESP_IPA_REPLAY_TARGET, trace->frame_num, trace->closed_loop);
+
+    for (uint32_t i = 0; i < trace->frame_num; i++) {
+        const esp_ipa_replay_frame_t *frame = &trace->frames[i];
+
+        memcpy(stats, &frame->stats, sizeof(esp_ipa_stats_t));
+        if (trace->closed_loop) {
+            scale_stats(stats, frame, &sensor);
+        } else {
+            sensor.cur_exposure = frame->exposure;
+            sensor.cur_gain = frame->gain;
+            sensor.cur_ae_target_level = frame->ae_target_level;
+            if (sensor.focus_info) {
+                sensor.focus_info->cur_pos = frame->focus_pos;
+            }
+        }
+
+        metadata->flags = 0;
+        int64_t start = esp_timer_get_time();
+        ret = esp_ipa_pipeline_process(handle, stats, &sensor, metadata);
+        int64_t latency = esp_timer_get_time() - start;
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "failed to process frame %" PRIu32, i);
+            goto exit_1;
+        }
+
+        latency_min = MIN(latency_min, latency);
+        latency_max = MAX(latency_max, latency);
+        latency_sum += latency;
+
+        if (trace->closed_loop) {
+            apply_metadata(&sensor, metadata);
+        }
+
+        printf("IPA_REPLAY,%" PRIu32 ",%08" PRIx32 ",%" PRIu32 ",%.3f,%.3f,%.3f,%" PRIu32 ",%" PRIi64 "\n",
+               i, metadata->flags,
+               (metadata->flags & IPA_METADATA_FLAGS_ET) ? metadata->exposure : sensor.cur_exposure,
+               (metadata->flags & IPA_METADATA_FLAGS_GN) ? metadata->gain : sensor.cur_gain,
+               metadata->red_gain, metadata->blue_gain,
+               (metadata->flags & IPA_METADATA_FLAGS_AETL) ? metadata->ae_target_level : sensor.cur_ae_target_level,
+               latency);
+    }
+
+    printf("IPA_REPLAY_LATENCY,%" PRIi64 ",%" PRIi64 ",%" PRIi64 "\n",
+           latency_min, latency_sum / trace->frame_num, latency_max);
+    printf("IPA_REPLAY_DONE\n");
+
+exit_1:
+    esp_ipa_pipeline_destroy(handle);
+exit_0:
+    heap_caps_free(stats);
+    heap_caps_free(metadata);
+}
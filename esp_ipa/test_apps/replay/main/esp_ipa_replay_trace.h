@@ -0,0 +1,45 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include "esp_ipa_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Recorded frame of IPA replay trace.
+ */
+typedef struct esp_ipa_replay_frame {
+    uint32_t exposure;                      /*!< Sensor exposure when statistics were recorded, unit is micro second */
+    float gain;                             /*!< Sensor gain when statistics were recorded */
+    uint32_t ae_target_level;               /*!< Sensor AE target level when statistics were recorded */
+    uint32_t focus_pos;                     /*!< Focus position when statistics were recorded */
+
+    esp_ipa_stats_t stats;                  /*!< Recorded ISP statistics */
+} esp_ipa_replay_frame_t;
+
+/**
+ * @brief IPA replay trace.
+ */
+typedef struct esp_ipa_replay_trace {
+    esp_ipa_sensor_t sensor;                /*!< Sensor limits, current values are taken from frames */
+    bool closed_loop;                       /*!< true: scale AE luminance by IPA exposure and gain, false: replay statistics as recorded */
+
+    const esp_ipa_replay_frame_t *frames;   /*!< Recorded frames */
+    uint32_t frame_num;                     /*!< Recorded frames number */
+} esp_ipa_replay_trace_t;
+
+/**
+ * @brief Replay trace generated by esp_ipa/tools/replay/esp_ipa_replay.py
+ */
+extern const esp_ipa_replay_trace_t g_esp_ipa_replay_trace;
+
+#ifdef __cplusplus
+}
+#endif
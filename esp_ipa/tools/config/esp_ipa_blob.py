@@ -0,0 +1,270 @@
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+'''
+Convert the compiled IPA configuration object file into a binary blob which can be
+loaded at runtime by esp_ipa_blob_load*().
+
+The object file is built from the C source generated by esp_ipa_config.py with the
+target compiler, so the structure layout is exactly the one the firmware uses. All
+allocated data sections are packed into one data area, every absolute pointer in it is
+turned into an offset from the data area start and recorded in a relocation table, so
+the loader only needs to add the load address to the listed slots.
+
+Blob layout (little-endian):
+
+    header      esp_ipa_blob_header_t
+    entries     entry_num * { name_offset, config_offset, config_size }
+    relocs      reloc_num * { data_offset }
+    data        data_size bytes, 8-byte aligned
+'''
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+sys.path.append(os.path.dirname(os.path.abspath(__file__)) + '/isp')
+
+import common
+
+BLOB_MAGIC = 0x42415049     # 'IPAB'
+BLOB_VERSION = 1
+BLOB_HEADER = struct.Struct('<IHHHHIIIIIIII')
+BLOB_ENTRY = struct.Struct('<III')
+BLOB_RELOC = struct.Struct('<I')
+BLOB_DATA_ALIGN = 8
+
+INDEX_SYMBOL = 's_video_ipa_configs'
+POINTER_SIZE = 4
+
+SHT_PROGBITS = 1
+SHT_SYMTAB = 2
+SHT_RELA = 4
+SHT_NOBITS = 8
+SHT_REL = 9
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+SHN_UNDEF = 0
+SHN_LORESERVE = 0xff00
+
+# Only constant and initialized data is taken, unwind tables and the like are dropped
+DATA_SECTIONS = ('.rodata', '.srodata', '.data', '.sdata', '.bss', '.sbss')
+
+# 32-bit absolute relocation type of each supported machine
+ABS32_RELOC = {
+    3: 1,       # EM_386, R_386_32
+    94: 1,      # EM_XTENSA, R_XTENSA_32
+    243: 1,     # EM_RISCV, R_RISCV_32
+}
+
+def align(value, alignment):
+    return (value + alignment - 1) & ~(alignment - 1)
+
+class elf_c(object):
+    def __init__(self, path):
+        self.data = open(path, 'rb').read()
+        if self.data[:4] != b'\x7fELF':
+            raise common.fatal_error(f'{path} is not an ELF file')
+        if self.data[4] != 1 or self.data[5] != 1:
+            raise common.fatal_error(f'{path} is not a 32-bit little-endian ELF file')
+
+        (self.type, self.machine, _, _, _, shoff, _, _, _, _, shentsize, shnum, shstrndx) = \
+            struct.unpack_from('<HHIIIIIHHHHHH', self.data, 16)
+
+        if self.machine not in ABS32_RELOC:
+            raise common.fatal_error(f'ELF machine {self.machine} is not supported')
+
+        self.sections = list()
+        for i in range(shnum):
+            (name, type, flags, addr, offset, size, link, info, addralign, entsize) = \
+                struct.unpack_from('<IIIIIIIIII', self.data, shoff + i * shentsize)
+            self.sections.append({
+                'name': name, 'type': type, 'flags': flags, 'offset': offset, 'size': size,
+                'link': link, 'info': info, 'align': max(addralign, 1), 'entsize': entsize
+            })
+
+        shstr = self.sections[shstrndx]
+        for s in self.sections:
+            s['name'] = self.string(shstr, s['name'])
+
+        self.symbols = list()
+        for s in self.sections:
+            if s['type'] == SHT_SYMTAB:
+                strtab = self.sections[s['link']]
+                for i in range(s['size'] // 16):
+                    (name, value, size, info, other, shndx) = \
+                        struct.unpack_from('<IIIBBH', self.data, s['offset'] + i * 16)
+                    self.symbols.append({
+                        'name': self.string(strtab, name), 'value': value, 'size': size, 'shndx': shndx
+                    })
+
+    def string(self, section, offset):
+        start = section['offset'] + offset
+        end = self.data.index(b'\0', start)
+        return self.data[start:end].decode()
+
+    def content(self, section):
+        if section['type'] == SHT_NOBITS:
+            return bytes(section['size'])
+        return self.data[section['offset']:section['offset'] + section['size']]
+
+    def relocations(self, section):
+        rela = section['type'] == SHT_RELA
+        entsize = 12 if rela else 8
+        for i in range(section['size'] // entsize):
+            base = section['offset'] + i * entsize
+            offset, info = struct.unpack_from('<II', self.data, base)
+            addend = struct.unpack_from('<i', self.data, base + 8)[0] if rela else None
+            yield offset, info >> 8, info & 0xff, addend
+
+class blob_c(object):
+    def __init__(self, elf):
+        self.elf = elf
+        self.layout = dict()
+        self.image = bytearray()
+        self.relocs = list()
+        self.entries = list()
+
+        self.pack_sections()
+        self.relocate()
+        self.find_entries()
+
+    def is_data(self, index):
+        s = self.elf.sections[index]
+        return (s['flags'] & SHF_ALLOC) and not (s['flags'] & SHF_EXECINSTR) and \
+               s['type'] in (SHT_PROGBITS, SHT_NOBITS) and s['size'] > 0 and \
+               any(s['name'] == p or s['name'].startswith(p + '.') for p in DATA_SECTIONS)
+
+    def pack_sections(self):
+        for i, s in enumerate(self.elf.sections):
+            if self.is_data(i):
+                offset = align(len(self.image), s['align'])
+                self.image += bytes(offset - len(self.image))
+                self.image += self.elf.content(s)
+                self.layout[i] = offset
+
+        if len(self.image) == 0:
+            raise common.fatal_error('no IPA configuration data found in object file')
+
+    def symbol_offset(self, symbol):
+        shndx = symbol['shndx']
+        if shndx == SHN_UNDEF or shndx >= SHN_LORESERVE:
+            raise common.fatal_error(f'symbol "{symbol["name"]}" is not defined in IPA configuration object file')
+        if shndx not in self.layout:
+            raise common.fatal_error(f'symbol "{symbol["name"]}" is not placed in a data section')
+        return self.layout[shndx] + symbol['value']
+
+    def relocate(self):
+        abs32 = ABS32_RELOC[self.elf.machine]
+
+        for s in self.elf.sections:
+            if s['type'] not in (SHT_REL, SHT_RELA) or s['info'] not in self.layout:
+                continue
+
+            base = self.layout[s['info']]
+            for offset, sym, type, addend in self.elf.relocations(s):
+                slot = base + offset
+                if type != abs32:
+                    raise common.fatal_error(f'unsupported relocation type {type} in section {s["name"]}')
+                if addend is None:
+                    addend = struct.unpack_from('<i', self.image, slot)[0]
+
+                target = self.symbol_offset(self.elf.symbols[sym]) + addend
+                struct.pack_into('<I', self.image, slot, target)
+                self.relocs.append(slot)
+
+        self.relocs.sort()
+
+    def find_entries(self):
+        index = [s for s in self.elf.symbols if s['name'] == INDEX_SYMBOL]
+        if len(index) != 1:
+            raise common.fatal_error(f'IPA configuration index "{INDEX_SYMBOL}" not found, is any JSON file given?')
+
+        base = self.symbol_offset(index[0])
+        relocs = set(self.relocs)
+        for i in range(index[0]['size'] // (2 * POINTER_SIZE)):
+            slots = (base + i * 2 * POINTER_SIZE, base + i * 2 * POINTER_SIZE + POINTER_SIZE)
+            if not all(s in relocs for s in slots):
+                raise common.fatal_error(f'IPA configuration index entry {i} is not relocatable')
+
+            name, config = struct.unpack_from('<II', self.image, slots[0])
+            size = self.config_size(config)
+            self.entries.append((name, config, size))
+
+    def config_size(self, offset):
+        for s in self.elf.symbols:
+            if s['size'] > 0 and s['shndx'] in self.layout and self.symbol_offset(s) == offset:
+                return s['size']
+        raise common.fatal_error(f'no symbol found for IPA configuration at offset {offset:#x}')
+
+    def name(self, offset):
+        end = self.image.index(b'\0', offset)
+        return self.image[offset:end].decode()
+
+    def get_bytes(self, version):
+        entry_offset = BLOB_HEADER.size
+        reloc_offset = entry_offset + len(self.entries) * BLOB_ENTRY.size
+        data_offset = align(reloc_offset + len(self.relocs) * BLOB_RELOC.size, BLOB_DATA_ALIGN)
+
+        body = bytearray()
+        for e in self.entries:
+            body += BLOB_ENTRY.pack(*e)
+        for r in self.relocs:
+            body += BLOB_RELOC.pack(r)
+        body += bytes(data_offset - BLOB_HEADER.size - len(body))
+        body += self.image
+
+        header = BLOB_HEADER.pack(BLOB_MAGIC, BLOB_VERSION, version, self.elf.machine, POINTER_SIZE,
+                                  BLOB_HEADER.size + len(body), zlib.crc32(body),
+                                  len(self.entries), entry_offset,
+                                  len(self.relocs), reloc_offset,
+                                  data_offset, len(self.image))
+        return header + body
+
+def ipa_blob(version, input, output):
+    blob = blob_c(elf_c(input))
+    data = blob.get_bytes(version)
+
+    with open(output, 'wb') as fp:
+        fp.write(data)
+
+    for name, config, size in blob.entries:
+        print(f'IPA configuration "{blob.name(name)}": offset {config:#x}, size {size}')
+    print(f'IPA configuration blob {output}: {len(data)} bytes, {len(blob.relocs)} relocations')
+
+def main():
+    parser = argparse.ArgumentParser(description='IPA configuration binary blob generation', prog='ipa_blob')
+
+    parser.add_argument(
+        '--input', '-i',
+        help='IPA configuration object file compiled from esp_ipa_config.py output',
+        type=str,
+        required=True)
+
+    parser.add_argument(
+        '--output', '-o',
+        help='Output blob file name with full path',
+        type=str,
+        required=True)
+
+    parser.add_argument(
+        '--version', '-v',
+        help='Configuration parameters version',
+        type=int,
+        required=True)
+
+    args = parser.parse_args()
+
+    ipa_blob(args.version, args.input, args.output)
+
+def _main():
+    try:
+        main()
+    except common.fatal_error as e:
+        print(f'\nA fatal error occurred: {e}')
+        sys.exit(2)
+
+if __name__ == '__main__':
+    _main()
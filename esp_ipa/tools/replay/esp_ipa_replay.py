@@ -0,0 +1,284 @@
+# SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+
+import argparse
+import json
+import os
+import re
+import sys
+
+sys.path.append(os.path.dirname(os.path.abspath(__file__)) + '/../config/isp')
+
+import common
+
+TRACE_VERSION = 1
+
+SENSOR_FIELDS = (
+    ('width', 'u'),
+    ('height', 'u'),
+    ('max_exposure', 'u'),
+    ('min_exposure', 'u'),
+    ('step_exposure', 'u'),
+    ('max_gain', 'f'),
+    ('min_gain', 'f'),
+    ('step_gain', 'f'),
+    ('max_ae_target_level', 'u'),
+    ('min_ae_target_level', 'u'),
+    ('step_ae_target_level', 'u'),
+)
+
+STATS_FLAGS = {
+    'awb': 'IPA_STATS_FLAGS_AWB',
+    'ae': 'IPA_STATS_FLAGS_AE',
+    'hist': 'IPA_STATS_FLAGS_HIST',
+    'sharpen': 'IPA_STATS_FLAGS_SHARPEN',
+    'af': 'IPA_STATS_FLAGS_AF',
+    'awb_subwin': 'IPA_STATS_FLAGS_AWB_SUBWIN',
+}
+
+REPLAY_LINE = re.compile(r'IPA_REPLAY,(\d+),([0-9a-fA-F]+),(\d+),([-\d.]+),([-\d.]+),([-\d.]+),(\d+),(\d+)')
+LATENCY_LINE = re.compile(r'IPA_REPLAY_LATENCY,(\d+),(\d+),(\d+)')
+
+def cvalue(value, type):
+    if type == 'f':
+        return f'{float(value)}f'
+    return f'{int(value)}'
+
+def awb_text(awb):
+    return (f'{{ .counted = {int(awb["counted"])}, .sum_r = {int(awb["sum_r"])}, '
+            f'.sum_g = {int(awb["sum_g"])}, .sum_b = {int(awb["sum_b"])} }}')
+
+def array_text(value, count_macro, fmt):
+    if isinstance(value, list):
+        return ', '.join(fmt(v) for v in value)
+    # A scalar value fills all elements, this keeps uniform scenes short in trace files
+    return f'[0 ... {count_macro} - 1] = {fmt(value)}'
+
+def frame_text(index, frame):
+    flags = list()
+    stats = str()
+
+    if 'ae' in frame:
+        stats += f'.ae_stats = {{ {array_text(frame["ae"], "ISP_AE_REGIONS", lambda v: f"{{ .luminance = {int(v)} }}")} }},\n'
+        flags.append('ae')
+    if 'awb' in frame:
+        stats += f'.awb_stats = {{ {awb_text(frame["awb"])} }},\n'
+        flags.append('awb')
+    if 'awb_subwin' in frame:
+        cells = frame['awb_subwin']
+        rows = ', '.join('{ ' + ', '.join(awb_text(c) for c in row) + ' }' for row in cells)
+        stats += f'.awb_subwin = {{ {rows} }},\n'
+        flags.append('awb_subwin')
+    if 'hist' in frame:
+        stats += f'.hist_stats = {{ {array_text(frame["hist"], "ISP_HIST_SEGMENT_NUMS", lambda v: f"{{ .value = {int(v)} }}")} }},\n'
+        flags.append('hist')
+    if 'sharpen' in frame:
+        stats += f'.sharpen_stats = {{ .value = {int(frame["sharpen"])} }},\n'
+        flags.append('sharpen')
+    if 'af' in frame:
+        af = ', '.join(f'{{ .definition = {int(a["definition"])}, .luminance = {int(a["luminance"])} }}' for a in frame['af'])
+        stats += f'.af_stats = {{ {af} }},\n'
+        flags.append('af')
+
+    flags_text = ' | '.join(STATS_FLAGS[f] for f in flags) if flags else '0'
+
+    return common.cfmt_string(f'''
+        {{
+            .exposure = {int(frame["exposure"])},
+            .gain = {float(frame["gain"])}f,
+            .ae_target_level = {int(frame.get("ae_target_level", 0))},
+            .focus_pos = {int(frame.get("focus_pos", 0))},
+            .stats = {{
+                .seq = {index},
+                .flags = {flags_text},
+                {stats}
+            }}
+        }},''')
+
+def expand_frames(frames):
+    for frame in frames:
+        for _ in range(int(frame.get('repeat', 1))):
+            yield frame
+
+def trace_gen(input, output):
+    j = json.loads(open(input, 'r').read())
+    if j.get('version') != TRACE_VERSION:
+        raise common.fatal_error(f'IPA replay trace file version should be {TRACE_VERSION}')
+
+    sensor = j['sensor']
+    frames = list(expand_frames(j['frames']))
+    if len(frames) == 0:
+        raise common.fatal_error('IPA replay trace has no frames')
+
+    sensor_text = str()
+    for name, type in SENSOR_FIELDS:
+        sensor_text += f'.{name} = {cvalue(sensor.get(name, 0), type)},\n'
+
+    focus_text = str()
+    if 'focus' in sensor:
+        focus = sensor['focus']
+        focus_text = common.cfmt_string(f'''
+            static esp_ipa_sensor_focus_t s_esp_ipa_replay_focus = {{
+                .max_pos = {int(focus["max_pos"])},
+                .min_pos = {int(focus["min_pos"])},
+                .step_pos = {int(focus.get("step_pos", 1))},
+                .period_in_us = {int(focus.get("period_in_us", 0))},
+                .codes_per_step = {int(focus.get("codes_per_step", 1))},
+            }};
+            ''')
+        sensor_text += '.focus_info = &s_esp_ipa_replay_focus,\n'
+
+    frames_text = str()
+    for i, frame in enumerate(frames):
+        frames_text += frame_text(i, frame)
+
+    text = common.cfmt_string(f'''
+        /*
+         * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+         *
+         * SPDX-License-Identifier: ESPRESSIF MIT
+         */
+
+        #include "esp_ipa_replay_trace.h"
+
+        {focus_text}
+        static const esp_ipa_replay_frame_t s_esp_ipa_replay_frames[] = {{
+            {frames_text}
+        }};
+
+        const esp_ipa_replay_trace_t g_esp_ipa_replay_trace = {{
+            .sensor = {{
+                {sensor_text}
+            }},
+            .closed_loop = {"true" if j.get("closed_loop", False) else "false"},
+            .frames = s_esp_ipa_replay_frames,
+            .frame_num = ARRAY_SIZE(s_esp_ipa_replay_frames),
+        }};
+
+        /* Trace file: {os.path.basename(input)} */
+        ''')
+
+    with open(output, 'w') as fp:
+        fp.write(text)
+
+def converge_frame(values, tolerance):
+    """
+    Return the first frame index after which all values stay within
+    tolerance (relative) of the final value.
+    """
+    final = values[-1]
+    limit = abs(final) * tolerance
+    index = len(values) - 1
+    while index > 0 and abs(values[index - 1] - final) <= limit:
+        index -= 1
+    return index
+
+def log_parse(input):
+    frames = list()
+    latency = None
+
+    with open(input, 'r', errors='ignore') as fp:
+        for line in fp:
+            m = REPLAY_LINE.search(line)
+            if m:
+                frames.append({
+                    'frame': int(m.group(1)),
+                    'flags': int(m.group(2), 16),
+                    'exposure': int(m.group(3)),
+                    'gain': float(m.group(4)),
+                    'red_gain': float(m.group(5)),
+                    'blue_gain': float(m.group(6)),
+                    'ae_target_level': int(m.group(7)),
+                    'latency_us': int(m.group(8)),
+                })
+                continue
+
+            m = LATENCY_LINE.search(line)
+            if m:
+                latency = {'min_us': int(m.group(1)), 'avg_us': int(m.group(2)), 'max_us': int(m.group(3))}
+
+    if len(frames) == 0:
+        raise common.fatal_error(f'no replay output found in {input}')
+
+    return frames, latency
+
+def log_report(frames, latency, tolerance):
+    luma = [f['exposure'] * f['gain'] for f in frames]
+    awb = [f['red_gain'] / f['blue_gain'] if f['blue_gain'] else 0.0 for f in frames]
+
+    if latency is None:
+        lat = [f['latency_us'] for f in frames]
+        latency = {'min_us': min(lat), 'avg_us': sum(lat) // len(lat), 'max_us': max(lat)}
+
+    return {
+        'frames': len(frames),
+        'ae_converge_frame': converge_frame(luma, tolerance),
+        'awb_converge_frame': converge_frame(awb, tolerance),
+        'final_exposure': frames[-1]['exposure'],
+        'final_gain': frames[-1]['gain'],
+        'final_red_gain': frames[-1]['red_gain'],
+        'final_blue_gain': frames[-1]['blue_gain'],
+        'latency': latency,
+    }
+
+def log_check(args):
+    frames, latency = log_parse(args.input)
+    report = log_report(frames, latency, args.tolerance)
+    print(json.dumps(report, indent=4))
+
+    if args.update_baseline:
+        with open(args.baseline, 'w') as fp:
+            fp.write(json.dumps(report, indent=4) + '\n')
+        return 0
+
+    errors = list()
+    if args.baseline:
+        baseline = json.loads(open(args.baseline, 'r').read())
+
+        for key in ('ae_converge_frame', 'awb_converge_frame'):
+            if report[key] > baseline[key] + args.frame_margin:
+                errors.append(f'{key} regressed: {report[key]} > {baseline[key]} + {args.frame_margin}')
+
+        base_avg = baseline['latency']['avg_us']
+        if report['latency']['avg_us'] > base_avg * (1.0 + args.latency_margin / 100.0):
+            errors.append(f'average latency regressed: {report["latency"]["avg_us"]}us > {base_avg}us + {args.latency_margin}%')
+
+    if args.max_converge_frames is not None:
+        for key in ('ae_converge_frame', 'awb_converge_frame'):
+            if report[key] > args.max_converge_frames:
+                errors.append(f'{key} {report[key]} exceeds {args.max_converge_frames}')
+
+    for e in errors:
+        print(f'error: {e}', file=sys.stderr)
+
+    return 1 if errors else 0
+
+def main():
+    parser = argparse.ArgumentParser(description='IPA replay trace generation and result check', prog='ipa_replay')
+    subparsers = parser.add_subparsers(dest='command', required=True)
+
+    gen = subparsers.add_parser('gen', help='generate C source from a JSON replay trace')
+    gen.add_argument('--input', '-i', help='JSON replay trace file', type=str, required=True)
+    gen.add_argument('--output', '-o', help='output C source file', type=str, required=True)
+
+    check = subparsers.add_parser('check', help='check replay output log for 3A convergence and latency regressions')
+    check.add_argument('--input', '-i', help='replay application output log', type=str, required=True)
+    check.add_argument('--baseline', '-b', help='baseline report JSON file', type=str)
+    check.add_argument('--update-baseline', help='write current report to baseline file', action='store_true')
+    check.add_argument('--tolerance', help='relative tolerance used to detect convergence', type=float, default=0.02)
+    check.add_argument('--frame-margin', help='allowed convergence frame increase against baseline', type=int, default=2)
+    check.add_argument('--latency-margin', help='allowed average latency increase against baseline in percent', type=float, default=20.0)
+    check.add_argument('--max-converge-frames', help='absolute convergence frame limit', type=int)
+
+    args = parser.parse_args()
+
+    if args.command == 'gen':
+        trace_gen(args.input, args.output)
+        return 0
+    else:
+        if args.update_baseline and not args.baseline:
+            parser.error('--update-baseline requires --baseline')
+        return log_check(args)
+
+if __name__ == '__main__':
+    sys.exit(main())
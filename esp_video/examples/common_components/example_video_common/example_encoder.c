@@ -12,6 +12,7 @@
 #include "esp_cam_sensor_xclk.h"
 #if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
 #include "driver/jpeg_encode.h"
+#include "esp_video_jpeg_engine.h"
 #else
 #include "esp_jpeg_enc.h"
 #endif
@@ -20,6 +21,7 @@
 typedef struct example_encoder {
 #if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
     jpeg_encode_cfg_t jpeg_enc_config;
+    esp_video_jpeg_engine_client_handle_t jpeg_client;
 #else
     jpeg_enc_handle_t jpeg_handle;
 #endif
@@ -28,14 +30,6 @@ typedef struct example_encoder {
 
 static const char *TAG = "example_encoder";
 
-#if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
-/**
- * @brief JPEG hardware encoder handle to provide a single instance for all video streams
- */
-static jpeg_encoder_handle_t s_jpeg_hw_handle;
-static uint32_t s_jpeg_hw_ref_count;
-#endif
-
 /**
  * @brief Initialize the encoder
  *
@@ -56,7 +50,7 @@ esp_err_t example_encoder_init(example_encoder_config_t *config, example_encoder
     uint32_t jpeg_enc_input_src_size;
 #if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
     jpeg_encode_cfg_t jpeg_enc_config = {0};
-    jpeg_encoder_handle_t jpeg_handle = NULL;
+    esp_video_jpeg_engine_client_handle_t jpeg_client = NULL;
 #else
     jpeg_enc_handle_t jpeg_handle = NULL;
     jpeg_enc_config_t jpeg_enc_config = {0};
@@ -107,12 +101,11 @@ esp_err_t example_encoder_init(example_encoder_config_t *config, example_encoder
         return ESP_ERR_NOT_SUPPORTED;
     }
 
-    if (!s_jpeg_hw_handle) {
-        jpeg_encode_engine_cfg_t encode_eng_cfg = {
-            .timeout_ms = 5000,
-        };
-        ESP_RETURN_ON_ERROR(jpeg_new_encoder_engine(&encode_eng_cfg, &jpeg_handle), TAG, "failed to create jpeg encoder engine");
-    }
+    /* The hardware encoder is shared with other streams and the JPEG encoder video device */
+    esp_video_jpeg_engine_client_config_t client_cfg = {
+        .priority = config->priority ? config->priority : ESP_VIDEO_JPEG_ENGINE_PRIORITY_DEFAULT,
+    };
+    ESP_RETURN_ON_ERROR(esp_video_jpeg_engine_client_create(&client_cfg, &jpeg_client), TAG, "failed to create jpeg engine client");
 #else
     jpeg_enc_config.quality = config->quality;
 
@@ -156,10 +149,7 @@ esp_err_t example_encoder_init(example_encoder_config_t *config, example_encoder
 
 #if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
     encoder->jpeg_enc_config = jpeg_enc_config;
-    if (!s_jpeg_hw_ref_count) {
-        s_jpeg_hw_ref_count++;
-        s_jpeg_hw_handle = jpeg_handle;
-    }
+    encoder->jpeg_client = jpeg_client;
 #else
     encoder->jpeg_handle = jpeg_handle;
 #endif
@@ -172,7 +162,7 @@ esp_err_t example_encoder_init(example_encoder_config_t *config, example_encoder
 
 fail0:
 #if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
-    jpeg_del_encoder_engine(jpeg_handle);
+    esp_video_jpeg_engine_client_delete(jpeg_client);
 #else
     jpeg_enc_close(jpeg_handle);
 #endif
@@ -190,13 +180,6 @@ fail0:
  */
 esp_err_t example_encoder_alloc_output_buffer(example_encoder_handle_t handle, uint8_t **buf, uint32_t *size)
 {
-#if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
-    if (!s_jpeg_hw_ref_count) {
-        ESP_LOGE(TAG, "jpeg hardware encoder is not initialized");
-        return ESP_ERR_INVALID_STATE;
-    }
-#endif
-
     uint8_t *jpeg_out_buf;
     example_encoder_t *encoder = (example_encoder_t *)handle;
     if (!encoder || !buf || !size) {
@@ -237,13 +220,6 @@ esp_err_t example_encoder_alloc_output_buffer(example_encoder_handle_t handle, u
  */
 esp_err_t example_encoder_free_output_buffer(example_encoder_handle_t handle, uint8_t *buf)
 {
-#if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
-    if (!s_jpeg_hw_ref_count) {
-        ESP_LOGE(TAG, "jpeg hardware encoder is not initialized");
-        return ESP_ERR_INVALID_STATE;
-    }
-#endif
-
     if (!buf || !handle) {
         ESP_LOGE(TAG, "invalid argument");
         return ESP_ERR_INVALID_ARG;
@@ -272,13 +248,6 @@ esp_err_t example_encoder_free_output_buffer(example_encoder_handle_t handle, ui
 esp_err_t example_encoder_process(example_encoder_handle_t handle, uint8_t *src_buf, uint32_t src_size,
                                   uint8_t *dst_buf, uint32_t dst_size, uint32_t *dst_size_out)
 {
-#if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
-    if (!s_jpeg_hw_ref_count) {
-        ESP_LOGE(TAG, "jpeg hardware encoder is not initialized");
-        return ESP_ERR_INVALID_STATE;
-    }
-#endif
-
     if (!handle || !src_buf || !src_size || !dst_buf || !dst_size || !dst_size_out) {
         return ESP_ERR_INVALID_ARG;
     }
@@ -287,7 +256,7 @@ esp_err_t example_encoder_process(example_encoder_handle_t handle, uint8_t *src_
     example_encoder_t *encoder = (example_encoder_t *)handle;
 
 #if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
-    ret = jpeg_encoder_process(s_jpeg_hw_handle, &encoder->jpeg_enc_config, src_buf, src_size, dst_buf, dst_size, dst_size_out);
+    ret = esp_video_jpeg_engine_encode(encoder->jpeg_client, &encoder->jpeg_enc_config, src_buf, src_size, dst_buf, dst_size, dst_size_out);
 #else
     ret = jpeg_enc_process(encoder->jpeg_handle, src_buf, src_size, dst_buf, dst_size, (int *)dst_size_out);
 #endif
@@ -335,15 +304,7 @@ esp_err_t example_encoder_deinit(example_encoder_handle_t handle)
     }
 
 #if CONFIG_EXAMPLE_SELECT_JPEG_HW_DRIVER
-    if (s_jpeg_hw_ref_count) {
-        s_jpeg_hw_ref_count--;
-        if (!s_jpeg_hw_ref_count) {
-            jpeg_del_encoder_engine(s_jpeg_hw_handle);
-            s_jpeg_hw_handle = NULL;
-        }
-    } else {
-        ESP_LOGW(TAG, "jpeg hardware encoder ref count already 0, possible double deinit");
-    }
+    esp_video_jpeg_engine_client_delete(encoder->jpeg_client);
 #else
     jpeg_enc_close(encoder->jpeg_handle);
 #endif
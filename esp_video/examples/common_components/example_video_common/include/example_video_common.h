@@ -211,6 +211,7 @@ typedef struct example_encoder_config {
     uint32_t height;            /**< Image height */
     uint32_t pixel_format;      /**< Input image pixel format in V4L2 format */
     uint8_t quality;            /**< Image quality */
+    uint8_t priority;           /**< Hardware JPEG encoder priority shared with other encoders, 0 means ESP_VIDEO_JPEG_ENGINE_PRIORITY_DEFAULT */
 } example_encoder_config_t;
 
 /**
@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Dual stream handle.
+ */
+typedef struct esp_video_dual_stream *esp_video_dual_stream_handle_t;
+
+/**
+ * @brief Dual stream ID.
+ */
+typedef enum esp_video_dual_stream_id {
+    ESP_VIDEO_DUAL_STREAM_MAIN = 0,     /*!< Main stream, encoded from the capture frame directly */
+    ESP_VIDEO_DUAL_STREAM_SUB,          /*!< Sub stream, encoded from the frame scaled down by PPA */
+} esp_video_dual_stream_id_t;
+
+/**
+ * @brief Encoded frame callback.
+ *
+ * @note Main stream callback is called in the task calling esp_video_dual_stream_process(), and
+ *       sub stream callback is called in the sub stream task. Data is only valid in the callback.
+ *
+ * @param user_data User data of the dual stream configuration
+ * @param id        Stream ID
+ * @param data      Encoded frame data
+ * @param size      Encoded frame size in bytes
+ * @param flags     V4L2 buffer flags of the encoded frame, e.g. V4L2_BUF_FLAG_KEYFRAME
+ */
+typedef void (*esp_video_dual_stream_cb_t)(void *user_data, esp_video_dual_stream_id_t id,
+                                           const uint8_t *data, uint32_t size, uint32_t flags);
+
+/**
+ * @brief Dual stream encoder configuration.
+ */
+typedef struct esp_video_dual_stream_encoder {
+    int fd;                             /*!< Opened M2M encoder video device file descriptor, e.g. ESP_VIDEO_H264_DEVICE_NAME */
+    uint32_t pixel_format;              /*!< Encoded V4L2 pixel format, V4L2_PIX_FMT_H264 or V4L2_PIX_FMT_JPEG */
+} esp_video_dual_stream_encoder_t;
+
+/**
+ * @brief Dual stream configuration.
+ */
+typedef struct esp_video_dual_stream_config {
+    uint32_t width;                     /*!< Capture frame width in pixels, it is the main stream width */
+    uint32_t height;                    /*!< Capture frame height in pixels, it is the main stream height */
+    uint32_t pixel_format;              /*!< Capture frame V4L2 pixel format, V4L2_PIX_FMT_YUV420, V4L2_PIX_FMT_RGB565 or V4L2_PIX_FMT_RGB24 */
+
+    esp_video_dual_stream_encoder_t main;   /*!< Main stream encoder */
+    esp_video_dual_stream_encoder_t sub;    /*!< Sub stream encoder, it must be a different video device from the main stream encoder */
+    uint32_t sub_width;                 /*!< Sub stream width in pixels, not larger than width */
+    uint32_t sub_height;                /*!< Sub stream height in pixels, not larger than height */
+    uint8_t sub_interval;               /*!< Encode sub stream every sub_interval capture frames, 0 means 1 */
+    uint8_t sub_task_priority;          /*!< Sub stream task priority, 0 means 5 */
+
+    esp_video_dual_stream_cb_t cb;      /*!< Encoded frame callback */
+    void *user_data;                    /*!< User data of callback */
+} esp_video_dual_stream_config_t;
+
+/**
+ * @brief Dual stream statistics.
+ */
+typedef struct esp_video_dual_stream_stats {
+    uint32_t frames;                    /*!< Capture frames processed */
+    uint32_t main_frames;               /*!< Main stream frames encoded */
+    uint32_t sub_frames;                /*!< Sub stream frames encoded */
+    uint32_t sub_skipped;               /*!< Sub stream frames skipped because the previous one was still being encoded */
+    uint32_t errors;                    /*!< Frames failed to be scaled or encoded */
+} esp_video_dual_stream_stats_t;
+
+/**
+ * @brief Create dual stream object, it configures formats and buffers of both encoder video
+ *        devices and starts streaming of them.
+ *
+ * @note The main stream encoder reads capture frames by V4L2_MEMORY_USERPTR without copying,
+ *       so capture buffers must meet the encoder buffer requirement, e.g. allocated by MMAP of
+ *       the camera video device. Sub stream frame is scaled by PPA into the sub stream encoder
+ *       buffer. PPA scales by 1/16 steps, if the ratio of sizes is not a multiple of it, the
+ *       center of the capture frame is scaled to keep the sub stream size.
+ *
+ * @note Encoder controls, e.g. bitrate and JPEG quality, are set by the application through the
+ *       encoder file descriptors.
+ *
+ * @param config Dual stream configuration
+ * @param handle Pointer to store dual stream handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format or scaling ratio is not supported
+ *      - ESP_ERR_NO_MEM if failed to allocate memory
+ *      - Others if failed to configure encoder video devices or PPA
+ */
+esp_err_t esp_video_dual_stream_create(const esp_video_dual_stream_config_t *config, esp_video_dual_stream_handle_t *handle);
+
+/**
+ * @brief Encode a capture frame into the main stream and, when it is due, the sub stream.
+ *
+ * The frame is scaled by PPA for the sub stream first, then the sub stream is encoded in the
+ * sub stream task while the main stream is encoded in the calling task, so the two encoder
+ * engines work at the same time. If the sub stream task is still encoding the previous frame,
+ * this frame is skipped by the sub stream instead of blocking the main stream.
+ *
+ * The capture frame is not used any more when this function returns, so it can be queued back
+ * to the camera video device.
+ *
+ * @param handle Dual stream handle
+ * @param frame  Capture frame buffer pointer
+ * @param size   Capture frame size in bytes
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_SIZE if frame is smaller than the capture format
+ *      - Others if failed to encode the main stream
+ */
+esp_err_t esp_video_dual_stream_process(esp_video_dual_stream_handle_t handle, const uint8_t *frame, size_t size);
+
+/**
+ * @brief Get dual stream statistics.
+ *
+ * @param handle Dual stream handle
+ * @param stats  Pointer to store statistics
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_dual_stream_get_stats(esp_video_dual_stream_handle_t handle, esp_video_dual_stream_stats_t *stats);
+
+/**
+ * @brief Delete dual stream object, it waits for the sub stream frame being encoded and stops
+ *        streaming of both encoder video devices, the file descriptors are not closed.
+ *
+ * @param handle Dual stream handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_dual_stream_delete(esp_video_dual_stream_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
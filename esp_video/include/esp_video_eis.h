@@ -0,0 +1,165 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "linux/videodev2.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VIDEO_EIS_IMU_SAMPLE_NUM        64  /*!< Number of IMU samples kept between two frames */
+
+/**
+ * @brief Electronic image stabilization handle.
+ */
+typedef struct esp_video_eis *esp_video_eis_handle_t;
+
+/**
+ * @brief Source of camera motion.
+ */
+typedef enum esp_video_eis_motion_source {
+    ESP_VIDEO_EIS_MOTION_SOURCE_IMAGE = 0,      /*!< Motion is estimated by block matching of frames */
+    ESP_VIDEO_EIS_MOTION_SOURCE_IMU,            /*!< Motion is integrated from gyroscope samples fed by esp_video_eis_feed_imu() */
+} esp_video_eis_motion_source_t;
+
+/**
+ * @brief Electronic image stabilization configuration.
+ */
+typedef struct esp_video_eis_config {
+    uint32_t sensor_width;                      /*!< Camera sensor output width, the area where crop window moves */
+    uint32_t sensor_height;                     /*!< Camera sensor output height, the area where crop window moves */
+    uint32_t crop_width;                        /*!< Crop window width, it is the captured frame width */
+    uint32_t crop_height;                       /*!< Crop window height, it is the captured frame height */
+    uint32_t pixel_format;                      /*!< Captured frame V4L2 pixel format, e.g. V4L2_PIX_FMT_YUV420 */
+
+    esp_video_eis_motion_source_t motion_source;    /*!< Source of camera motion */
+    uint32_t downscale;                         /*!< Frame is downscaled by this factor before block matching, 0 means 4 */
+    uint32_t search_range;                      /*!< Block matching search range in downscaled pixels, 0 means 6 */
+    uint8_t smoothing;                          /*!< Weight of previous intended camera path in 1/256, larger value keeps the view steadier, 0 means 240 */
+    uint8_t crop_latency;                       /*!< Frames from setting crop window to the first frame captured with it, 0 means 1 */
+    float focal_length;                         /*!< Lens focal length in sensor pixels, it converts IMU rotation to pixels */
+} esp_video_eis_config_t;
+
+/**
+ * @brief Gyroscope sample.
+ *
+ * @note Swap or negate axes according to the IMU mounting, so that positive rates move the
+ *       scene to the right and down on the sensor.
+ */
+typedef struct esp_video_eis_imu_sample {
+    int64_t timestamp_us;                       /*!< Sample time, in the same clock as "timestamp" of "struct v4l2_buffer" */
+    float rate_x;                               /*!< Angular rate in rad/s which moves the scene horizontally */
+    float rate_y;                               /*!< Angular rate in rad/s which moves the scene vertically */
+} esp_video_eis_imu_sample_t;
+
+/**
+ * @brief Electronic image stabilization result of a frame.
+ */
+typedef struct esp_video_eis_result {
+    struct v4l2_rect crop;                      /*!< Crop window to set by VIDIOC_S_SELECTION for the following frames */
+    int32_t motion_x;                           /*!< Horizontal scene motion of this frame in 1/16 pixel */
+    int32_t motion_y;                           /*!< Vertical scene motion of this frame in 1/16 pixel */
+    bool valid;                                 /*!< false if motion can't be estimated, e.g. flat scene, and it is treated as still */
+} esp_video_eis_result_t;
+
+/**
+ * @brief Create electronic image stabilization object.
+ *
+ * Stabilization only moves the ISP crop window, so no frame is copied. Set the crop window
+ * from esp_video_eis_get_crop() by VIDIOC_S_SELECTION before stream on, then process every
+ * dequeued frame and set the result crop window while streaming.
+ *
+ * @note Supported pixel formats: V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_UYVY and
+ *       V4L2_PIX_FMT_YUV420 in ISP output layout.
+ *
+ * @param config Electronic image stabilization configuration
+ * @param handle Pointer to store electronic image stabilization handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format is not supported
+ *      - ESP_ERR_NO_MEM if failed to allocate memory
+ */
+esp_err_t esp_video_eis_create(const esp_video_eis_config_t *config, esp_video_eis_handle_t *handle);
+
+/**
+ * @brief Get crop window to set before stream on, it is at the center of sensor.
+ *
+ * @param handle Electronic image stabilization handle
+ * @param crop   Pointer to store crop window
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_eis_get_crop(esp_video_eis_handle_t handle, struct v4l2_rect *crop);
+
+/**
+ * @brief Feed gyroscope samples, this can be called from the IMU task.
+ *
+ * @param handle  Electronic image stabilization handle
+ * @param samples Gyroscope samples in time order
+ * @param num     Number of samples
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if motion source is not IMU
+ */
+esp_err_t esp_video_eis_feed_imu(esp_video_eis_handle_t handle, const esp_video_eis_imu_sample_t *samples, uint32_t num);
+
+/**
+ * @brief Estimate camera motion of a frame and move crop window to cancel it.
+ *
+ * @param handle       Electronic image stabilization handle
+ * @param frame        Frame buffer pointer, it can be NULL if motion source is IMU
+ * @param size         Frame buffer size in bytes
+ * @param timestamp_us Frame time, e.g. "timestamp" of "struct v4l2_buffer"
+ * @param result       Pointer to store result
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_SIZE if buffer is smaller than the frame
+ */
+esp_err_t esp_video_eis_process(esp_video_eis_handle_t handle, const uint8_t *frame, size_t size,
+                                int64_t timestamp_us, esp_video_eis_result_t *result);
+
+/**
+ * @brief Drop the previous frame and camera path, e.g. after stream restart.
+ *
+ * @note The crop window moves back to the center, set it by VIDIOC_S_SELECTION.
+ *
+ * @param handle Electronic image stabilization handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_eis_reset(esp_video_eis_handle_t handle);
+
+/**
+ * @brief Delete electronic image stabilization object.
+ *
+ * @param handle Electronic image stabilization handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_eis_delete(esp_video_eis_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief H.264 adaptive bitrate handle.
+ */
+typedef struct esp_video_h264_abr *esp_video_h264_abr_handle_t;
+
+/**
+ * @brief H.264 adaptive bitrate configuration.
+ */
+typedef struct esp_video_h264_abr_config {
+    int fd;                             /*!< H.264 video device file descriptor, its current bitrate is the initial bitrate */
+    uint32_t min_bitrate;               /*!< Minimum bitrate in bits per second */
+    uint32_t max_bitrate;               /*!< Maximum bitrate in bits per second */
+
+    uint8_t high_level;                 /*!< Send queue level in percent from which bitrate is decreased, 0 means 50 */
+    uint8_t low_level;                  /*!< Send queue level in percent below which bitrate can be increased, 0 means 10 */
+    uint32_t increase_interval_ms;      /*!< Time of send queue staying below low_level before every increase step, 0 means 1000 */
+} esp_video_h264_abr_config_t;
+
+/**
+ * @brief Network feedback of H.264 stream sender.
+ */
+typedef struct esp_video_h264_abr_feedback {
+    uint32_t queued_bytes;              /*!< Bytes waiting in the send queue */
+    uint32_t queue_size;                /*!< Capacity of the send queue in bytes */
+    bool dropped;                       /*!< Data of a frame has been dropped since the last feedback */
+} esp_video_h264_abr_feedback_t;
+
+/**
+ * @brief Create H.264 adaptive bitrate object.
+ *
+ * @param config H.264 adaptive bitrate configuration
+ * @param handle Pointer to store H.264 adaptive bitrate handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NO_MEM if failed to allocate memory
+ *      - Others if failed to get bitrate of the H.264 video device
+ */
+esp_err_t esp_video_h264_abr_create(const esp_video_h264_abr_config_t *config, esp_video_h264_abr_handle_t *handle);
+
+/**
+ * @brief Update bitrate of the H.264 video device by network feedback.
+ *
+ * Call it after every frame is put into the send queue, or periodically. The new bitrate is
+ * set by V4L2_CID_MPEG_VIDEO_BITRATE and takes effect from the next encoded frame, and an IDR
+ * frame is requested by V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME if "dropped" is set. IDR frames are
+ * requested at most once every 300ms, data dropped within this time is recovered by the next one.
+ *
+ * @param handle   H.264 adaptive bitrate handle
+ * @param feedback Network feedback
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - Others if failed to set controls of the H.264 video device
+ */
+esp_err_t esp_video_h264_abr_update(esp_video_h264_abr_handle_t handle, const esp_video_h264_abr_feedback_t *feedback);
+
+/**
+ * @brief Get current bitrate.
+ *
+ * @param handle  H.264 adaptive bitrate handle
+ * @param bitrate Pointer to store bitrate in bits per second
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_h264_abr_get_bitrate(esp_video_h264_abr_handle_t handle, uint32_t *bitrate);
+
+/**
+ * @brief Delete H.264 adaptive bitrate object, the bitrate of the H.264 video device is kept.
+ *
+ * @param handle H.264 adaptive bitrate handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_h264_abr_delete(esp_video_h264_abr_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
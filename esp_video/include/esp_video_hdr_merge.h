@@ -0,0 +1,94 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
+#include "esp_ipa_types.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VIDEO_HDR_MERGE_MAX_NUM         4   /*!< Maximum number of frames merged into one frame */
+#define ESP_VIDEO_HDR_MERGE_LUT_SIZE        256 /*!< Entry number of linearization and tone lookup tables */
+#define ESP_VIDEO_HDR_MERGE_LINEAR_MAX      4095 /*!< Maximum value of linearization lookup table */
+
+/**
+ * @brief HDR merge configuration.
+ */
+typedef struct esp_video_hdr_merge_config {
+    uint32_t width;                     /*!< Frame width in pixels */
+    uint32_t height;                    /*!< Frame height in pixels */
+    uint32_t pixel_format;              /*!< Frame V4L2 pixel format, e.g. V4L2_PIX_FMT_SBGGR8 */
+
+    uint32_t num;                       /*!< Number of frames to merge, 2 ~ ESP_VIDEO_HDR_MERGE_MAX_NUM */
+    uint32_t exposure[ESP_VIDEO_HDR_MERGE_MAX_NUM]; /*!< Exposure of every frame, e.g. exposure time in microseconds multiplied by gain, only the ratio is used */
+
+    const uint16_t *linear_lut;         /*!< Lookup table to convert pixel value to linear value in 0 ~ ESP_VIDEO_HDR_MERGE_LINEAR_MAX, NULL means pixel value is linear, e.g. RAW frames */
+    const uint8_t *tone_lut;            /*!< Lookup table applied to log compressed radiance, NULL means no tone mapping */
+    uint8_t saturation;                 /*!< Pixel value from which pixels are treated as saturated, 0 means 250 */
+} esp_video_hdr_merge_config_t;
+
+/**
+ * @brief Merge frames of different exposures into one frame with higher dynamic range.
+ *
+ * Pixel values are converted to linear values and divided by frame exposure, the radiance is
+ * the weighted average of all frames, where pixels close to black or saturation have lower
+ * weight and saturated pixels are excluded. The radiance is compressed in log domain to 8 bits
+ * and mapped by the tone lookup table.
+ *
+ * @note Supported pixel formats: V4L2_PIX_FMT_SBGGR8, V4L2_PIX_FMT_SGBRG8, V4L2_PIX_FMT_SGRBG8,
+ *       V4L2_PIX_FMT_SRGGB8, V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_YUYV and V4L2_PIX_FMT_UYVY. Only Y of
+ *       YUV frames is merged, U and V are copied from the frame with the highest weight.
+ *
+ * @param config HDR merge configuration
+ * @param frames Frame buffer pointers, the number is "config->num"
+ * @param size   Size of every frame buffer and the output buffer in bytes
+ * @param out    Output buffer pointer, it can be one of "frames"
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format is not supported
+ *      - ESP_ERR_INVALID_SIZE if buffer is smaller than the frame
+ */
+esp_err_t esp_video_hdr_merge_process(const esp_video_hdr_merge_config_t *config, const uint8_t *const frames[],
+                                      size_t size, uint8_t *out);
+
+#if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
+/**
+ * @brief Convert an IPA GAMMA curve to a tone lookup table of HDR merge, so that the
+ *        GAMMA curve of an AEN GAMMA unit can be used for tone mapping.
+ *
+ * @param gamma IPA GAMMA channel pointer
+ * @param lut   Tone lookup table, the size is ESP_VIDEO_HDR_MERGE_LUT_SIZE
+ *
+ * @return None
+ */
+void esp_video_hdr_merge_gamma_to_tone_lut(const esp_ipa_gamma_channel_t *gamma, uint8_t *lut);
+
+/**
+ * @brief Convert the inverse of an IPA GAMMA curve to a linearization lookup table of HDR
+ *        merge, this is used when frames are processed by ISP GAMMA.
+ *
+ * @param gamma IPA GAMMA channel pointer
+ * @param lut   Linearization lookup table, the size is ESP_VIDEO_HDR_MERGE_LUT_SIZE
+ *
+ * @return None
+ */
+void esp_video_hdr_merge_gamma_to_linear_lut(const esp_ipa_gamma_channel_t *gamma, uint16_t *lut);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
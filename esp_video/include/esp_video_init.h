@@ -193,7 +193,8 @@ typedef struct esp_video_init_usb_uvc_config {
 typedef struct esp_video_init_jpeg_enc_config {
     jpeg_encoder_handle_t enc_handle;           /*!< JPEG encoder driver handle:
                                                      - NULL, JPEG video device will create JPEG encoder driver handle by itself
-                                                     - Not null, JPEG video device will use this handle instead of creating JPEG encoder driver handle */
+                                                     - Not null, JPEG video device will use this handle instead of creating JPEG encoder driver handle
+                                                     The handle is used by the shared JPEG engine, see esp_video_jpeg_engine.h */
 } esp_video_init_jpeg_enc_config_t;
 
 /**
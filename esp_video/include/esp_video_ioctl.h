@@ -39,6 +39,55 @@ struct v4l2_event_callback {
     void *user_data;
 };
 
+/**
+ * @brief Zero shutter lag ring configuration.
+ */
+struct v4l2_zsl_ring {
+    uint32_t type;              /*!< enum v4l2_buf_type, only V4L2_BUF_TYPE_VIDEO_CAPTURE is supported */
+    uint32_t count;             /*!< Number of recent frames kept in the ring, 0 means disabling the ring */
+};
+
+/**
+ * @brief Zero shutter lag frame request.
+ *
+ * @note "timestamp" is in the clock of "timestamp" of struct v4l2_buffer, which is esp_timer_get_time(),
+ *       the time since boot, so a trigger time from gettimeofday() doesn't match frames.
+ */
+struct v4l2_zsl_frame {
+    uint32_t type;              /*!< enum v4l2_buf_type, only V4L2_BUF_TYPE_VIDEO_CAPTURE is supported */
+    struct timeval timestamp;   /*!< Input: trigger time from esp_timer_get_time(); output: timestamp of the frame */
+    uint32_t sequence;          /*!< Output: sequence of the frame */
+    uint8_t *buffer;            /*!< Input: buffer to copy the frame into */
+    uint32_t length;            /*!< Input: buffer size */
+    uint32_t bytesused;         /*!< Output: frame data size */
+};
+
+#define ESP_VIDEO_H264_ROI_MAX_NUM      8       /*!< Maximum number of H.264 ROI regions */
+#define ESP_VIDEO_H264_ROI_MIN_DELTA_QP -32     /*!< Minimum QP offset of H.264 ROI */
+#define ESP_VIDEO_H264_ROI_MAX_DELTA_QP 31      /*!< Maximum QP offset of H.264 ROI */
+
+/**
+ * @brief H.264 region of interest.
+ *
+ * @note Encoder works on 16x16 macroblocks, so the region is expanded to macroblock boundaries.
+ */
+typedef struct esp_video_h264_roi_region {
+    uint16_t left;              /*!< Left of region in pixels */
+    uint16_t top;               /*!< Top of region in pixels */
+    uint16_t width;             /*!< Width of region in pixels */
+    uint16_t height;            /*!< Height of region in pixels */
+    int8_t delta_qp;            /*!< QP offset of region, negative value spends more bits on it */
+} esp_video_h264_roi_region_t;
+
+/**
+ * @brief H.264 regions of interest, it is the payload of V4L2_CID_CODEC_ESP_H264_ROI.
+ */
+typedef struct esp_video_h264_roi {
+    uint8_t num;                /*!< Number of valid regions, 0 disables ROI */
+    int8_t background_delta_qp; /*!< QP offset of macroblocks out of all regions, positive value saves bits of background */
+    esp_video_h264_roi_region_t regions[ESP_VIDEO_H264_ROI_MAX_NUM]; /*!< Regions, a macroblock in several regions takes the first one */
+} esp_video_h264_roi_t;
+
 #define V4L2_FMT_STR                    "%c%c%c%c"
 #define V4L2_FMT_STR_ARG(fmt)           (uint8_t)(((fmt) >> 0)  & 0xFF), \
                                         (uint8_t)(((fmt) >> 8)  & 0xFF), \
@@ -73,11 +122,101 @@ struct v4l2_event_callback {
  */
 #define VIDIOC_S_EVENT_CALLBACK  _IOW('V',  BASE_VIDIOC_PRIVATE + 9, struct v4l2_event_callback)
 
+/**
+ * @brief Keep copies of the most recent frames of capture stream in PSRAM, so that a frame
+ *        captured before a shutter trigger can be fetched by VIDIOC_G_ZSL_FRAME.
+ *
+ * @note Frames are copied when they are dequeued by VIDIOC_DQBUF, so the ring doesn't hold
+ *       DMA buffers. Call it after VIDIOC_REQBUFS, because frame size is the buffer size.
+ */
+#define VIDIOC_S_ZSL_RING   _IOW('V',  BASE_VIDIOC_PRIVATE + 10, struct v4l2_zsl_ring)
+
+/**
+ * @brief Copy the latest frame done before the trigger time out of zero shutter lag ring.
+ */
+#define VIDIOC_G_ZSL_FRAME  _IOWR('V',  BASE_VIDIOC_PRIVATE + 11, struct v4l2_zsl_frame)
+
 #define V4L2_CID_CAMERA_AE_LEVEL        (V4L2_CID_CAMERA_CLASS_BASE + 40)
 #define V4L2_CID_CAMERA_STATS           (V4L2_CID_CAMERA_CLASS_BASE + 41)
 #define V4L2_CID_CAMERA_GROUP           (V4L2_CID_CAMERA_CLASS_BASE + 42)
 #define V4L2_CID_MOTOR_START_TIME       (V4L2_CID_CAMERA_CLASS_BASE + 43)
 
+#define V4L2_CID_CODEC_ESP_BASE         (V4L2_CTRL_CLASS_CODEC | 0x1200)
+
+/**
+ * @brief H.264 video device dequeues capture buffers by NAL units instead of access units.
+ *
+ * @note Only valid when option ESP_VIDEO_ENABLE_H264_NAL_OUTPUT is enabled, and it can't
+ *       be changed when the encoder is started.
+ *
+ * @note If an access unit fails to be encoded, an empty buffer with flags V4L2_BUF_FLAG_ERROR
+ *       and V4L2_BUF_FLAG_ESP_FRAME_END is dequeued instead.
+ */
+#define V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT  (V4L2_CID_CODEC_ESP_BASE + 0)
+
+/**
+ * @brief H.264 video device regions of interest, payload is esp_video_h264_roi_t by "p_u8" and "size".
+ *
+ * @note Only hardware H.264 video device supports it. It can be set when the encoder is started,
+ *       and takes effect from the next encoded frame, so it can follow detection results frame by frame.
+ */
+#define V4L2_CID_CODEC_ESP_H264_ROI         (V4L2_CID_CODEC_ESP_BASE + 1)
+
+/**
+ * @brief H.264 video device read-only number of frames which are larger than the capture buffer.
+ *
+ * @note Only valid when option ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION is enabled, such a frame
+ *       is encoded again as an IDR frame. If the IDR frame is still larger than the capture buffer, it is
+ *       encoded once more with the maximum QP, which is kept until the GOP ends, and it is dropped only
+ *       if it still doesn't fit.
+ */
+#define V4L2_CID_CODEC_ESP_H264_OVERFLOW_FRAMES (V4L2_CID_CODEC_ESP_BASE + 2)
+
+/**
+ * @brief Buffer flags of H.264 NAL unit output, the buffer data keeps the Annex B start code.
+ */
+#define V4L2_BUF_FLAG_ESP_NAL_START     0x01000000  /*!< Buffer starts a NAL unit */
+#define V4L2_BUF_FLAG_ESP_NAL_END       0x02000000  /*!< Buffer ends a NAL unit */
+#define V4L2_BUF_FLAG_ESP_FRAME_END     0x04000000  /*!< Buffer is the last one of an access unit or a JPEG frame */
+
+#define V4L2_CID_JPEG_ESP_BASE          (V4L2_CTRL_CLASS_JPEG | 0x1000)
+
+/**
+ * @brief JPEG encoder video device target frame size in bytes, 0 disables it.
+ *
+ * @note Quality is predicted from the size of the previous frame to meet the target, and a frame
+ *       larger than the target by more than 1/8 is encoded again with lower quality, at most twice.
+ *       V4L2_CID_JPEG_COMPRESSION_QUALITY is the highest quality used, and getting it returns the
+ *       quality predicted for the next frame when the target size is set.
+ */
+#define V4L2_CID_JPEG_ESP_TARGET_SIZE   (V4L2_CID_JPEG_ESP_BASE + 0)
+
+/**
+ * @brief JPEG encoder video device dequeues a frame by several capture buffers whose size is set
+ *        by "sizeimage" of VIDIOC_S_FMT, the last one is marked by V4L2_BUF_FLAG_ESP_FRAME_END.
+ *
+ * @note Only valid when option ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT is enabled, and it can't
+ *       be changed when the encoder is started.
+ *
+ * @note If a frame fails to be encoded, an empty buffer with flags V4L2_BUF_FLAG_ERROR and
+ *       V4L2_BUF_FLAG_ESP_FRAME_END is dequeued instead.
+ */
+#define V4L2_CID_JPEG_ESP_CHUNK_OUTPUT  (V4L2_CID_JPEG_ESP_BASE + 1)
+
+/**
+ * @brief JPEG encoder video device priority of the shared hardware JPEG encoder, from 0 to
+ *        ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX, see esp_video_jpeg_engine.h.
+ */
+#define V4L2_CID_JPEG_ESP_ENGINE_PRIORITY   (V4L2_CID_JPEG_ESP_BASE + 2)
+
+/**
+ * @brief JPEG encoder video device read-only number of frames which are larger than the capture buffer.
+ *
+ * @note Only valid when option ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION is enabled, such a frame
+ *       is encoded again with lower quality to fit the capture buffer.
+ */
+#define V4L2_CID_JPEG_ESP_OVERFLOW_FRAMES   (V4L2_CID_JPEG_ESP_BASE + 3)
+
 /**
  * @brief Use this class to call esp_cam_sensor ioctl commands directly, this is only
  * used for camera sensor, not for motor controller.
@@ -128,6 +267,32 @@ typedef struct v4l2_event_esp_mipi_csi_error {
     uint32_t host_err_mask;          /*!< Host error mask */
 } v4l2_event_esp_mipi_csi_error_t;
 
+/**
+ * @brief Motion detection event.
+ *
+ * This event is sent to the camera video device by the ISP pipeline controller when motion
+ * starts and stops. Motion is detected from ISP AE and AWB statistics grids, so no frame is
+ * read by CPU. Subscribe it before stream on.
+ */
+#define V4L2_EVENT_ESP_MOTION_DETECT    (V4L2_EVENT_PRIVATE_START + 4)
+
+#define ESP_MOTION_DETECT_STATE_STOP    0   /*!< Motion stops */
+#define ESP_MOTION_DETECT_STATE_START   1   /*!< Motion starts */
+
+/**
+ * @brief Motion detection event data.
+ */
+typedef struct v4l2_event_esp_motion_detect {
+    uint32_t state;                  /*!< ESP_MOTION_DETECT_STATE_START or ESP_MOTION_DETECT_STATE_STOP */
+    uint32_t map;                    /*!< Coarse motion map, bit "y * grid_width + x" is set if the cell changed during the motion */
+    uint8_t grid_width;              /*!< Number of motion map cells in horizontal direction */
+    uint8_t grid_height;             /*!< Number of motion map cells in vertical direction */
+    uint8_t scene_change;            /*!< 1 if most of the scene changed, e.g. the camera is moved or covered */
+    uint8_t reserved;
+    uint32_t level;                  /*!< Maximum relative change of cells in 1/256 */
+    uint32_t frames;                 /*!< Number of statistics frames of the motion */
+} v4l2_event_esp_motion_detect_t;
+
 #ifdef __cplusplus
 }
 #endif
@@ -62,6 +62,27 @@ extern "C" {
 #define V4L2_CID_USER_ESP_ISP_AE             (V4L2_CID_USER_ESP_ISP_BASE + 0x000c)   /*!< Auto exposure V4L2 controller ID */
 #define V4L2_CID_USER_ESP_ISP_HIST           (V4L2_CID_USER_ESP_ISP_BASE + 0x000d)   /*!< Histogram V4L2 controller ID */
 
+/**
+ * @brief Power line frequency detected from light flicker by ISP pipeline controller, it is 50 or 60
+ *        in Hz, or 0 if no flicker is detected yet.
+ *
+ * @note This command is for the ISP video device, and it is read-only, only ISP pipeline controller updates it.
+ *
+ * @note Set V4L2_CID_POWER_LINE_FREQUENCY of the ISP video device to V4L2_CID_POWER_LINE_FREQUENCY_AUTO
+ *       to make AGC anti-flicker follow the detected frequency, or to another value to force it.
+ */
+#define V4L2_CID_USER_ESP_ISP_FLICKER        (V4L2_CID_USER_ESP_ISP_BASE + 0x000e)
+
+/**
+ * @brief Statistics sequence number of the first frame which is processed completely with the
+ *        configuration committed last time, it is read-only.
+ *
+ * @note When CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG is enabled, image processing controls set while
+ *       ISP statistics are streaming are collected and committed together at the next frame boundary,
+ *       compare this with "seq" of "esp_video_isp_stats_t" to know which statistics show the new configuration.
+ */
+#define V4L2_CID_USER_ESP_ISP_COMMIT_SEQ     (V4L2_CID_USER_ESP_ISP_BASE + 0x000f)
+
 /**
  * @brief ESP32XXX ISP image statistics output, data type is "esp_ipa_stats_t"
  */
@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <sys/time.h>
 #include "sdkconfig.h"
 #include "esp_err.h"
 #include "esp_video_isp_ioctl.h"
@@ -17,12 +18,25 @@ extern "C" {
 #endif
 
 #if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
+#include "esp_ipa_types.h"
 
 #define ESP_VIDEO_ISP_AF_STATS_WIN              (1 << 0)    /*!< AF statistics window */
 #define ESP_VIDEO_ISP_AWB_STATS_WIN             (1 << 1)    /*!< AWB statistics window */
 #define ESP_VIDEO_ISP_AE_STATS_WIN              (1 << 2)    /*!< AE statistics window */
 #define ESP_VIDEO_ISP_HIST_STATS_WIN            (1 << 3)    /*!< Hist statistics window */
 
+#define ESP_VIDEO_ISP_ROI_MAX_NUM               8           /*!< Maximum number of regions of interest */
+#define ESP_VIDEO_ISP_ROI_WEIGHT_MAX            255         /*!< Maximum weight of region of interest */
+
+/**
+ * @brief Region of interest of AE and AWB.
+ */
+typedef struct esp_video_isp_roi {
+    esp_ipa_region_t region;    /*!< Region in camera sensor output resolution */
+    uint32_t weight;            /*!< Extra weight of region, a pixel in this region weighs 1 + weight while other
+                                     parts of image weigh 1, e.g. 7 means a pixel in this region is 8 times as important */
+} esp_video_isp_roi_t;
+
 /**
  * @brief AGC status.
  */
@@ -31,6 +45,24 @@ typedef enum esp_video_isp_pipeline_agc_status {
     ESP_VIDEO_ISP_PIPELINE_AGC_ENABLE   = 1, /**< AGC enabled */
 } esp_video_isp_pipeline_agc_status_t;
 
+/**
+ * @brief Swap IPA pipeline configuration without stopping ISP pipeline.
+ *
+ * @note The new IPA pipeline is created in the caller context and replaces the running one
+ *       in ISP task before the next statistics frame is processed. It is initialized from
+ *       the current sensor state, and the current exposure, gain, white balance gains, focus
+ *       position and AGC settings are kept, so the image has no visible exposure reset.
+ *       The IPA configuration must be valid until the next swap or ISP pipeline deinitialization.
+ *
+ * @param ipa_config IPA configuration, e.g. from esp_ipa_pipeline_get_config() or esp_ipa_blob_get_config()
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_swap_ipa_config(const esp_ipa_config_t *ipa_config);
+
 /**
  * @brief Set AGC status.
  *
@@ -108,6 +140,25 @@ esp_err_t esp_video_isp_pipeline_dump_stats(esp_video_isp_stats_t *stats, uint32
  */
 esp_err_t esp_video_isp_pipeline_set_statistics_window(uint32_t target_windows, uint32_t left, uint32_t top, uint32_t width, uint32_t height);
 
+/**
+ * @brief Set regions of interest of AE and AWB, e.g. faces from a detector.
+ *
+ * @note ROI weights are applied to AE blocks and AWB sub-windows of ISP statistics before IPA
+ *       processing, so IPA exposes and balances for the regions while still seeing the whole
+ *       image. AE block luminance is scaled to the ROI weighted average, and AWB sub-windows
+ *       are weighted when the ISP supports AWB sub-window statistics.
+ * @note This function only copies the regions and is cheap enough to be called every frame.
+ *
+ * @param roi ROI array
+ * @param num ROI number, in range [0, ESP_VIDEO_ISP_ROI_MAX_NUM], 0 means clearing all ROIs
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ */
+esp_err_t esp_video_isp_pipeline_set_roi(const esp_video_isp_roi_t *roi, uint32_t num);
+
 /**
  * @brief Set AGC maximum exposure time.
  *
@@ -159,6 +210,113 @@ esp_err_t esp_video_isp_pipeline_set_agc_min_exposure(uint32_t exposure_us);
  *      - Others if failed
  */
 esp_err_t esp_video_isp_pipeline_get_agc_min_exposure(uint32_t *exposure_us);
+
+/**
+ * @brief Get BF denoising level which is selected by the IPA auto denoising algorithm from
+ *        sensor gain and applied to ISP currently, e.g. to control software denoising stages.
+ *
+ * @param level Pointer to store BF denoising level
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ *      - ESP_ERR_NOT_FOUND if IPA has not enabled BF
+ */
+esp_err_t esp_video_isp_pipeline_get_denoise_level(uint8_t *level);
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_ENGINE
+/**
+ * @brief Auto focus engine state.
+ */
+typedef enum esp_video_isp_pipeline_af_state {
+    ESP_VIDEO_ISP_PIPELINE_AF_IDLE      = 0, /**< AF search is not started, e.g. camera has no motor */
+    ESP_VIDEO_ISP_PIPELINE_AF_SEARCHING = 1, /**< AF is searching the sharpest lens position */
+    ESP_VIDEO_ISP_PIPELINE_AF_LOCKED    = 2, /**< Lens is locked at the sharpest position */
+    ESP_VIDEO_ISP_PIPELINE_AF_FAILED    = 3, /**< No contrast is found in the AF windows */
+} esp_video_isp_pipeline_af_state_t;
+
+/**
+ * @brief Restart auto focus search, e.g. when the application knows the scene has changed.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ *      - ESP_ERR_NOT_SUPPORTED if camera has no focus motor
+ */
+esp_err_t esp_video_isp_pipeline_af_trigger(void);
+
+/**
+ * @brief Get auto focus engine state and lens position.
+ *
+ * @param state Pointer to store AF state
+ * @param pos   Pointer to store lens position, it can be NULL
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_get_af_state(esp_video_isp_pipeline_af_state_t *state, uint32_t *pos);
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING
+#define ESP_VIDEO_ISP_BRACKETING_MAX_NUM        4           /*!< Maximum number of exposures in one bracketing sequence */
+#define ESP_VIDEO_ISP_BRACKETING_INDEX_NONE     0xff        /*!< Frame is not exposed by a bracketing sequence */
+
+/**
+ * @brief Exposure bracketing configuration.
+ */
+typedef struct esp_video_isp_bracketing_config {
+    uint32_t num;                                           /*!< Number of exposures in one sequence, less than 2 means disabling bracketing */
+    uint32_t exposure_ratio[ESP_VIDEO_ISP_BRACKETING_MAX_NUM]; /*!< Exposure of every frame in percent of AE exposure, one of them must be 100 */
+} esp_video_isp_bracketing_config_t;
+
+/**
+ * @brief Exposure information of a captured frame.
+ */
+typedef struct esp_video_isp_frame_info {
+    struct timeval timestamp;                               /*!< Timestamp of the statistics frame */
+    uint32_t sequence;                                      /*!< Statistics sequence */
+    uint32_t exposure_us;                                   /*!< Exposure time in microseconds */
+    float gain;                                             /*!< Sensor gain */
+    uint8_t bracketing_index;                               /*!< Index in bracketing sequence, ESP_VIDEO_ISP_BRACKETING_INDEX_NONE if bracketing is disabled */
+} esp_video_isp_frame_info_t;
+
+/**
+ * @brief Set exposure bracketing, frames are exposed by the ratios of the AE exposure in turn.
+ *
+ * @note IPA only processes statistics of frames whose ratio is 100, so AE and AWB are not
+ *       disturbed by bracketed frames. Exposure settings take effect after
+ *       CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING_DELAY frames, so the first frames after
+ *       enabling are not tagged by a bracketing index.
+ * @note Exposure longer than the frame period is limited by the sensor, use a lower ratio or a
+ *       lower frame rate for long exposures.
+ *
+ * @param config Bracketing configuration, NULL means disabling bracketing
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ *      - ESP_ERR_NOT_SUPPORTED if camera sensor exposure can't be set
+ */
+esp_err_t esp_video_isp_pipeline_set_bracketing(const esp_video_isp_bracketing_config_t *config);
+
+/**
+ * @brief Get exposure information of a captured frame by its timestamp, e.g. to pick frames
+ *        of different exposures for HDR merging.
+ *
+ * @param timestamp Timestamp of captured frame, e.g. "timestamp" of "struct v4l2_buffer"
+ * @param info      Pointer to store frame information
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ *      - ESP_ERR_NOT_FOUND if the frame is too old or no statistics frame matches it
+ */
+esp_err_t esp_video_isp_pipeline_get_frame_info(const struct timeval *timestamp, esp_video_isp_frame_info_t *info);
+#endif
 #endif /* CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER */
 
 #ifdef __cplusplus
@@ -0,0 +1,136 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "driver/jpeg_encode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Default priority of JPEG engine clients, the JPEG encoder video device uses it.
+ */
+#define ESP_VIDEO_JPEG_ENGINE_PRIORITY_DEFAULT  8
+
+/**
+ * @brief Maximum priority of JPEG engine clients.
+ */
+#define ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX      15
+
+/**
+ * @brief JPEG engine client handle.
+ */
+typedef struct esp_video_jpeg_engine_client *esp_video_jpeg_engine_client_handle_t;
+
+/**
+ * @brief JPEG engine client configuration.
+ */
+typedef struct esp_video_jpeg_engine_client_config {
+    uint8_t priority;                   /*!< Client priority from 0 to ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX, jobs of a higher priority client are encoded first */
+    jpeg_encoder_handle_t enc_handle;   /*!< JPEG encoder driver handle used by the shared engine if it is not created yet, NULL to create it by the engine */
+} esp_video_jpeg_engine_client_config_t;
+
+/**
+ * @brief JPEG engine statistics.
+ */
+typedef struct esp_video_jpeg_engine_stats {
+    uint32_t jobs;                      /*!< Jobs encoded */
+    uint32_t waited_jobs;               /*!< Jobs which waited for other jobs */
+    uint32_t max_wait_jobs;             /*!< Maximum number of jobs encoded while a job was waiting */
+} esp_video_jpeg_engine_stats_t;
+
+/**
+ * @brief Create a client of the shared hardware JPEG encoder engine, the engine is created
+ *        together with the first client.
+ *
+ * The JPEG encoder video device and applications calling the JPEG encoder driver directly
+ * share one engine by clients, so their jobs are scheduled instead of contending for the
+ * hardware. Waiting jobs are encoded by client priority, jobs of the same priority are encoded
+ * in the order they are submitted, and a waiting job is raised by one priority level every time
+ * another job is encoded before it, so a low priority client is never starved.
+ *
+ * @param config Client configuration
+ * @param handle Pointer to store client handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NO_MEM if failed to allocate memory
+ *      - Others if failed to create JPEG encoder engine
+ */
+esp_err_t esp_video_jpeg_engine_client_create(const esp_video_jpeg_engine_client_config_t *config,
+                                              esp_video_jpeg_engine_client_handle_t *handle);
+
+/**
+ * @brief Encode a frame by the shared JPEG encoder engine, it blocks until the job is scheduled
+ *        and encoded.
+ *
+ * @note The job is encoded in the calling task, and buffers must meet the requirement of
+ *       jpeg_encoder_process(). One client submits one job at a time, so tasks encoding at
+ *       the same time should use different clients.
+ *
+ * @param handle   Client handle
+ * @param config   JPEG encode configuration
+ * @param src      Source frame buffer pointer
+ * @param src_size Source frame size in bytes
+ * @param dst      Destination buffer pointer
+ * @param dst_size Destination buffer size in bytes
+ * @param out_size Pointer to store encoded JPEG size in bytes
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - Others if failed to encode
+ */
+esp_err_t esp_video_jpeg_engine_encode(esp_video_jpeg_engine_client_handle_t handle, const jpeg_encode_cfg_t *config,
+                                       const uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size,
+                                       uint32_t *out_size);
+
+/**
+ * @brief Set priority of a JPEG engine client, it takes effect from the next job.
+ *
+ * @param handle   Client handle
+ * @param priority Client priority from 0 to ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_jpeg_engine_client_set_priority(esp_video_jpeg_engine_client_handle_t handle, uint8_t priority);
+
+/**
+ * @brief Get statistics of the shared JPEG encoder engine.
+ *
+ * @param stats Pointer to store statistics
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_STATE if the engine is not created
+ */
+esp_err_t esp_video_jpeg_engine_get_stats(esp_video_jpeg_engine_stats_t *stats);
+
+/**
+ * @brief Delete a JPEG engine client, the engine is deleted together with the last client.
+ *
+ * @note The client must not be encoding any job.
+ *
+ * @param handle Client handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_jpeg_engine_client_delete(esp_video_jpeg_engine_client_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
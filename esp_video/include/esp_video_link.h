@@ -0,0 +1,58 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Link configuration of a camera video device and an M2M encoder video device.
+ */
+typedef struct esp_video_link_config {
+    int cap_fd;                         /*!< Camera video device file descriptor, e.g. ESP_VIDEO_MIPI_CSI_DEVICE_NAME */
+    int m2m_fd;                         /*!< M2M encoder video device file descriptor, e.g. ESP_VIDEO_H264_DEVICE_NAME */
+    uint32_t width;                     /*!< Frame width in pixels, 0 means the current camera capture width */
+    uint32_t height;                    /*!< Frame height in pixels, 0 means the current camera capture height */
+    uint32_t pixel_format;              /*!< Encoded V4L2 pixel format, V4L2_PIX_FMT_H264 or V4L2_PIX_FMT_JPEG */
+} esp_video_link_config_t;
+
+/**
+ * @brief Negotiate the raw frame format of a camera video device and an M2M encoder video device,
+ *        and set it as the camera capture format and the encoder output format.
+ *
+ * Encoder input formats are tried in the order of VIDIOC_ENUM_FMT, which lists the encoder native
+ * layout first, and the first one which the camera video device can capture is selected, so camera
+ * frames are queued to the encoder without any conversion pass or intermediate buffer. e.g. the ISP
+ * outputs V4L2_PIX_FMT_YUV420 in the hardware H.264 encoder input layout directly.
+ *
+ * The encoder capture format is set to pixel_format of the same size with sizeimage 0, so the default
+ * or estimated compressed buffer size is used.
+ *
+ * @note Buffers are not requested, so call it before VIDIOC_REQBUFS of both video devices.
+ *
+ * @note V4L2_PIX_FMT_YUV420 of the camera and JPEG video devices is not planar, so it is not linked to
+ *       the software H.264 encoder which reads planar YUV420.
+ *
+ * @param config       Link configuration
+ * @param pixel_format Pointer to store the negotiated raw V4L2 pixel format, it can be NULL
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if the camera video device can't capture any encoder input format
+ *      - Others if failed to set format of video devices
+ */
+esp_err_t esp_video_link_set_format(const esp_video_link_config_t *config, uint32_t *pixel_format);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+/* esp_ipa is in the build, it is only released for ESP32-P4 now */
+#if CONFIG_ESP_IPA_CONFIG_PARAM_VERSION
+#include "esp_ipa_types.h"
+#define ESP_VIDEO_SW_STATS_IPA_SUPPORTED    1
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM   5   /*!< Auto exposure statistics block number in horizontal direction */
+#define ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM   5   /*!< Auto exposure statistics block number in vertical direction */
+#define ESP_VIDEO_SW_STATS_HIST_NUM         16  /*!< Histogram bin number, every bin covers 16 luma values */
+
+#define ESP_VIDEO_SW_STATS_FLAG_AE          (1 << 0)    /*!< Statistics has auto exposure block luma */
+#define ESP_VIDEO_SW_STATS_FLAG_AWB         (1 << 1)    /*!< Statistics has auto white balance white patch sum */
+#define ESP_VIDEO_SW_STATS_FLAG_HIST        (1 << 2)    /*!< Statistics has luma histogram */
+
+/**
+ * @brief Software statistics configuration.
+ */
+typedef struct esp_video_sw_stats_config {
+    uint32_t width;                     /*!< Frame width in pixels */
+    uint32_t height;                    /*!< Frame height in pixels */
+    uint32_t pixel_format;              /*!< Frame V4L2 pixel format, e.g. V4L2_PIX_FMT_YUYV */
+    uint32_t sample_step;               /*!< Sampling step in pixels in both directions, 0 means CONFIG_ESP_VIDEO_SW_STATS_SAMPLE_STEP */
+
+    uint8_t awb_min_luma;               /*!< Minimum luma of a sampled pixel counted as white patch */
+    uint8_t awb_max_luma;               /*!< Maximum luma of a sampled pixel counted as white patch */
+    uint8_t awb_max_chroma;             /*!< Maximum difference of the largest and smallest RGB channel of a white patch */
+} esp_video_sw_stats_config_t;
+
+/**
+ * @brief Software statistics of one frame.
+ */
+typedef struct esp_video_sw_stats {
+    uint32_t flags;                     /*!< Statistics flags, ESP_VIDEO_SW_STATS_FLAG_* */
+    uint32_t sample_num;                /*!< Number of sampled pixels */
+
+    uint32_t ae_luma[ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM][ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM]; /*!< Average luma of every block, in [row][column] */
+
+    struct {
+        uint32_t counted;               /*!< Number of white patches */
+        uint32_t sum_r;                 /*!< Sum of R channel of white patches */
+        uint32_t sum_g;                 /*!< Sum of G channel of white patches */
+        uint32_t sum_b;                 /*!< Sum of B channel of white patches */
+    } awb;                              /*!< Auto white balance statistics */
+
+    uint32_t hist[ESP_VIDEO_SW_STATS_HIST_NUM];   /*!< Luma histogram of sampled pixels */
+} esp_video_sw_stats_t;
+
+/**
+ * @brief Calculate statistics from a frame by sparse sampling, this is used by pipelines
+ *        without ISP, such as DVP and SPI YUV/RGB sensors.
+ *
+ * @note Supported pixel formats: V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_UYVY, V4L2_PIX_FMT_RGB565,
+ *       V4L2_PIX_FMT_RGB565X, V4L2_PIX_FMT_RGB24, V4L2_PIX_FMT_BGR24 and V4L2_PIX_FMT_GREY.
+ *
+ * @param config Statistics configuration
+ * @param buffer Frame buffer pointer
+ * @param size   Frame buffer size in bytes
+ * @param stats  Statistics result pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format is not supported
+ *      - ESP_ERR_INVALID_SIZE if buffer is smaller than the frame
+ */
+esp_err_t esp_video_sw_stats_process(const esp_video_sw_stats_config_t *config, const uint8_t *buffer,
+                                     size_t size, esp_video_sw_stats_t *stats);
+
+#if ESP_VIDEO_SW_STATS_IPA_SUPPORTED
+/**
+ * @brief Convert software statistics to IPA statistics, so that IPA algorithms can run
+ *        with frames from pipelines without ISP.
+ *
+ * @param stats     Software statistics pointer
+ * @param seq       Statistics sequence, e.g. frame sequence
+ * @param ipa_stats IPA statistics pointer
+ *
+ * @return None
+ */
+void esp_video_sw_stats_to_ipa_stats(const esp_video_sw_stats_t *stats, uint64_t seq, esp_ipa_stats_t *ipa_stats);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
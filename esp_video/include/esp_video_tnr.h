@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdkconfig.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VIDEO_TNR_STRENGTH_MAX          224 /*!< Maximum weight of reference frame in 1/256, the current frame always has some weight */
+#define ESP_VIDEO_TNR_DENOISE_LEVEL_MAX     20  /*!< ISP BF denoising level which maps to ESP_VIDEO_TNR_STRENGTH_MAX */
+
+/**
+ * @brief Temporal noise reduction handle.
+ */
+typedef struct esp_video_tnr *esp_video_tnr_handle_t;
+
+/**
+ * @brief Temporal noise reduction configuration.
+ */
+typedef struct esp_video_tnr_config {
+    uint32_t width;                     /*!< Frame width in pixels, it must be even */
+    uint32_t height;                    /*!< Frame height in pixels */
+    uint32_t pixel_format;              /*!< Frame V4L2 pixel format, e.g. V4L2_PIX_FMT_YUV420 */
+
+    uint32_t tile_size;                 /*!< Width and height of motion detection tile in pixels, 0 means 16 */
+    uint8_t motion_threshold;           /*!< Mean absolute difference of a tile from which the tile is treated as moving, 0 means 12 */
+    uint8_t strength;                   /*!< Initial weight of reference frame in 1/256, up to ESP_VIDEO_TNR_STRENGTH_MAX */
+} esp_video_tnr_config_t;
+
+/**
+ * @brief Create temporal noise reduction object.
+ *
+ * @note Supported pixel formats: V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_UYVY and
+ *       V4L2_PIX_FMT_YUV420 in ISP output layout, only Y is filtered and U and V are kept.
+ *
+ * @param config Temporal noise reduction configuration
+ * @param handle Pointer to store temporal noise reduction handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format is not supported
+ *      - ESP_ERR_NO_MEM if failed to allocate memory
+ */
+esp_err_t esp_video_tnr_create(const esp_video_tnr_config_t *config, esp_video_tnr_handle_t *handle);
+
+/**
+ * @brief Filter a frame with the previous output frame as reference.
+ *
+ * Every tile is compared with the same tile of the reference frame, static tiles are blended
+ * with the reference by the strength, while moving tiles and pixels changing much more than
+ * the noise keep the current frame, so that moving objects leave no trails.
+ *
+ * @param handle Temporal noise reduction handle
+ * @param in     Input frame buffer pointer
+ * @param size   Size of input and output buffers in bytes
+ * @param out    Output frame buffer pointer, it can be "in"
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_SIZE if buffer is smaller than the frame
+ */
+esp_err_t esp_video_tnr_process(esp_video_tnr_handle_t handle, const uint8_t *in, size_t size, uint8_t *out);
+
+/**
+ * @brief Set temporal noise reduction strength.
+ *
+ * @param handle   Temporal noise reduction handle
+ * @param strength Weight of reference frame in 1/256, 0 disables filtering, values larger
+ *                 than ESP_VIDEO_TNR_STRENGTH_MAX are limited
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_tnr_set_strength(esp_video_tnr_handle_t handle, uint8_t strength);
+
+/**
+ * @brief Set temporal noise reduction strength by ISP BF denoising level, which is selected
+ *        by the IPA auto denoising algorithm from sensor gain.
+ *
+ * @param handle Temporal noise reduction handle
+ * @param level  ISP BF denoising level
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_tnr_set_denoise_level(esp_video_tnr_handle_t handle, uint8_t level);
+
+#if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
+/**
+ * @brief Set temporal noise reduction strength by the BF denoising level which the ISP pipeline
+ *        controller applies currently, this should be called before processing every frame.
+ *
+ * @param handle Temporal noise reduction handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - Others if failed to get denoising level, and the strength is not changed
+ */
+esp_err_t esp_video_tnr_sync_isp_pipeline(esp_video_tnr_handle_t handle);
+#endif
+
+/**
+ * @brief Drop the reference frame, e.g. after scene cut or stream restart, so that the next
+ *        frame is output without filtering.
+ *
+ * @param handle Temporal noise reduction handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_tnr_reset(esp_video_tnr_handle_t handle);
+
+/**
+ * @brief Delete temporal noise reduction object.
+ *
+ * @param handle Temporal noise reduction handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_tnr_delete(esp_video_tnr_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
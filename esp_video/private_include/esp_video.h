@@ -15,6 +15,9 @@
 #include "linux/videodev2.h"
 #include "esp_video_buffer.h"
 #include "esp_video_internal.h"
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+#include "esp_video_zsl.h"
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -34,6 +37,7 @@ struct esp_video_format_desc {
 struct esp_video_param {
     uint16_t skip_frames;                   /*!< Skip frame numbers */
     uint16_t skip_count;                    /*!< Skip frame count */
+    uint32_t sequence;                      /*!< Sequence number of next done frame */
 };
 
 /**
@@ -54,6 +58,10 @@ struct esp_video_stream {
     struct v4l2_rect rect;                  /*!< Selection rectangles */
 
     struct esp_video_param param;           /*!< Video stream parameters */
+
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+    struct esp_video_zsl *zsl;              /*!< Zero shutter lag ring of recent frames */
+#endif
 };
 
 /**
@@ -391,6 +399,15 @@ esp_err_t esp_video_get_element_index_payload(struct esp_video *video, uint32_t
  */
 struct esp_video *esp_video_device_get_object(const char *name);
 
+/**
+ * @brief Get video object by VFS path
+ *
+ * @param path The video device VFS path, e.g. "/dev/video0"
+ *
+ * @return Video object pointer if found by path
+ */
+struct esp_video *esp_video_device_get_object_by_path(const char *path);
+
 /**
  * @brief Get video stream object pointer by stream type.
  *
@@ -505,6 +522,43 @@ esp_err_t esp_video_get_m2m_queued_elements(struct esp_video *video,
  */
 struct esp_video_buffer_element *esp_video_clone_element(struct esp_video *video, uint32_t type, struct esp_video_buffer_element *element);
 
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+/**
+ * @brief Set zero shutter lag ring of video stream.
+ *
+ * @param video Video object
+ * @param ring  Zero shutter lag ring configuration
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_set_zsl_ring(struct esp_video *video, const struct v4l2_zsl_ring *ring);
+
+/**
+ * @brief Copy a frame done before the trigger time out of zero shutter lag ring.
+ *
+ * @param video Video object
+ * @param frame Zero shutter lag frame request
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_get_zsl_frame(struct esp_video *video, struct v4l2_zsl_frame *frame);
+
+/**
+ * @brief Record a dequeued frame into zero shutter lag ring if the ring is enabled.
+ *
+ * @param video   Video object
+ * @param type    Video stream type
+ * @param element Video buffer element of the frame
+ *
+ * @return None
+ */
+void esp_video_record_zsl_frame(struct esp_video *video, uint32_t type, const struct esp_video_buffer_element *element);
+#endif
+
 /**
  * @brief Get buffer type from video
  *
@@ -795,6 +849,19 @@ esp_err_t esp_video_unsubscribe_event(struct esp_video *video, struct v4l2_event
  */
 esp_err_t esp_video_get_event(struct esp_video *video, struct v4l2_event *event);
 
+/**
+ * @brief Send an event to video event queue if its type is subscribed, this is called in task context
+ *
+ * @param video     Video object
+ * @param event     Event buffer pointer, "timestamp" is set by this function
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NOT_FOUND if event type is not subscribed
+ *      - Others if failed
+ */
+esp_err_t esp_video_queue_event(struct esp_video *video, struct v4l2_event *event);
+
 /**
  * @brief Restart video hardware
  *
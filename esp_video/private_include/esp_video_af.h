@@ -0,0 +1,124 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Contrast detection auto focus search state.
+ */
+typedef enum esp_video_af_state {
+    ESP_VIDEO_AF_STATE_IDLE = 0,                /*!< Search is not started */
+    ESP_VIDEO_AF_STATE_COARSE,                  /*!< Coarse scan over the full lens range */
+    ESP_VIDEO_AF_STATE_FINE,                    /*!< Hill climbing around the coarse peak */
+    ESP_VIDEO_AF_STATE_LOCKED,                  /*!< Lens is at the sharpest position */
+    ESP_VIDEO_AF_STATE_FAILED,                  /*!< No contrast is found in the scene */
+} esp_video_af_state_t;
+
+/**
+ * @brief Contrast detection auto focus configuration.
+ */
+typedef struct esp_video_af_config {
+    int32_t min_pos;                            /*!< Minimum lens position */
+    int32_t max_pos;                            /*!< Maximum lens position */
+    uint32_t coarse_steps;                      /*!< Number of coarse scan positions over the full range */
+    uint32_t fine_step;                         /*!< Lens position step of hill climbing */
+
+    uint32_t period_in_us;                      /*!< Motor period in microseconds per step, 0 means the move is instant */
+    uint32_t codes_per_step;                    /*!< Motor position codes per step */
+    uint32_t settle_us;                         /*!< Lens ringing settle time after the move ends */
+
+    uint8_t drop_percent;                       /*!< Coarse scan stops when definition drops by this percent below the peak */
+    uint8_t refocus_percent;                    /*!< Locked lens refocuses when definition changes by this percent */
+    uint8_t refocus_frames;                     /*!< Number of continuous changed frames to refocus, 0 means never refocus */
+} esp_video_af_config_t;
+
+/**
+ * @brief Contrast detection auto focus object.
+ */
+typedef struct esp_video_af {
+    esp_video_af_config_t config;
+    esp_video_af_state_t state;
+
+    int32_t pos;                                /*!< Lens position of last move */
+    int32_t target;                             /*!< Lens position to measure definition at */
+    int64_t settle_time;                        /*!< Time when lens stops ringing after last move */
+    int64_t stats_time;                         /*!< Time of last statistics frame */
+    int64_t frame_period;                       /*!< Estimated statistics frame period */
+
+    int32_t dir;                                /*!< Scan direction, 1 or -1 */
+    int32_t coarse_interval;                    /*!< Lens position interval of coarse scan */
+    int32_t coarse_pos;                         /*!< Peak position of coarse scan */
+    int32_t best_pos;
+    uint32_t best_def;
+    uint8_t drop_count;
+    bool reversed;                              /*!< Hill climbing has tried the other direction */
+    bool climbed;                               /*!< Hill climbing has found a sharper position in current direction */
+
+    uint32_t lock_def;                          /*!< Definition when lens is locked */
+    uint8_t change_count;
+
+    uint32_t moves;                             /*!< Number of lens moves of this search */
+    uint32_t frames;                            /*!< Number of statistics frames of this search */
+    uint32_t discarded;                         /*!< Number of frames discarded because lens is moving */
+} esp_video_af_t;
+
+/**
+ * @brief Initialize auto focus object.
+ *
+ * @param af     Auto focus object pointer
+ * @param config Auto focus configuration
+ * @param pos    Current lens position
+ *
+ * @return None
+ */
+void esp_video_af_init(esp_video_af_t *af, const esp_video_af_config_t *config, int32_t pos);
+
+/**
+ * @brief Start or restart focus search, the search runs in the following esp_video_af_process() calls.
+ *
+ * @param af Auto focus object pointer
+ *
+ * @return None
+ */
+void esp_video_af_start(esp_video_af_t *af);
+
+/**
+ * @brief Process the focus definition of one statistics frame.
+ *
+ * Frames whose exposure may overlap with a lens move or its ringing are discarded, so
+ * only definitions of a still lens drive the search.
+ *
+ * @param af         Auto focus object pointer
+ * @param definition Sum of AF statistics definition
+ * @param time_us    Time of statistics frame end in microseconds
+ * @param pos        Lens position to move to
+ *
+ * @return true if the lens should move to "pos", false if not
+ */
+bool esp_video_af_process(esp_video_af_t *af, uint32_t definition, int64_t time_us, int32_t *pos);
+
+/**
+ * @brief Tell auto focus object that lens starts moving, the lens settle time is calculated from
+ *        the start time, motor step period and move distance.
+ *
+ * @param af            Auto focus object pointer
+ * @param pos           Lens target position
+ * @param start_time_us Time of lens starts moving in microseconds
+ *
+ * @return None
+ */
+void esp_video_af_moved(esp_video_af_t *af, int32_t pos, int64_t start_time_us);
+
+#ifdef __cplusplus
+}
+#endif
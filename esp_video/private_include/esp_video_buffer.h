@@ -64,6 +64,9 @@ struct esp_video_buffer_element {
     uint8_t *buffer;                                  /*!< Buffer space to fill data */
 
     uint32_t valid_size;                              /*!< Valid data size */
+    int64_t timestamp;                                /*!< Time when data is done in microseconds, from esp_timer_get_time() */
+    uint32_t sequence;                                /*!< Sequence number of done data in stream */
+    uint32_t flags;                                   /*!< Extra V4L2 buffer flags set by video device */
 
     void *priv_data;                                  /*!< Private data */
 };
@@ -137,7 +137,7 @@ esp_err_t esp_video_destroy_dvp_video_device(void);
 /**
  * @brief Create H.264 video device
  *
- * @param hw_codec true: hardware H.264, false: software H.264(has not supported)
+ * @param hw_codec true: hardware H.264, false: software H.264
  *
  * @return
  *      - ESP_OK on success
@@ -148,7 +148,7 @@ esp_err_t esp_video_create_h264_video_device(bool hw_codec);
 /**
  * @brief Destroy H.264 video device
  *
- * @param hw_codec true: hardware H.264, false: software H.264(has not supported)
+ * @param hw_codec true: hardware H.264, false: software H.264
  *
  * @return
  *      - ESP_OK on success
@@ -238,6 +238,24 @@ esp_err_t esp_video_isp_video_device_add_isp_proc(isp_proc_handle_t isp_proc, ui
  */
 esp_err_t esp_video_isp_video_device_remove_isp_proc(isp_proc_handle_t isp_proc);
 
+#if ESP_VIDEO_ISP_DEVICE_CROP
+/**
+ * @brief Move ISP crop window while streaming, the size must be the same as the started one
+ *
+ * @note Crop is not disabled while streaming, so if the ISP driver only allows configuring
+ *       disabled crop, the stream must be stopped to change the crop window.
+ *
+ * @param isp_proc       ISP processor handle
+ * @param crop_rect      New crop rectangle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if ISP crop is not started or it can't be configured while enabled
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_video_device_move_crop(isp_proc_handle_t isp_proc, const struct v4l2_rect *crop_rect);
+#endif
+
 /**
  * @brief Create ISP video device
  *
@@ -280,6 +298,19 @@ bool esp_video_isp_video_device_is_raw_bypass(void);
  *      - Others if failed
  */
 esp_err_t esp_video_isp_video_device_set_stats_windows(uint32_t left, uint32_t top, uint32_t right, uint32_t bottom);
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+/**
+ * @brief Set power line frequency detected from light flicker, it is read by V4L2_CID_USER_ESP_ISP_FLICKER
+ *
+ * @param freq Power line frequency in Hz, 50 or 60, or 0 if no flicker is detected
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if the frequency is invalid
+ */
+esp_err_t esp_video_isp_video_device_set_flicker(uint32_t freq);
+#endif
 #endif
 
 #ifdef CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE
@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VIDEO_EIS_CORE_BLOCK_SIZE       16  /*!< Block matching block size in downscaled pixels */
+#define ESP_VIDEO_EIS_CORE_BLOCKS_X         4   /*!< Number of blocks in horizontal direction */
+#define ESP_VIDEO_EIS_CORE_BLOCKS_Y         3   /*!< Number of blocks in vertical direction */
+#define ESP_VIDEO_EIS_CORE_MAX_LATENCY      4   /*!< Maximum frames from setting crop window to the first frame captured with it */
+
+/**
+ * @brief Electronic image stabilization core configuration.
+ */
+typedef struct esp_video_eis_core_config {
+    uint32_t sensor_width;                      /*!< Width of the area where crop window moves */
+    uint32_t sensor_height;                     /*!< Height of the area where crop window moves */
+    uint32_t crop_width;                        /*!< Crop window width, it is the analysed frame width */
+    uint32_t crop_height;                       /*!< Crop window height, it is the analysed frame height */
+
+    /**
+     * Y layout of analysed frame, every 2 pixels take "group" bytes and Y of them are at "y_offset",
+     * one line takes "line_size" bytes
+     */
+    uint32_t group;
+    uint32_t y_offset[2];
+    uint32_t line_size;
+
+    uint32_t downscale;                         /*!< Frame is downscaled by this factor before block matching */
+    uint32_t search_range;                      /*!< Block matching search range in downscaled pixels */
+    uint8_t smoothing;                          /*!< Weight of previous smoothed camera path in 1/256 */
+    uint8_t crop_latency;                       /*!< Frames from setting crop window to the first frame captured with it, 1 ~ ESP_VIDEO_EIS_CORE_MAX_LATENCY */
+} esp_video_eis_core_config_t;
+
+/**
+ * @brief Electronic image stabilization core object.
+ */
+typedef struct esp_video_eis_core {
+    esp_video_eis_core_config_t config;
+
+    uint32_t ds_width;                          /*!< Downscaled frame width */
+    uint32_t ds_height;                         /*!< Downscaled frame height */
+    uint8_t *plane[2];                          /*!< Downscaled Y of previous and current frames */
+    uint8_t cur;                                /*!< Index of current frame in "plane" */
+    bool prev_valid;
+
+    int64_t path[2];                            /*!< Camera path, accumulated scene motion in 1/16 pixel */
+    int64_t smooth[2];                          /*!< Low pass filtered camera path in 1/16 pixel */
+
+    uint32_t frame_count;
+    int32_t origin[2];                          /*!< Crop window left and top at the center */
+    int32_t crop[ESP_VIDEO_EIS_CORE_MAX_LATENCY + 2][2];    /*!< Recently output crop window left and top */
+} esp_video_eis_core_t;
+
+/**
+ * @brief Get buffer size of downscaled frames.
+ *
+ * @param config Electronic image stabilization core configuration
+ *
+ * @return Buffer size in bytes, 0 if frame is too small for block matching
+ */
+size_t esp_video_eis_core_buffer_size(const esp_video_eis_core_config_t *config);
+
+/**
+ * @brief Initialize electronic image stabilization core, crop window starts at the center.
+ *
+ * @param core   Electronic image stabilization core object
+ * @param config Electronic image stabilization core configuration
+ * @param buffer Buffer of downscaled frames, the size is given by esp_video_eis_core_buffer_size()
+ *
+ * @return None
+ */
+void esp_video_eis_core_init(esp_video_eis_core_t *core, const esp_video_eis_core_config_t *config, uint8_t *buffer);
+
+/**
+ * @brief Drop the previous frame and camera path, crop window moves back to the center.
+ *
+ * @param core Electronic image stabilization core object
+ *
+ * @return None
+ */
+void esp_video_eis_core_reset(esp_video_eis_core_t *core);
+
+/**
+ * @brief Estimate scene motion of a frame captured by the crop window.
+ *
+ * Blocks on a grid of the downscaled frame are matched with the previous frame, and the global
+ * motion is the median of block motions, so that local moving objects are ignored. Motion of
+ * crop window is added, so the result is scene motion on sensor.
+ *
+ * @param core   Electronic image stabilization core object
+ * @param frame  Frame captured by the crop window
+ * @param motion Pointer to store horizontal and vertical scene motion in 1/16 pixel
+ *
+ * @return true if motion is estimated, false if there is no previous frame or the scene is flat
+ */
+bool esp_video_eis_core_estimate(esp_video_eis_core_t *core, const uint8_t *frame, int32_t motion[2]);
+
+/**
+ * @brief Move crop window to cancel scene motion of a frame.
+ *
+ * @param core   Electronic image stabilization core object
+ * @param motion Horizontal and vertical scene motion in 1/16 pixel
+ * @param crop   Pointer to store crop window left and top
+ *
+ * @return None
+ */
+void esp_video_eis_core_update(esp_video_eis_core_t *core, const int32_t motion[2], int32_t crop[2]);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,95 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VIDEO_FLICKER_MAX_ROWS          32  /*!< Maximum number of rows of luminance profile */
+
+#define ESP_VIDEO_FLICKER_FREQ_UNKNOWN      0   /*!< No flicker is detected yet */
+#define ESP_VIDEO_FLICKER_FREQ_50HZ         50  /*!< Light flickers at 100Hz, power line is 50Hz */
+#define ESP_VIDEO_FLICKER_FREQ_60HZ         60  /*!< Light flickers at 120Hz, power line is 60Hz */
+
+/**
+ * @brief Flicker detection configuration.
+ */
+typedef struct esp_video_flicker_config {
+    uint16_t window_frames;                     /*!< Number of frames of a detection window */
+    uint16_t min_amplitude;                     /*!< Minimum flicker amplitude relative to luminance in 1/1000 */
+    uint8_t confirm_windows;                    /*!< Number of continuous windows with the same result to change the detected frequency */
+} esp_video_flicker_config_t;
+
+/**
+ * @brief Flicker detection object.
+ */
+typedef struct esp_video_flicker {
+    esp_video_flicker_config_t config;
+
+    uint32_t rows;                              /*!< Number of rows of previous profile, 0 if there is no previous profile */
+    uint32_t prev_luma[ESP_VIDEO_FLICKER_MAX_ROWS];
+    int64_t prev_timestamp;
+
+    float sum_cos[2];                           /*!< Correlation of luminance change with 100Hz and 120Hz waves */
+    float sum_sin[2];
+    float weight[2];                            /*!< Sum of squared norm of waves */
+    float energy;                               /*!< Sum of squared luminance change */
+    uint16_t frames;
+
+    uint32_t candidate;                         /*!< Result of the last windows */
+    uint8_t candidate_count;
+    uint32_t freq;                              /*!< Detected power line frequency, ESP_VIDEO_FLICKER_FREQ_* */
+    uint16_t amplitude[2];                      /*!< Amplitude of 100Hz and 120Hz flicker of the last window in 1/1000 */
+} esp_video_flicker_t;
+
+/**
+ * @brief Initialize flicker detection object.
+ *
+ * @param flicker Flicker detection object pointer
+ * @param config  Flicker detection configuration
+ *
+ * @return None
+ */
+void esp_video_flicker_init(esp_video_flicker_t *flicker, const esp_video_flicker_config_t *config);
+
+/**
+ * @brief Drop accumulated data and the detected frequency.
+ *
+ * @param flicker Flicker detection object pointer
+ *
+ * @return None
+ */
+void esp_video_flicker_reset(esp_video_flicker_t *flicker);
+
+/**
+ * @brief Process luminance profile of one frame.
+ *
+ * Rolling shutter sensors expose rows at different time, so flickering light makes horizontal
+ * bands which move between frames. The change of every row to the previous frame removes the
+ * scene, and it is correlated with 100Hz and 120Hz waves at the exposure time of the row.
+ *
+ * @note Bands don't move if the frame period is a multiple of the flicker period, e.g. 120Hz at
+ *       30fps, then this frequency can't be told from the scene and is not detected.
+ *
+ * @param flicker     Flicker detection object pointer
+ * @param timestamp   Frame timestamp in microseconds, it has a fixed offset to the first row
+ * @param row_period  Time between exposure of two neighboring rows of the profile in nanoseconds
+ * @param luma        Average luminance of rows from top to bottom
+ * @param rows        Number of rows, not larger than ESP_VIDEO_FLICKER_MAX_ROWS
+ *
+ * @return Detected power line frequency, ESP_VIDEO_FLICKER_FREQ_*
+ */
+uint32_t esp_video_flicker_process(esp_video_flicker_t *flicker, int64_t timestamp, uint32_t row_period,
+                                   const uint32_t *luma, uint32_t rows);
+
+#ifdef __cplusplus
+}
+#endif
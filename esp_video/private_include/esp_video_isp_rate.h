@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Scene signature of one statistics frame, it is used to check if the scene is stable.
+ */
+typedef struct esp_video_isp_scene {
+    uint32_t luma;                              /*!< Sum of AE block luminance */
+    uint32_t rg;                                /*!< AWB R/G ratio in fixed point */
+    uint32_t bg;                                /*!< AWB B/G ratio in fixed point */
+    uint32_t definition;                        /*!< Sum of AF window definition */
+    uint32_t exposure;                          /*!< Sensor exposure, it is compared exactly */
+    uint32_t gain;                              /*!< Sensor gain, it is compared exactly */
+} esp_video_isp_scene_t;
+
+/**
+ * @brief Adaptive rate configuration.
+ */
+typedef struct esp_video_isp_rate_config {
+    uint8_t threshold;                          /*!< Relative change of scene values in percent, larger than it is a scene change */
+    uint8_t stable_frames;                      /*!< Number of continuous stable frames before 3A is treated as converged */
+    uint8_t decimation;                         /*!< One of this number of frames is processed when 3A is converged */
+} esp_video_isp_rate_config_t;
+
+/**
+ * @brief Adaptive rate object.
+ */
+typedef struct esp_video_isp_rate {
+    esp_video_isp_rate_config_t config;
+
+    esp_video_isp_scene_t scene;                /*!< Scene signature of the last processed frame */
+    uint16_t stable_count;
+    uint16_t skip_count;
+} esp_video_isp_rate_t;
+
+/**
+ * @brief Initialize adaptive rate object.
+ *
+ * @param rate   Adaptive rate object pointer
+ * @param config Adaptive rate configuration
+ *
+ * @return None
+ */
+void esp_video_isp_rate_init(esp_video_isp_rate_t *rate, const esp_video_isp_rate_config_t *config);
+
+/**
+ * @brief Return to processing every frame, e.g. when the application changes parameters.
+ *
+ * @param rate Adaptive rate object pointer
+ *
+ * @return None
+ */
+void esp_video_isp_rate_reset(esp_video_isp_rate_t *rate);
+
+/**
+ * @brief Check if processing of a statistics frame can be skipped.
+ *
+ * When the scene signature stays within the threshold for "stable_frames" processed frames,
+ * 3A is considered to be converged and only one of "decimation" frames is processed. Any
+ * scene or sensor change returns to processing every frame.
+ *
+ * @param rate  Adaptive rate object pointer
+ * @param scene Scene signature of the statistics frame
+ *
+ * @return true if processing is skipped, false if not
+ */
+bool esp_video_isp_rate_skip(esp_video_isp_rate_t *rate, const esp_video_isp_scene_t *scene);
+
+#ifdef __cplusplus
+}
+#endif
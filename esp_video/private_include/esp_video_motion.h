@@ -0,0 +1,119 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_VIDEO_MOTION_MAX_CELLS          32  /*!< Maximum number of statistics grid cells, one bit of motion map per cell */
+
+/**
+ * @brief Motion detection event.
+ */
+typedef enum esp_video_motion_event {
+    ESP_VIDEO_MOTION_EVENT_NONE = 0,            /*!< Motion state is not changed */
+    ESP_VIDEO_MOTION_EVENT_START,               /*!< Motion starts */
+    ESP_VIDEO_MOTION_EVENT_STOP,                /*!< Motion stops */
+} esp_video_motion_event_t;
+
+/**
+ * @brief Motion detection configuration.
+ */
+typedef struct esp_video_motion_config {
+    uint8_t grid_width;                         /*!< Number of statistics cells in horizontal direction */
+    uint8_t grid_height;                        /*!< Number of statistics cells in vertical direction */
+    uint16_t threshold;                         /*!< Relative change of a cell to the background in 1/256, larger change is motion */
+    uint8_t min_cells;                          /*!< Minimum number of changed cells of a motion frame */
+    uint8_t trigger_frames;                     /*!< Number of continuous motion frames to start motion */
+    uint16_t hold_frames;                       /*!< Number of continuous still frames to stop motion */
+    uint8_t scene_change_percent;               /*!< Percent of changed cells which is a scene change, e.g. camera is moved or covered */
+} esp_video_motion_config_t;
+
+/**
+ * @brief White balance statistics of a cell, only pixels in the white range are counted.
+ */
+typedef struct esp_video_motion_chroma {
+    uint32_t counted;                           /*!< Number of counted pixels */
+    uint32_t sum_r;                             /*!< Sum of R of counted pixels */
+    uint32_t sum_g;                             /*!< Sum of G of counted pixels */
+    uint32_t sum_b;                             /*!< Sum of B of counted pixels */
+} esp_video_motion_chroma_t;
+
+/**
+ * @brief Motion detection result.
+ */
+typedef struct esp_video_motion_result {
+    uint32_t map;                               /*!< Bit "y * grid_width + x" is set if the cell changed, accumulated over the motion for events */
+    uint32_t level;                             /*!< Maximum relative change of cells in 1/256 */
+    uint32_t frames;                            /*!< Number of frames of the motion */
+    bool scene_change;                          /*!< Most of the scene changed, background is learned again */
+} esp_video_motion_result_t;
+
+/**
+ * @brief Motion detection object.
+ */
+typedef struct esp_video_motion {
+    esp_video_motion_config_t config;
+    uint32_t cells;                             /*!< Number of cells */
+
+    bool bg_valid;
+    uint32_t bg_luma[ESP_VIDEO_MOTION_MAX_CELLS];   /*!< Background luminance in 1/256 */
+    uint32_t bg_rg[ESP_VIDEO_MOTION_MAX_CELLS];     /*!< Background R/G in 1/256, 0 if cell has no white pixel */
+    uint32_t bg_bg[ESP_VIDEO_MOTION_MAX_CELLS];     /*!< Background B/G in 1/256, 0 if cell has no white pixel */
+
+    bool active;                                /*!< Motion is started */
+    uint8_t trigger_count;
+    uint16_t quiet_count;
+    esp_video_motion_result_t motion;           /*!< Accumulated result of current motion */
+} esp_video_motion_t;
+
+/**
+ * @brief Initialize motion detection object.
+ *
+ * @param motion Motion detection object pointer
+ * @param config Motion detection configuration, grid_width * grid_height must not be larger
+ *               than ESP_VIDEO_MOTION_MAX_CELLS
+ *
+ * @return None
+ */
+void esp_video_motion_init(esp_video_motion_t *motion, const esp_video_motion_config_t *config);
+
+/**
+ * @brief Drop the background and motion state, e.g. after stream restart.
+ *
+ * @param motion Motion detection object pointer
+ *
+ * @return None
+ */
+void esp_video_motion_reset(esp_video_motion_t *motion);
+
+/**
+ * @brief Process statistics grids of one frame.
+ *
+ * Every cell is compared with its background, after the global brightness change is removed by
+ * the median ratio of all cells, so AE steps and lights dimming are not motion. Cells which are
+ * still slowly follow the scene, and changed cells are absorbed much slower, e.g. a parked car.
+ *
+ * @param motion Motion detection object pointer
+ * @param luma   Average luminance of cells in row order
+ * @param chroma White balance statistics of cells in row order, NULL if not available
+ * @param result Pointer to store result of this frame, or the accumulated result of the motion
+ *               if motion starts or stops
+ *
+ * @return Motion detection event
+ */
+esp_video_motion_event_t esp_video_motion_process(esp_video_motion_t *motion, const uint32_t *luma,
+                                                  const esp_video_motion_chroma_t *chroma,
+                                                  esp_video_motion_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
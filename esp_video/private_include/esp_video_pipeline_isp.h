@@ -9,6 +9,7 @@
 #include <string.h>
 #include "esp_err.h"
 #include "esp_ipa.h"
+#include "esp_video_isp_pipeline.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -54,6 +55,25 @@ esp_err_t esp_video_isp_pipeline_deinit(void);
  */
 bool esp_video_isp_pipeline_is_initialized(void);
 
+#if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
+/**
+ * @brief Calculate weights of statistics blocks of a window split into x_num * y_num blocks, the
+ *        weight of a block is 1 plus the ROI weights scaled by the fraction of the block they cover.
+ *
+ * @param window  Statistics window region
+ * @param roi     Regions of interest
+ * @param roi_num Number of regions of interest
+ * @param x_num   Block number in horizontal direction
+ * @param y_num   Block number in vertical direction
+ * @param weights Block weights in Q8, weights[x * y_num + y] is the weight of block (x, y), which
+ *                is the order of IPA AE statistics
+ *
+ * @return None
+ */
+void esp_video_isp_roi_calc_weights(const esp_ipa_region_t *window, const esp_video_isp_roi_t *roi, uint32_t roi_num,
+                                    int x_num, int y_num, uint32_t *weights);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_video_buffer.h"
+#include "esp_video_ioctl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Zero shutter lag ring frame.
+ */
+struct esp_video_zsl_frame {
+    uint8_t *buffer;                        /*!< Frame buffer */
+    uint32_t valid_size;                    /*!< Frame data size, 0 means the frame is empty */
+    int64_t timestamp;                      /*!< Time when frame is done in microseconds */
+    uint32_t sequence;                      /*!< Frame sequence number in stream */
+};
+
+/**
+ * @brief Zero shutter lag ring object, it keeps copies of the most recent frames.
+ *
+ * @note Ring is not locked, it is protected by the video device mutex. Frame data is copied
+ *       out of the mutex, between esp_video_zsl_record_start() and esp_video_zsl_record_done().
+ */
+struct esp_video_zsl {
+    uint32_t size;                          /*!< Buffer size of every frame */
+    uint32_t count;                         /*!< Number of frames */
+    uint32_t next;                          /*!< Index of the frame to be overwritten */
+    uint32_t writers;                       /*!< Number of frames being copied into the ring */
+    bool released;                          /*!< Ring is released, the last writer destroys it */
+    uint8_t *buffer;                        /*!< Buffer of all frames */
+    struct esp_video_zsl_frame frame[0];    /*!< Frames */
+};
+
+/**
+ * @brief Create zero shutter lag ring, frame buffers are allocated from PSRAM.
+ *
+ * @param count Number of frames
+ * @param size  Buffer size of every frame
+ *
+ * @return
+ *      - Zero shutter lag ring object pointer on success
+ *      - NULL if failed
+ */
+struct esp_video_zsl *esp_video_zsl_create(uint32_t count, uint32_t size);
+
+/**
+ * @brief Release zero shutter lag ring, it is destroyed at once, or by esp_video_zsl_record_done()
+ *        if frames are being copied into it.
+ *
+ * @param zsl Zero shutter lag ring object pointer
+ *
+ * @return None
+ */
+void esp_video_zsl_release(struct esp_video_zsl *zsl);
+
+/**
+ * @brief Take the oldest frame of zero shutter lag ring to copy a done frame into, the frame is
+ *        empty until esp_video_zsl_record_done() is called.
+ *
+ * @param zsl     Zero shutter lag ring object pointer
+ * @param element Video buffer element of the done frame
+ *
+ * @return
+ *      - Frame to copy data of element into on success
+ *      - NULL if the done frame doesn't fit the ring
+ */
+struct esp_video_zsl_frame *esp_video_zsl_record_start(struct esp_video_zsl *zsl, const struct esp_video_buffer_element *element);
+
+/**
+ * @brief Finish copying a done frame into zero shutter lag ring.
+ *
+ * @note The ring may be destroyed by this function if it has been released.
+ *
+ * @param zsl     Zero shutter lag ring object pointer
+ * @param frame   Frame returned by esp_video_zsl_record_start()
+ * @param element Video buffer element of the done frame
+ *
+ * @return None
+ */
+void esp_video_zsl_record_done(struct esp_video_zsl *zsl, struct esp_video_zsl_frame *frame,
+                               const struct esp_video_buffer_element *element);
+
+/**
+ * @brief Copy the frame matching the trigger timestamp out of zero shutter lag ring.
+ *
+ * @param zsl   Zero shutter lag ring object pointer
+ * @param frame Frame request, refer to struct v4l2_zsl_frame
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NOT_FOUND if all frames are done after the trigger timestamp
+ *      - ESP_ERR_INVALID_SIZE if the buffer is smaller than the frame
+ */
+esp_err_t esp_video_zsl_get_frame(struct esp_video_zsl *zsl, struct v4l2_zsl_frame *frame);
+
+#ifdef __cplusplus
+}
+#endif
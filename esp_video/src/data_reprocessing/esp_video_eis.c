@@ -0,0 +1,345 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/lock.h>
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "linux/videodev2.h"
+#include "esp_video_eis.h"
+#include "esp_video_eis_core.h"
+
+#define EIS_DOWNSCALE_DEFAULT           4
+#define EIS_SEARCH_RANGE_DEFAULT        6
+#define EIS_SMOOTHING_DEFAULT           240
+#define EIS_CROP_LATENCY_DEFAULT        1
+
+typedef struct esp_video_eis {
+    esp_video_eis_core_t core;
+    esp_video_eis_motion_source_t motion_source;
+    size_t frame_size;
+    uint8_t *buffer;                    /*!< Downscaled frames of block matching */
+
+    /**
+     * Gyroscope samples which are not integrated yet, they are fed by IMU task and
+     * consumed by frame processing
+     */
+    _lock_t imu_lock;
+    esp_video_eis_imu_sample_t imu[ESP_VIDEO_EIS_IMU_SAMPLE_NUM];
+    uint32_t imu_head;
+    uint32_t imu_num;
+    int64_t imu_last_us;                /*!< Time up to which rotation has been integrated, 0 if unknown */
+    float focal_length;
+} esp_video_eis_t;
+
+static const char *TAG = "eis";
+
+static esp_err_t eis_init_layout(esp_video_eis_core_config_t *config, uint32_t pixel_format)
+{
+    switch (pixel_format) {
+    case V4L2_PIX_FMT_GREY:
+        config->group = 2;
+        config->y_offset[0] = 0;
+        config->y_offset[1] = 1;
+        break;
+    case V4L2_PIX_FMT_YUYV:
+        config->group = 4;
+        config->y_offset[0] = 0;
+        config->y_offset[1] = 2;
+        break;
+    case V4L2_PIX_FMT_UYVY:
+        config->group = 4;
+        config->y_offset[0] = 1;
+        config->y_offset[1] = 3;
+        break;
+    case V4L2_PIX_FMT_YUV420:
+        /* ISP output and H.264 encoder input layout, odd lines are "U Y Y" and even lines are "V Y Y" */
+        config->group = 3;
+        config->y_offset[0] = 1;
+        config->y_offset[1] = 2;
+        break;
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    config->line_size = config->crop_width / 2 * config->group;
+
+    return ESP_OK;
+}
+
+/* Rotation between the previous frame and this frame, samples after this frame are kept for the next one */
+static bool eis_integrate_imu(esp_video_eis_t *eis, int64_t timestamp_us, int32_t motion[2])
+{
+    float angle[2] = {0, 0};
+    bool valid = false;
+
+    _lock_acquire(&eis->imu_lock);
+
+    while (eis->imu_num) {
+        const esp_video_eis_imu_sample_t *sample = &eis->imu[eis->imu_head];
+        float dt;
+
+        if (sample->timestamp_us > timestamp_us) {
+            break;
+        }
+
+        /* The first sample only gives the start time */
+        if (eis->imu_last_us && sample->timestamp_us > eis->imu_last_us) {
+            dt = (sample->timestamp_us - eis->imu_last_us) / 1000000.0f;
+            angle[0] += sample->rate_x * dt;
+            angle[1] += sample->rate_y * dt;
+            valid = true;
+        }
+
+        eis->imu_last_us = sample->timestamp_us;
+        eis->imu_head = (eis->imu_head + 1) % ESP_VIDEO_EIS_IMU_SAMPLE_NUM;
+        eis->imu_num--;
+    }
+
+    _lock_release(&eis->imu_lock);
+
+    motion[0] = (int32_t)(angle[0] * eis->focal_length * 16);
+    motion[1] = (int32_t)(angle[1] * eis->focal_length * 16);
+
+    return valid;
+}
+
+static void eis_get_crop(const esp_video_eis_t *eis, const int32_t offset[2], struct v4l2_rect *crop)
+{
+    crop->left = offset[0];
+    crop->top = offset[1];
+    crop->width = eis->core.config.crop_width;
+    crop->height = eis->core.config.crop_height;
+}
+
+/**
+ * @brief Create electronic image stabilization object.
+ *
+ * Stabilization only moves the ISP crop window, so no frame is copied. Set the crop window
+ * from esp_video_eis_get_crop() by VIDIOC_S_SELECTION before stream on, then process every
+ * dequeued frame and set the result crop window while streaming.
+ *
+ * @note Supported pixel formats: V4L2_PIX_FMT_GREY, V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_UYVY and
+ *       V4L2_PIX_FMT_YUV420 in ISP output layout.
+ *
+ * @param config Electronic image stabilization configuration
+ * @param handle Pointer to store electronic image stabilization handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format is not supported
+ *      - ESP_ERR_NO_MEM if failed to allocate memory
+ */
+esp_err_t esp_video_eis_create(const esp_video_eis_config_t *config, esp_video_eis_handle_t *handle)
+{
+    esp_err_t ret;
+    esp_video_eis_t *eis;
+    esp_video_eis_core_config_t core_config = {0};
+    size_t buffer_size = 0;
+
+    ESP_RETURN_ON_FALSE(config && handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->crop_width && config->crop_height && !(config->crop_width & 1) &&
+                        config->crop_width <= config->sensor_width && config->crop_height <= config->sensor_height,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid resolution");
+    ESP_RETURN_ON_FALSE(config->crop_latency <= ESP_VIDEO_EIS_CORE_MAX_LATENCY, ESP_ERR_INVALID_ARG,
+                        TAG, "crop latency is too large");
+    ESP_RETURN_ON_FALSE((config->motion_source == ESP_VIDEO_EIS_MOTION_SOURCE_IMAGE) ||
+                        ((config->motion_source == ESP_VIDEO_EIS_MOTION_SOURCE_IMU) && (config->focal_length > 0)),
+                        ESP_ERR_INVALID_ARG, TAG, "invalid motion source");
+
+    core_config.sensor_width = config->sensor_width;
+    core_config.sensor_height = config->sensor_height;
+    core_config.crop_width = config->crop_width;
+    core_config.crop_height = config->crop_height;
+    core_config.downscale = config->downscale ? config->downscale : EIS_DOWNSCALE_DEFAULT;
+    core_config.search_range = config->search_range ? config->search_range : EIS_SEARCH_RANGE_DEFAULT;
+    core_config.smoothing = config->smoothing ? config->smoothing : EIS_SMOOTHING_DEFAULT;
+    core_config.crop_latency = config->crop_latency ? config->crop_latency : EIS_CROP_LATENCY_DEFAULT;
+    ESP_RETURN_ON_ERROR(eis_init_layout(&core_config, config->pixel_format), TAG, "pixel format is not supported");
+
+    if (config->motion_source == ESP_VIDEO_EIS_MOTION_SOURCE_IMAGE) {
+        buffer_size = esp_video_eis_core_buffer_size(&core_config);
+        ESP_RETURN_ON_FALSE(buffer_size, ESP_ERR_INVALID_ARG, TAG, "frame is too small for block matching");
+    }
+
+    eis = heap_caps_calloc(1, sizeof(esp_video_eis_t), MALLOC_CAP_DEFAULT);
+    ESP_RETURN_ON_FALSE(eis, ESP_ERR_NO_MEM, TAG, "failed to malloc EIS");
+
+    /* Downscaled frames are read many times by block matching, so they are in internal RAM */
+    if (buffer_size) {
+        eis->buffer = heap_caps_malloc(buffer_size, MALLOC_CAP_DEFAULT);
+        ESP_GOTO_ON_FALSE(eis->buffer, ESP_ERR_NO_MEM, exit_0, TAG, "failed to malloc downscaled frames");
+    }
+
+    eis->motion_source = config->motion_source;
+    eis->frame_size = (size_t)core_config.line_size * core_config.crop_height;
+    eis->focal_length = config->focal_length;
+    _lock_init(&eis->imu_lock);
+    esp_video_eis_core_init(&eis->core, &core_config, eis->buffer);
+
+    *handle = eis;
+
+    return ESP_OK;
+
+exit_0:
+    heap_caps_free(eis);
+    return ret;
+}
+
+/**
+ * @brief Get crop window to set before stream on, it is at the center of sensor.
+ *
+ * @param handle Electronic image stabilization handle
+ * @param crop   Pointer to store crop window
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_eis_get_crop(esp_video_eis_handle_t handle, struct v4l2_rect *crop)
+{
+    ESP_RETURN_ON_FALSE(handle && crop, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    eis_get_crop(handle, handle->core.origin, crop);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Feed gyroscope samples, this can be called from the IMU task.
+ *
+ * @param handle  Electronic image stabilization handle
+ * @param samples Gyroscope samples in time order
+ * @param num     Number of samples
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if motion source is not IMU
+ */
+esp_err_t esp_video_eis_feed_imu(esp_video_eis_handle_t handle, const esp_video_eis_imu_sample_t *samples, uint32_t num)
+{
+    esp_video_eis_t *eis = handle;
+
+    ESP_RETURN_ON_FALSE(eis && samples, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(eis->motion_source == ESP_VIDEO_EIS_MOTION_SOURCE_IMU, ESP_ERR_NOT_SUPPORTED,
+                        TAG, "motion source is not IMU");
+
+    _lock_acquire(&eis->imu_lock);
+
+    for (uint32_t i = 0; i < num; i++) {
+        uint32_t tail = (eis->imu_head + eis->imu_num) % ESP_VIDEO_EIS_IMU_SAMPLE_NUM;
+
+        /* Frames are not processed in time, the oldest sample is dropped */
+        if (eis->imu_num == ESP_VIDEO_EIS_IMU_SAMPLE_NUM) {
+            eis->imu_last_us = eis->imu[eis->imu_head].timestamp_us;
+            eis->imu_head = (eis->imu_head + 1) % ESP_VIDEO_EIS_IMU_SAMPLE_NUM;
+            eis->imu_num--;
+        }
+
+        eis->imu[tail] = samples[i];
+        eis->imu_num++;
+    }
+
+    _lock_release(&eis->imu_lock);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Estimate camera motion of a frame and move crop window to cancel it.
+ *
+ * @param handle       Electronic image stabilization handle
+ * @param frame        Frame buffer pointer, it can be NULL if motion source is IMU
+ * @param size         Frame buffer size in bytes
+ * @param timestamp_us Frame time, e.g. "timestamp" of "struct v4l2_buffer"
+ * @param result       Pointer to store result
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_SIZE if buffer is smaller than the frame
+ */
+esp_err_t esp_video_eis_process(esp_video_eis_handle_t handle, const uint8_t *frame, size_t size,
+                                int64_t timestamp_us, esp_video_eis_result_t *result)
+{
+    esp_video_eis_t *eis = handle;
+    int32_t motion[2];
+    int32_t offset[2];
+    bool valid;
+
+    ESP_RETURN_ON_FALSE(eis && result, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    if (eis->motion_source == ESP_VIDEO_EIS_MOTION_SOURCE_IMAGE) {
+        ESP_RETURN_ON_FALSE(frame, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+        ESP_RETURN_ON_FALSE(size >= eis->frame_size, ESP_ERR_INVALID_SIZE, TAG, "buffer is too small");
+
+        valid = esp_video_eis_core_estimate(&eis->core, frame, motion);
+    } else {
+        /* Gyroscope measures the camera itself, so crop window motion needs no compensation */
+        valid = eis_integrate_imu(eis, timestamp_us, motion);
+    }
+
+    esp_video_eis_core_update(&eis->core, motion, offset);
+
+    eis_get_crop(eis, offset, &result->crop);
+    result->motion_x = motion[0];
+    result->motion_y = motion[1];
+    result->valid = valid;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Drop the previous frame and camera path, e.g. after stream restart.
+ *
+ * @note The crop window moves back to the center, set it by VIDIOC_S_SELECTION.
+ *
+ * @param handle Electronic image stabilization handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_eis_reset(esp_video_eis_handle_t handle)
+{
+    esp_video_eis_t *eis = handle;
+
+    ESP_RETURN_ON_FALSE(eis, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    _lock_acquire(&eis->imu_lock);
+    eis->imu_head = 0;
+    eis->imu_num = 0;
+    eis->imu_last_us = 0;
+    _lock_release(&eis->imu_lock);
+
+    esp_video_eis_core_reset(&eis->core);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Delete electronic image stabilization object.
+ *
+ * @param handle Electronic image stabilization handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_eis_delete(esp_video_eis_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    _lock_close(&handle->imu_lock);
+    heap_caps_free(handle->buffer);
+    heap_caps_free(handle);
+
+    return ESP_OK;
+}
@@ -0,0 +1,328 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_video_eis_core.h"
+
+#define EIS_HISTORY_NUM         (ESP_VIDEO_EIS_CORE_MAX_LATENCY + 2)
+#define EIS_BLOCK_PIXELS        (ESP_VIDEO_EIS_CORE_BLOCK_SIZE * ESP_VIDEO_EIS_CORE_BLOCK_SIZE)
+#define EIS_BLOCKS_NUM          (ESP_VIDEO_EIS_CORE_BLOCKS_X * ESP_VIDEO_EIS_CORE_BLOCKS_Y)
+
+/* Blocks whose mean gradient is lower than this have no texture to match */
+#define EIS_MIN_TEXTURE         (EIS_BLOCK_PIXELS * 3)
+/* Blocks whose best match has larger mean difference are occluded or changed */
+#define EIS_MAX_SAD             (EIS_BLOCK_PIXELS * 24)
+/* At least this number of blocks are required, the median of fewer blocks is not reliable */
+#define EIS_MIN_BLOCKS          3
+
+static inline uint32_t eis_sad(const uint8_t *a, const uint8_t *b, uint32_t stride, uint32_t limit)
+{
+    uint32_t sad = 0;
+
+    for (int y = 0; y < ESP_VIDEO_EIS_CORE_BLOCK_SIZE; y++) {
+        for (int x = 0; x < ESP_VIDEO_EIS_CORE_BLOCK_SIZE; x++) {
+            sad += abs((int)a[x] - b[x]);
+        }
+
+        /* Stop as soon as this position can't be the best one */
+        if (sad > limit) {
+            break;
+        }
+
+        a += stride;
+        b += stride;
+    }
+
+    return sad;
+}
+
+static uint32_t eis_texture(const uint8_t *p, uint32_t stride)
+{
+    uint32_t sum = 0;
+
+    for (int y = 0; y < ESP_VIDEO_EIS_CORE_BLOCK_SIZE - 1; y++) {
+        for (int x = 0; x < ESP_VIDEO_EIS_CORE_BLOCK_SIZE - 1; x++) {
+            sum += abs((int)p[x + 1] - p[x]) + abs((int)p[x + stride] - p[x]);
+        }
+
+        p += stride;
+    }
+
+    return sum;
+}
+
+/* Parabola through 3 matching costs, the result is the vertex offset in 1/16 pixel */
+static int32_t eis_subpixel(uint32_t prev, uint32_t best, uint32_t next)
+{
+    int32_t den = (int32_t)prev + (int32_t)next - 2 * (int32_t)best;
+
+    if (den <= 0) {
+        return 0;
+    }
+
+    return ((int32_t)prev - (int32_t)next) * 8 / den;
+}
+
+static void eis_downscale(esp_video_eis_core_t *core, const uint8_t *frame, uint8_t *plane)
+{
+    const esp_video_eis_core_config_t *config = &core->config;
+    uint32_t n = config->downscale;
+    uint32_t area = n * n;
+
+    for (uint32_t dy = 0; dy < core->ds_height; dy++) {
+        for (uint32_t dx = 0; dx < core->ds_width; dx++) {
+            uint32_t sum = 0;
+
+            for (uint32_t y = dy * n; y < (dy + 1) * n; y++) {
+                const uint8_t *line = frame + (size_t)y * config->line_size;
+
+                for (uint32_t x = dx * n; x < (dx + 1) * n; x++) {
+                    sum += line[x / 2 * config->group + config->y_offset[x & 1]];
+                }
+            }
+
+            plane[dy * core->ds_width + dx] = sum / area;
+        }
+    }
+}
+
+static int eis_compare(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a;
+    int32_t y = *(const int32_t *)b;
+
+    return x < y ? -1 : (x > y);
+}
+
+static bool eis_match_block(const esp_video_eis_core_t *core, const uint8_t *prev, const uint8_t *cur,
+                            uint32_t bx, uint32_t by, int32_t motion[2])
+{
+    uint32_t stride = core->ds_width;
+    int32_t range = core->config.search_range;
+    const uint8_t *block = prev + by * stride + bx;
+    uint32_t best = UINT32_MAX;
+    int32_t best_x = 0;
+    int32_t best_y = 0;
+
+    if (eis_texture(block, stride) < EIS_MIN_TEXTURE) {
+        return false;
+    }
+
+    for (int32_t y = -range; y <= range; y++) {
+        for (int32_t x = -range; x <= range; x++) {
+            const uint8_t *p = cur + (by + y) * stride + bx + x;
+            uint32_t sad = eis_sad(block, p, stride, best);
+
+            /* Prefer smaller motion if costs are the same, e.g. periodic textures */
+            if ((sad < best) || ((sad == best) && (abs(x) + abs(y) < abs(best_x) + abs(best_y)))) {
+                best = sad;
+                best_x = x;
+                best_y = y;
+            }
+        }
+    }
+
+    if (best > EIS_MAX_SAD) {
+        return false;
+    }
+
+    motion[0] = best_x * 16;
+    motion[1] = best_y * 16;
+
+    if (abs(best_x) < range) {
+        const uint8_t *p = cur + (by + best_y) * stride + bx + best_x;
+
+        motion[0] += eis_subpixel(eis_sad(block, p - 1, stride, UINT32_MAX), best, eis_sad(block, p + 1, stride, UINT32_MAX));
+    }
+
+    if (abs(best_y) < range) {
+        const uint8_t *p = cur + (by + best_y) * stride + bx + best_x;
+
+        motion[1] += eis_subpixel(eis_sad(block, p - stride, stride, UINT32_MAX), best,
+                                  eis_sad(block, p + stride, stride, UINT32_MAX));
+    }
+
+    return true;
+}
+
+/* Crop window of a frame is the one output "crop_latency" frames before, or the initial one */
+static const int32_t *eis_applied_crop(const esp_video_eis_core_t *core, int32_t frame)
+{
+    if (frame < 0) {
+        return core->origin;
+    }
+
+    return core->crop[frame % EIS_HISTORY_NUM];
+}
+
+/**
+ * @brief Get buffer size of downscaled frames.
+ *
+ * @param config Electronic image stabilization core configuration
+ *
+ * @return Buffer size in bytes, 0 if frame is too small for block matching
+ */
+size_t esp_video_eis_core_buffer_size(const esp_video_eis_core_config_t *config)
+{
+    uint32_t ds_width = config->crop_width / config->downscale;
+    uint32_t ds_height = config->crop_height / config->downscale;
+    uint32_t min_size = ESP_VIDEO_EIS_CORE_BLOCK_SIZE + config->search_range * 2 + 1;
+
+    if ((ds_width < min_size) || (ds_height < min_size)) {
+        return 0;
+    }
+
+    return (size_t)ds_width * ds_height * 2;
+}
+
+/**
+ * @brief Initialize electronic image stabilization core, crop window starts at the center.
+ *
+ * @param core   Electronic image stabilization core object
+ * @param config Electronic image stabilization core configuration
+ * @param buffer Buffer of downscaled frames, the size is given by esp_video_eis_core_buffer_size()
+ *
+ * @return None
+ */
+void esp_video_eis_core_init(esp_video_eis_core_t *core, const esp_video_eis_core_config_t *config, uint8_t *buffer)
+{
+    memset(core, 0, sizeof(esp_video_eis_core_t));
+
+    core->config = *config;
+    core->ds_width = config->crop_width / config->downscale;
+    core->ds_height = config->crop_height / config->downscale;
+    core->plane[0] = buffer;
+    core->plane[1] = buffer + core->ds_width * core->ds_height;
+
+    esp_video_eis_core_reset(core);
+}
+
+/**
+ * @brief Drop the previous frame and camera path, crop window moves back to the center.
+ *
+ * @param core Electronic image stabilization core object
+ *
+ * @return None
+ */
+void esp_video_eis_core_reset(esp_video_eis_core_t *core)
+{
+    int32_t left = (core->config.sensor_width - core->config.crop_width) / 2 & ~1;
+    int32_t top = (core->config.sensor_height - core->config.crop_height) / 2 & ~1;
+
+    core->prev_valid = false;
+    core->path[0] = core->path[1] = 0;
+    core->smooth[0] = core->smooth[1] = 0;
+
+    /* The crop window which is set now is used by all frames before the first output is applied */
+    core->frame_count = 0;
+    core->origin[0] = left;
+    core->origin[1] = top;
+}
+
+/**
+ * @brief Estimate scene motion of a frame captured by the crop window.
+ *
+ * @param core   Electronic image stabilization core object
+ * @param frame  Frame captured by the crop window
+ * @param motion Pointer to store horizontal and vertical scene motion in 1/16 pixel
+ *
+ * @return true if motion is estimated, false if there is no previous frame or the scene is flat
+ */
+bool esp_video_eis_core_estimate(esp_video_eis_core_t *core, const uint8_t *frame, int32_t motion[2])
+{
+    const esp_video_eis_core_config_t *config = &core->config;
+    uint8_t *prev = core->plane[core->cur ^ 1];
+    uint8_t *cur = core->plane[core->cur];
+    int32_t block_motion[2][EIS_BLOCKS_NUM];
+    uint32_t num = 0;
+    bool valid = false;
+
+    motion[0] = motion[1] = 0;
+    eis_downscale(core, frame, cur);
+
+    if (core->prev_valid) {
+        uint32_t range = config->search_range;
+        uint32_t x_span = core->ds_width - ESP_VIDEO_EIS_CORE_BLOCK_SIZE - range * 2;
+        uint32_t y_span = core->ds_height - ESP_VIDEO_EIS_CORE_BLOCK_SIZE - range * 2;
+
+        for (uint32_t j = 0; j < ESP_VIDEO_EIS_CORE_BLOCKS_Y; j++) {
+            uint32_t by = range + y_span * j / (ESP_VIDEO_EIS_CORE_BLOCKS_Y - 1);
+
+            for (uint32_t i = 0; i < ESP_VIDEO_EIS_CORE_BLOCKS_X; i++) {
+                uint32_t bx = range + x_span * i / (ESP_VIDEO_EIS_CORE_BLOCKS_X - 1);
+                int32_t m[2];
+
+                if (eis_match_block(core, prev, cur, bx, by, m)) {
+                    block_motion[0][num] = m[0];
+                    block_motion[1][num] = m[1];
+                    num++;
+                }
+            }
+        }
+
+        /* Unknown motion is treated as a still camera */
+        if (num >= EIS_MIN_BLOCKS) {
+            int32_t frame_index = (int32_t)core->frame_count - config->crop_latency;
+
+            for (int k = 0; k < 2; k++) {
+                qsort(block_motion[k], num, sizeof(int32_t), eis_compare);
+                motion[k] = block_motion[k][num / 2] * (int32_t)config->downscale;
+
+                /* Frame content moves against the crop window, so crop window motion is added back */
+                motion[k] += (eis_applied_crop(core, frame_index)[k] - eis_applied_crop(core, frame_index - 1)[k]) * 16;
+            }
+
+            valid = true;
+        }
+    }
+
+    core->prev_valid = true;
+    core->cur ^= 1;
+
+    return valid;
+}
+
+/**
+ * @brief Move crop window to cancel scene motion of a frame.
+ *
+ * @param core   Electronic image stabilization core object
+ * @param motion Horizontal and vertical scene motion in 1/16 pixel
+ * @param crop   Pointer to store crop window left and top
+ *
+ * @return None
+ */
+void esp_video_eis_core_update(esp_video_eis_core_t *core, const int32_t motion[2], int32_t crop[2])
+{
+    const esp_video_eis_core_config_t *config = &core->config;
+    int32_t max[2] = {
+        config->sensor_width - config->crop_width,
+        config->sensor_height - config->crop_height,
+    };
+
+    for (int k = 0; k < 2; k++) {
+        int32_t center = core->origin[k];
+        int64_t offset;
+
+        /* Intended camera path is the low pass filtered path, the crop window cancels the rest */
+        core->path[k] += motion[k];
+        core->smooth[k] += (core->path[k] - core->smooth[k]) * (256 - config->smoothing) / 256;
+        offset = center + ((core->path[k] - core->smooth[k]) >> 4);
+
+        if (offset < 0 || offset > max[k]) {
+            offset = offset < 0 ? 0 : max[k];
+            /* Follow the camera at the margin, so the window leaves the margin as soon as the camera stops */
+            core->smooth[k] = core->path[k] - ((offset - center) << 4);
+        }
+
+        /* Keep Bayer and YUV422 phase */
+        crop[k] = offset & ~1;
+    }
+
+    core->crop[core->frame_count % EIS_HISTORY_NUM][0] = crop[0];
+    core->crop[core->frame_count % EIS_HISTORY_NUM][1] = crop[1];
+    core->frame_count++;
+}
@@ -0,0 +1,291 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include "esp_check.h"
+#include "linux/videodev2.h"
+#include "esp_video_hdr_merge.h"
+
+#define HDR_MERGE_SATURATION_DEFAULT    250
+/* Scale of exposure ratio, radiance is "linear * scale >> HDR_MERGE_RADIANCE_SHIFT" which keeps 4 fraction bits */
+#define HDR_MERGE_SCALE_SHIFT           12
+#define HDR_MERGE_RADIANCE_SHIFT        8
+
+typedef struct hdr_merge {
+    uint32_t num;
+    uint32_t shortest;                                  /*!< Index of the frame with the shortest exposure */
+    uint32_t scale[ESP_VIDEO_HDR_MERGE_MAX_NUM];        /*!< Ratio of the shortest exposure to frame exposure */
+    uint16_t linear[ESP_VIDEO_HDR_MERGE_LUT_SIZE];
+    uint8_t weight[ESP_VIDEO_HDR_MERGE_LUT_SIZE];
+    uint8_t out[ESP_VIDEO_HDR_MERGE_LUT_SIZE];          /*!< Log compression and tone mapping, indexed by hdr_merge_log_index() */
+} hdr_merge_t;
+
+static const char *TAG = "hdr_merge";
+
+/**
+ * Approximate log2 of radiance in 1/16 octave, the integer part is the position of the
+ * most significant bit and the fraction part is the following 4 bits
+ */
+static inline uint32_t hdr_merge_log_index(uint32_t radiance)
+{
+    uint32_t msb;
+    uint32_t frac;
+
+    if (!radiance) {
+        return 0;
+    }
+
+    msb = 31 - __builtin_clz(radiance);
+    frac = msb >= 4 ? (radiance >> (msb - 4)) & 0xf : (radiance << (4 - msb)) & 0xf;
+
+    return (msb << 4) | frac;
+}
+
+static inline uint32_t hdr_merge_radiance(const hdr_merge_t *merge, uint32_t n, uint8_t value)
+{
+    return (merge->linear[value] * merge->scale[n]) >> HDR_MERGE_RADIANCE_SHIFT;
+}
+
+static void hdr_merge_init(hdr_merge_t *merge, const esp_video_hdr_merge_config_t *config)
+{
+    uint8_t saturation = config->saturation ? config->saturation : HDR_MERGE_SATURATION_DEFAULT;
+    uint32_t longest = 0;
+    uint32_t min_index;
+    uint32_t max_index;
+
+    merge->num = config->num;
+    merge->shortest = 0;
+    for (uint32_t n = 1; n < config->num; n++) {
+        if (config->exposure[n] < config->exposure[merge->shortest]) {
+            merge->shortest = n;
+        }
+        if (config->exposure[n] > config->exposure[longest]) {
+            longest = n;
+        }
+    }
+
+    for (uint32_t n = 0; n < config->num; n++) {
+        merge->scale[n] = ((uint64_t)config->exposure[merge->shortest] << HDR_MERGE_SCALE_SHIFT) / config->exposure[n];
+    }
+
+    for (int i = 0; i < ESP_VIDEO_HDR_MERGE_LUT_SIZE; i++) {
+        uint16_t linear = config->linear_lut ? config->linear_lut[i] : (i << 4) | (i >> 4);
+
+        merge->linear[i] = linear > ESP_VIDEO_HDR_MERGE_LINEAR_MAX ? ESP_VIDEO_HDR_MERGE_LINEAR_MAX : linear;
+        /* Hat weight, values in the middle are the most reliable */
+        merge->weight[i] = i >= saturation ? 0 : (i < 128 ? i : 255 - i) + 1;
+    }
+
+    /* Log compression maps one code of the longest exposure frame to black and saturation of the shortest one to white */
+    min_index = hdr_merge_log_index((merge->linear[1] * merge->scale[longest]) >> HDR_MERGE_RADIANCE_SHIFT);
+    max_index = hdr_merge_log_index((ESP_VIDEO_HDR_MERGE_LINEAR_MAX << HDR_MERGE_SCALE_SHIFT) >> HDR_MERGE_RADIANCE_SHIFT);
+    if (max_index <= min_index) {
+        min_index = max_index - 1;
+    }
+
+    for (uint32_t i = 0; i < ESP_VIDEO_HDR_MERGE_LUT_SIZE; i++) {
+        uint32_t value;
+
+        if (i <= min_index) {
+            value = 0;
+        } else if (i >= max_index) {
+            value = 255;
+        } else {
+            value = (i - min_index) * 255 / (max_index - min_index);
+        }
+
+        merge->out[i] = config->tone_lut ? config->tone_lut[value] : value;
+    }
+}
+
+static inline uint8_t hdr_merge_pixel(const hdr_merge_t *merge, const uint8_t *const frames[], size_t offset,
+                                      uint32_t *weights)
+{
+    uint32_t sum = 0;
+    uint32_t weight_sum = 0;
+    uint32_t radiance;
+
+    for (uint32_t n = 0; n < merge->num; n++) {
+        uint8_t value = frames[n][offset];
+        uint32_t weight = merge->weight[value];
+
+        sum += weight * hdr_merge_radiance(merge, n, value);
+        weight_sum += weight;
+        if (weights) {
+            weights[n] += weight;
+        }
+    }
+
+    /* All frames are saturated, the shortest exposure frame is the closest one */
+    if (weight_sum) {
+        radiance = sum / weight_sum;
+    } else {
+        radiance = hdr_merge_radiance(merge, merge->shortest, frames[merge->shortest][offset]);
+    }
+
+    return merge->out[hdr_merge_log_index(radiance)];
+}
+
+static void hdr_merge_yuv422(const hdr_merge_t *merge, const uint8_t *const frames[], size_t size,
+                             uint32_t y_offset, uint8_t *out)
+{
+    uint32_t uv_offset = 1 - y_offset;
+
+    for (size_t i = 0; i < size; i += 4) {
+        uint32_t weights[ESP_VIDEO_HDR_MERGE_MAX_NUM] = {0};
+        uint32_t best = 0;
+        uint8_t y0 = hdr_merge_pixel(merge, frames, i + y_offset, weights);
+        uint8_t y1 = hdr_merge_pixel(merge, frames, i + y_offset + 2, weights);
+        uint8_t u;
+        uint8_t v;
+
+        for (uint32_t n = 1; n < merge->num; n++) {
+            if (weights[n] > weights[best]) {
+                best = n;
+            }
+        }
+
+        /* Read chroma before writing, the output buffer may be one of the input frames */
+        u = frames[best][i + uv_offset];
+        v = frames[best][i + uv_offset + 2];
+        out[i + y_offset] = y0;
+        out[i + y_offset + 2] = y1;
+        out[i + uv_offset] = u;
+        out[i + uv_offset + 2] = v;
+    }
+}
+
+/**
+ * @brief Merge frames of different exposures into one frame with higher dynamic range.
+ *
+ * Pixel values are converted to linear values and divided by frame exposure, the radiance is
+ * the weighted average of all frames, where pixels close to black or saturation have lower
+ * weight and saturated pixels are excluded. The radiance is compressed in log domain to 8 bits
+ * and mapped by the tone lookup table.
+ *
+ * @param config HDR merge configuration
+ * @param frames Frame buffer pointers, the number is "config->num"
+ * @param size   Size of every frame buffer and the output buffer in bytes
+ * @param out    Output buffer pointer, it can be one of "frames"
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format is not supported
+ *      - ESP_ERR_INVALID_SIZE if buffer is smaller than the frame
+ */
+esp_err_t esp_video_hdr_merge_process(const esp_video_hdr_merge_config_t *config, const uint8_t *const frames[],
+                                      size_t size, uint8_t *out)
+{
+    hdr_merge_t merge;
+    uint32_t bpp;
+    size_t frame_size;
+
+    ESP_RETURN_ON_FALSE(config && frames && out, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->num >= 2 && config->num <= ESP_VIDEO_HDR_MERGE_MAX_NUM,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid frame number");
+    for (uint32_t n = 0; n < config->num; n++) {
+        ESP_RETURN_ON_FALSE(frames[n] && config->exposure[n], ESP_ERR_INVALID_ARG, TAG, "invalid frame %" PRIu32, n);
+    }
+
+    switch (config->pixel_format) {
+    case V4L2_PIX_FMT_SBGGR8:
+    case V4L2_PIX_FMT_SGBRG8:
+    case V4L2_PIX_FMT_SGRBG8:
+    case V4L2_PIX_FMT_SRGGB8:
+    case V4L2_PIX_FMT_GREY:
+        bpp = 1;
+        break;
+    case V4L2_PIX_FMT_YUYV:
+    case V4L2_PIX_FMT_UYVY:
+        bpp = 2;
+        ESP_RETURN_ON_FALSE(!(config->width & 1), ESP_ERR_INVALID_ARG, TAG, "invalid resolution");
+        break;
+    default:
+        ESP_LOGE(TAG, "pixel format is not supported");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    frame_size = (size_t)config->width * config->height * bpp;
+    ESP_RETURN_ON_FALSE(frame_size && size >= frame_size, ESP_ERR_INVALID_SIZE, TAG, "buffer is too small");
+
+    hdr_merge_init(&merge, config);
+
+    if (config->pixel_format == V4L2_PIX_FMT_YUYV) {
+        hdr_merge_yuv422(&merge, frames, frame_size, 0, out);
+    } else if (config->pixel_format == V4L2_PIX_FMT_UYVY) {
+        hdr_merge_yuv422(&merge, frames, frame_size, 1, out);
+    } else {
+        /* Bayer pattern is not changed by merging, so every component is merged in the same way */
+        for (size_t i = 0; i < frame_size; i++) {
+            out[i] = hdr_merge_pixel(&merge, frames, i, NULL);
+        }
+    }
+
+    return ESP_OK;
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
+static uint8_t hdr_merge_gamma_value(const esp_ipa_gamma_channel_t *gamma, uint32_t x)
+{
+    uint32_t x0 = 0;
+    uint32_t y0 = 0;
+
+    for (int i = 0; i < ISP_GAMMA_CURVE_POINTS_NUM; i++) {
+        uint32_t x1 = gamma->x[i];
+        uint32_t y1 = gamma->y[i];
+
+        if (x <= x1) {
+            return x1 > x0 ? y0 + ((int32_t)(y1 - y0) * (int32_t)(x - x0)) / (int32_t)(x1 - x0) : y1;
+        }
+
+        x0 = x1;
+        y0 = y1;
+    }
+
+    return y0;
+}
+
+/**
+ * @brief Convert an IPA GAMMA curve to a tone lookup table of HDR merge, so that the
+ *        GAMMA curve of an AEN GAMMA unit can be used for tone mapping.
+ *
+ * @param gamma IPA GAMMA channel pointer
+ * @param lut   Tone lookup table, the size is ESP_VIDEO_HDR_MERGE_LUT_SIZE
+ *
+ * @return None
+ */
+void esp_video_hdr_merge_gamma_to_tone_lut(const esp_ipa_gamma_channel_t *gamma, uint8_t *lut)
+{
+    for (uint32_t i = 0; i < ESP_VIDEO_HDR_MERGE_LUT_SIZE; i++) {
+        lut[i] = hdr_merge_gamma_value(gamma, i);
+    }
+}
+
+/**
+ * @brief Convert the inverse of an IPA GAMMA curve to a linearization lookup table of HDR
+ *        merge, this is used when frames are processed by ISP GAMMA.
+ *
+ * @param gamma IPA GAMMA channel pointer
+ * @param lut   Linearization lookup table, the size is ESP_VIDEO_HDR_MERGE_LUT_SIZE
+ *
+ * @return None
+ */
+void esp_video_hdr_merge_gamma_to_linear_lut(const esp_ipa_gamma_channel_t *gamma, uint16_t *lut)
+{
+    uint32_t x = 0;
+
+    /* GAMMA curve is monotonic, the linear value of output "y" is the first input reaching it */
+    for (uint32_t y = 0; y < ESP_VIDEO_HDR_MERGE_LUT_SIZE; y++) {
+        while (x < ESP_VIDEO_HDR_MERGE_LUT_SIZE - 1 && hdr_merge_gamma_value(gamma, x) < y) {
+            x++;
+        }
+
+        lut[y] = (x << 4) | (x >> 4);
+    }
+}
+#endif
@@ -0,0 +1,247 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <string.h>
+#include "esp_check.h"
+#include "linux/videodev2.h"
+#include "esp_video_sw_stats.h"
+
+#define SW_STATS_CLAMP(v)       ((v) < 0 ? 0 : ((v) > 255 ? 255 : (v)))
+#define SW_STATS_RGB2Y(r, g, b) (((r) * 77 + (g) * 150 + (b) * 29) >> 8)
+
+typedef struct sw_stats_pixel {
+    int y;
+    int r;
+    int g;
+    int b;
+} sw_stats_pixel_t;
+
+static const char *TAG = "sw_stats";
+
+static uint32_t sw_stats_get_bpp(uint32_t pixel_format)
+{
+    switch (pixel_format) {
+    case V4L2_PIX_FMT_YUYV:
+    case V4L2_PIX_FMT_UYVY:
+    case V4L2_PIX_FMT_RGB565:
+    case V4L2_PIX_FMT_RGB565X:
+        return 2;
+    case V4L2_PIX_FMT_RGB24:
+    case V4L2_PIX_FMT_BGR24:
+        return 3;
+    case V4L2_PIX_FMT_GREY:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static inline void sw_stats_yuv_to_rgb(int y, int u, int v, sw_stats_pixel_t *pixel)
+{
+    int d = u - 128;
+    int e = v - 128;
+    int r = y + ((359 * e) >> 8);
+    int g = y - ((88 * d + 183 * e) >> 8);
+    int b = y + ((454 * d) >> 8);
+
+    pixel->y = y;
+    pixel->r = SW_STATS_CLAMP(r);
+    pixel->g = SW_STATS_CLAMP(g);
+    pixel->b = SW_STATS_CLAMP(b);
+}
+
+static inline void sw_stats_rgb565_to_rgb(uint16_t val, sw_stats_pixel_t *pixel)
+{
+    int r = (val >> 11) & 0x1f;
+    int g = (val >> 5) & 0x3f;
+    int b = val & 0x1f;
+
+    pixel->r = (r << 3) | (r >> 2);
+    pixel->g = (g << 2) | (g >> 4);
+    pixel->b = (b << 3) | (b >> 2);
+    pixel->y = SW_STATS_RGB2Y(pixel->r, pixel->g, pixel->b);
+}
+
+static inline void sw_stats_get_pixel(uint32_t pixel_format, const uint8_t *line, uint32_t x, sw_stats_pixel_t *pixel)
+{
+    const uint8_t *p;
+
+    switch (pixel_format) {
+    case V4L2_PIX_FMT_YUYV:
+        /* Y0 U Y1 V, U and V are shared by 2 pixels */
+        p = line + (x & ~1U) * 2;
+        sw_stats_yuv_to_rgb(p[(x & 1) * 2], p[1], p[3], pixel);
+        break;
+    case V4L2_PIX_FMT_UYVY:
+        p = line + (x & ~1U) * 2;
+        sw_stats_yuv_to_rgb(p[1 + (x & 1) * 2], p[0], p[2], pixel);
+        break;
+    case V4L2_PIX_FMT_RGB565:
+        p = line + x * 2;
+        sw_stats_rgb565_to_rgb(p[0] | (p[1] << 8), pixel);
+        break;
+    case V4L2_PIX_FMT_RGB565X:
+        p = line + x * 2;
+        sw_stats_rgb565_to_rgb((p[0] << 8) | p[1], pixel);
+        break;
+    case V4L2_PIX_FMT_RGB24:
+        p = line + x * 3;
+        pixel->r = p[0];
+        pixel->g = p[1];
+        pixel->b = p[2];
+        pixel->y = SW_STATS_RGB2Y(pixel->r, pixel->g, pixel->b);
+        break;
+    case V4L2_PIX_FMT_BGR24:
+        p = line + x * 3;
+        pixel->r = p[2];
+        pixel->g = p[1];
+        pixel->b = p[0];
+        pixel->y = SW_STATS_RGB2Y(pixel->r, pixel->g, pixel->b);
+        break;
+    default:
+        pixel->y = pixel->r = pixel->g = pixel->b = line[x];
+        break;
+    }
+}
+
+/**
+ * @brief Calculate statistics from a frame by sparse sampling, this is used by pipelines
+ *        without ISP, such as DVP and SPI YUV/RGB sensors.
+ *
+ * @param config Statistics configuration
+ * @param buffer Frame buffer pointer
+ * @param size   Frame buffer size in bytes
+ * @param stats  Statistics result pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format is not supported
+ *      - ESP_ERR_INVALID_SIZE if buffer is smaller than the frame
+ */
+esp_err_t esp_video_sw_stats_process(const esp_video_sw_stats_config_t *config, const uint8_t *buffer,
+                                     size_t size, esp_video_sw_stats_t *stats)
+{
+    uint32_t bpp;
+    uint32_t step;
+    uint32_t stride;
+    uint32_t ae_sum[ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM][ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM] = {0};
+    uint32_t ae_num[ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM][ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM] = {0};
+
+    ESP_RETURN_ON_FALSE(config && buffer && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->width >= ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM &&
+                        config->height >= ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid resolution");
+
+    bpp = sw_stats_get_bpp(config->pixel_format);
+    ESP_RETURN_ON_FALSE(bpp, ESP_ERR_NOT_SUPPORTED, TAG, "pixel format is not supported");
+
+    stride = config->width * bpp;
+    ESP_RETURN_ON_FALSE(size >= (size_t)stride * config->height, ESP_ERR_INVALID_SIZE, TAG, "buffer is too small");
+
+    step = config->sample_step ? config->sample_step : CONFIG_ESP_VIDEO_SW_STATS_SAMPLE_STEP;
+
+    memset(stats, 0, sizeof(esp_video_sw_stats_t));
+
+    /* Samples start at half of the step so that they are centered in the frame */
+    for (uint32_t y = step / 2; y < config->height; y += step) {
+        const uint8_t *line = buffer + y * stride;
+        uint32_t by = y * ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM / config->height;
+        uint32_t bx = 0;
+        uint32_t bx_end = config->width / ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM;
+
+        for (uint32_t x = step / 2; x < config->width; x += step) {
+            sw_stats_pixel_t pixel;
+
+            while (x >= bx_end) {
+                bx++;
+                bx_end = (bx + 1) * config->width / ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM;
+            }
+
+            sw_stats_get_pixel(config->pixel_format, line, x, &pixel);
+
+            ae_sum[by][bx] += pixel.y;
+            ae_num[by][bx]++;
+            stats->hist[pixel.y >> 4]++;
+
+            if (pixel.y >= config->awb_min_luma && pixel.y <= config->awb_max_luma) {
+                int max = pixel.r > pixel.g ? pixel.r : pixel.g;
+                int min = pixel.r < pixel.g ? pixel.r : pixel.g;
+
+                max = max > pixel.b ? max : pixel.b;
+                min = min < pixel.b ? min : pixel.b;
+                if (max - min <= config->awb_max_chroma) {
+                    stats->awb.counted++;
+                    stats->awb.sum_r += pixel.r;
+                    stats->awb.sum_g += pixel.g;
+                    stats->awb.sum_b += pixel.b;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM; i++) {
+        for (int j = 0; j < ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM; j++) {
+            stats->ae_luma[i][j] = ae_num[i][j] ? ae_sum[i][j] / ae_num[i][j] : 0;
+            stats->sample_num += ae_num[i][j];
+        }
+    }
+
+    stats->flags = ESP_VIDEO_SW_STATS_FLAG_AE | ESP_VIDEO_SW_STATS_FLAG_HIST;
+    if (config->pixel_format != V4L2_PIX_FMT_GREY) {
+        stats->flags |= ESP_VIDEO_SW_STATS_FLAG_AWB;
+    }
+
+    return ESP_OK;
+}
+
+#if ESP_VIDEO_SW_STATS_IPA_SUPPORTED
+_Static_assert(ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM * ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM == ISP_AE_REGIONS,
+               "Software statistics AE blocks should match IPA AE regions");
+_Static_assert(ESP_VIDEO_SW_STATS_HIST_NUM == ISP_HIST_SEGMENT_NUMS,
+               "Software statistics histogram should match IPA histogram");
+
+/**
+ * @brief Convert software statistics to IPA statistics, so that IPA algorithms can run
+ *        with frames from pipelines without ISP.
+ *
+ * @param stats     Software statistics pointer
+ * @param seq       Statistics sequence, e.g. frame sequence
+ * @param ipa_stats IPA statistics pointer
+ *
+ * @return None
+ */
+void esp_video_sw_stats_to_ipa_stats(const esp_video_sw_stats_t *stats, uint64_t seq, esp_ipa_stats_t *ipa_stats)
+{
+    ipa_stats->flags = 0;
+    ipa_stats->seq = seq;
+
+    if (stats->flags & ESP_VIDEO_SW_STATS_FLAG_AE) {
+        /* IPA AE statistics are in [column][row] order, the same as ISP */
+        for (int i = 0; i < ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM; i++) {
+            for (int j = 0; j < ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM; j++) {
+                ipa_stats->ae_stats[j * ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM + i].luminance = stats->ae_luma[i][j];
+            }
+        }
+        ipa_stats->flags |= IPA_STATS_FLAGS_AE;
+    }
+
+    if (stats->flags & ESP_VIDEO_SW_STATS_FLAG_AWB) {
+        ipa_stats->awb_stats[0].counted = stats->awb.counted;
+        ipa_stats->awb_stats[0].sum_r = stats->awb.sum_r;
+        ipa_stats->awb_stats[0].sum_g = stats->awb.sum_g;
+        ipa_stats->awb_stats[0].sum_b = stats->awb.sum_b;
+        ipa_stats->flags |= IPA_STATS_FLAGS_AWB;
+    }
+
+    if (stats->flags & ESP_VIDEO_SW_STATS_FLAG_HIST) {
+        for (int i = 0; i < ESP_VIDEO_SW_STATS_HIST_NUM; i++) {
+            ipa_stats->hist_stats[i].value = stats->hist[i];
+        }
+        ipa_stats->flags |= IPA_STATS_FLAGS_HIST;
+    }
+}
+#endif
@@ -0,0 +1,353 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "linux/videodev2.h"
+#include "esp_video_tnr.h"
+#if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
+#include "esp_video_isp_pipeline.h"
+#endif
+
+#define TNR_TILE_SIZE_DEFAULT           16
+#define TNR_MOTION_THRESHOLD_DEFAULT    12
+
+/* Reference frame is read and written once per frame, so it can be in PSRAM */
+#define TNR_REF_CAPS                    (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+
+typedef struct esp_video_tnr {
+    uint32_t width;
+    uint32_t height;
+    uint32_t tile_size;
+    uint32_t motion_threshold;
+
+    /**
+     * Y layout, every 2 pixels take "group" bytes and Y of them are at "y_offset"
+     */
+    uint32_t group;
+    uint32_t y_offset[2];
+    uint32_t line_size;
+    size_t frame_size;
+
+    uint8_t strength;
+    bool ref_valid;
+    uint8_t *ref;                       /*!< Y plane of the previous output frame */
+
+    /**
+     * Pixel weight in 1/256 indexed by the absolute difference to reference, pixels changing much
+     * more than the noise inside a static tile are edges of small moving objects
+     */
+    uint16_t pixel_weight[256];
+} esp_video_tnr_t;
+
+static const char *TAG = "tnr";
+
+static esp_err_t tnr_init_layout(esp_video_tnr_t *tnr, uint32_t pixel_format)
+{
+    switch (pixel_format) {
+    case V4L2_PIX_FMT_GREY:
+        tnr->group = 2;
+        tnr->y_offset[0] = 0;
+        tnr->y_offset[1] = 1;
+        break;
+    case V4L2_PIX_FMT_YUYV:
+        tnr->group = 4;
+        tnr->y_offset[0] = 0;
+        tnr->y_offset[1] = 2;
+        break;
+    case V4L2_PIX_FMT_UYVY:
+        tnr->group = 4;
+        tnr->y_offset[0] = 1;
+        tnr->y_offset[1] = 3;
+        break;
+    case V4L2_PIX_FMT_YUV420:
+        /* ISP output and H.264 encoder input layout, odd lines are "U Y Y" and even lines are "V Y Y" */
+        tnr->group = 3;
+        tnr->y_offset[0] = 1;
+        tnr->y_offset[1] = 2;
+        break;
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    tnr->line_size = tnr->width / 2 * tnr->group;
+    tnr->frame_size = (size_t)tnr->line_size * tnr->height;
+
+    return ESP_OK;
+}
+
+static void tnr_init_pixel_weight(esp_video_tnr_t *tnr)
+{
+    uint32_t low = tnr->motion_threshold * 2;
+    uint32_t high = tnr->motion_threshold * 4;
+
+    for (uint32_t i = 0; i < 256; i++) {
+        if (i <= low) {
+            tnr->pixel_weight[i] = 256;
+        } else if (i >= high) {
+            tnr->pixel_weight[i] = 0;
+        } else {
+            tnr->pixel_weight[i] = (high - i) * 256 / (high - low);
+        }
+    }
+}
+
+/* Mean absolute difference of every other line, noise is uncorrelated so this is close to the full tile */
+static uint32_t tnr_tile_motion(const esp_video_tnr_t *tnr, const uint8_t *frame, uint32_t x0, uint32_t x1,
+                                uint32_t y0, uint32_t y1)
+{
+    uint32_t sad = 0;
+    uint32_t count = 0;
+
+    for (uint32_t y = y0; y < y1; y += 2) {
+        const uint8_t *line = frame + (size_t)y * tnr->line_size;
+        const uint8_t *ref = tnr->ref + (size_t)y * tnr->width;
+
+        for (uint32_t x = x0; x < x1; x += 2) {
+            const uint8_t *p = line + x / 2 * tnr->group;
+
+            sad += abs((int)p[tnr->y_offset[0]] - ref[x]);
+            sad += abs((int)p[tnr->y_offset[1]] - ref[x + 1]);
+        }
+
+        count += x1 - x0;
+    }
+
+    return sad / count;
+}
+
+static inline uint8_t tnr_blend(const esp_video_tnr_t *tnr, uint8_t cur, uint8_t ref, uint32_t weight)
+{
+    uint32_t w = (weight * tnr->pixel_weight[abs((int)cur - ref)]) >> 8;
+
+    return (cur * (256 - w) + ref * w + 128) >> 8;
+}
+
+static void tnr_tile_filter(esp_video_tnr_t *tnr, uint8_t *frame, uint32_t x0, uint32_t x1,
+                            uint32_t y0, uint32_t y1, uint32_t weight)
+{
+    for (uint32_t y = y0; y < y1; y++) {
+        uint8_t *line = frame + (size_t)y * tnr->line_size;
+        uint8_t *ref = tnr->ref + (size_t)y * tnr->width;
+
+        for (uint32_t x = x0; x < x1; x += 2) {
+            uint8_t *p = line + x / 2 * tnr->group;
+            uint8_t *p0 = &p[tnr->y_offset[0]];
+            uint8_t *p1 = &p[tnr->y_offset[1]];
+
+            if (weight) {
+                *p0 = tnr_blend(tnr, *p0, ref[x], weight);
+                *p1 = tnr_blend(tnr, *p1, ref[x + 1], weight);
+            }
+
+            /* The output is the reference of the next frame, which makes the filter recursive */
+            ref[x] = *p0;
+            ref[x + 1] = *p1;
+        }
+    }
+}
+
+/**
+ * @brief Create temporal noise reduction object.
+ *
+ * @param config Temporal noise reduction configuration
+ * @param handle Pointer to store temporal noise reduction handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format is not supported
+ *      - ESP_ERR_NO_MEM if failed to allocate memory
+ */
+esp_err_t esp_video_tnr_create(const esp_video_tnr_config_t *config, esp_video_tnr_handle_t *handle)
+{
+    esp_err_t ret;
+    esp_video_tnr_t *tnr;
+
+    ESP_RETURN_ON_FALSE(config && handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->width && config->height && !(config->width & 1), ESP_ERR_INVALID_ARG,
+                        TAG, "invalid resolution");
+    ESP_RETURN_ON_FALSE(!(config->tile_size & 1), ESP_ERR_INVALID_ARG, TAG, "tile size must be even");
+
+    tnr = heap_caps_calloc(1, sizeof(esp_video_tnr_t), MALLOC_CAP_DEFAULT);
+    ESP_RETURN_ON_FALSE(tnr, ESP_ERR_NO_MEM, TAG, "failed to malloc TNR");
+
+    tnr->width = config->width;
+    tnr->height = config->height;
+    tnr->tile_size = config->tile_size ? config->tile_size : TNR_TILE_SIZE_DEFAULT;
+    tnr->motion_threshold = config->motion_threshold ? config->motion_threshold : TNR_MOTION_THRESHOLD_DEFAULT;
+    tnr->strength = MIN(config->strength, ESP_VIDEO_TNR_STRENGTH_MAX);
+    ESP_GOTO_ON_ERROR(tnr_init_layout(tnr, config->pixel_format), exit_0, TAG, "pixel format is not supported");
+    tnr_init_pixel_weight(tnr);
+
+    tnr->ref = heap_caps_malloc_prefer((size_t)tnr->width * tnr->height, 2, TNR_REF_CAPS, MALLOC_CAP_DEFAULT);
+    ESP_GOTO_ON_FALSE(tnr->ref, ESP_ERR_NO_MEM, exit_0, TAG, "failed to malloc reference frame");
+
+    *handle = tnr;
+
+    return ESP_OK;
+
+exit_0:
+    heap_caps_free(tnr);
+    return ret;
+}
+
+/**
+ * @brief Filter a frame with the previous output frame as reference.
+ *
+ * @param handle Temporal noise reduction handle
+ * @param in     Input frame buffer pointer
+ * @param size   Size of input and output buffers in bytes
+ * @param out    Output frame buffer pointer, it can be "in"
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_SIZE if buffer is smaller than the frame
+ */
+esp_err_t esp_video_tnr_process(esp_video_tnr_handle_t handle, const uint8_t *in, size_t size, uint8_t *out)
+{
+    esp_video_tnr_t *tnr = handle;
+
+    ESP_RETURN_ON_FALSE(tnr && in && out, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(size >= tnr->frame_size, ESP_ERR_INVALID_SIZE, TAG, "buffer is too small");
+
+    /* U and V are kept, so Y is filtered in the output buffer */
+    if (out != in) {
+        memcpy(out, in, tnr->frame_size);
+    }
+
+    for (uint32_t y0 = 0; y0 < tnr->height; y0 += tnr->tile_size) {
+        uint32_t y1 = MIN(y0 + tnr->tile_size, tnr->height);
+
+        for (uint32_t x0 = 0; x0 < tnr->width; x0 += tnr->tile_size) {
+            uint32_t x1 = MIN(x0 + tnr->tile_size, tnr->width);
+            uint32_t weight = 0;
+
+            if (tnr->ref_valid && tnr->strength) {
+                uint32_t motion = tnr_tile_motion(tnr, out, x0, x1, y0, y1);
+                uint32_t threshold = tnr->motion_threshold;
+
+                if (motion <= threshold) {
+                    weight = tnr->strength;
+                } else if (motion < threshold * 2) {
+                    weight = tnr->strength * (threshold * 2 - motion) / threshold;
+                }
+            }
+
+            tnr_tile_filter(tnr, out, x0, x1, y0, y1, weight);
+        }
+    }
+
+    tnr->ref_valid = true;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Set temporal noise reduction strength.
+ *
+ * @param handle   Temporal noise reduction handle
+ * @param strength Weight of reference frame in 1/256, 0 disables filtering, values larger
+ *                 than ESP_VIDEO_TNR_STRENGTH_MAX are limited
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_tnr_set_strength(esp_video_tnr_handle_t handle, uint8_t strength)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    handle->strength = MIN(strength, ESP_VIDEO_TNR_STRENGTH_MAX);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Set temporal noise reduction strength by ISP BF denoising level, which is selected
+ *        by the IPA auto denoising algorithm from sensor gain.
+ *
+ * @param handle Temporal noise reduction handle
+ * @param level  ISP BF denoising level
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_tnr_set_denoise_level(esp_video_tnr_handle_t handle, uint8_t level)
+{
+    uint32_t strength = (uint32_t)MIN(level, ESP_VIDEO_TNR_DENOISE_LEVEL_MAX) * ESP_VIDEO_TNR_STRENGTH_MAX /
+                        ESP_VIDEO_TNR_DENOISE_LEVEL_MAX;
+
+    return esp_video_tnr_set_strength(handle, strength);
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
+/**
+ * @brief Set temporal noise reduction strength by the BF denoising level which the ISP pipeline
+ *        controller applies currently, this should be called before processing every frame.
+ *
+ * @param handle Temporal noise reduction handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - Others if failed to get denoising level, and the strength is not changed
+ */
+esp_err_t esp_video_tnr_sync_isp_pipeline(esp_video_tnr_handle_t handle)
+{
+    uint8_t level;
+
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_ERROR(esp_video_isp_pipeline_get_denoise_level(&level), TAG, "failed to get denoising level");
+
+    return esp_video_tnr_set_denoise_level(handle, level);
+}
+#endif
+
+/**
+ * @brief Drop the reference frame, e.g. after scene cut or stream restart, so that the next
+ *        frame is output without filtering.
+ *
+ * @param handle Temporal noise reduction handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_tnr_reset(esp_video_tnr_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    handle->ref_valid = false;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Delete temporal noise reduction object.
+ *
+ * @param handle Temporal noise reduction handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_tnr_delete(esp_video_tnr_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    heap_caps_free(handle->ref);
+    heap_caps_free(handle);
+
+    return ESP_OK;
+}
@@ -477,11 +477,6 @@ static esp_err_t csi_set_selection(esp_video_device_common_t *common, struct v4l
     struct csi_video *csi_video = (struct csi_video *)common->priv;
     const esp_cam_sensor_format_t *sensor_format = common->sensor_format;
 
-    if (common->cam_ctrl_handle) {
-        ESP_LOGE(TAG, "MIPI-CSI should be stream off");
-        return ESP_ERR_INVALID_STATE;
-    }
-
     if (selection->target == V4L2_SEL_TGT_CROP) {
         struct v4l2_rect *r = &selection->r;
 
@@ -491,6 +486,18 @@ static esp_err_t csi_set_selection(esp_video_device_common_t *common, struct v4l
             return ESP_ERR_INVALID_ARG;
         }
 
+        if (common->cam_ctrl_handle) {
+            const struct v4l2_rect *cur = CAPTURE_VIDEO_GET_RECT(common->video);
+
+            /* Moving the crop window keeps buffer size, e.g. electronic image stabilization */
+            if (!csi_video->set_crop || !csi_video->isp_proc || r->width != cur->width || r->height != cur->height) {
+                ESP_LOGE(TAG, "MIPI-CSI should be stream off to change crop size");
+                return ESP_ERR_INVALID_STATE;
+            }
+
+            return esp_video_isp_video_device_move_crop(csi_video->isp_proc, r);
+        }
+
         struct v4l2_format format = {
             .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
             .fmt.pix = {
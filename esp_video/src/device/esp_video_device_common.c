@@ -740,6 +740,13 @@ static esp_err_t common_video_subscribe_event(struct esp_video *video, struct v4
 {
     esp_video_device_common_t *common = VIDEO_DEVICE_COMMON(video);
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_DETECT
+    /* Motion events are sent by ISP pipeline controller, the device has nothing to enable */
+    if (sub->type == V4L2_EVENT_ESP_MOTION_DETECT) {
+        return ESP_OK;
+    }
+#endif
+
     if (!common->intf->subscribe_event) {
         return ESP_ERR_NOT_SUPPORTED;
     }
@@ -759,6 +766,12 @@ static esp_err_t common_video_unsubscribe_event(struct esp_video *video, struct
 {
     esp_video_device_common_t *common = VIDEO_DEVICE_COMMON(video);
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_DETECT
+    if (sub->type == V4L2_EVENT_ESP_MOTION_DETECT) {
+        return ESP_OK;
+    }
+#endif
+
     if (!common->intf->unsubscribe_event) {
         return ESP_ERR_NOT_SUPPORTED;
     }
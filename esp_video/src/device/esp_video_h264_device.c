@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2024-2026 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: ESPRESSIF MIT
  */
@@ -7,12 +7,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/param.h>
+#include <sys/lock.h>
 #include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "esp_attr.h"
 #include "esp_private/esp_cache_private.h"
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
 #include "esp_h264_enc_single_hw.h"
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
 #include "esp_h264_enc_single_sw.h"
+#endif
 #include "esp_h264_enc_single.h"
 
 #include "esp_video.h"
@@ -28,10 +33,17 @@
 #endif
 
 #define H264_VIDEO_DEVICE_GOP       30
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+#define H264_VIDEO_DEVICE_MIN_QP    CONFIG_ESP_VIDEO_SW_H264_DEFAULT_MIN_QP
+#define H264_VIDEO_DEVICE_MAX_QP    CONFIG_ESP_VIDEO_SW_H264_DEFAULT_MAX_QP
+#define H264_VIDEO_DEVICE_BITRATE   1000000
+#else
 #define H264_VIDEO_DEVICE_MIN_QP    25
 #define H264_VIDEO_DEVICE_MAX_QP    26
 #define H264_VIDEO_DEVICE_BITRATE   10000000
+#endif
 #define H264_VIDEO_DEVICE_FPS       30
+#define H264_VIDEO_DEVICE_QUALITY   50
 
 #define H264_VIDEO_MAX_I_PERIOD     120
 #define H264_VIDEO_MIN_I_PERIOD     1
@@ -45,13 +57,34 @@
 #define H264_VIDEO_MIN_QP           0
 #define H264_VIDEO_QP_STEP          1
 
+#define H264_VIDEO_MAX_QUALITY      100
+#define H264_VIDEO_MIN_QUALITY      1
+#define H264_VIDEO_QUALITY_STEP     1
+
 #define H264_VIDEO_MIN_WIDTH            64
 #define H264_VIDEO_MIN_HEIGHT           64
 
+#define H264_START_CODE_SIZE            3
+
+#define H264_MB_SIZE                    16
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+/* IDR frames are much larger than the average frame size of the bitrate */
+#define H264_IDR_FRAME_SIZE_RATIO       8
+/* Minimum estimated frame size in 1/H264_MIN_FRAME_SIZE_DIV of pixels, IDR frames of low bitrates exceed the bitrate */
+#define H264_MIN_FRAME_SIZE_DIV         16
+#endif
+
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(x)   (sizeof(x) / sizeof((x)[0]))
 #endif
 
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+#define H264_VIDEO_NAL_OUTPUT(hv)       ((hv)->nal_output)
+#else
+#define H264_VIDEO_NAL_OUTPUT(hv)       false
+#endif
+
 struct h264_video {
     bool hw_codec;
 
@@ -61,7 +94,40 @@ struct h264_video {
     uint8_t max_qp;
     uint8_t fps;
     uint32_t bitrate;
+    uint8_t rc_mode;                    /*!< V4L2_MPEG_VIDEO_BITRATE_MODE_CBR or V4L2_MPEG_VIDEO_BITRATE_MODE_CQ */
+    uint8_t quality;                    /*!< Constant quality level of V4L2_MPEG_VIDEO_BITRATE_MODE_CQ */
     esp_h264_enc_handle_t enc_handle;
+
+    /**
+     * QP range, rate control mode and IDR request can't be changed by encoder parameter
+     * handle, so the encoder is re-created before encoding next frame, and the new
+     * encoder starts with an IDR frame.
+     */
+    bool reopen;
+    _lock_t lock;                       /*!< Serialize encoding and changing encoder */
+
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+    esp_video_h264_roi_t roi;           /*!< Regions of interest in pixels, applied to hardware encoder */
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    bool size_estimated;                /*!< Capture buffer size is estimated by bitrate */
+    uint8_t *reserve_buffer;            /*!< Frame larger than capture buffer is encoded again into it */
+    uint32_t reserve_buffer_size;
+    uint32_t overflow_frames;
+    bool overflow_qp;                   /*!< Encoder is opened with the maximum QP, since an IDR frame overflows capture buffer */
+    uint32_t overflow_qp_frames;        /*!< Frames encoded with the maximum QP, the QP range is restored after a GOP */
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+    bool nal_output;
+    uint8_t *au_buffer;                 /*!< Bitstream of the access unit being dequeued by NAL units */
+    uint32_t au_buffer_size;
+    uint32_t au_size;                   /*!< Valid size of bitstream in au_buffer */
+    uint32_t au_pos;                    /*!< Offset of bitstream not dequeued */
+    uint32_t nal_end;                   /*!< End offset of the NAL unit being dequeued */
+    uint32_t au_flags;                  /*!< V4L2 frame type flags of the access unit */
+#endif
 };
 
 static const struct v4l2_query_ext_ctrl s_h264_qctrl[] = {
@@ -109,6 +175,75 @@ static const struct v4l2_query_ext_ctrl s_h264_qctrl[] = {
         .default_value = H264_VIDEO_DEVICE_BITRATE,
         .name = "Video Bitrate"
     },
+    {
+        .id = V4L2_CID_MPEG_VIDEO_BITRATE_MODE,
+        .type = V4L2_CTRL_TYPE_MENU,
+        .maximum = V4L2_MPEG_VIDEO_BITRATE_MODE_CQ,
+        .minimum = V4L2_MPEG_VIDEO_BITRATE_MODE_CBR,
+        .step = 1,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .default_value = V4L2_MPEG_VIDEO_BITRATE_MODE_CBR,
+        .name = "Video Bitrate Mode"
+    },
+    {
+        .id = V4L2_CID_MPEG_VIDEO_CONSTANT_QUALITY,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .maximum = H264_VIDEO_MAX_QUALITY,
+        .minimum = H264_VIDEO_MIN_QUALITY,
+        .step = H264_VIDEO_QUALITY_STEP,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .default_value = H264_VIDEO_DEVICE_QUALITY,
+        .name = "Constant Quality"
+    },
+    {
+        .id = V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME,
+        .type = V4L2_CTRL_TYPE_BUTTON,
+        .flags = V4L2_CTRL_FLAG_WRITE_ONLY,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .name = "Force Key Frame"
+    },
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+    {
+        .id = V4L2_CID_CODEC_ESP_H264_ROI,
+        .type = V4L2_CTRL_TYPE_U8,
+        .maximum = UINT8_MAX,
+        .minimum = 0,
+        .step = 1,
+        .elems = sizeof(esp_video_h264_roi_t),
+        .nr_of_dims = 1,
+        .name = "H264 Regions of Interest",
+    },
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    {
+        .id = V4L2_CID_CODEC_ESP_H264_OVERFLOW_FRAMES,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .maximum = INT32_MAX,
+        .minimum = 0,
+        .step = 1,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .default_value = 0,
+        .flags = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .name = "H264 Overflow Frames",
+    },
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+    {
+        .id = V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT,
+        .type = V4L2_CTRL_TYPE_BOOLEAN,
+        .maximum = 1,
+        .minimum = 0,
+        .step = 1,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .default_value = 0,
+        .name = "H264 NAL Unit Output",
+    },
+#endif
 };
 
 static const char *TAG = "h.264_video";
@@ -133,23 +268,361 @@ static esp_err_t errno_h264_to_std(esp_h264_err_t h264_err)
     }
 }
 
-static esp_err_t h264_get_input_format_from_v4l2(uint32_t v4l2_format, esp_h264_raw_format_t *input_format, uint8_t *input_bpp)
+static esp_err_t h264_get_input_format_from_v4l2(bool hw_codec, uint32_t v4l2_format, esp_h264_raw_format_t *input_format, uint8_t *input_bpp)
 {
     esp_err_t ret = ESP_OK;
 
-    switch (v4l2_format) {
-    case V4L2_PIX_FMT_YUV420:
-        *input_format = ESP_H264_RAW_FMT_O_UYY_E_VYY;
-        *input_bpp = 12;
-        break;
-    default:
-        ret = ESP_ERR_NOT_SUPPORTED;
-        break;
+    if (hw_codec) {
+        switch (v4l2_format) {
+        case V4L2_PIX_FMT_YUV420:
+            *input_format = ESP_H264_RAW_FMT_O_UYY_E_VYY;
+            *input_bpp = 12;
+            break;
+        default:
+            ret = ESP_ERR_NOT_SUPPORTED;
+            break;
+        }
+    } else {
+        /**
+         * Software encoder input comes from DVP/SPI cameras or software conversion,
+         * so YUV420 is the standard planar layout rather than the ISP output layout.
+         */
+        switch (v4l2_format) {
+        case V4L2_PIX_FMT_YUV420:
+            *input_format = ESP_H264_RAW_FMT_I420;
+            *input_bpp = 12;
+            break;
+        case V4L2_PIX_FMT_YUYV:
+            *input_format = ESP_H264_RAW_FMT_YUYV;
+            *input_bpp = 16;
+            break;
+        default:
+            ret = ESP_ERR_NOT_SUPPORTED;
+            break;
+        }
     }
 
     return ret;
 }
 
+static esp_h264_err_t h264_get_param_handle(struct h264_video *h264_video, esp_h264_enc_param_handle_t *param)
+{
+    esp_h264_err_t h264_err = ESP_H264_ERR_UNSUPPORTED;
+
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+    if (h264_video->hw_codec) {
+        esp_h264_enc_param_hw_handle_t hw_param;
+
+        h264_err = esp_h264_enc_hw_get_param_hd(h264_video->enc_handle, &hw_param);
+        if (h264_err == ESP_H264_ERR_OK) {
+            *param = &hw_param->base;
+        }
+    }
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+    if (!h264_video->hw_codec) {
+        esp_h264_enc_param_sw_handle_t sw_param;
+
+        h264_err = esp_h264_enc_sw_get_param_hd(h264_video->enc_handle, &sw_param);
+        if (h264_err == ESP_H264_ERR_OK) {
+            *param = &sw_param->base;
+        }
+    }
+#endif
+
+    return h264_err;
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+static esp_err_t h264_check_roi(struct esp_video *video, const esp_video_h264_roi_t *roi)
+{
+    uint32_t width = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video);
+    uint32_t height = M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video);
+
+    ESP_RETURN_ON_FALSE(roi->num <= ESP_VIDEO_H264_ROI_MAX_NUM, ESP_ERR_INVALID_ARG, TAG, "ROI number is out of range");
+    ESP_RETURN_ON_FALSE(roi->background_delta_qp >= ESP_VIDEO_H264_ROI_MIN_DELTA_QP &&
+                        roi->background_delta_qp <= ESP_VIDEO_H264_ROI_MAX_DELTA_QP,
+                        ESP_ERR_INVALID_ARG, TAG, "ROI background delta QP is out of range");
+
+    for (int i = 0; i < roi->num; i++) {
+        const esp_video_h264_roi_region_t *region = &roi->regions[i];
+
+        ESP_RETURN_ON_FALSE(region->width && region->height &&
+                            ((uint32_t)region->left + region->width) <= width &&
+                            ((uint32_t)region->top + region->height) <= height,
+                            ESP_ERR_INVALID_ARG, TAG, "ROI region %d is out of image", i);
+        ESP_RETURN_ON_FALSE(region->delta_qp >= ESP_VIDEO_H264_ROI_MIN_DELTA_QP &&
+                            region->delta_qp <= ESP_VIDEO_H264_ROI_MAX_DELTA_QP,
+                            ESP_ERR_INVALID_ARG, TAG, "ROI region %d delta QP is out of range", i);
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * Configure regions of interest of hardware encoder, the configuration is kept by encoder
+ * and used by every frame encoded after it, caller must hold h264_video->lock.
+ */
+static esp_err_t h264_apply_roi(struct h264_video *h264_video)
+{
+    esp_h264_err_t h264_err;
+    esp_h264_enc_param_hw_handle_t hw_param;
+    const esp_video_h264_roi_t *roi = &h264_video->roi;
+    esp_h264_enc_roi_cfg_t roi_cfg = {
+        .roi_mode = roi->num ? ESP_H264_ROI_MODE_DELTA_QP : ESP_H264_ROI_MODE_DISABLE,
+        .none_roi_delta_qp = roi->background_delta_qp,
+    };
+
+    h264_err = esp_h264_enc_hw_get_param_hd(h264_video->enc_handle, &hw_param);
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to get H.264 encoder parameter");
+        return errno_h264_to_std(h264_err);
+    }
+
+    /* Configuring ROI mode drops regions set before */
+    h264_err = esp_h264_enc_hw_cfg_roi(hw_param, roi_cfg);
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to configure H.264 encoder ROI");
+        return errno_h264_to_std(h264_err);
+    }
+
+    for (int i = 0; i < roi->num; i++) {
+        const esp_video_h264_roi_region_t *region = &roi->regions[i];
+        /* Expand region to macroblocks which contain any pixel of it */
+        uint16_t x = region->left / H264_MB_SIZE;
+        uint16_t y = region->top / H264_MB_SIZE;
+        esp_h264_enc_roi_reg_t roi_reg = {
+            .x = x,
+            .y = y,
+            .len_x = (region->left + region->width + H264_MB_SIZE - 1) / H264_MB_SIZE - x,
+            .len_y = (region->top + region->height + H264_MB_SIZE - 1) / H264_MB_SIZE - y,
+            .qp = region->delta_qp,
+        };
+
+        h264_err = esp_h264_enc_hw_set_roi_region(hw_param, roi_reg);
+        if (h264_err != ESP_H264_ERR_OK) {
+            ESP_LOGE(TAG, "failed to set H.264 encoder ROI region %d", i);
+            return errno_h264_to_std(h264_err);
+        }
+    }
+
+    return ESP_OK;
+}
+#endif
+
+static esp_err_t h264_open_encoder(struct esp_video *video, struct h264_video *h264_video)
+{
+    esp_h264_err_t h264_err = ESP_H264_ERR_UNSUPPORTED;
+    esp_h264_enc_cfg_t config = {
+        .pic_type = h264_video->input_format,
+        .gop = h264_video->gop,
+        .fps = h264_video->fps,
+        .res = {
+            .width = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video),
+            .height = M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video),
+        },
+        .rc = {
+            .bitrate = h264_video->bitrate,
+            .qp_min = h264_video->min_qp,
+            .qp_max = h264_video->max_qp,
+        }
+    };
+
+    if (h264_video->rc_mode == V4L2_MPEG_VIDEO_BITRATE_MODE_CQ) {
+        /* Quality 1~100 maps to QP 51~0, and every frame uses the same QP */
+        config.rc.qp_min = H264_VIDEO_MAX_QP - h264_video->quality * H264_VIDEO_MAX_QP / H264_VIDEO_MAX_QUALITY;
+        config.rc.qp_max = config.rc.qp_min;
+    }
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    if (h264_video->overflow_qp) {
+        config.rc.qp_min = H264_VIDEO_MAX_QP;
+        config.rc.qp_max = H264_VIDEO_MAX_QP;
+        h264_video->overflow_qp_frames = 0;
+    }
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+    if (h264_video->hw_codec) {
+        h264_err = esp_h264_enc_hw_new(&config, &h264_video->enc_handle);
+    }
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+    if (!h264_video->hw_codec) {
+        h264_err = esp_h264_enc_sw_new(&config, &h264_video->enc_handle);
+    }
+#endif
+
+    if (h264_err != ESP_H264_ERR_OK) {
+        h264_video->enc_handle = NULL;
+        ESP_LOGE(TAG, "failed to create H.264 encoder");
+        return errno_h264_to_std(h264_err);
+    }
+
+    h264_err = esp_h264_enc_open(h264_video->enc_handle);
+    if (h264_err != ESP_H264_ERR_OK) {
+        esp_h264_enc_del(h264_video->enc_handle);
+        h264_video->enc_handle = NULL;
+
+        ESP_LOGE(TAG, "failed to open H.264 encoder");
+        return errno_h264_to_std(h264_err);
+    }
+
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+    if (h264_video->hw_codec && h264_apply_roi(h264_video) != ESP_OK) {
+        esp_h264_enc_close(h264_video->enc_handle);
+        esp_h264_enc_del(h264_video->enc_handle);
+        h264_video->enc_handle = NULL;
+
+        return ESP_FAIL;
+    }
+#endif
+
+    h264_video->reopen = false;
+
+    return ESP_OK;
+}
+
+static esp_err_t h264_close_encoder(struct h264_video *h264_video)
+{
+    esp_h264_err_t h264_err;
+
+    h264_err = esp_h264_enc_close(h264_video->enc_handle);
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to close H.264 encoder");
+        return errno_h264_to_std(h264_err);
+    }
+
+    h264_err = esp_h264_enc_del(h264_video->enc_handle);
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to delete H.264 encoder");
+        return errno_h264_to_std(h264_err);
+    }
+    h264_video->enc_handle = NULL;
+
+    return ESP_OK;
+}
+
+/**
+ * Encode one frame between changes of encoder, caller must hold h264_video->lock.
+ */
+static esp_h264_err_t h264_encode_frame(struct esp_video *video, struct h264_video *h264_video,
+                                        esp_h264_enc_in_frame_t *in_frame, esp_h264_enc_out_frame_t *out_frame)
+{
+    esp_h264_err_t h264_err;
+
+    if (h264_video->reopen) {
+        if (h264_close_encoder(h264_video) != ESP_OK ||
+                h264_open_encoder(video, h264_video) != ESP_OK) {
+            return ESP_H264_ERR_FAIL;
+        }
+
+        ESP_LOGD(TAG, "encoder is re-created");
+    }
+
+    if (!h264_video->enc_handle) {
+        return ESP_H264_ERR_FAIL;
+    }
+
+    h264_err = esp_h264_enc_process(h264_video->enc_handle, in_frame, out_frame);
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    /* The next frame starts a new GOP, so it is an IDR frame encoded with the QP range of user again */
+    if (h264_err == ESP_H264_ERR_OK && h264_video->overflow_qp &&
+            ++h264_video->overflow_qp_frames >= h264_video->gop) {
+        h264_video->overflow_qp = false;
+        h264_video->reopen = true;
+    }
+#endif
+
+    return h264_err;
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+/**
+ * Estimate capture buffer size by the bitrate, it is not larger than the default size, which is
+ * 8 bits per pixel. Constant quality mode has no bitrate, so the default size is used.
+ */
+static uint32_t h264_estimate_frame_size(struct h264_video *h264_video, uint32_t width, uint32_t height)
+{
+    uint64_t size;
+
+    if (h264_video->rc_mode != V4L2_MPEG_VIDEO_BITRATE_MODE_CBR) {
+        return width * height;
+    }
+
+    size = (uint64_t)h264_video->bitrate * H264_IDR_FRAME_SIZE_RATIO / h264_video->fps / 8;
+    size = MAX(size, width * height / H264_MIN_FRAME_SIZE_DIV);
+
+    return MIN(size, width * height);
+}
+
+/**
+ * Re-create the encoder and encode the frame into the reserve buffer as an IDR frame, caller
+ * must hold h264_video->lock.
+ */
+static esp_h264_err_t h264_encode_reserve_frame(struct esp_video *video, struct h264_video *h264_video,
+                                                esp_h264_enc_in_frame_t *in_frame, esp_h264_enc_out_frame_t *out_frame)
+{
+    esp_h264_err_t h264_err;
+    uint8_t *dst = out_frame->raw_data.buffer;
+    uint32_t dst_size = out_frame->raw_data.len;
+
+    h264_video->reopen = true;
+
+    out_frame->raw_data.buffer = h264_video->reserve_buffer;
+    out_frame->raw_data.len = h264_video->reserve_buffer_size;
+    h264_err = h264_encode_frame(video, h264_video, in_frame, out_frame);
+    out_frame->raw_data.buffer = dst;
+    out_frame->raw_data.len = dst_size;
+
+    return h264_err;
+}
+
+/**
+ * Frame is larger than capture buffer and the truncated frame may be referenced, so the encoder
+ * is re-created and the frame is encoded again into the reserve buffer as an IDR frame, and then
+ * it is copied if it fits capture buffer.
+ *
+ * Rate control can't shrink an IDR frame below the QP range, e.g. at a low bitrate or a scene of
+ * high detail, so an IDR frame which still overflows is encoded once more with the maximum QP, and
+ * the maximum QP is kept until the GOP ends. Otherwise, every next frame would be an IDR frame which
+ * overflows and is dropped again. Only a frame which still overflows with the maximum QP is dropped,
+ * caller must hold h264_video->lock.
+ */
+static esp_h264_err_t h264_encode_overflow_frame(struct esp_video *video, struct h264_video *h264_video,
+                                                 esp_h264_enc_in_frame_t *in_frame, esp_h264_enc_out_frame_t *out_frame)
+{
+    esp_h264_err_t h264_err;
+    uint8_t *dst = out_frame->raw_data.buffer;
+    uint32_t dst_size = out_frame->raw_data.len;
+
+    h264_video->overflow_frames++;
+
+    h264_err = h264_encode_reserve_frame(video, h264_video, in_frame, out_frame);
+    if (h264_err == ESP_H264_ERR_OK && out_frame->length > dst_size && !h264_video->overflow_qp) {
+        ESP_LOGW(TAG, "IDR frame size=%" PRIu32 " is larger than capture buffer size=%" PRIu32 ", encode it again with QP=%d",
+                 out_frame->length, dst_size, H264_VIDEO_MAX_QP);
+        h264_video->overflow_qp = true;
+        h264_err = h264_encode_reserve_frame(video, h264_video, in_frame, out_frame);
+    }
+    if (h264_err != ESP_H264_ERR_OK) {
+        return h264_err;
+    }
+
+    if (out_frame->length > dst_size) {
+        ESP_LOGW(TAG, "frame size=%" PRIu32 " is larger than capture buffer size=%" PRIu32 ", drop it", out_frame->length, dst_size);
+        h264_video->reopen = true;
+        return ESP_H264_ERR_OVERFLOW;
+    }
+
+    ESP_LOGW(TAG, "frame is larger than capture buffer size=%" PRIu32 ", encode it again as IDR frame", dst_size);
+    memcpy(dst, h264_video->reserve_buffer, out_frame->length);
+
+    return ESP_H264_ERR_OK;
+}
+#endif
+
 static esp_err_t h264_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
 {
     esp_h264_err_t h264_err;
@@ -167,7 +640,14 @@ static esp_err_t h264_video_m2m_process(struct esp_video *video, uint8_t *src, u
     };
     struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
 
-    h264_err = esp_h264_enc_process(h264_video->enc_handle, &in_frame, &out_frame);
+    _lock_acquire(&h264_video->lock);
+    h264_err = h264_encode_frame(video, h264_video, &in_frame, &out_frame);
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    if (h264_err == ESP_H264_ERR_OVERFLOW && h264_video->reserve_buffer) {
+        h264_err = h264_encode_overflow_frame(video, h264_video, &in_frame, &out_frame);
+    }
+#endif
+    _lock_release(&h264_video->lock);
     if (h264_err == ESP_H264_ERR_OK) {
         *dst_out_size = out_frame.length;
     }
@@ -175,6 +655,139 @@ static esp_err_t h264_video_m2m_process(struct esp_video *video, uint8_t *src, u
     return errno_h264_to_std(h264_err);
 }
 
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+/**
+ * Return offset of the first Annex B start code at or after "pos", the leading zero byte of
+ * 4-byte start code is taken as a part of the start code. Return "size" if there is none.
+ */
+static uint32_t h264_find_start_code(const uint8_t *data, uint32_t pos, uint32_t size)
+{
+    for (uint32_t i = pos; i + H264_START_CODE_SIZE <= size; i++) {
+        if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+            return (i > pos && data[i - 1] == 0) ? i - 1 : i;
+        }
+    }
+
+    return size;
+}
+
+static esp_err_t h264_encode_access_unit(struct esp_video *video, struct h264_video *h264_video, struct esp_video_buffer_element *src_element)
+{
+    esp_h264_err_t h264_err;
+    esp_h264_enc_in_frame_t in_frame = {
+        .raw_data = {
+            .buffer = ELEMENT_BUFFER(src_element),
+            .len = ELEMENT_SIZE(src_element),
+        }
+    };
+    esp_h264_enc_out_frame_t out_frame = {
+        .raw_data = {
+            .buffer = h264_video->au_buffer,
+            .len = h264_video->au_buffer_size,
+        }
+    };
+
+    h264_video->au_size = 0;
+    h264_video->au_pos = 0;
+    h264_video->nal_end = 0;
+
+    _lock_acquire(&h264_video->lock);
+    h264_err = h264_encode_frame(video, h264_video, &in_frame, &out_frame);
+    _lock_release(&h264_video->lock);
+    if (h264_err != ESP_H264_ERR_OK) {
+        ESP_LOGE(TAG, "failed to encode frame ret=%d", h264_err);
+        return errno_h264_to_std(h264_err);
+    }
+
+    h264_video->au_size = out_frame.length;
+    h264_video->au_flags = out_frame.frame_type == ESP_H264_FRAME_TYPE_P ? V4L2_BUF_FLAG_PFRAME : V4L2_BUF_FLAG_KEYFRAME;
+
+    return ESP_OK;
+}
+
+/**
+ * Fill one capture buffer with data of one NAL unit, a new access unit is encoded
+ * only after all NAL units of the previous one are dequeued. If encoding fails, an
+ * empty buffer marked by V4L2_BUF_FLAG_ERROR ends the access unit.
+ */
+static esp_err_t h264_video_nal_output_process(struct esp_video *video, struct h264_video *h264_video)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t size;
+    uint32_t flags = 0;
+    struct esp_video_buffer_element *src_element;
+    struct esp_video_buffer_element *dst_element;
+
+    dst_element = esp_video_get_queued_element(video, V4L2_BUF_TYPE_VIDEO_CAPTURE);
+    if (!dst_element) {
+        ESP_LOGE(TAG, "no valid buffer");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (h264_video->au_pos >= h264_video->au_size) {
+        src_element = esp_video_get_queued_element(video, V4L2_BUF_TYPE_VIDEO_OUTPUT);
+        if (!src_element) {
+            ESP_LOGE(TAG, "no valid buffer");
+            esp_video_queue_element(video, V4L2_BUF_TYPE_VIDEO_CAPTURE, dst_element);
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        ret = h264_encode_access_unit(video, h264_video, src_element);
+        ESP_RETURN_ON_ERROR(esp_video_done_element(video, V4L2_BUF_TYPE_VIDEO_OUTPUT, src_element),
+                            TAG, "failed to put element back into done list");
+    }
+
+    if (h264_video->au_pos < h264_video->au_size) {
+        if (h264_video->au_pos >= h264_video->nal_end) {
+            h264_video->nal_end = h264_find_start_code(h264_video->au_buffer,
+                                                       h264_video->au_pos + H264_START_CODE_SIZE,
+                                                       h264_video->au_size);
+            flags |= V4L2_BUF_FLAG_ESP_NAL_START;
+        }
+
+        size = MIN(h264_video->nal_end - h264_video->au_pos, ELEMENT_SIZE(dst_element));
+        memcpy(ELEMENT_BUFFER(dst_element), h264_video->au_buffer + h264_video->au_pos, size);
+        h264_video->au_pos += size;
+
+        if (h264_video->au_pos == h264_video->nal_end) {
+            flags |= V4L2_BUF_FLAG_ESP_NAL_END;
+        }
+        if (h264_video->au_pos == h264_video->au_size) {
+            flags |= V4L2_BUF_FLAG_ESP_FRAME_END;
+        }
+
+        dst_element->valid_size = size;
+        dst_element->flags = flags | h264_video->au_flags;
+    } else {
+        dst_element->valid_size = 0;
+        if (ret != ESP_OK) {
+            dst_element->flags = V4L2_BUF_FLAG_ERROR | V4L2_BUF_FLAG_ESP_FRAME_END;
+        }
+    }
+
+    ESP_RETURN_ON_ERROR(esp_video_done_element(video, V4L2_BUF_TYPE_VIDEO_CAPTURE, dst_element),
+                        TAG, "failed to put element back into done list");
+
+    return ESP_OK;
+}
+#endif
+
+static esp_err_t h264_video_process(struct esp_video *video)
+{
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+
+    if (h264_video->nal_output) {
+        return h264_video_nal_output_process(video, h264_video);
+    }
+#endif
+
+    return esp_video_m2m_process(video,
+                                 V4L2_BUF_TYPE_VIDEO_OUTPUT,
+                                 V4L2_BUF_TYPE_VIDEO_CAPTURE,
+                                 h264_video_m2m_process);
+}
+
 static esp_err_t h264_video_init(struct esp_video *video)
 {
     M2M_VIDEO_SET_CAPTURE_FORMAT(video, H264_VIDEO_MIN_WIDTH, H264_VIDEO_MIN_HEIGHT, V4L2_PIX_FMT_H264);
@@ -190,7 +803,7 @@ static esp_err_t h264_video_deinit(struct esp_video *video)
 
 static esp_err_t h264_video_start(struct esp_video *video, uint32_t type)
 {
-    esp_h264_err_t h264_err = ESP_H264_ERR_UNSUPPORTED;
+    esp_err_t ret;
     struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
 
     if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
@@ -200,40 +813,57 @@ static esp_err_t h264_video_start(struct esp_video *video, uint32_t type)
     }
 
     if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
-        esp_h264_enc_cfg_hw_t config = {
-            .pic_type = h264_video->input_format,
-            .gop = h264_video->gop,
-            .fps = h264_video->fps,
-            .res = {
-                .width = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video),
-                .height = M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video),
-            },
-            .rc = {
-                .bitrate = h264_video->bitrate,
-                .qp_min = h264_video->min_qp,
-                .qp_max = h264_video->max_qp,
-            }
-        };
-
-        if (h264_video->hw_codec) {
-            h264_err = esp_h264_enc_hw_new(&config, &h264_video->enc_handle);
-        } else {
-            h264_err = ESP_H264_ERR_UNSUPPORTED;
+        _lock_acquire(&h264_video->lock);
+        ret = h264_open_encoder(video, h264_video);
+        _lock_release(&h264_video->lock);
+        if (ret != ESP_OK) {
+            return ret;
         }
 
-        if (h264_err != ESP_H264_ERR_OK) {
-            ESP_LOGE(TAG, "failed to create H.264 encoder");
-            return errno_h264_to_std(h264_err);
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+        /* Same as the default capture buffer size, which is 8 bits per pixel of bitstream */
+        uint32_t reserve_buffer_size = M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) *
+                                       M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video);
+
+        /**
+         * Only estimated capture buffer needs it, and NAL unit output encodes a whole access unit
+         * into its bitstream buffer, so it never overflows.
+         */
+        if (h264_video->size_estimated && !H264_VIDEO_NAL_OUTPUT(h264_video) &&
+                M2M_VIDEO_CAPTURE_BUF_SIZE(video) < reserve_buffer_size) {
+            h264_video->reserve_buffer = heap_caps_malloc(reserve_buffer_size, H264_MEM_CAPS);
+            if (!h264_video->reserve_buffer) {
+                _lock_acquire(&h264_video->lock);
+                h264_close_encoder(h264_video);
+                _lock_release(&h264_video->lock);
+
+                ESP_LOGE(TAG, "failed to malloc reserve buffer");
+                return ESP_ERR_NO_MEM;
+            }
+
+            h264_video->reserve_buffer_size = reserve_buffer_size;
         }
+#endif
 
-        h264_err = esp_h264_enc_open(h264_video->enc_handle);
-        if (h264_err != ESP_H264_ERR_OK) {
-            esp_h264_enc_del(h264_video->enc_handle);
-            h264_video->enc_handle = NULL;
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+        if (h264_video->nal_output) {
+            h264_video->au_buffer_size = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video) *
+                                         M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video) * 3 / 2;
+            h264_video->au_buffer = heap_caps_malloc(h264_video->au_buffer_size, H264_MEM_CAPS);
+            if (!h264_video->au_buffer) {
+                _lock_acquire(&h264_video->lock);
+                h264_close_encoder(h264_video);
+                _lock_release(&h264_video->lock);
+
+                ESP_LOGE(TAG, "failed to malloc bitstream buffer");
+                return ESP_ERR_NO_MEM;
+            }
 
-            ESP_LOGE(TAG, "failed to open H.264 encoder");
-            return errno_h264_to_std(h264_err);
+            h264_video->au_size = 0;
+            h264_video->au_pos = 0;
+            h264_video->nal_end = 0;
         }
+#endif
     }
 
     return ESP_OK;
@@ -241,22 +871,31 @@ static esp_err_t h264_video_start(struct esp_video *video, uint32_t type)
 
 static esp_err_t h264_video_stop(struct esp_video *video, uint32_t type)
 {
-    esp_h264_err_t h264_err;
+    esp_err_t ret = ESP_OK;
     struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
 
     if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
-        h264_err = esp_h264_enc_close(h264_video->enc_handle);
-        if (h264_err != ESP_H264_ERR_OK) {
-            ESP_LOGE(TAG, "failed to close H.264 encoder");
-            return errno_h264_to_std(h264_err);
+        _lock_acquire(&h264_video->lock);
+        /* Encoder has been released if it failed to be re-created */
+        if (h264_video->enc_handle) {
+            ret = h264_close_encoder(h264_video);
         }
-
-        h264_err = esp_h264_enc_del(h264_video->enc_handle);
-        if (h264_err != ESP_H264_ERR_OK) {
-            ESP_LOGE(TAG, "failed to delete H.264 encoder");
-            return errno_h264_to_std(h264_err);
+        _lock_release(&h264_video->lock);
+        if (ret != ESP_OK) {
+            return ret;
         }
-        h264_video->enc_handle = NULL;
+
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+        heap_caps_free(h264_video->au_buffer);
+        h264_video->au_buffer = NULL;
+        h264_video->au_size = 0;
+        h264_video->au_pos = 0;
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+        heap_caps_free(h264_video->reserve_buffer);
+        h264_video->reserve_buffer = NULL;
+        h264_video->overflow_qp = false;
+#endif
     }
 
     return ESP_OK;
@@ -275,15 +914,28 @@ static esp_err_t h264_video_enum_format(struct esp_video *video, uint32_t type,
 
         *pixel_format = h264_capture_format[index];
     } else if (type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
-        static const uint32_t h264_output_format[] = {
+        static const uint32_t h264_hw_output_format[] = {
+            V4L2_PIX_FMT_YUV420,
+        };
+        static const uint32_t h264_sw_output_format[] = {
             V4L2_PIX_FMT_YUV420,
+            V4L2_PIX_FMT_YUYV,
         };
+        struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
 
-        if (index >= ARRAY_SIZE(h264_output_format)) {
-            return ESP_ERR_INVALID_ARG;
-        }
+        if (h264_video->hw_codec) {
+            if (index >= ARRAY_SIZE(h264_hw_output_format)) {
+                return ESP_ERR_INVALID_ARG;
+            }
+
+            *pixel_format = h264_hw_output_format[index];
+        } else {
+            if (index >= ARRAY_SIZE(h264_sw_output_format)) {
+                return ESP_ERR_INVALID_ARG;
+            }
 
-        *pixel_format = h264_output_format[index];
+            *pixel_format = h264_sw_output_format[index];
+        }
     } else {
         return ESP_ERR_NOT_SUPPORTED;
     }
@@ -296,6 +948,9 @@ static esp_err_t h264_video_set_format(struct esp_video *video, const struct v4l
     esp_err_t ret;
     const struct v4l2_pix_format *pix = &format->fmt.pix;
     struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    struct v4l2_format estimated_format;
+#endif
 
     if (format->type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
         if ((pix->pixelformat != V4L2_PIX_FMT_H264) ||
@@ -304,6 +959,15 @@ static esp_err_t h264_video_set_format(struct esp_video *video, const struct v4l
             ESP_LOGE(TAG, "pixel format or width or height is invalid");
             return ESP_ERR_INVALID_ARG;
         }
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+        h264_video->size_estimated = !pix->sizeimage;
+        if (h264_video->size_estimated) {
+            estimated_format = *format;
+            estimated_format.fmt.pix.sizeimage = h264_estimate_frame_size(h264_video, pix->width, pix->height);
+            format = &estimated_format;
+        }
+#endif
     } else if (format->type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
         uint8_t input_bpp;
 
@@ -315,7 +979,7 @@ static esp_err_t h264_video_set_format(struct esp_video *video, const struct v4l
             return ESP_ERR_INVALID_ARG;
         }
 
-        ret = h264_get_input_format_from_v4l2(pix->pixelformat, &h264_video->input_format, &input_bpp);
+        ret = h264_get_input_format_from_v4l2(h264_video->hw_codec, pix->pixelformat, &h264_video->input_format, &input_bpp);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "pixel format is invalid");
             return ret;
@@ -337,10 +1001,7 @@ static esp_err_t h264_video_notify(struct esp_video *video, enum esp_video_event
         uint32_t type = *(uint32_t *)arg;
 
         if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
-            ret = esp_video_m2m_process(video,
-                                        V4L2_BUF_TYPE_VIDEO_OUTPUT,
-                                        V4L2_BUF_TYPE_VIDEO_CAPTURE,
-                                        h264_video_m2m_process);
+            ret = h264_video_process(video);
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "failed to process M2M device data");
                 return ret;
@@ -351,15 +1012,14 @@ static esp_err_t h264_video_notify(struct esp_video *video, enum esp_video_event
     return ESP_OK;
 }
 
-static esp_err_t h264_video_set_ext_ctrl(struct esp_video *video, const struct v4l2_ext_controls *ctrls)
+static esp_err_t h264_set_ext_ctrl(struct esp_video *video, struct h264_video *h264_video, const struct v4l2_ext_controls *ctrls)
 {
     esp_err_t ret = ESP_OK;
-    esp_h264_enc_param_hw_handle_t param;
-    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+    esp_h264_enc_param_handle_t param;
     bool h264_started = h264_video->enc_handle != NULL;
 
     if (h264_started) {
-        ret = esp_h264_enc_hw_get_param_hd(h264_video->enc_handle, &param);
+        ret = h264_get_param_handle(h264_video, &param);
         if (ret != ESP_H264_ERR_OK) {
             ESP_LOGE(TAG, "failed to get H.264 encoder parameter");
             return errno_h264_to_std(ret);
@@ -377,7 +1037,7 @@ static esp_err_t h264_video_set_ext_ctrl(struct esp_video *video, const struct v
             }
 
             if (h264_started) {
-                ret = esp_h264_enc_set_gop(&param->base, ctrl->value);
+                ret = esp_h264_enc_set_gop(param, ctrl->value);
                 if (ret != ESP_H264_ERR_OK) {
                     ESP_LOGE(TAG, "failed to set H.264 encoder GOP");
                     return errno_h264_to_std(ret);
@@ -394,7 +1054,7 @@ static esp_err_t h264_video_set_ext_ctrl(struct esp_video *video, const struct v
             }
 
             if (h264_started) {
-                ret = esp_h264_enc_set_bitrate(&param->base, ctrl->value);
+                ret = esp_h264_enc_set_bitrate(param, ctrl->value);
                 if (ret != ESP_H264_ERR_OK) {
                     ESP_LOGE(TAG, "failed to set H.264 encoder bitrate");
                     return errno_h264_to_std(ret);
@@ -409,8 +1069,8 @@ static esp_err_t h264_video_set_ext_ctrl(struct esp_video *video, const struct v
                 ESP_LOGE(TAG, "min QP value is out of range");
                 return ESP_ERR_INVALID_ARG;
             }
-            if (h264_started) {
-                ESP_LOGW(TAG, "min QP is not supported when encoder is started");
+            if (h264_started && h264_video->min_qp != ctrl->value) {
+                h264_video->reopen = true;
             }
 
             h264_video->min_qp = ctrl->value;
@@ -420,12 +1080,72 @@ static esp_err_t h264_video_set_ext_ctrl(struct esp_video *video, const struct v
                 ESP_LOGE(TAG, "max QP value is out of range");
                 return ESP_ERR_INVALID_ARG;
             }
-            if (h264_started) {
-                ESP_LOGW(TAG, "max QP is not supported when encoder is started");
+            if (h264_started && h264_video->max_qp != ctrl->value) {
+                h264_video->reopen = true;
             }
 
             h264_video->max_qp = ctrl->value;
             break;
+        case V4L2_CID_MPEG_VIDEO_BITRATE_MODE:
+            if (ctrl->value != V4L2_MPEG_VIDEO_BITRATE_MODE_CBR && ctrl->value != V4L2_MPEG_VIDEO_BITRATE_MODE_CQ) {
+                ESP_LOGE(TAG, "bitrate mode is not supported");
+                return ESP_ERR_INVALID_ARG;
+            }
+            if (h264_started && h264_video->rc_mode != ctrl->value) {
+                h264_video->reopen = true;
+            }
+
+            h264_video->rc_mode = ctrl->value;
+            break;
+        case V4L2_CID_MPEG_VIDEO_CONSTANT_QUALITY:
+            if (ctrl->value < H264_VIDEO_MIN_QUALITY || ctrl->value > H264_VIDEO_MAX_QUALITY) {
+                ESP_LOGE(TAG, "constant quality value is out of range");
+                return ESP_ERR_INVALID_ARG;
+            }
+            if (h264_started && h264_video->rc_mode == V4L2_MPEG_VIDEO_BITRATE_MODE_CQ &&
+                    h264_video->quality != ctrl->value) {
+                h264_video->reopen = true;
+            }
+
+            h264_video->quality = ctrl->value;
+            break;
+        case V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME:
+            if (h264_started) {
+                h264_video->reopen = true;
+            }
+            break;
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+        case V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT:
+            if (h264_started) {
+                ESP_LOGE(TAG, "NAL unit output can't be changed when encoder is started");
+                return ESP_ERR_INVALID_STATE;
+            }
+
+            h264_video->nal_output = ctrl->value != 0;
+            break;
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+        case V4L2_CID_CODEC_ESP_H264_ROI: {
+            const esp_video_h264_roi_t *roi = (const esp_video_h264_roi_t *)ctrl->p_u8;
+
+            if (!h264_video->hw_codec) {
+                ESP_LOGE(TAG, "ROI is not supported by software encoder");
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            if (!roi || ctrl->size != sizeof(esp_video_h264_roi_t)) {
+                ESP_LOGE(TAG, "ROI size is invalid");
+                return ESP_ERR_INVALID_ARG;
+            }
+            ESP_RETURN_ON_ERROR(h264_check_roi(video, roi), TAG, "ROI is invalid");
+
+            h264_video->roi = *roi;
+            if (h264_started) {
+                /* Not encoding now, so the next frame uses new regions */
+                ESP_RETURN_ON_ERROR(h264_apply_roi(h264_video), TAG, "failed to apply ROI");
+            }
+            break;
+        }
+#endif
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
             ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
@@ -436,6 +1156,19 @@ static esp_err_t h264_video_set_ext_ctrl(struct esp_video *video, const struct v
     return ret;
 }
 
+static esp_err_t h264_video_set_ext_ctrl(struct esp_video *video, const struct v4l2_ext_controls *ctrls)
+{
+    esp_err_t ret;
+    struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
+
+    /* Changes are done between frames, so they take effect from the next encoded frame */
+    _lock_acquire(&h264_video->lock);
+    ret = h264_set_ext_ctrl(video, h264_video, ctrls);
+    _lock_release(&h264_video->lock);
+
+    return ret;
+}
+
 static esp_err_t h264_video_get_ext_ctrl(struct esp_video *video, struct v4l2_ext_controls *ctrls)
 {
     esp_err_t ret = ESP_OK;
@@ -457,6 +1190,40 @@ static esp_err_t h264_video_get_ext_ctrl(struct esp_video *video, struct v4l2_ex
         case V4L2_CID_MPEG_VIDEO_H264_MAX_QP:
             ctrl->value = h264_video->max_qp;
             break;
+        case V4L2_CID_MPEG_VIDEO_BITRATE_MODE:
+            ctrl->value = h264_video->rc_mode;
+            break;
+        case V4L2_CID_MPEG_VIDEO_CONSTANT_QUALITY:
+            ctrl->value = h264_video->quality;
+            break;
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+        case V4L2_CID_CODEC_ESP_H264_OVERFLOW_FRAMES:
+            ctrl->value = h264_video->overflow_frames;
+            break;
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+        case V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT:
+            ctrl->value = h264_video->nal_output;
+            break;
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+        case V4L2_CID_CODEC_ESP_H264_ROI:
+            if (!h264_video->hw_codec) {
+                ret = ESP_ERR_NOT_SUPPORTED;
+                ESP_LOGE(TAG, "ROI is not supported by software encoder");
+                break;
+            }
+            if (!ctrl->p_u8 || ctrl->size != sizeof(esp_video_h264_roi_t)) {
+                ret = ESP_ERR_INVALID_ARG;
+                ESP_LOGE(TAG, "ROI size is invalid");
+                break;
+            }
+
+            _lock_acquire(&h264_video->lock);
+            memcpy(ctrl->p_u8, &h264_video->roi, sizeof(esp_video_h264_roi_t));
+            _lock_release(&h264_video->lock);
+            break;
+#endif
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
             ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
@@ -474,13 +1241,29 @@ static esp_err_t h264_video_query_ext_ctrl(struct esp_video *video, struct v4l2_
 
 static esp_err_t h264_video_set_parm(struct esp_video *video, struct v4l2_streamparm *stream_parm, struct esp_video_stream *stream)
 {
+    esp_h264_err_t h264_err = ESP_H264_ERR_OK;
+    esp_h264_enc_param_handle_t param;
     struct h264_video *h264_video = VIDEO_PRIV_DATA(struct h264_video *, video);
     struct v4l2_fract *time_per_frame = &stream_parm->parm.capture.timeperframe;
+    uint8_t fps;
 
-    ESP_RETURN_ON_FALSE(h264_video->enc_handle == NULL, ESP_ERR_INVALID_STATE, TAG, "H.264 encoder is started, cannot set FPS");
     ESP_RETURN_ON_FALSE(time_per_frame->numerator > 0 && time_per_frame->denominator > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid time per frame");
+    fps = time_per_frame->denominator / time_per_frame->numerator;
+    ESP_RETURN_ON_FALSE(fps > 0, ESP_ERR_INVALID_ARG, TAG, "Invalid time per frame");
+
+    _lock_acquire(&h264_video->lock);
+    if (h264_video->enc_handle) {
+        h264_err = h264_get_param_handle(h264_video, &param);
+        if (h264_err == ESP_H264_ERR_OK) {
+            h264_err = esp_h264_enc_set_fps(param, fps);
+        }
+    }
+    if (h264_err == ESP_H264_ERR_OK) {
+        h264_video->fps = fps;
+    }
+    _lock_release(&h264_video->lock);
+    ESP_RETURN_ON_FALSE(h264_err == ESP_H264_ERR_OK, errno_h264_to_std(h264_err), TAG, "failed to set H.264 encoder FPS");
 
-    h264_video->fps = time_per_frame->denominator / time_per_frame->numerator;
     return ESP_OK;
 }
 
@@ -513,7 +1296,7 @@ static const struct esp_video_ops s_h264_video_ops = {
 /**
  * @brief Create H.264 video device
  *
- * @param hw_codec true: hardware H.264, false: software H.264(has not supported)
+ * @param hw_codec true: hardware H.264, false: software H.264
  *
  * @return
  *      - ESP_OK on success
@@ -523,27 +1306,29 @@ esp_err_t esp_video_create_h264_video_device(bool hw_codec)
 {
     struct esp_video *video;
     struct h264_video *h264_video;
+    uint8_t input_bpp;
     uint32_t device_caps = V4L2_CAP_VIDEO_M2M | V4L2_CAP_EXT_PIX_FORMAT | V4L2_CAP_STREAMING | V4L2_CAP_TIMEPERFRAME;
     uint32_t caps = device_caps | V4L2_CAP_DEVICE_CAPS;
 
-    if (hw_codec == false) {
-        return ESP_ERR_NOT_SUPPORTED;
-    }
-
     h264_video = heap_caps_calloc(1, sizeof(struct h264_video), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
     if (!h264_video) {
         return ESP_ERR_NO_MEM;
     }
 
     h264_video->hw_codec = hw_codec;
+    h264_get_input_format_from_v4l2(hw_codec, V4L2_PIX_FMT_YUV420, &h264_video->input_format, &input_bpp);
     h264_video->gop = H264_VIDEO_DEVICE_GOP;
     h264_video->min_qp = H264_VIDEO_DEVICE_MIN_QP;
     h264_video->max_qp = H264_VIDEO_DEVICE_MAX_QP;
+    h264_video->rc_mode = V4L2_MPEG_VIDEO_BITRATE_MODE_CBR;
+    h264_video->quality = H264_VIDEO_DEVICE_QUALITY;
     h264_video->bitrate = H264_VIDEO_DEVICE_BITRATE;
     h264_video->fps = H264_VIDEO_DEVICE_FPS;
+    _lock_init(&h264_video->lock);
 
     video = esp_video_create(H264_NAME, ESP_VIDEO_H264_DEVICE_ID, &s_h264_video_ops, h264_video, caps, device_caps);
     if (!video) {
+        _lock_close(&h264_video->lock);
         heap_caps_free(h264_video);
         return ESP_FAIL;
     }
@@ -554,7 +1339,7 @@ esp_err_t esp_video_create_h264_video_device(bool hw_codec)
 /**
  * @brief Destroy H.264 video device
  *
- * @param hw_codec true: hardware H.264, false: software H.264(has not supported)
+ * @param hw_codec true: hardware H.264, false: software H.264
  *
  * @return
  *      - ESP_OK on success
@@ -566,10 +1351,6 @@ esp_err_t esp_video_destroy_h264_video_device(bool hw_codec)
     struct esp_video *video;
     struct h264_video *h264_video;
 
-    if (hw_codec == false) {
-        return ESP_ERR_NOT_SUPPORTED;
-    }
-
     video = esp_video_device_get_object(H264_NAME);
     if (!video) {
         return ESP_ERR_NOT_FOUND;
@@ -582,6 +1363,7 @@ esp_err_t esp_video_destroy_h264_video_device(bool hw_codec)
         return ret;
     }
 
+    _lock_close(&h264_video->lock);
     heap_caps_free(h264_video);
 
     return ESP_OK;
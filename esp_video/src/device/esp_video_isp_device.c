@@ -64,6 +64,27 @@
 
 #define ISP_LSC_GET_GRIDS(res)      (((res) - 1) / 2 / ISP_LL_LSC_GRID_HEIGHT + 2)
 
+/**
+ * Image processing modules which are configured by application controls.
+ */
+#define ISP_MODULE_BF               (1 << 0)
+#define ISP_MODULE_CCM              (1 << 1)
+#define ISP_MODULE_WBG              (1 << 2)
+#define ISP_MODULE_SHARPEN          (1 << 3)
+#define ISP_MODULE_GAMMA            (1 << 4)
+#define ISP_MODULE_DEMOSAIC         (1 << 5)
+#define ISP_MODULE_COLOR            (1 << 6)
+#define ISP_MODULE_LSC              (1 << 7)
+#define ISP_MODULE_BLC              (1 << 8)
+#define ISP_MODULE_NUMS             9
+
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+#define ISP_COMMIT_TASK_NAME        "isp_commit"
+#define ISP_COMMIT_TASK_STACK_SIZE  3072
+/* Higher than ISP pipeline controller task, so configuration is written as early as possible in the frame blanking */
+#define ISP_COMMIT_TASK_PRIORITY    12
+#endif
+
 #if ESP_VIDEO_ISP_DEVICE_ONCE_CONFIG
 #define ISP_CHECK_RETURN(ret)      (ret != ESP_OK)
 #else
@@ -141,6 +162,11 @@ struct isp_video {
 
     size_t lsc_gain_size;
     esp_isp_lsc_gain_array_t lsc_gain_array;
+
+    /* Copy of R, GR, GB and B gain tables written to ISP, the application may change its tables in place */
+
+    isp_lsc_gain_t *lsc_applied_gain;
+    size_t lsc_applied_size;
 #endif
 
 #if ESP_VIDEO_ISP_DEVICE_BLC
@@ -213,6 +239,22 @@ struct isp_video {
     /* ISP bypass mode */
     uint8_t isp_raw_bypass           : 1;
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+    /* Power line frequency mode set by application, and flicker frequency detected by ISP pipeline controller */
+
+    int32_t power_line_frequency;
+    int32_t flicker_frequency;
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+    /* Modules whose configuration is changed but not written to ISP hardware yet, ISP_MODULE_* */
+
+    TaskHandle_t commit_task;
+    uint32_t shadow_dirty;
+    uint32_t shadow_enable;
+    uint64_t commit_seq;
+#endif
+
     /* Statistics data */
 
     uint64_t seq;
@@ -433,8 +475,55 @@ static const struct v4l2_query_ext_ctrl s_isp_qctrl[] = {
         .default_value = 0,
         .name = "HIST",
     },
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+    {
+        .id = V4L2_CID_USER_ESP_ISP_COMMIT_SEQ,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .maximum = INT32_MAX,
+        .minimum = 0,
+        .step = 1,
+        .elems = sizeof(int32_t),
+        .nr_of_dims = 1,
+        .default_value = 0,
+        .flags = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .name = "commit sequence",
+    },
+#endif
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+    {
+        .id = V4L2_CID_POWER_LINE_FREQUENCY,
+        .type = V4L2_CTRL_TYPE_MENU,
+        .maximum = V4L2_CID_POWER_LINE_FREQUENCY_AUTO,
+        .minimum = V4L2_CID_POWER_LINE_FREQUENCY_DISABLED,
+        .step = 1,
+        .elems = sizeof(int32_t),
+        .nr_of_dims = 1,
+        .default_value = V4L2_CID_POWER_LINE_FREQUENCY_AUTO,
+        .name = "power line frequency",
+    },
+    {
+        .id = V4L2_CID_USER_ESP_ISP_FLICKER,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .maximum = 60,
+        .minimum = 0,
+        .step = 1,
+        .elems = sizeof(int32_t),
+        .nr_of_dims = 1,
+        .default_value = 0,
+        .flags = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .name = "flicker frequency",
+    },
+#endif
 };
 static const int s_isp_qctrl_nums = ARRAY_SIZE(s_isp_qctrl);
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+static const char *s_isp_power_line_frequency_menu[] = {
+    [V4L2_CID_POWER_LINE_FREQUENCY_DISABLED] = "Disabled",
+    [V4L2_CID_POWER_LINE_FREQUENCY_50HZ] = "50 Hz",
+    [V4L2_CID_POWER_LINE_FREQUENCY_60HZ] = "60 Hz",
+    [V4L2_CID_POWER_LINE_FREQUENCY_AUTO] = "Auto",
+};
+#endif
 static const char *TAG = "isp_video";
 
 static struct isp_video s_isp_video;
@@ -457,6 +546,9 @@ static esp_err_t isp_stats_done(struct isp_video *isp_video, const void *buffer,
 {
     esp_err_t ret = ESP_OK;
     uint32_t target_flags = ISP_STATS_FLAGS;
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+    BaseType_t wakeup = pdFALSE;
+#endif
 
     if (!isp_video->capture_meta) {
         return false;
@@ -535,10 +627,24 @@ static esp_err_t isp_stats_done(struct isp_video *isp_video, const void *buffer,
         isp_video->stats_buffer->seq = isp_video->seq++;
         META_VIDEO_DONE_BUF(isp_video->video, isp_video->stats_buffer, sizeof(esp_video_isp_stats_t));
         isp_video->stats_buffer = NULL;
+
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+        /* Statistics of the whole frame are done, this is the frame boundary to commit configuration */
+        if (isp_video->shadow_dirty) {
+            vTaskNotifyGiveFromISR(isp_video->commit_task, &wakeup);
+        }
+#endif
     }
 
 exit:
     portEXIT_CRITICAL(&isp_video->spinlock);
+
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+    if (wakeup == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+#endif
+
     return ret;
 }
 
@@ -1253,6 +1359,27 @@ static esp_err_t isp_stop_wbg(struct isp_video *isp_video)
 #endif
 
 #if ESP_VIDEO_ISP_DEVICE_LSC
+/* Keep a copy of gain tables written to ISP, nothing is kept if out of memory, then tables are always written */
+static void isp_save_lsc(struct isp_video *isp_video)
+{
+    size_t size = isp_video->lsc_gain_size;
+    const esp_isp_lsc_gain_array_t *array = &isp_video->lsc_gain_array;
+
+    if (isp_video->lsc_applied_size != size) {
+        heap_caps_free(isp_video->lsc_applied_gain);
+        isp_video->lsc_applied_gain = heap_caps_malloc(size * 4 * sizeof(isp_lsc_gain_t), ISP_MEM_CAPS);
+        isp_video->lsc_applied_size = isp_video->lsc_applied_gain ? size : 0;
+        if (!isp_video->lsc_applied_gain) {
+            return;
+        }
+    }
+
+    memcpy(&isp_video->lsc_applied_gain[size * 0], array->gain_r, size * sizeof(isp_lsc_gain_t));
+    memcpy(&isp_video->lsc_applied_gain[size * 1], array->gain_gr, size * sizeof(isp_lsc_gain_t));
+    memcpy(&isp_video->lsc_applied_gain[size * 2], array->gain_gb, size * sizeof(isp_lsc_gain_t));
+    memcpy(&isp_video->lsc_applied_gain[size * 3], array->gain_b, size * sizeof(isp_lsc_gain_t));
+}
+
 static esp_err_t isp_start_lsc(struct isp_video *isp_video)
 {
     uint32_t h = ISP_LSC_GET_GRIDS(META_VIDEO_GET_FORMAT_HEIGHT(isp_video->video));
@@ -1268,6 +1395,7 @@ static esp_err_t isp_start_lsc(struct isp_video *isp_video)
     ESP_RETURN_ON_FALSE(isp_video->lsc_gain_size = (w * h), ESP_ERR_INVALID_ARG, TAG, "LSC configuration is invalid");
 
     ESP_RETURN_ON_ERROR(esp_isp_lsc_configure(isp_video->isp_proc, &lsc_config), TAG, "failed to configure LSC");
+    isp_save_lsc(isp_video);
     ESP_RETURN_ON_ERROR(esp_isp_lsc_enable(isp_video->isp_proc), TAG, "failed to enable LSC");
     isp_video->lsc_started = true;
 
@@ -1285,6 +1413,7 @@ static esp_err_t isp_reconfigure_lsc(struct isp_video *isp_video)
     ESP_RETURN_ON_FALSE(isp_video->lsc_gain_size = (w * h), ESP_ERR_INVALID_ARG, TAG, "LSC configuration is invalid");
 
     ESP_RETURN_ON_ERROR(esp_isp_lsc_configure(isp_video->isp_proc, &lsc_config), TAG, "failed to configure LSC");
+    isp_save_lsc(isp_video);
     if (!isp_video->lsc_started) {
         ESP_RETURN_ON_ERROR(esp_isp_lsc_enable(isp_video->isp_proc), TAG, "failed to enable LSC");
         isp_video->lsc_started = true;
@@ -1627,6 +1756,180 @@ static esp_err_t isp_stop_pipeline(struct isp_video *isp_video)
     return ESP_OK;
 }
 
+static esp_err_t isp_commit_module(struct isp_video *isp_video, uint32_t module, bool enable)
+{
+    switch (module) {
+    case ISP_MODULE_BF:
+        ESP_RETURN_ON_ERROR(isp_stop_bf(isp_video), TAG, "failed to stop BF");
+        if (enable) {
+            ESP_RETURN_ON_ERROR(isp_start_bf(isp_video), TAG, "failed to start BF");
+        }
+        break;
+    case ISP_MODULE_CCM:
+        if (enable) {
+            ESP_RETURN_ON_ERROR(isp_reconfigure_ccm(isp_video), TAG, "failed to reconfigure CCM");
+        } else {
+            ESP_RETURN_ON_ERROR(isp_stop_ccm(isp_video), TAG, "failed to stop CCM");
+        }
+        break;
+    case ISP_MODULE_WBG:
+#if ESP_VIDEO_ISP_DEVICE_WBG
+        if (enable) {
+            ESP_RETURN_ON_ERROR(isp_reconfigure_wbg(isp_video), TAG, "failed to reconfigure WBG");
+        } else {
+            ESP_RETURN_ON_ERROR(isp_stop_wbg(isp_video), TAG, "failed to stop WBG");
+        }
+#else
+        ESP_RETURN_ON_ERROR(isp_reconfigure_white_balance(isp_video), TAG, "failed to reconfigure white balance");
+#endif
+        break;
+    case ISP_MODULE_SHARPEN:
+        if (enable) {
+            ESP_RETURN_ON_ERROR(isp_reconfigure_sharpen(isp_video), TAG, "failed to reconfigure sharpen");
+        } else {
+            ESP_RETURN_ON_ERROR(isp_stop_sharpen(isp_video), TAG, "failed to stop sharpen");
+        }
+        break;
+    case ISP_MODULE_GAMMA:
+        if (enable) {
+            ESP_RETURN_ON_ERROR(isp_reconfigure_gamma(isp_video), TAG, "failed to reconfigure GAMMA");
+        } else {
+            ESP_RETURN_ON_ERROR(isp_stop_gamma(isp_video), TAG, "failed to stop GAMMA");
+        }
+        break;
+    case ISP_MODULE_DEMOSAIC:
+        if (enable) {
+            ESP_RETURN_ON_ERROR(isp_reconfigure_demosaic(isp_video), TAG, "failed to reconfigure demosaic");
+        } else {
+            ESP_RETURN_ON_ERROR(isp_stop_demosaic(isp_video), TAG, "failed to stop demosaic");
+        }
+        break;
+    case ISP_MODULE_COLOR:
+        ESP_RETURN_ON_ERROR(isp_reconfigure_color(isp_video), TAG, "failed to reconfigure color");
+        break;
+#if ESP_VIDEO_ISP_DEVICE_LSC
+    case ISP_MODULE_LSC:
+        if (enable) {
+            ESP_RETURN_ON_ERROR(isp_reconfigure_lsc(isp_video), TAG, "failed to reconfigure LSC");
+        } else {
+            ESP_RETURN_ON_ERROR(isp_stop_lsc(isp_video), TAG, "failed to stop LSC");
+        }
+        break;
+#endif
+#if ESP_VIDEO_ISP_DEVICE_BLC
+    case ISP_MODULE_BLC:
+        if (enable) {
+            ESP_RETURN_ON_ERROR(isp_reconfigure_blc(isp_video), TAG, "failed to reconfigure BLC");
+        } else {
+            ESP_RETURN_ON_ERROR(isp_stop_blc(isp_video), TAG, "failed to stop BLC");
+        }
+        break;
+#endif
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    return ESP_OK;
+}
+
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+static void isp_commit_done(struct isp_video *isp_video)
+{
+    uint64_t seq;
+
+    portENTER_CRITICAL(&isp_video->spinlock);
+    seq = isp_video->seq;
+    portEXIT_CRITICAL(&isp_video->spinlock);
+
+    /**
+     * Frame "seq" may have started before the configuration was written, so the next one
+     * is the first frame processed completely with the new configuration.
+     */
+    isp_video->commit_seq = seq + 1;
+}
+
+/* Write all pending shadow configuration to ISP hardware, ISP_LOCK must be held */
+static void isp_commit_shadow(struct isp_video *isp_video)
+{
+    uint32_t dirty;
+
+    if (!ISP_STARTED(isp_video)) {
+        return;
+    }
+
+    portENTER_CRITICAL(&isp_video->spinlock);
+    dirty = isp_video->shadow_dirty;
+    isp_video->shadow_dirty = 0;
+    portEXIT_CRITICAL(&isp_video->spinlock);
+    if (!dirty) {
+        return;
+    }
+
+    for (int i = 0; i < ISP_MODULE_NUMS; i++) {
+        uint32_t module = 1 << i;
+
+        if ((dirty & module) &&
+                (isp_commit_module(isp_video, module, isp_video->shadow_enable & module) != ESP_OK)) {
+            ESP_LOGE(TAG, "failed to commit module=%" PRIx32, module);
+        }
+    }
+
+    isp_commit_done(isp_video);
+}
+
+static void isp_commit_task(void *arg)
+{
+    struct isp_video *isp_video = (struct isp_video *)arg;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        ISP_LOCK(isp_video);
+        isp_commit_shadow(isp_video);
+        ISP_UNLOCK(isp_video);
+    }
+
+    vTaskDelete(NULL);
+}
+#endif
+
+/**
+ * Write configuration of the module to ISP hardware, or keep it in the shadow configuration
+ * until the next frame boundary when ISP statistics are streaming.
+ */
+static esp_err_t isp_update_module(struct isp_video *isp_video, uint32_t module, bool enable)
+{
+    if (!ISP_STARTED(isp_video)) {
+        return ESP_OK;
+    }
+
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+    /* Frame boundary comes from the statistics interrupt, there is none without capturing statistics */
+    if (isp_video->capture_meta) {
+        portENTER_CRITICAL(&isp_video->spinlock);
+        isp_video->shadow_dirty |= module;
+        if (enable) {
+            isp_video->shadow_enable |= module;
+        } else {
+            isp_video->shadow_enable &= ~module;
+        }
+        portEXIT_CRITICAL(&isp_video->spinlock);
+
+        return ESP_OK;
+    }
+
+    portENTER_CRITICAL(&isp_video->spinlock);
+    isp_video->shadow_dirty &= ~module;
+    portEXIT_CRITICAL(&isp_video->spinlock);
+    ESP_RETURN_ON_ERROR(isp_commit_module(isp_video, module, enable), TAG, "failed to commit module");
+    isp_commit_done(isp_video);
+
+    return ESP_OK;
+#else
+    return isp_commit_module(isp_video, module, enable);
+#endif
+}
+
 static esp_err_t isp_video_init(struct esp_video *video)
 {
     uint32_t buf_size = sizeof(esp_video_isp_stats_t);
@@ -1665,6 +1968,10 @@ static esp_err_t isp_video_stop(struct esp_video *video, uint32_t type)
 
     if (type == V4L2_BUF_TYPE_META_CAPTURE) {
         isp_video->capture_meta = false;
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+        /* No more frame boundary comes from statistics interrupt, so write pending configuration now */
+        isp_commit_shadow(isp_video);
+#endif
     }
 
     ISP_UNLOCK(isp_video);
@@ -1708,392 +2015,536 @@ static esp_err_t isp_video_notify(struct esp_video *video, enum esp_video_event
     return ESP_OK;
 }
 
-static esp_err_t isp_video_set_ext_ctrl(struct esp_video *video, const struct v4l2_ext_controls *ctrls)
+/**
+ * @brief Check if the control value is the same as the one which has been applied to ISP,
+ *        then reconfiguring the ISP module can be skipped, especially for GAMMA and LSC
+ *        whose tables take a long time to write.
+ *
+ * @param isp_video ISP video device pointer
+ * @param ctrl      V4L2 extended control pointer
+ *
+ * @return true if the control has been applied, false if not
+ */
+static bool isp_ctrl_is_applied(struct isp_video *isp_video, const struct v4l2_ext_control *ctrl)
 {
-    esp_err_t ret = ESP_OK;
-    struct isp_video *isp_video = VIDEO_PRIV_DATA(struct isp_video *, video);
+    if (!ISP_STARTED(isp_video)) {
+        return false;
+    }
 
-    ISP_LOCK(isp_video);
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+    uint32_t dirty;
 
-    for (int i = 0; i < ctrls->count; i++) {
-        struct v4l2_ext_control *ctrl = &ctrls->controls[i];
+    /* Hardware state doesn't show the target configuration until pending configuration is committed */
+    portENTER_CRITICAL(&isp_video->spinlock);
+    dirty = isp_video->shadow_dirty;
+    portEXIT_CRITICAL(&isp_video->spinlock);
+    if (dirty) {
+        return false;
+    }
+#endif
 
-        switch (ctrl->id) {
-        case V4L2_CID_USER_ESP_ISP_BF: {
-            const esp_video_isp_bf_t *bf = (const esp_video_isp_bf_t *)ctrl->p_u8;
-
-            isp_video->bf_enable = bf->enable;
-            if (bf->enable) {
-                isp_video->denoising_level = bf->level;
-                for (int i = 0; i < ISP_BF_TEMPLATE_X_NUMS; i++) {
-                    for (int j = 0; j < ISP_BF_TEMPLATE_Y_NUMS; j++) {
-                        isp_video->bf_matrix[i][j] = bf->matrix[i][j];
-                    }
-                }
+    switch (ctrl->id) {
+    case V4L2_CID_USER_ESP_ISP_BF: {
+        const esp_video_isp_bf_t *bf = (const esp_video_isp_bf_t *)ctrl->p_u8;
 
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_bf(isp_video), exit, TAG, "failed to stop BF");
-                    ESP_GOTO_ON_ERROR(isp_start_bf(isp_video), exit, TAG, "failed to start BF");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_bf(isp_video), exit, TAG, "failed to stop BF");
-                }
-            }
-            break;
+        if (!bf->enable) {
+            return !isp_video->bf_started;
         }
-        case V4L2_CID_USER_ESP_ISP_CCM: {
-            const esp_video_isp_ccm_t *ccm = (const esp_video_isp_ccm_t *)ctrl->p_u8;
-
-            isp_video->ccm_enable = ccm->enable;
-            if (ccm->enable) {
-                for (int i = 0; i < ISP_CCM_DIMENSION; i++) {
-                    for (int j = 0; j < ISP_CCM_DIMENSION; j++) {
-                        isp_video->ccm_matrix[i][j] = ccm->matrix[i][j];
-                    }
-                }
 
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_ccm(isp_video), exit, TAG, "failed to reconfigure CCM");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_ccm(isp_video), exit, TAG, "failed to stop CCM");
-                }
-            }
-            break;
+        return isp_video->bf_started &&
+               (isp_video->denoising_level == bf->level) &&
+               !memcmp(isp_video->bf_matrix, bf->matrix, sizeof(isp_video->bf_matrix));
+    }
+    case V4L2_CID_USER_ESP_ISP_CCM: {
+        const esp_video_isp_ccm_t *ccm = (const esp_video_isp_ccm_t *)ctrl->p_u8;
+
+        return ccm->enable && isp_video->ccm_enable && isp_video->ccm_started &&
+               !memcmp(isp_video->ccm_matrix, ccm->matrix, sizeof(isp_video->ccm_matrix));
+    }
+    case V4L2_CID_USER_ESP_ISP_SHARPEN: {
+        const esp_video_isp_sharpen_t *sharpen = (const esp_video_isp_sharpen_t *)ctrl->p_u8;
+
+        if (!sharpen->enable) {
+            return !isp_video->sharpen_started;
         }
-        case V4L2_CID_RED_BALANCE:
-#if ESP_VIDEO_ISP_DEVICE_WBG
-            isp_video->red_balance_gain = (float)ctrl->value / V4L2_CID_RED_BALANCE_DEN;
-            if (ctrl->value > 0) {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_wbg(isp_video), exit, TAG, "failed to reconfigure WBG");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    isp_video->red_balance_gain = 1.0f;
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_wbg(isp_video), exit, TAG, "failed to reconfigure WBG");
-                }
-            }
-#else
-            if (ctrl->value > 0) {
-                isp_video->red_balance_gain = (float)ctrl->value / V4L2_CID_RED_BALANCE_DEN;
-                isp_video->red_balance_enable = true;
-            } else {
-                isp_video->red_balance_enable = false;
-            }
 
-            if (ISP_STARTED(isp_video)) {
-                ESP_GOTO_ON_ERROR(isp_reconfigure_ccm(isp_video), exit, TAG, "failed to reconfigure CCM");
-            }
-#endif
-            break;
-        case V4L2_CID_BLUE_BALANCE:
+        return isp_video->sharpen_started &&
+               (isp_video->h_thresh == sharpen->h_thresh) &&
+               (isp_video->l_thresh == sharpen->l_thresh) &&
+               (isp_video->h_coeff == sharpen->h_coeff) &&
+               (isp_video->m_coeff == sharpen->m_coeff) &&
+               !memcmp(isp_video->sharpen_matrix, sharpen->matrix, sizeof(isp_video->sharpen_matrix));
+    }
+    case V4L2_CID_USER_ESP_ISP_GAMMA_EXT: {
+        const esp_video_isp_gamma_ext_t *gamma_ext = (const esp_video_isp_gamma_ext_t *)ctrl->p_u8;
+        const size_t size = sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM;
+
+        if (!gamma_ext->enable) {
+            return !isp_video->gamma_started;
+        }
+
+        if (!isp_video->gamma_started ||
+                ((gamma_ext->flags & isp_video->gamma.flags) != gamma_ext->flags)) {
+            return false;
+        }
+
+        if ((gamma_ext->flags & ESP_VIDEO_ISP_GAMMA_EXT_FLAG_RED) &&
+                memcmp(isp_video->gamma.red_points, gamma_ext->red_points, size)) {
+            return false;
+        }
+        if ((gamma_ext->flags & ESP_VIDEO_ISP_GAMMA_EXT_FLAG_GREEN) &&
+                memcmp(isp_video->gamma.green_points, gamma_ext->green_points, size)) {
+            return false;
+        }
+        if ((gamma_ext->flags & ESP_VIDEO_ISP_GAMMA_EXT_FLAG_BLUE) &&
+                memcmp(isp_video->gamma.blue_points, gamma_ext->blue_points, size)) {
+            return false;
+        }
+
+        return true;
+    }
+    case V4L2_CID_USER_ESP_ISP_DEMOSAIC: {
+        const esp_video_isp_demosaic_t *demosaic = (const esp_video_isp_demosaic_t *)ctrl->p_u8;
+
+        if (!demosaic->enable) {
+            return !isp_video->demosaic_started;
+        }
+
+        return isp_video->demosaic_started && (isp_video->gradient_ratio == demosaic->gradient_ratio);
+    }
+    case V4L2_CID_USER_ESP_ISP_WB: {
+        const esp_video_isp_wb_t *wb = (const esp_video_isp_wb_t *)ctrl->p_u8;
+
 #if ESP_VIDEO_ISP_DEVICE_WBG
-            isp_video->blue_balance_gain = (float)ctrl->value / V4L2_CID_BLUE_BALANCE_DEN;
-            if (ctrl->value > 0) {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_wbg(isp_video), exit, TAG, "failed to reconfigure WBG");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    isp_video->blue_balance_gain = 1.0f;
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_wbg(isp_video), exit, TAG, "failed to reconfigure WBG");
-                }
-            }
+        if (!isp_video->wbg_started) {
+            return false;
+        }
 #else
-            if (ctrl->value > 0) {
-                isp_video->blue_balance_gain = (float )ctrl->value / V4L2_CID_BLUE_BALANCE_DEN;
-                isp_video->blue_balance_enable = true;
-            } else {
-                isp_video->blue_balance_enable = false;
-            }
+        if (!isp_video->ccm_started) {
+            return false;
+        }
+#endif
 
-            if (ISP_STARTED(isp_video)) {
-                ESP_GOTO_ON_ERROR(isp_reconfigure_ccm(isp_video), exit, TAG, "failed to reconfigure CCM");
-            }
+        return wb->enable && isp_video->red_balance_enable && isp_video->blue_balance_enable &&
+               (isp_video->red_balance_gain == wb->red_gain) &&
+               (isp_video->blue_balance_gain == wb->blue_gain);
+    }
+    case V4L2_CID_BRIGHTNESS:
+        return isp_video->color_config.color_brightness == ctrl->value;
+    case V4L2_CID_CONTRAST:
+        return isp_video->color_config.color_contrast.val == ctrl->value;
+    case V4L2_CID_SATURATION:
+        return isp_video->color_config.color_saturation.val == ctrl->value;
+    case V4L2_CID_HUE:
+        return isp_video->color_config.color_hue == ctrl->value;
+    case V4L2_CID_USER_ESP_ISP_AWB: {
+        const esp_video_isp_awb_t *awb = (const esp_video_isp_awb_t *)ctrl->p_u8;
+
+        if (!awb->enable) {
+            return !isp_video->awb_started;
+        }
+
+        if (!isp_video->awb_started ||
+                (isp_video->awb.green_max != awb->green_max) ||
+                (isp_video->awb.green_min != awb->green_min) ||
+                (isp_video->awb.rg_max != awb->rg_max) ||
+                (isp_video->awb.rg_min != awb->rg_min) ||
+                (isp_video->awb.bg_max != awb->bg_max) ||
+                (isp_video->awb.bg_min != awb->bg_min)) {
+            return false;
+        }
+
+        /**
+         * If the right and bottom of the window is 0, the window keeps unchanged.
+         */
+        if (awb->windows->btm_right.x == 0 && awb->windows->btm_right.y == 0) {
+            return true;
+        }
+
+        return !memcmp(isp_video->awb.windows, awb->windows, sizeof(isp_video->awb.windows));
+    }
+#if ESP_VIDEO_ISP_DEVICE_LSC
+    case V4L2_CID_USER_ESP_ISP_LSC: {
+        const esp_video_isp_lsc_t *lsc = (const esp_video_isp_lsc_t *)ctrl->p_u8;
+
+        if (!lsc->enable) {
+            return !isp_video->lsc_started;
+        }
+
+        const size_t size = isp_video->lsc_applied_size;
+        const isp_lsc_gain_t *gain = isp_video->lsc_applied_gain;
+
+        if (!isp_video->lsc_started || !size || (size != lsc->lsc_gain_size) ||
+                !lsc->gain_r || !lsc->gain_gr || !lsc->gain_gb || !lsc->gain_b) {
+            return false;
+        }
+
+        return !memcmp(&gain[size * 0], lsc->gain_r, size * sizeof(isp_lsc_gain_t)) &&
+               !memcmp(&gain[size * 1], lsc->gain_gr, size * sizeof(isp_lsc_gain_t)) &&
+               !memcmp(&gain[size * 2], lsc->gain_gb, size * sizeof(isp_lsc_gain_t)) &&
+               !memcmp(&gain[size * 3], lsc->gain_b, size * sizeof(isp_lsc_gain_t));
+    }
 #endif
-            break;
-        case V4L2_CID_USER_ESP_ISP_SHARPEN: {
-            const esp_video_isp_sharpen_t *sharpen = (const esp_video_isp_sharpen_t *)ctrl->p_u8;
-
-            isp_video->sharpen_enable = sharpen->enable;
-            if (sharpen->enable) {
-                isp_video->h_thresh = sharpen->h_thresh;
-                isp_video->l_thresh = sharpen->l_thresh;
-                isp_video->h_coeff = sharpen->h_coeff;
-                isp_video->m_coeff = sharpen->m_coeff;
-                for (int i = 0; i < ISP_SHARPEN_TEMPLATE_X_NUMS; i++) {
-                    for (int j = 0; j < ISP_SHARPEN_TEMPLATE_Y_NUMS; j++) {
-                        isp_video->sharpen_matrix[i][j] = sharpen->matrix[i][j];
-                    }
-                }
+#if ESP_VIDEO_ISP_DEVICE_BLC
+    case V4L2_CID_USER_ESP_ISP_BLC: {
+        const esp_video_isp_blc_t *blc = (const esp_video_isp_blc_t *)ctrl->p_u8;
 
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_sharpen(isp_video), exit, TAG, "failed to reconfigure sharpen");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_sharpen(isp_video), exit, TAG, "failed to stop sharpen");
-                }
-            }
-            break;
+        if (!blc->enable) {
+            return !isp_video->blc_started;
         }
-        case V4L2_CID_USER_ESP_ISP_GAMMA: {
-            const esp_video_isp_gamma_t *gamma = (const esp_video_isp_gamma_t *)ctrl->p_u8;
-
-            memcpy(&isp_video->gamma.red_points, gamma->points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
-            memcpy(&isp_video->gamma.green_points, gamma->points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
-            memcpy(&isp_video->gamma.blue_points, gamma->points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
-            isp_video->gamma.flags = ESP_VIDEO_ISP_GAMMA_EXT_FLAG_RED | ESP_VIDEO_ISP_GAMMA_EXT_FLAG_GREEN | ESP_VIDEO_ISP_GAMMA_EXT_FLAG_BLUE;
-            isp_video->gamma.enable = gamma->enable;
-            if (isp_video->gamma.enable) {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_gamma(isp_video), exit, TAG, "failed to reconfigure GAMMA");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_gamma(isp_video), exit, TAG, "failed to stop GAMMA");
-                }
-            }
-            break;
+
+        return isp_video->blc_started &&
+               (isp_video->blc_config.stretch_enable == blc->stretch_enable) &&
+               (isp_video->blc_config.top_left_offset == blc->top_left_offset) &&
+               (isp_video->blc_config.top_right_offset == blc->top_right_offset) &&
+               (isp_video->blc_config.bottom_left_offset == blc->bottom_left_offset) &&
+               (isp_video->blc_config.bottom_right_offset == blc->bottom_right_offset);
+    }
+#endif
+    case V4L2_CID_USER_ESP_ISP_AF: {
+        const esp_video_isp_af_t *af = (const esp_video_isp_af_t *)ctrl->p_u8;
+
+        if (!af->enable) {
+            return !isp_video->af_started;
         }
-        case V4L2_CID_USER_ESP_ISP_GAMMA_EXT: {
-            const esp_video_isp_gamma_ext_t *gamma_ext = (const esp_video_isp_gamma_ext_t *)ctrl->p_u8;
 
-            if (gamma_ext->flags & ESP_VIDEO_ISP_GAMMA_EXT_FLAG_RED) {
-                memcpy(&isp_video->gamma.red_points, gamma_ext->red_points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
-                isp_video->gamma.flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_RED;
-            }
-            if (gamma_ext->flags & ESP_VIDEO_ISP_GAMMA_EXT_FLAG_GREEN) {
-                memcpy(&isp_video->gamma.green_points, gamma_ext->green_points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
-                isp_video->gamma.flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_GREEN;
-            }
-            if (gamma_ext->flags & ESP_VIDEO_ISP_GAMMA_EXT_FLAG_BLUE) {
-                memcpy(&isp_video->gamma.blue_points, gamma_ext->blue_points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
-                isp_video->gamma.flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_BLUE;
-            }
-            isp_video->gamma.enable = gamma_ext->enable;
-            if (gamma_ext->enable) {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_gamma(isp_video), exit, TAG, "failed to reconfigure GAMMA");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_gamma(isp_video), exit, TAG, "failed to stop GAMMA");
+        return isp_video->af_started &&
+               (isp_video->af_config.edge_thresh == af->edge_thresh) &&
+               !memcmp(isp_video->af_config.windows, af->windows, sizeof(isp_video->af_config.windows));
+    }
+    default:
+        return false;
+    }
+}
+
+/**
+ * Apply one control, caller must hold ISP_LOCK.
+ */
+static esp_err_t isp_video_set_ctrl(struct isp_video *isp_video, const struct v4l2_ext_control *ctrl)
+{
+    esp_err_t ret = ESP_OK;
+
+    switch (ctrl->id) {
+    case V4L2_CID_USER_ESP_ISP_BF: {
+        const esp_video_isp_bf_t *bf = (const esp_video_isp_bf_t *)ctrl->p_u8;
+
+        isp_video->bf_enable = bf->enable;
+        if (bf->enable) {
+            isp_video->denoising_level = bf->level;
+            for (int i = 0; i < ISP_BF_TEMPLATE_X_NUMS; i++) {
+                for (int j = 0; j < ISP_BF_TEMPLATE_Y_NUMS; j++) {
+                    isp_video->bf_matrix[i][j] = bf->matrix[i][j];
                 }
             }
-            break;
         }
-        case V4L2_CID_USER_ESP_ISP_DEMOSAIC: {
-            const esp_video_isp_demosaic_t *demosaic = (const esp_video_isp_demosaic_t *)ctrl->p_u8;
 
-            isp_video->demosaic_enable = demosaic->enable;
-            if (demosaic->enable) {
-                isp_video->gradient_ratio = demosaic->gradient_ratio;
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_BF, bf->enable), exit, TAG, "failed to update BF");
+        break;
+    }
+    case V4L2_CID_USER_ESP_ISP_CCM: {
+        const esp_video_isp_ccm_t *ccm = (const esp_video_isp_ccm_t *)ctrl->p_u8;
 
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_demosaic(isp_video), exit, TAG, "failed to reconfigure demosaic");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_demosaic(isp_video), exit, TAG, "failed to stop demosaic");
+        isp_video->ccm_enable = ccm->enable;
+        if (ccm->enable) {
+            for (int i = 0; i < ISP_CCM_DIMENSION; i++) {
+                for (int j = 0; j < ISP_CCM_DIMENSION; j++) {
+                    isp_video->ccm_matrix[i][j] = ccm->matrix[i][j];
                 }
             }
-            break;
         }
-        case V4L2_CID_USER_ESP_ISP_WB: {
-            esp_video_isp_wb_t *wb = (esp_video_isp_wb_t *)ctrl->p_u8;
-
-            isp_video->red_balance_enable = wb->enable;
-            isp_video->blue_balance_enable = wb->enable;
-            if (wb->enable) {
-                isp_video->red_balance_gain = wb->red_gain;
-                isp_video->blue_balance_gain = wb->blue_gain;
 
-                if (ISP_STARTED(isp_video)) {
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_CCM, ccm->enable), exit, TAG, "failed to update CCM");
+        break;
+    }
+    case V4L2_CID_RED_BALANCE:
 #if ESP_VIDEO_ISP_DEVICE_WBG
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_wbg(isp_video), exit, TAG, "failed to reconfigure WBG");
+        isp_video->red_balance_gain = (float)ctrl->value / V4L2_CID_RED_BALANCE_DEN;
+        if ((ctrl->value <= 0) && ISP_STARTED(isp_video)) {
+            isp_video->red_balance_gain = 1.0f;
+        }
+
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_WBG, true), exit, TAG, "failed to update WBG");
 #else
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_white_balance(isp_video), exit, TAG, "failed to reconfigure white balance");
+        if (ctrl->value > 0) {
+            isp_video->red_balance_gain = (float)ctrl->value / V4L2_CID_RED_BALANCE_DEN;
+            isp_video->red_balance_enable = true;
+        } else {
+            isp_video->red_balance_enable = false;
+        }
+
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_WBG, true), exit, TAG, "failed to update white balance");
 #endif
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    isp_video->red_balance_gain = 1.0f;
-                    isp_video->blue_balance_gain = 1.0f;
+        break;
+    case V4L2_CID_BLUE_BALANCE:
 #if ESP_VIDEO_ISP_DEVICE_WBG
-                    ESP_GOTO_ON_ERROR(isp_stop_wbg(isp_video), exit, TAG, "failed to stop WBG");
+        isp_video->blue_balance_gain = (float)ctrl->value / V4L2_CID_BLUE_BALANCE_DEN;
+        if ((ctrl->value <= 0) && ISP_STARTED(isp_video)) {
+            isp_video->blue_balance_gain = 1.0f;
+        }
+
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_WBG, true), exit, TAG, "failed to update WBG");
 #else
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_white_balance(isp_video), exit, TAG, "failed to reconfigure white balance");
+        if (ctrl->value > 0) {
+            isp_video->blue_balance_gain = (float )ctrl->value / V4L2_CID_BLUE_BALANCE_DEN;
+            isp_video->blue_balance_enable = true;
+        } else {
+            isp_video->blue_balance_enable = false;
+        }
+
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_WBG, true), exit, TAG, "failed to update white balance");
 #endif
+        break;
+    case V4L2_CID_USER_ESP_ISP_SHARPEN: {
+        const esp_video_isp_sharpen_t *sharpen = (const esp_video_isp_sharpen_t *)ctrl->p_u8;
+
+        isp_video->sharpen_enable = sharpen->enable;
+        if (sharpen->enable) {
+            isp_video->h_thresh = sharpen->h_thresh;
+            isp_video->l_thresh = sharpen->l_thresh;
+            isp_video->h_coeff = sharpen->h_coeff;
+            isp_video->m_coeff = sharpen->m_coeff;
+            for (int i = 0; i < ISP_SHARPEN_TEMPLATE_X_NUMS; i++) {
+                for (int j = 0; j < ISP_SHARPEN_TEMPLATE_Y_NUMS; j++) {
+                    isp_video->sharpen_matrix[i][j] = sharpen->matrix[i][j];
                 }
             }
-            break;
         }
-        case V4L2_CID_BRIGHTNESS: {
-            isp_video->color_config.color_brightness = ctrl->value;
-            if (ISP_STARTED(isp_video)) {
-                ESP_GOTO_ON_ERROR(isp_reconfigure_color(isp_video), exit, TAG, "failed to reconfigure color");
-            }
-            break;
+
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_SHARPEN, sharpen->enable), exit, TAG, "failed to update sharpen");
+        break;
+    }
+    case V4L2_CID_USER_ESP_ISP_GAMMA: {
+        const esp_video_isp_gamma_t *gamma = (const esp_video_isp_gamma_t *)ctrl->p_u8;
+
+        memcpy(&isp_video->gamma.red_points, gamma->points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
+        memcpy(&isp_video->gamma.green_points, gamma->points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
+        memcpy(&isp_video->gamma.blue_points, gamma->points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
+        isp_video->gamma.flags = ESP_VIDEO_ISP_GAMMA_EXT_FLAG_RED | ESP_VIDEO_ISP_GAMMA_EXT_FLAG_GREEN | ESP_VIDEO_ISP_GAMMA_EXT_FLAG_BLUE;
+        isp_video->gamma.enable = gamma->enable;
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_GAMMA, gamma->enable), exit, TAG, "failed to update GAMMA");
+        break;
+    }
+    case V4L2_CID_USER_ESP_ISP_GAMMA_EXT: {
+        const esp_video_isp_gamma_ext_t *gamma_ext = (const esp_video_isp_gamma_ext_t *)ctrl->p_u8;
+
+        if (gamma_ext->flags & ESP_VIDEO_ISP_GAMMA_EXT_FLAG_RED) {
+            memcpy(&isp_video->gamma.red_points, gamma_ext->red_points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
+            isp_video->gamma.flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_RED;
         }
-        case V4L2_CID_CONTRAST: {
-            isp_video->color_config.color_contrast.val = ctrl->value;
-            if (ISP_STARTED(isp_video)) {
-                ESP_GOTO_ON_ERROR(isp_reconfigure_color(isp_video), exit, TAG, "failed to reconfigure color");
-            }
-            break;
+        if (gamma_ext->flags & ESP_VIDEO_ISP_GAMMA_EXT_FLAG_GREEN) {
+            memcpy(&isp_video->gamma.green_points, gamma_ext->green_points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
+            isp_video->gamma.flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_GREEN;
         }
-        case V4L2_CID_SATURATION: {
-            isp_video->color_config.color_saturation.val = ctrl->value;
-            if (ISP_STARTED(isp_video)) {
-                ESP_GOTO_ON_ERROR(isp_reconfigure_color(isp_video), exit, TAG, "failed to reconfigure color");
-            }
+        if (gamma_ext->flags & ESP_VIDEO_ISP_GAMMA_EXT_FLAG_BLUE) {
+            memcpy(&isp_video->gamma.blue_points, gamma_ext->blue_points, sizeof(esp_video_isp_gamma_point_t) * ISP_GAMMA_CURVE_POINTS_NUM);
+            isp_video->gamma.flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_BLUE;
+        }
+        isp_video->gamma.enable = gamma_ext->enable;
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_GAMMA, gamma_ext->enable), exit, TAG, "failed to update GAMMA");
+        break;
+    }
+    case V4L2_CID_USER_ESP_ISP_DEMOSAIC: {
+        const esp_video_isp_demosaic_t *demosaic = (const esp_video_isp_demosaic_t *)ctrl->p_u8;
+
+        isp_video->demosaic_enable = demosaic->enable;
+        if (demosaic->enable) {
+            isp_video->gradient_ratio = demosaic->gradient_ratio;
+        }
+
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_DEMOSAIC, demosaic->enable), exit, TAG, "failed to update demosaic");
+        break;
+    }
+    case V4L2_CID_USER_ESP_ISP_WB: {
+        esp_video_isp_wb_t *wb = (esp_video_isp_wb_t *)ctrl->p_u8;
+
+        isp_video->red_balance_enable = wb->enable;
+        isp_video->blue_balance_enable = wb->enable;
+        if (wb->enable) {
+            isp_video->red_balance_gain = wb->red_gain;
+            isp_video->blue_balance_gain = wb->blue_gain;
+        } else if (ISP_STARTED(isp_video)) {
+            isp_video->red_balance_gain = 1.0f;
+            isp_video->blue_balance_gain = 1.0f;
+        }
+
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_WBG, wb->enable), exit, TAG, "failed to update white balance");
+        break;
+    }
+    case V4L2_CID_BRIGHTNESS: {
+        isp_video->color_config.color_brightness = ctrl->value;
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_COLOR, true), exit, TAG, "failed to update color");
+        break;
+    }
+    case V4L2_CID_CONTRAST: {
+        isp_video->color_config.color_contrast.val = ctrl->value;
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_COLOR, true), exit, TAG, "failed to update color");
+        break;
+    }
+    case V4L2_CID_SATURATION: {
+        isp_video->color_config.color_saturation.val = ctrl->value;
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_COLOR, true), exit, TAG, "failed to update color");
+        break;
+    }
+    case V4L2_CID_HUE: {
+        isp_video->color_config.color_hue = ctrl->value;
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_COLOR, true), exit, TAG, "failed to update color");
+        break;
+    }
+    case V4L2_CID_USER_ESP_ISP_AWB: {
+        const esp_video_isp_awb_t *awb = (const esp_video_isp_awb_t *)ctrl->p_u8;
+
+        if (awb->rg_min > awb->rg_max || awb->bg_min > awb->bg_max) {
+            ESP_LOGE(TAG, "Invalid ratio range");
             break;
         }
-        case V4L2_CID_HUE: {
-            isp_video->color_config.color_hue = ctrl->value;
-            if (ISP_STARTED(isp_video)) {
-                ESP_GOTO_ON_ERROR(isp_reconfigure_color(isp_video), exit, TAG, "failed to reconfigure color");
-            }
+        if (awb->green_min > awb->green_max) {
+            ESP_LOGE(TAG, "Invalid green value range");
             break;
         }
-        case V4L2_CID_USER_ESP_ISP_AWB: {
-            const esp_video_isp_awb_t *awb = (const esp_video_isp_awb_t *)ctrl->p_u8;
 
-            if (awb->rg_min > awb->rg_max || awb->bg_min > awb->bg_max) {
-                ESP_LOGE(TAG, "Invalid ratio range");
-                break;
-            }
-            if (awb->green_min > awb->green_max) {
-                ESP_LOGE(TAG, "Invalid green value range");
-                break;
-            }
+        if (awb->windows->btm_right.x == 0 && awb->windows->btm_right.y == 0) {
+            ESP_LOGD(TAG, "Window is not set, use default window");
 
-            if (awb->windows->btm_right.x == 0 && awb->windows->btm_right.y == 0) {
-                ESP_LOGD(TAG, "Window is not set, use default window");
+            isp_window_t win_tmp = isp_video->awb.windows[0];
+            isp_video->awb = *awb;
+            isp_video->awb.windows[0] = win_tmp;
+        } else {
+            isp_video->awb = *awb;
+        }
 
-                isp_window_t win_tmp = isp_video->awb.windows[0];
-                isp_video->awb = *awb;
-                isp_video->awb.windows[0] = win_tmp;
-            } else {
-                isp_video->awb = *awb;
+        if (awb->enable) {
+            if (ISP_STARTED(isp_video)) {
+                ESP_GOTO_ON_ERROR(isp_reconfigure_awb(isp_video), exit, TAG, "failed to reconfigure AWB");
             }
-
-            if (awb->enable) {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_awb(isp_video), exit, TAG, "failed to reconfigure AWB");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_awb(isp_video), exit, TAG, "failed to reconfigure AWB");
-                }
+        } else {
+            if (ISP_STARTED(isp_video)) {
+                ESP_GOTO_ON_ERROR(isp_stop_awb(isp_video), exit, TAG, "failed to reconfigure AWB");
             }
-            break;
         }
+        break;
+    }
 #if ESP_VIDEO_ISP_DEVICE_LSC
-        case V4L2_CID_USER_ESP_ISP_LSC: {
-            const esp_video_isp_lsc_t *lsc = (const esp_video_isp_lsc_t *)ctrl->p_u8;
-
-            isp_video->lsc_enable = lsc->enable;
-            if (lsc->enable) {
-                isp_video->lsc_gain_size = lsc->lsc_gain_size;
-                isp_video->lsc_gain_array.gain_r = (isp_lsc_gain_t *)lsc->gain_r;
-                isp_video->lsc_gain_array.gain_gr = (isp_lsc_gain_t *)lsc->gain_gr;
-                isp_video->lsc_gain_array.gain_gb = (isp_lsc_gain_t *)lsc->gain_gb;
-                isp_video->lsc_gain_array.gain_b = (isp_lsc_gain_t *)lsc->gain_b;
-
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_lsc(isp_video), exit, TAG, "failed to reconfigure LSC");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_lsc(isp_video), exit, TAG, "failed to stop LSC");
-                }
-            }
-
-            break;
+    case V4L2_CID_USER_ESP_ISP_LSC: {
+        const esp_video_isp_lsc_t *lsc = (const esp_video_isp_lsc_t *)ctrl->p_u8;
+
+        isp_video->lsc_enable = lsc->enable;
+        if (lsc->enable) {
+            isp_video->lsc_gain_size = lsc->lsc_gain_size;
+            isp_video->lsc_gain_array.gain_r = (isp_lsc_gain_t *)lsc->gain_r;
+            isp_video->lsc_gain_array.gain_gr = (isp_lsc_gain_t *)lsc->gain_gr;
+            isp_video->lsc_gain_array.gain_gb = (isp_lsc_gain_t *)lsc->gain_gb;
+            isp_video->lsc_gain_array.gain_b = (isp_lsc_gain_t *)lsc->gain_b;
         }
+
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_LSC, lsc->enable), exit, TAG, "failed to update LSC");
+        break;
+    }
 #endif
 #if ESP_VIDEO_ISP_DEVICE_BLC
-        case V4L2_CID_USER_ESP_ISP_BLC: {
-            esp_video_isp_blc_t *blc = (esp_video_isp_blc_t *)ctrl->p_u8;
+    case V4L2_CID_USER_ESP_ISP_BLC: {
+        esp_video_isp_blc_t *blc = (esp_video_isp_blc_t *)ctrl->p_u8;
 
-            isp_video->blc_config = *blc;
-            if (blc->enable) {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_blc(isp_video), exit, TAG, "failed to reconfigure BLC");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_blc(isp_video), exit, TAG, "failed to stop BLC");
-                }
-            }
-            break;
-        }
+        isp_video->blc_config = *blc;
+        ESP_GOTO_ON_ERROR(isp_update_module(isp_video, ISP_MODULE_BLC, blc->enable), exit, TAG, "failed to update BLC");
+        break;
+    }
 #endif
-        case V4L2_CID_USER_ESP_ISP_AF: {
-            esp_video_isp_af_t *af = (esp_video_isp_af_t *)ctrl->p_u8;
+    case V4L2_CID_USER_ESP_ISP_AF: {
+        esp_video_isp_af_t *af = (esp_video_isp_af_t *)ctrl->p_u8;
 
-            isp_video->af_config = *af;
-            if (af->enable) {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_af(isp_video), exit, TAG, "failed to reconfigure AF");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_af(isp_video), exit, TAG, "failed to stop AF");
-                }
+        isp_video->af_config = *af;
+        if (af->enable) {
+            if (ISP_STARTED(isp_video)) {
+                ESP_GOTO_ON_ERROR(isp_reconfigure_af(isp_video), exit, TAG, "failed to reconfigure AF");
+            }
+        } else {
+            if (ISP_STARTED(isp_video)) {
+                ESP_GOTO_ON_ERROR(isp_stop_af(isp_video), exit, TAG, "failed to stop AF");
             }
-            break;
-        }
-        case V4L2_CID_USER_ESP_ISP_RAW_BYPASS: {
-            isp_video->isp_raw_bypass = ctrl->value != 0 ? true : false;
-            break;
         }
-        case V4L2_CID_USER_ESP_ISP_AE: {
-            esp_video_isp_ae_t *ae = (esp_video_isp_ae_t *)ctrl->p_u8;
+        break;
+    }
+    case V4L2_CID_USER_ESP_ISP_RAW_BYPASS: {
+        isp_video->isp_raw_bypass = ctrl->value != 0 ? true : false;
+        break;
+    }
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+    case V4L2_CID_POWER_LINE_FREQUENCY: {
+        ESP_GOTO_ON_FALSE((ctrl->value >= V4L2_CID_POWER_LINE_FREQUENCY_DISABLED) &&
+                          (ctrl->value <= V4L2_CID_POWER_LINE_FREQUENCY_AUTO),
+                          ESP_ERR_INVALID_ARG, exit, TAG, "invalid power line frequency");
+        isp_video->power_line_frequency = ctrl->value;
+        break;
+    }
+#endif
+    case V4L2_CID_USER_ESP_ISP_AE: {
+        esp_video_isp_ae_t *ae = (esp_video_isp_ae_t *)ctrl->p_u8;
 
-            isp_video->ae_config = *ae;
-            if (ae->enable) {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_ae(isp_video), exit, TAG, "failed to reconfigure AE");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_ae(isp_video), exit, TAG, "failed to stop AE");
-                }
+        isp_video->ae_config = *ae;
+        if (ae->enable) {
+            if (ISP_STARTED(isp_video)) {
+                ESP_GOTO_ON_ERROR(isp_reconfigure_ae(isp_video), exit, TAG, "failed to reconfigure AE");
+            }
+        } else {
+            if (ISP_STARTED(isp_video)) {
+                ESP_GOTO_ON_ERROR(isp_stop_ae(isp_video), exit, TAG, "failed to stop AE");
             }
-            break;
         }
-        case V4L2_CID_USER_ESP_ISP_HIST: {
-            esp_video_isp_hist_t *hist = (esp_video_isp_hist_t *)ctrl->p_u8;
+        break;
+    }
+    case V4L2_CID_USER_ESP_ISP_HIST: {
+        esp_video_isp_hist_t *hist = (esp_video_isp_hist_t *)ctrl->p_u8;
 
-            isp_video->hist_config = *hist;
-            if (hist->enable) {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_reconfigure_hist(isp_video), exit, TAG, "failed to reconfigure HIST");
-                }
-            } else {
-                if (ISP_STARTED(isp_video)) {
-                    ESP_GOTO_ON_ERROR(isp_stop_hist(isp_video), exit, TAG, "failed to stop HIST");
-                }
+        isp_video->hist_config = *hist;
+        if (hist->enable) {
+            if (ISP_STARTED(isp_video)) {
+                ESP_GOTO_ON_ERROR(isp_reconfigure_hist(isp_video), exit, TAG, "failed to reconfigure HIST");
+            }
+        } else {
+            if (ISP_STARTED(isp_video)) {
+                ESP_GOTO_ON_ERROR(isp_stop_hist(isp_video), exit, TAG, "failed to stop HIST");
             }
-            break;
         }
-        default:
-            ret = ESP_ERR_NOT_SUPPORTED;
-            break;
+        break;
+    }
+    default:
+        ret = ESP_ERR_NOT_SUPPORTED;
+        break;
+    }
+
+exit:
+    return ret;
+}
+
+/**
+ * A failed control doesn't stop the following controls from being applied, and the
+ * error of the first failed control is returned.
+ */
+static esp_err_t isp_video_set_ext_ctrl(struct esp_video *video, const struct v4l2_ext_controls *ctrls)
+{
+    esp_err_t ret = ESP_OK;
+    struct isp_video *isp_video = VIDEO_PRIV_DATA(struct isp_video *, video);
+
+    ISP_LOCK(isp_video);
+
+    for (int i = 0; i < ctrls->count; i++) {
+        struct v4l2_ext_control *ctrl = &ctrls->controls[i];
+        esp_err_t err;
+
+        if (isp_ctrl_is_applied(isp_video, ctrl)) {
+            ESP_LOGD(TAG, "id=%" PRIx32 " is not changed, skip it", ctrl->id);
+            continue;
         }
 
-        if (ret != ESP_OK) {
-            break;
+        err = isp_video_set_ctrl(isp_video, ctrl);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "failed to set id=%" PRIx32 " ret=%x", ctrl->id, err);
+            if (ret == ESP_OK) {
+                ret = err;
+            }
         }
     }
 
-exit:
     ISP_UNLOCK(isp_video);
     return ret;
 }
@@ -2233,6 +2684,22 @@ static esp_err_t isp_video_get_ext_ctrl(struct esp_video *video, struct v4l2_ext
             ctrl->value = isp_video->isp_raw_bypass ? 1 : 0;
             break;
         }
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+        case V4L2_CID_POWER_LINE_FREQUENCY: {
+            ctrl->value = isp_video->power_line_frequency;
+            break;
+        }
+        case V4L2_CID_USER_ESP_ISP_FLICKER: {
+            ctrl->value = isp_video->flicker_frequency;
+            break;
+        }
+#endif
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+        case V4L2_CID_USER_ESP_ISP_COMMIT_SEQ: {
+            ctrl->value = (int32_t)(isp_video->commit_seq & INT32_MAX);
+            break;
+        }
+#endif
         case V4L2_CID_USER_ESP_ISP_AE: {
             esp_video_isp_ae_t *ae = (esp_video_isp_ae_t *)ctrl->p_u8;
 
@@ -2264,6 +2731,18 @@ static esp_err_t isp_video_query_ext_ctrl(struct esp_video *video, struct v4l2_q
     return esp_video_device_common_query_ext_ctrl(s_isp_qctrl, s_isp_qctrl_nums, qctrl);
 }
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+static esp_err_t isp_video_query_menu(struct esp_video *video, struct v4l2_querymenu *qmenu)
+{
+    ESP_RETURN_ON_FALSE(qmenu->id == V4L2_CID_POWER_LINE_FREQUENCY, ESP_ERR_NOT_SUPPORTED, TAG, "menu id=%" PRIx32 " is not supported", qmenu->id);
+    ESP_RETURN_ON_FALSE(qmenu->index < ARRAY_SIZE(s_isp_power_line_frequency_menu), ESP_ERR_INVALID_ARG, TAG, "menu index=%" PRIu32 " is out of range", qmenu->index);
+
+    strlcpy((char *)qmenu->name, s_isp_power_line_frequency_menu[qmenu->index], sizeof(qmenu->name));
+
+    return ESP_OK;
+}
+#endif
+
 static esp_err_t isp_video_set_selection(struct esp_video *video, struct v4l2_selection *selection)
 {
     struct isp_video *isp_video = VIDEO_PRIV_DATA(struct isp_video *, video);
@@ -2334,6 +2813,10 @@ static void isp_init_params(struct isp_video *isp_video)
     isp_video->color_config.color_brightness = ISP_BRIGHTNESS_DEFAULT;
 
     isp_video->isp_raw_bypass = true;
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+    isp_video->power_line_frequency = V4L2_CID_POWER_LINE_FREQUENCY_AUTO;
+#endif
 }
 
 static const struct esp_video_ops s_isp_video_ops = {
@@ -2347,6 +2830,9 @@ static const struct esp_video_ops s_isp_video_ops = {
     .set_ext_ctrl   = isp_video_set_ext_ctrl,
     .get_ext_ctrl   = isp_video_get_ext_ctrl,
     .query_ext_ctrl = isp_video_query_ext_ctrl,
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+    .query_menu     = isp_video_query_menu,
+#endif
     .set_selection  = isp_video_set_selection,
 };
 
@@ -2374,8 +2860,19 @@ esp_err_t esp_video_create_isp_video_device(void)
 
     isp_video->spinlock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
 
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+    if (xTaskCreate(isp_commit_task, ISP_COMMIT_TASK_NAME, ISP_COMMIT_TASK_STACK_SIZE, isp_video,
+                    ISP_COMMIT_TASK_PRIORITY, &isp_video->commit_task) != pdPASS) {
+        vSemaphoreDelete(isp_video->mutex);
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
     isp_video->video = esp_video_create(ISP_NAME, ESP_VIDEO_ISP1_DEVICE_ID, &s_isp_video_ops, isp_video, caps, device_caps);
     if (!isp_video->video) {
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+        vTaskDelete(isp_video->commit_task);
+#endif
         vSemaphoreDelete(isp_video->mutex);
         return ESP_FAIL;
     }
@@ -2407,6 +2904,17 @@ esp_err_t esp_video_destroy_isp_video_device(void)
         return ret;
     }
 
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+    /* Commit task only blocks on notification or lock out of the locked region, so it is safe to delete now */
+    ISP_LOCK(&s_isp_video);
+    vTaskDelete(s_isp_video.commit_task);
+    ISP_UNLOCK(&s_isp_video);
+#endif
+
+#if ESP_VIDEO_ISP_DEVICE_LSC
+    heap_caps_free(s_isp_video.lsc_applied_gain);
+#endif
+
     vSemaphoreDelete(s_isp_video.mutex);
     memset(&s_isp_video, 0, sizeof(struct isp_video));
 
@@ -2498,6 +3006,13 @@ esp_err_t esp_video_isp_video_device_remove_isp_proc(isp_proc_handle_t isp_proc)
 
     ESP_GOTO_ON_ERROR(isp_stop_pipeline(isp_video), fail_0, TAG, "failed to stop ISP pipeline");
 
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG
+    /* Pending configuration is kept in parameters, and it is written when ISP pipeline starts again */
+    portENTER_CRITICAL(&isp_video->spinlock);
+    isp_video->shadow_dirty = 0;
+    portEXIT_CRITICAL(&isp_video->spinlock);
+#endif
+
     ESP_GOTO_ON_ERROR(isp_stop_crop(isp_video), fail_0, TAG, "failed to stop ISP crop");
 
     esp_isp_evt_cbs_t cbs = {0};
@@ -2513,6 +3028,43 @@ fail_0:
     return ret;
 }
 
+#if ESP_VIDEO_ISP_DEVICE_CROP
+esp_err_t esp_video_isp_video_device_move_crop(isp_proc_handle_t isp_proc, const struct v4l2_rect *crop_rect)
+{
+    esp_err_t ret = ESP_OK;
+    struct isp_video *isp_video = &s_isp_video;
+    esp_isp_crop_config_t crop_config = {
+        .window = {
+            .top_left = {
+                .x = crop_rect->left,
+                .y = crop_rect->top
+            },
+            .btm_right = {
+                .x = crop_rect->left + crop_rect->width - 1,
+                .y = crop_rect->top + crop_rect->height - 1
+            }
+        }
+    };
+
+    ISP_LOCK(isp_video);
+
+    ESP_GOTO_ON_FALSE(isp_proc == isp_video->isp_proc, ESP_ERR_INVALID_ARG, exit_0, TAG, "ISP processor is not the same as the one in the video device");
+    ESP_GOTO_ON_FALSE(isp_video->crop_started, ESP_ERR_INVALID_STATE, exit_0, TAG, "ISP crop is not started");
+
+    /**
+     * Crop window registers are latched at frame start, so the window moves between two frames. Crop
+     * is never disabled while streaming, because frames output without crop don't fit the buffers,
+     * so ISP drivers which only allow configuring disabled crop return ESP_ERR_INVALID_STATE.
+     */
+    ret = esp_isp_crop_configure(isp_proc, &crop_config);
+    ESP_GOTO_ON_ERROR(ret, exit_0, TAG, "failed to move ISP crop, stop stream to change crop");
+
+exit_0:
+    ISP_UNLOCK(isp_video);
+    return ret;
+}
+#endif
+
 /**
  * @brief Check if the ISP bypass mode is enabled
  *
@@ -2544,3 +3096,18 @@ esp_err_t esp_video_isp_video_device_set_stats_windows(uint32_t left, uint32_t t
 
     return ret;
 }
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+esp_err_t esp_video_isp_video_device_set_flicker(uint32_t freq)
+{
+    struct isp_video *isp_video = &s_isp_video;
+
+    ESP_RETURN_ON_FALSE(freq == 0 || freq == 50 || freq == 60, ESP_ERR_INVALID_ARG, TAG, "invalid flicker frequency");
+
+    ISP_LOCK(isp_video);
+    isp_video->flicker_frequency = freq;
+    ISP_UNLOCK(isp_video);
+
+    return ESP_OK;
+}
+#endif
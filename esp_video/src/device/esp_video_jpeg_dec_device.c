@@ -12,6 +12,9 @@
 #include "esp_attr.h"
 #include "esp_private/esp_cache_private.h"
 #include "driver/jpeg_decode.h"
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+#include "driver/ppa.h"
+#endif
 
 #include "esp_video.h"
 #include "esp_video_ioctl.h"
@@ -28,6 +31,14 @@
 #define JPEG_DEC_VIDEO_MIN_WIDTH        64
 #define JPEG_DEC_VIDEO_MIN_HEIGHT       64
 
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+/* PPA scaling factor precision, so 1/2, 1/4 and 1/8 are exact */
+#define JPEG_DEC_SCALE_STEPS            16
+
+/* Decoded image is padded to MCU, and MCU is 16x16 at most */
+#define JPEG_DEC_MCU_MAX_SIZE           16
+#endif
+
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(x)                   (sizeof(x) / sizeof((x)[0]))
 #endif
@@ -38,6 +49,18 @@ struct jpeg_dec_video {
 
     jpeg_dec_output_format_t dst_type;
     jpeg_yuv_rgb_conv_std_t conv_std;
+
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+    bool started;
+    bool crop_set;                      /*!< Capture image is from the crop rectangle of decoded image */
+    struct v4l2_rect crop;
+
+    uint8_t *decode_buffer;             /*!< Whole decoded image, only used when capture image is scaled or cropped */
+    uint32_t decode_buffer_size;
+    uint32_t capture_size;              /*!< Scaled or cropped image size in bytes */
+    ppa_client_handle_t ppa;
+    ppa_srm_oper_config_t srm;          /*!< Scales or crops decoded image into capture buffer */
+#endif
 };
 
 static const char *TAG = "jpeg_dec_video";
@@ -96,18 +119,117 @@ static esp_err_t jpeg_dec_get_output_format_from_v4l2(uint32_t v4l2_format, jpeg
     return ret;
 }
 
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+static esp_err_t jpeg_dec_get_ppa_format(uint32_t v4l2_format, ppa_srm_color_mode_t *color_mode, uint32_t *align)
+{
+    esp_err_t ret = ESP_OK;
+
+    switch (v4l2_format) {
+    case V4L2_PIX_FMT_RGB565:
+    case V4L2_PIX_FMT_BGR565:
+        *color_mode = PPA_SRM_COLOR_MODE_RGB565;
+        *align = 1;
+        break;
+    case V4L2_PIX_FMT_RGB24:
+    case V4L2_PIX_FMT_BGR24:
+        *color_mode = PPA_SRM_COLOR_MODE_RGB888;
+        *align = 1;
+        break;
+#if ESP_VIDEO_JPEG_DEVICE_YUV420
+    case V4L2_PIX_FMT_YUV420:
+        /* Chroma is shared by 2x2 pixels, so size and offset must be even */
+        *color_mode = PPA_SRM_COLOR_MODE_YUV420;
+        *align = 2;
+        break;
+#endif
+    default:
+        ret = ESP_ERR_NOT_SUPPORTED;
+        break;
+    }
+
+    return ret;
+}
+
+/**
+ * Calculate PPA scaling factor in 1/JPEG_DEC_SCALE_STEPS, capture image is only scaled down,
+ * and the ratio must be exact so that there is no gap at the right or bottom.
+ */
+static esp_err_t jpeg_dec_calc_scale(uint32_t src, uint32_t dst, uint32_t *scale)
+{
+    if (dst > src || (dst * JPEG_DEC_SCALE_STEPS) % src) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    *scale = dst * JPEG_DEC_SCALE_STEPS / src;
+
+    return ESP_OK;
+}
+
+static void jpeg_dec_get_mcu_size(jpeg_down_sampling_type_t sample_method, uint32_t *mcu_w, uint32_t *mcu_h)
+{
+    switch (sample_method) {
+    case JPEG_DOWN_SAMPLING_YUV420:
+        *mcu_w = 16;
+        *mcu_h = 16;
+        break;
+    case JPEG_DOWN_SAMPLING_YUV422:
+        *mcu_w = 16;
+        *mcu_h = 8;
+        break;
+    default:
+        *mcu_w = 8;
+        *mcu_h = 8;
+        break;
+    }
+}
+
+/**
+ * Decode the whole JPEG image into the internal buffer, and then PPA scales or crops it into
+ * capture buffer directly, so the capture image is not copied by CPU.
+ */
+static esp_err_t jpeg_dec_video_scale_process(struct esp_video *video, const jpeg_decode_cfg_t *dec_config,
+                                              uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size,
+                                              uint32_t *dst_out_size)
+{
+    uint32_t mcu_w;
+    uint32_t mcu_h;
+    uint32_t decoded_size;
+    jpeg_decode_picture_info_t info;
+    struct jpeg_dec_video *jpeg_dec_video = VIDEO_PRIV_DATA(struct jpeg_dec_video *, video);
+    ppa_srm_oper_config_t *srm = &jpeg_dec_video->srm;
+
+    ESP_RETURN_ON_ERROR(jpeg_decoder_get_info(src, src_size, &info), TAG, "failed to parse JPEG header");
+    if ((info.width != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
+            (info.height != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
+        ESP_LOGE(TAG, "JPEG image size=%" PRIu32 "x%" PRIu32 " is not output format size", info.width, info.height);
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    ESP_RETURN_ON_ERROR(jpeg_decoder_process(jpeg_dec_video->dec_handle, dec_config, src, src_size,
+                                             jpeg_dec_video->decode_buffer, jpeg_dec_video->decode_buffer_size,
+                                             &decoded_size),
+                        TAG, "failed to decode JPEG image");
+
+    /* Decoded lines are padded to MCU width, so PPA reads them by the padded picture size */
+    jpeg_dec_get_mcu_size(info.sample_method, &mcu_w, &mcu_h);
+    srm->in.pic_w = (info.width + mcu_w - 1) / mcu_w * mcu_w;
+    srm->in.pic_h = (info.height + mcu_h - 1) / mcu_h * mcu_h;
+    srm->out.buffer = dst;
+    srm->out.buffer_size = dst_size;
+    ESP_RETURN_ON_ERROR(ppa_do_scale_rotate_mirror(jpeg_dec_video->ppa, srm), TAG, "failed to scale decoded image");
+
+    *dst_out_size = jpeg_dec_video->capture_size;
+
+    return ESP_OK;
+}
+#endif
+
 static esp_err_t jpeg_dec_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
 {
     esp_err_t ret;
     uint32_t jpeg_decoded_size;
     struct jpeg_dec_video *jpeg_dec_video = VIDEO_PRIV_DATA(struct jpeg_dec_video *, video);
 
-    if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
-            (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
-        ESP_LOGE(TAG, "capture and output width or height is invalid");
-        return ESP_ERR_INVALID_ARG;
-    }
-
     jpeg_decode_cfg_t dec_config = {
         .output_format = jpeg_dec_video->dst_type,
         .rgb_order = JPEG_DEC_RGB_ELEMENT_ORDER_RGB,
@@ -119,6 +241,18 @@ static esp_err_t jpeg_dec_video_m2m_process(struct esp_video *video, uint8_t *sr
         dec_config.rgb_order = JPEG_DEC_RGB_ELEMENT_ORDER_BGR;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+    if (jpeg_dec_video->decode_buffer) {
+        return jpeg_dec_video_scale_process(video, &dec_config, src, src_size, dst, dst_size, dst_out_size);
+    }
+#endif
+
+    if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
+            (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
+        ESP_LOGE(TAG, "capture and output width or height is invalid");
+        return ESP_ERR_INVALID_ARG;
+    }
+
     ret = jpeg_decoder_process(jpeg_dec_video->dec_handle,
                                &dec_config,
                                src,
@@ -175,19 +309,152 @@ static esp_err_t jpeg_dec_video_deinit(struct esp_video *video)
     return ESP_OK;
 }
 
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+static esp_err_t jpeg_dec_video_start_scale(struct esp_video *video)
+{
+    esp_err_t ret;
+    uint8_t bpp;
+    uint32_t align;
+    uint32_t scale_x;
+    uint32_t scale_y;
+    size_t allocated_size;
+    ppa_srm_color_mode_t color_mode;
+    jpeg_dec_output_format_t dst_type;
+    struct jpeg_dec_video *jpeg_dec_video = VIDEO_PRIV_DATA(struct jpeg_dec_video *, video);
+    uint32_t width = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video);
+    uint32_t height = M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video);
+    uint32_t capture_width = M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video);
+    uint32_t capture_height = M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video);
+    uint32_t capture_format = M2M_VIDEO_GET_CAPTURE_FORMAT_PIXEL_FORMAT(video);
+    struct v4l2_rect crop = {
+        .left = 0,
+        .top = 0,
+        .width = width,
+        .height = height,
+    };
+    ppa_client_config_t ppa_config = {
+        .oper_type = PPA_OPERATION_SRM,
+    };
+    jpeg_decode_memory_alloc_cfg_t mem_cfg = {
+        .buffer_direction = JPEG_DEC_ALLOC_OUTPUT_BUFFER,
+    };
+
+    if (jpeg_dec_video->crop_set) {
+        const struct v4l2_rect *r = &jpeg_dec_video->crop;
+
+        if ((r->left + r->width) > width || (r->top + r->height) > height) {
+            ESP_LOGE(TAG, "crop rectangle is out of output image");
+            return ESP_ERR_INVALID_ARG;
+        }
+
+        crop = *r;
+    }
+
+    if (crop.width == width && crop.height == height &&
+            capture_width == width && capture_height == height) {
+        /* Decode into capture buffer directly */
+        return ESP_OK;
+    }
+
+    ESP_RETURN_ON_ERROR(jpeg_dec_get_ppa_format(capture_format, &color_mode, &align), TAG,
+                        "capture pixel format can't be scaled or cropped");
+    if ((crop.left % align) || (crop.top % align) || (crop.width % align) || (crop.height % align) ||
+            (capture_width % align) || (capture_height % align)) {
+        ESP_LOGE(TAG, "crop rectangle or capture size is not aligned to %" PRIu32, align);
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_RETURN_ON_ERROR(jpeg_dec_calc_scale(crop.width, capture_width, &scale_x), TAG,
+                        "horizontal scaling ratio is not supported");
+    ESP_RETURN_ON_ERROR(jpeg_dec_calc_scale(crop.height, capture_height, &scale_y), TAG,
+                        "vertical scaling ratio is not supported");
+
+    ESP_RETURN_ON_ERROR(jpeg_dec_get_output_format_from_v4l2(capture_format, &dst_type, &bpp), TAG,
+                        "pixel format is invalid");
+    jpeg_dec_video->decode_buffer = jpeg_alloc_decoder_mem((width + JPEG_DEC_MCU_MAX_SIZE - 1) / JPEG_DEC_MCU_MAX_SIZE * JPEG_DEC_MCU_MAX_SIZE *
+                                                           (height + JPEG_DEC_MCU_MAX_SIZE - 1) / JPEG_DEC_MCU_MAX_SIZE * JPEG_DEC_MCU_MAX_SIZE *
+                                                           bpp / 8, &mem_cfg, &allocated_size);
+    ESP_RETURN_ON_FALSE(jpeg_dec_video->decode_buffer, ESP_ERR_NO_MEM, TAG, "failed to malloc decode buffer");
+    jpeg_dec_video->decode_buffer_size = allocated_size;
+    jpeg_dec_video->capture_size = capture_width * capture_height * bpp / 8;
+
+    ESP_GOTO_ON_ERROR(ppa_register_client(&ppa_config, &jpeg_dec_video->ppa), exit_0, TAG, "failed to register PPA client");
+
+    /* Input picture size and output buffer are filled by every frame */
+    jpeg_dec_video->srm = (ppa_srm_oper_config_t) {
+        .in = {
+            .buffer = jpeg_dec_video->decode_buffer,
+            .block_w = crop.width,
+            .block_h = crop.height,
+            .block_offset_x = crop.left,
+            .block_offset_y = crop.top,
+            .srm_cm = color_mode,
+        },
+        .out = {
+            .pic_w = capture_width,
+            .pic_h = capture_height,
+            .block_offset_x = 0,
+            .block_offset_y = 0,
+            .srm_cm = color_mode,
+        },
+        .rotation_angle = PPA_SRM_ROTATION_ANGLE_0,
+        .scale_x = (float)scale_x / JPEG_DEC_SCALE_STEPS,
+        .scale_y = (float)scale_y / JPEG_DEC_SCALE_STEPS,
+        .mode = PPA_TRANS_MODE_BLOCKING,
+    };
+
+    ESP_LOGD(TAG, "decode %" PRIu32 "x%" PRIu32 " crop=(%" PRId32 ",%" PRId32 ") %" PRIu32 "x%" PRIu32 " to %" PRIu32 "x%" PRIu32,
+             width, height, crop.left, crop.top, crop.width, crop.height, capture_width, capture_height);
+
+    return ESP_OK;
+
+exit_0:
+    heap_caps_free(jpeg_dec_video->decode_buffer);
+    jpeg_dec_video->decode_buffer = NULL;
+    return ret;
+}
+#endif
+
 static esp_err_t jpeg_dec_video_start(struct esp_video *video, uint32_t type)
 {
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+    struct jpeg_dec_video *jpeg_dec_video = VIDEO_PRIV_DATA(struct jpeg_dec_video *, video);
+
+    /**
+     * Capture image can be scaled down from or cropped by selection out of output image,
+     * and it is checked when the whole format is known.
+     */
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        ESP_RETURN_ON_ERROR(jpeg_dec_video_start_scale(video), TAG, "failed to start scaling");
+        jpeg_dec_video->started = true;
+    }
+#else
     if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
             (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
         ESP_LOGE(TAG, "width or height is invalid");
         return ESP_ERR_INVALID_ARG;
     }
+#endif
 
     return ESP_OK;
 }
 
 static esp_err_t jpeg_dec_video_stop(struct esp_video *video, uint32_t type)
 {
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+    struct jpeg_dec_video *jpeg_dec_video = VIDEO_PRIV_DATA(struct jpeg_dec_video *, video);
+
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        if (jpeg_dec_video->decode_buffer) {
+            ppa_unregister_client(jpeg_dec_video->ppa);
+            jpeg_dec_video->ppa = NULL;
+            heap_caps_free(jpeg_dec_video->decode_buffer);
+            jpeg_dec_video->decode_buffer = NULL;
+        }
+
+        jpeg_dec_video->started = false;
+    }
+#endif
+
     return ESP_OK;
 }
 
@@ -306,6 +573,36 @@ static esp_err_t jpeg_dec_video_notify(struct esp_video *video, enum esp_video_e
     return ESP_OK;
 }
 
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+static esp_err_t jpeg_dec_video_set_selection(struct esp_video *video, struct v4l2_selection *selection)
+{
+    struct jpeg_dec_video *jpeg_dec_video = VIDEO_PRIV_DATA(struct jpeg_dec_video *, video);
+    const struct v4l2_rect *r = &selection->r;
+
+    if (selection->type != V4L2_BUF_TYPE_VIDEO_CAPTURE || selection->target != V4L2_SEL_TGT_CROP) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (jpeg_dec_video->started) {
+        ESP_LOGE(TAG, "capture stream should be stream off");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    /* Crop rectangle is in the coordinate of decoded image whose size is output format size */
+    if (r->left < 0 || r->top < 0 ||
+            r->width < JPEG_DEC_VIDEO_MIN_WIDTH || (r->left + r->width) > M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video) ||
+            r->height < JPEG_DEC_VIDEO_MIN_HEIGHT || (r->top + r->height) > M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video)) {
+        ESP_LOGE(TAG, "crop width or height is invalid");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    jpeg_dec_video->crop = *r;
+    jpeg_dec_video->crop_set = true;
+
+    return ESP_OK;
+}
+#endif
+
 static const struct esp_video_ops s_jpeg_dec_video_ops = {
     .init           = jpeg_dec_video_init,
     .deinit         = jpeg_dec_video_deinit,
@@ -314,6 +611,9 @@ static const struct esp_video_ops s_jpeg_dec_video_ops = {
     .enum_format    = jpeg_dec_video_enum_format,
     .set_format     = jpeg_dec_video_set_format,
     .notify         = jpeg_dec_video_notify,
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_DEC_SCALE
+    .set_selection  = jpeg_dec_video_set_selection,
+#endif
 };
 
 /**
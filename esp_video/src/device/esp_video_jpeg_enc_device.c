@@ -11,7 +11,9 @@
 #include "esp_log.h"
 #include "esp_attr.h"
 #include "esp_private/esp_cache_private.h"
+#include "esp_check.h"
 #include "driver/jpeg_encode.h"
+#include "esp_video_jpeg_engine.h"
 
 #include "esp_video.h"
 #include "esp_video_device_internal.h"
@@ -37,17 +39,53 @@
 #define JPEG_VIDEO_MIN_WIDTH            64
 #define JPEG_VIDEO_MIN_HEIGHT           64
 
+#define JPEG_VIDEO_MAX_TARGET_SIZE      (16 * 1024 * 1024)
+
+/* Frame larger than target size by more than 1/JPEG_TARGET_SIZE_TOLERANCE is encoded again */
+#define JPEG_TARGET_SIZE_TOLERANCE      8
+#define JPEG_TARGET_SIZE_MAX_RETRY      2
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+/* Markers, quantization tables and Huffman tables */
+#define JPEG_HEADER_SIZE                1024
+#endif
+
 #ifndef ARRAY_SIZE
 #define ARRAY_SIZE(x)                   (sizeof(x) / sizeof((x)[0]))
 #endif
 
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+#define JPEG_VIDEO_CHUNK_OUTPUT(jv)     ((jv)->chunk_output)
+#else
+#define JPEG_VIDEO_CHUNK_OUTPUT(jv)     false
+#endif
+
 struct jpeg_video {
-    bool jpeg_inited;
-    jpeg_encoder_handle_t enc_handle;
+    jpeg_encoder_handle_t enc_handle;   /*!< Encoder driver handle given by application, it may be NULL */
+    esp_video_jpeg_engine_client_handle_t engine_client;
+    uint8_t engine_priority;
 
     jpeg_enc_input_format_t src_type;
     jpeg_down_sampling_type_t sub_sample;
     uint8_t image_quality;
+
+    uint32_t target_size;               /*!< Target frame size in bytes, 0 if it is disabled */
+    uint8_t target_quality;             /*!< Quality of the next frame in target size mode */
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    bool size_estimated;                /*!< Capture buffer size is estimated by quality */
+    uint8_t *reserve_buffer;            /*!< Frame larger than capture buffer is encoded again into it */
+    uint32_t reserve_buffer_size;
+    uint32_t overflow_frames;
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+    bool chunk_output;
+    uint8_t *frame_buffer;              /*!< JPEG frame being dequeued by chunks */
+    uint32_t frame_buffer_size;
+    uint32_t frame_size;                /*!< Valid size of JPEG frame in frame_buffer */
+    uint32_t frame_pos;                 /*!< Offset of JPEG frame not dequeued */
+#endif
 };
 
 static const struct v4l2_query_ext_ctrl s_jpeg_qctrl[] = {
@@ -79,6 +117,55 @@ static const struct v4l2_query_ext_ctrl s_jpeg_qctrl[] = {
         .nr_of_dims = 0,
         .name = "Compression Quality",
     },
+    {
+        .id = V4L2_CID_JPEG_ESP_TARGET_SIZE,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .minimum = 0,
+        .maximum = JPEG_VIDEO_MAX_TARGET_SIZE,
+        .step = 1,
+        .default_value = 0,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .name = "Target Frame Size",
+    },
+    {
+        .id = V4L2_CID_JPEG_ESP_ENGINE_PRIORITY,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .minimum = 0,
+        .maximum = ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX,
+        .step = 1,
+        .default_value = ESP_VIDEO_JPEG_ENGINE_PRIORITY_DEFAULT,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .name = "Engine Priority",
+    },
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    {
+        .id = V4L2_CID_JPEG_ESP_OVERFLOW_FRAMES,
+        .type = V4L2_CTRL_TYPE_INTEGER,
+        .minimum = 0,
+        .maximum = INT32_MAX,
+        .step = 1,
+        .default_value = 0,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .flags = V4L2_CTRL_FLAG_READ_ONLY | V4L2_CTRL_FLAG_VOLATILE,
+        .name = "Overflow Frames",
+    },
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+    {
+        .id = V4L2_CID_JPEG_ESP_CHUNK_OUTPUT,
+        .type = V4L2_CTRL_TYPE_BOOLEAN,
+        .minimum = 0,
+        .maximum = 1,
+        .step = 1,
+        .default_value = 0,
+        .elems = 1,
+        .nr_of_dims = 0,
+        .name = "Chunk Output",
+    },
+#endif
 };
 
 static const char *TAG = "jpeg_video";
@@ -130,33 +217,180 @@ static esp_err_t jpeg_get_input_format_from_v4l2(uint32_t v4l2_format, jpeg_enc_
     return ret;
 }
 
-static esp_err_t jpeg_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
+/**
+ * Quantization tables are scaled from the standard ones by "scale" in percent, and JPEG size
+ * is nearly proportional to 1/scale, so quality is predicted in scale domain.
+ */
+static uint32_t jpeg_quality_to_scale(uint32_t quality)
+{
+    return quality < 50 ? 5000 / quality : 200 - quality * 2;
+}
+
+static uint8_t jpeg_scale_to_quality(uint32_t scale)
+{
+    uint32_t quality;
+
+    if (scale >= 100) {
+        quality = 5000 / scale;
+    } else {
+        quality = (200 - scale) / 2;
+    }
+
+    return MAX(quality, JPEG_VIDEO_MIN_COMP_QUALITY);
+}
+
+/* Predict quality of which frame size is "target" */
+static uint8_t jpeg_predict_quality(struct jpeg_video *jpeg_video, uint8_t quality, uint32_t size, uint32_t target)
+{
+    uint32_t scale = jpeg_quality_to_scale(quality);
+    uint64_t new_scale = (uint64_t)scale * size / target;
+
+    /* Increase quality by half step to avoid oscillation when the scene changes */
+    if (new_scale < scale) {
+        new_scale = (scale + new_scale) / 2;
+    }
+    new_scale = MIN(new_scale, jpeg_quality_to_scale(JPEG_VIDEO_MIN_COMP_QUALITY));
+
+    return MIN(jpeg_scale_to_quality(new_scale), jpeg_video->image_quality);
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+/**
+ * Bits per pixel of detailed scenes in 1/100 bit by quality, for 4:2:0 frames which have
+ * 1.5 samples per pixel, and frames of other chroma subsampling are scaled by samples per pixel.
+ */
+static const struct {
+    uint8_t quality;
+    uint16_t bpp;
+} s_jpeg_size_model[] = {
+    {50,  150},
+    {75,  200},
+    {85,  300},
+    {90,  400},
+    {95,  550},
+    {100, 800},
+};
+
+/* Estimate capture buffer size, it is not larger than the default size, which is 8 bits per pixel */
+static uint32_t jpeg_estimate_frame_size(struct jpeg_video *jpeg_video, uint32_t width, uint32_t height)
+{
+    uint32_t bpp = s_jpeg_size_model[ARRAY_SIZE(s_jpeg_size_model) - 1].bpp;
+    uint32_t samples;
+    uint64_t size;
+
+    for (size_t i = 0; i < ARRAY_SIZE(s_jpeg_size_model); i++) {
+        if (jpeg_video->image_quality <= s_jpeg_size_model[i].quality) {
+            bpp = s_jpeg_size_model[i].bpp;
+            break;
+        }
+    }
+
+    /* Samples per pixel in 1/2 */
+    switch (jpeg_video->sub_sample) {
+    case JPEG_DOWN_SAMPLING_GRAY:
+        samples = 2;
+        break;
+    case JPEG_DOWN_SAMPLING_YUV420:
+        samples = 3;
+        break;
+    case JPEG_DOWN_SAMPLING_YUV422:
+        samples = 4;
+        break;
+    default:
+        samples = 6;
+        break;
+    }
+
+    size = (uint64_t)width * height * bpp * samples / (100 * 3 * 8) + JPEG_HEADER_SIZE;
+    if (jpeg_video->target_size) {
+        /* Frames are kept around the target size, and the first frames of a new scene are encoded again */
+        size = MIN(size, jpeg_video->target_size + jpeg_video->target_size / JPEG_TARGET_SIZE_TOLERANCE + JPEG_HEADER_SIZE);
+    }
+
+    return MIN(size, width * height);
+}
+#endif
+
+/**
+ * Encode a frame into capture buffer, and a frame which may be truncated is encoded again into
+ * the reserve buffer and copied if it fits capture buffer. ESP_ERR_INVALID_SIZE is returned
+ * with the frame size if it doesn't fit.
+ */
+static esp_err_t jpeg_encode_buffer(struct jpeg_video *jpeg_video, const jpeg_encode_cfg_t *enc_config, uint8_t *src, uint32_t src_size,
+                                    uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
 {
     esp_err_t ret;
-    uint32_t jpeg_codeced_size;
-    struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
 
-    if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
-            (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
-        ESP_LOGE(TAG, "capture and output width or height is invalid");
-        return ESP_ERR_INVALID_ARG;
+    ret = esp_video_jpeg_engine_encode(jpeg_video->engine_client, enc_config, src, src_size, dst, dst_size, dst_out_size);
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    /* Encoder stops at the end of buffer, so a full buffer is taken as truncated too */
+    if (jpeg_video->reserve_buffer && (ret != ESP_OK || *dst_out_size >= dst_size)) {
+        ret = esp_video_jpeg_engine_encode(jpeg_video->engine_client, enc_config, src, src_size,
+                                           jpeg_video->reserve_buffer, jpeg_video->reserve_buffer_size, dst_out_size);
+        if (ret == ESP_OK) {
+            if (*dst_out_size < dst_size) {
+                memcpy(dst, jpeg_video->reserve_buffer, *dst_out_size);
+            } else {
+                ret = ESP_ERR_INVALID_SIZE;
+            }
+        }
     }
+#endif
 
+    return ret;
+}
+
+static esp_err_t jpeg_encode_frame(struct esp_video *video, struct jpeg_video *jpeg_video, uint8_t *src, uint32_t src_size,
+                                   uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
+{
+    esp_err_t ret;
+    uint32_t jpeg_codeced_size;
+    uint32_t target_size = jpeg_video->target_size;
     jpeg_encode_cfg_t enc_config = {
         .src_type = jpeg_video->src_type,
         .sub_sample = jpeg_video->sub_sample,
-        .image_quality = jpeg_video->image_quality,
+        .image_quality = target_size ? jpeg_video->target_quality : jpeg_video->image_quality,
         .width = M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video),
         .height = M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video),
     };
 
-    ret = jpeg_encoder_process(jpeg_video->enc_handle,
-                               &enc_config,
-                               src,
-                               src_size,
-                               dst,
-                               dst_size,
-                               &jpeg_codeced_size);
+    for (int i = 0; ; i++) {
+        ret = jpeg_encode_buffer(jpeg_video, &enc_config, src, src_size, dst, dst_size, &jpeg_codeced_size);
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+        if (ret == ESP_ERR_INVALID_SIZE) {
+            if (i == 0) {
+                jpeg_video->overflow_frames++;
+                ESP_LOGW(TAG, "frame size=%" PRIu32 " is larger than capture buffer size=%" PRIu32, jpeg_codeced_size, dst_size);
+            }
+
+            if ((enc_config.image_quality == JPEG_VIDEO_MIN_COMP_QUALITY) || (i >= JPEG_TARGET_SIZE_MAX_RETRY)) {
+                break;
+            }
+
+            enc_config.image_quality = MIN(jpeg_predict_quality(jpeg_video, enc_config.image_quality, jpeg_codeced_size,
+                                                                dst_size - dst_size / JPEG_TARGET_SIZE_TOLERANCE),
+                                           enc_config.image_quality - 1);
+            ESP_LOGD(TAG, "encode again with quality=%d", enc_config.image_quality);
+            continue;
+        }
+#endif
+        if (ret != ESP_OK || !target_size) {
+            break;
+        }
+
+        if ((jpeg_codeced_size <= target_size + target_size / JPEG_TARGET_SIZE_TOLERANCE) ||
+                (enc_config.image_quality == JPEG_VIDEO_MIN_COMP_QUALITY) ||
+                (i >= JPEG_TARGET_SIZE_MAX_RETRY)) {
+            /* Next frame is similar to this one, so start from the quality predicted by this frame */
+            jpeg_video->target_quality = jpeg_predict_quality(jpeg_video, enc_config.image_quality, jpeg_codeced_size, target_size);
+            break;
+        }
+
+        enc_config.image_quality = MIN(jpeg_predict_quality(jpeg_video, enc_config.image_quality, jpeg_codeced_size, target_size),
+                                       enc_config.image_quality - 1);
+        ESP_LOGD(TAG, "size=%" PRIu32 " is over target, encode again with quality=%d", jpeg_codeced_size, enc_config.image_quality);
+    }
+
     if (ret == ESP_OK) {
         *dst_out_size = jpeg_codeced_size;
     }
@@ -164,24 +398,98 @@ static esp_err_t jpeg_video_m2m_process(struct esp_video *video, uint8_t *src, u
     return ret;
 }
 
-static esp_err_t jpeg_video_init(struct esp_video *video)
+static esp_err_t jpeg_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
 {
-    esp_err_t ret;
     struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
 
-    if (!jpeg_video->jpeg_inited) {
-        jpeg_encode_engine_cfg_t encode_eng_cfg = {
-            .intr_priority = 0,
-            .timeout_ms = 40,
-        };
+    if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
+            (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
+        ESP_LOGE(TAG, "capture and output width or height is invalid");
+        return ESP_ERR_INVALID_ARG;
+    }
 
-        ret = jpeg_new_encoder_engine(&encode_eng_cfg, &jpeg_video->enc_handle);
+    return jpeg_encode_frame(video, jpeg_video, src, src_size, dst, dst_size, dst_out_size);
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+/**
+ * Fill one capture buffer with the next chunk of JPEG frame, a new frame is encoded
+ * only after all chunks of the previous one are dequeued. If encoding fails, an empty
+ * buffer marked by V4L2_BUF_FLAG_ERROR ends the frame.
+ */
+static esp_err_t jpeg_video_chunk_output_process(struct esp_video *video, struct jpeg_video *jpeg_video)
+{
+    esp_err_t ret = ESP_OK;
+    uint32_t size;
+    struct esp_video_buffer_element *src_element;
+    struct esp_video_buffer_element *dst_element;
+
+    dst_element = esp_video_get_queued_element(video, V4L2_BUF_TYPE_VIDEO_CAPTURE);
+    if (!dst_element) {
+        ESP_LOGE(TAG, "no valid buffer");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (jpeg_video->frame_pos >= jpeg_video->frame_size) {
+        src_element = esp_video_get_queued_element(video, V4L2_BUF_TYPE_VIDEO_OUTPUT);
+        if (!src_element) {
+            ESP_LOGE(TAG, "no valid buffer");
+            esp_video_queue_element(video, V4L2_BUF_TYPE_VIDEO_CAPTURE, dst_element);
+            return ESP_ERR_INVALID_STATE;
+        }
+
+        jpeg_video->frame_size = 0;
+        jpeg_video->frame_pos = 0;
+        ret = jpeg_encode_frame(video, jpeg_video, ELEMENT_BUFFER(src_element), src_element->valid_size,
+                                jpeg_video->frame_buffer, jpeg_video->frame_buffer_size, &jpeg_video->frame_size);
         if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "failed to create JPEG encoder");
-            return ret;
+            ESP_LOGE(TAG, "failed to encode frame ret=%x", ret);
+            jpeg_video->frame_size = 0;
+        }
+
+        ESP_RETURN_ON_ERROR(esp_video_done_element(video, V4L2_BUF_TYPE_VIDEO_OUTPUT, src_element),
+                            TAG, "failed to put element back into done list");
+    }
+
+    if (jpeg_video->frame_pos < jpeg_video->frame_size) {
+        size = MIN(jpeg_video->frame_size - jpeg_video->frame_pos, ELEMENT_SIZE(dst_element));
+        memcpy(ELEMENT_BUFFER(dst_element), jpeg_video->frame_buffer + jpeg_video->frame_pos, size);
+        jpeg_video->frame_pos += size;
+
+        dst_element->valid_size = size;
+        if (jpeg_video->frame_pos == jpeg_video->frame_size) {
+            dst_element->flags = V4L2_BUF_FLAG_ESP_FRAME_END;
+        }
+    } else {
+        dst_element->valid_size = 0;
+        if (ret != ESP_OK) {
+            dst_element->flags = V4L2_BUF_FLAG_ERROR | V4L2_BUF_FLAG_ESP_FRAME_END;
         }
     }
 
+    ESP_RETURN_ON_ERROR(esp_video_done_element(video, V4L2_BUF_TYPE_VIDEO_CAPTURE, dst_element),
+                        TAG, "failed to put element back into done list");
+
+    return ESP_OK;
+}
+#endif
+
+static esp_err_t jpeg_video_init(struct esp_video *video)
+{
+    esp_err_t ret;
+    struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
+
+    esp_video_jpeg_engine_client_config_t client_cfg = {
+        .priority = jpeg_video->engine_priority,
+        .enc_handle = jpeg_video->enc_handle,
+    };
+
+    ret = esp_video_jpeg_engine_client_create(&client_cfg, &jpeg_video->engine_client);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to create JPEG engine client");
+        return ret;
+    }
+
     M2M_VIDEO_SET_CAPTURE_FORMAT(video, JPEG_VIDEO_MIN_WIDTH, JPEG_VIDEO_MIN_HEIGHT, V4L2_PIX_FMT_JPEG);
     M2M_VIDEO_SET_OUTPUT_FORMAT(video, JPEG_VIDEO_MIN_WIDTH, JPEG_VIDEO_MIN_HEIGHT, V4L2_PIX_FMT_RGB565);
 
@@ -193,32 +501,100 @@ static esp_err_t jpeg_video_deinit(struct esp_video *video)
     esp_err_t ret;
     struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
 
-    if (!jpeg_video->jpeg_inited) {
-        ret = jpeg_del_encoder_engine(jpeg_video->enc_handle);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "failed to delete JPEG encoder");
-            return ret;
-        }
-
-        jpeg_video->enc_handle = NULL;
+    ret = esp_video_jpeg_engine_client_delete(jpeg_video->engine_client);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "failed to delete JPEG engine client");
+        return ret;
     }
 
+    jpeg_video->engine_client = NULL;
+
     return ESP_OK;
 }
 
 static esp_err_t jpeg_video_start(struct esp_video *video, uint32_t type)
 {
+    struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
+
     if ((M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_WIDTH(video)) ||
             (M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video) != M2M_VIDEO_GET_OUTPUT_FORMAT_HEIGHT(video))) {
         ESP_LOGE(TAG, "width or height is invalid");
         return ESP_ERR_INVALID_ARG;
     }
 
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        jpeg_video->target_quality = jpeg_video->image_quality;
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+        uint32_t frame_size = M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) * M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video);
+
+        /**
+         * Only estimated capture buffer needs it, and chunk output encodes a whole frame into
+         * frame buffer, so it never overflows.
+         */
+        if (jpeg_video->size_estimated && !JPEG_VIDEO_CHUNK_OUTPUT(jpeg_video) &&
+                M2M_VIDEO_CAPTURE_BUF_SIZE(video) < frame_size) {
+            size_t allocated_size;
+            jpeg_encode_memory_alloc_cfg_t mem_cfg = {
+                .buffer_direction = JPEG_ENC_ALLOC_OUTPUT_BUFFER,
+            };
+
+            /* Same as the default capture buffer size */
+            jpeg_video->reserve_buffer = jpeg_alloc_encoder_mem(frame_size, &mem_cfg, &allocated_size);
+            if (!jpeg_video->reserve_buffer) {
+                ESP_LOGE(TAG, "failed to malloc reserve buffer");
+                return ESP_ERR_NO_MEM;
+            }
+
+            jpeg_video->reserve_buffer_size = allocated_size;
+        }
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+        if (jpeg_video->chunk_output) {
+            size_t allocated_size;
+            jpeg_encode_memory_alloc_cfg_t mem_cfg = {
+                .buffer_direction = JPEG_ENC_ALLOC_OUTPUT_BUFFER,
+            };
+
+            /* Same as the default capture buffer size of a whole frame */
+            jpeg_video->frame_buffer = jpeg_alloc_encoder_mem(M2M_VIDEO_GET_CAPTURE_FORMAT_WIDTH(video) *
+                                                              M2M_VIDEO_GET_CAPTURE_FORMAT_HEIGHT(video),
+                                                              &mem_cfg, &allocated_size);
+            if (!jpeg_video->frame_buffer) {
+                ESP_LOGE(TAG, "failed to malloc frame buffer");
+                return ESP_ERR_NO_MEM;
+            }
+
+            jpeg_video->frame_buffer_size = allocated_size;
+            jpeg_video->frame_size = 0;
+            jpeg_video->frame_pos = 0;
+        }
+#endif
+    }
+
     return ESP_OK;
 }
 
 static esp_err_t jpeg_video_stop(struct esp_video *video, uint32_t type)
 {
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT || CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
+
+    if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+        heap_caps_free(jpeg_video->frame_buffer);
+        jpeg_video->frame_buffer = NULL;
+        jpeg_video->frame_size = 0;
+        jpeg_video->frame_pos = 0;
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+        heap_caps_free(jpeg_video->reserve_buffer);
+        jpeg_video->reserve_buffer = NULL;
+#endif
+    }
+#endif
+
     return ESP_OK;
 }
 
@@ -259,6 +635,9 @@ static esp_err_t jpeg_video_set_format(struct esp_video *video, const struct v4l
     esp_err_t ret;
     const struct v4l2_pix_format *pix = &format->fmt.pix;
     struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    struct v4l2_format estimated_format;
+#endif
 
     if (format->type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
         /**
@@ -270,6 +649,15 @@ static esp_err_t jpeg_video_set_format(struct esp_video *video, const struct v4l
             ESP_LOGE(TAG, "pixel format or width or height is invalid");
             return ESP_ERR_INVALID_ARG;
         }
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+        jpeg_video->size_estimated = !pix->sizeimage;
+        if (jpeg_video->size_estimated) {
+            estimated_format = *format;
+            estimated_format.fmt.pix.sizeimage = jpeg_estimate_frame_size(jpeg_video, pix->width, pix->height);
+            format = &estimated_format;
+        }
+#endif
     } else if (format->type == V4L2_BUF_TYPE_VIDEO_OUTPUT) {
         uint8_t input_bpp;
 
@@ -303,10 +691,19 @@ static esp_err_t jpeg_video_notify(struct esp_video *video, enum esp_video_event
         uint32_t type = *(uint32_t *)arg;
 
         if (type == V4L2_BUF_TYPE_VIDEO_CAPTURE) {
-            ret = esp_video_m2m_process(video,
-                                        V4L2_BUF_TYPE_VIDEO_OUTPUT,
-                                        V4L2_BUF_TYPE_VIDEO_CAPTURE,
-                                        jpeg_video_m2m_process);
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+            struct jpeg_video *jpeg_video = VIDEO_PRIV_DATA(struct jpeg_video *, video);
+
+            if (jpeg_video->chunk_output) {
+                ret = jpeg_video_chunk_output_process(video, jpeg_video);
+            } else
+#endif
+            {
+                ret = esp_video_m2m_process(video,
+                                            V4L2_BUF_TYPE_VIDEO_OUTPUT,
+                                            V4L2_BUF_TYPE_VIDEO_CAPTURE,
+                                            jpeg_video_m2m_process);
+            }
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "failed to process M2M device data");
                 return ret;
@@ -331,7 +728,41 @@ static esp_err_t jpeg_video_set_ext_ctrl(struct esp_video *video, const struct v
             break;
         case V4L2_CID_JPEG_COMPRESSION_QUALITY:
             jpeg_video->image_quality = ctrl->value;
+            jpeg_video->target_quality = ctrl->value;
+            break;
+        case V4L2_CID_JPEG_ESP_TARGET_SIZE:
+            if (ctrl->value < 0 || ctrl->value > JPEG_VIDEO_MAX_TARGET_SIZE) {
+                ESP_LOGE(TAG, "target size is out of range");
+                return ESP_ERR_INVALID_ARG;
+            }
+
+            jpeg_video->target_size = ctrl->value;
+            jpeg_video->target_quality = jpeg_video->image_quality;
+            break;
+        case V4L2_CID_JPEG_ESP_ENGINE_PRIORITY:
+            if (ctrl->value < 0 || ctrl->value > ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX) {
+                ESP_LOGE(TAG, "engine priority is out of range");
+                return ESP_ERR_INVALID_ARG;
+            }
+
+            if (jpeg_video->engine_client) {
+                ret = esp_video_jpeg_engine_client_set_priority(jpeg_video->engine_client, ctrl->value);
+                if (ret != ESP_OK) {
+                    return ret;
+                }
+            }
+            jpeg_video->engine_priority = ctrl->value;
             break;
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+        case V4L2_CID_JPEG_ESP_CHUNK_OUTPUT:
+            if (jpeg_video->frame_buffer) {
+                ESP_LOGE(TAG, "chunk output can't be changed when encoder is started");
+                return ESP_ERR_INVALID_STATE;
+            }
+
+            jpeg_video->chunk_output = ctrl->value != 0;
+            break;
+#endif
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
             ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
@@ -355,8 +786,24 @@ static esp_err_t jpeg_video_get_ext_ctrl(struct esp_video *video, struct v4l2_ex
             ctrl->value = jpeg_video->sub_sample;
             break;
         case V4L2_CID_JPEG_COMPRESSION_QUALITY:
-            ctrl->value = jpeg_video->image_quality;
+            ctrl->value = jpeg_video->target_size ? jpeg_video->target_quality : jpeg_video->image_quality;
+            break;
+        case V4L2_CID_JPEG_ESP_TARGET_SIZE:
+            ctrl->value = jpeg_video->target_size;
             break;
+        case V4L2_CID_JPEG_ESP_ENGINE_PRIORITY:
+            ctrl->value = jpeg_video->engine_priority;
+            break;
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+        case V4L2_CID_JPEG_ESP_OVERFLOW_FRAMES:
+            ctrl->value = jpeg_video->overflow_frames;
+            break;
+#endif
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+        case V4L2_CID_JPEG_ESP_CHUNK_OUTPUT:
+            ctrl->value = jpeg_video->chunk_output;
+            break;
+#endif
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
             ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
@@ -389,8 +836,8 @@ static const struct esp_video_ops s_jpeg_video_ops = {
  * @brief Create JPEG encoder video device
  *
  * @param enc_handle JPEG encoder driver handle,
- *      - NULL, JPEG video device will create JPEG encoder driver handle by itself
- *      - Not null, JPEG video device will use this handle instead of creating JPEG encoder driver handle
+ *      - NULL, the shared JPEG engine will create JPEG encoder driver handle by itself
+ *      - Not null, the shared JPEG engine will use this handle instead of creating JPEG encoder driver handle
  *
  * @return
  *      - ESP_OK on success
@@ -408,12 +855,11 @@ esp_err_t esp_video_create_jpeg_enc_video_device(jpeg_encoder_handle_t enc_handl
         return ESP_ERR_NO_MEM;
     }
 
-    if (enc_handle) {
-        jpeg_video->jpeg_inited = true;
-        jpeg_video->enc_handle = enc_handle;
-    }
+    jpeg_video->enc_handle = enc_handle;
+    jpeg_video->engine_priority = ESP_VIDEO_JPEG_ENGINE_PRIORITY_DEFAULT;
     jpeg_video->sub_sample = JPEG_VIDEO_CHROMA_SUBSAMPLING;
     jpeg_video->image_quality = JPEG_VIDEO_COMP_QUALITY;
+    jpeg_video->target_quality = JPEG_VIDEO_COMP_QUALITY;
 
     video = esp_video_create(JPEG_NAME, ESP_VIDEO_JPEG_DEVICE_ID, &s_jpeg_video_ops, jpeg_video, caps, device_caps);
     if (!video) {
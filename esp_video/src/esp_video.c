@@ -11,6 +11,7 @@
 #include "esp_check.h"
 #include "esp_memory_utils.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "esp_video.h"
 #include "esp_video_vfs.h"
 #include "esp_video_device.h"
@@ -115,6 +116,17 @@ const char *esp_video_usb_uvc_device_name[] = {
     ESP_VIDEO_USB_UVC_NAME(9),
 };
 
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+/* Frame size of ZSL ring is the buffer size, so the ring is released together with buffers, video->mutex must be held */
+static void esp_video_release_stream_zsl(struct esp_video_stream *stream)
+{
+    if (stream->zsl) {
+        esp_video_zsl_release(stream->zsl);
+        stream->zsl = NULL;
+    }
+}
+#endif
+
 static void esp_video_release_stream_buffer(struct esp_video_stream *stream)
 {
     if (!stream) {
@@ -308,6 +320,31 @@ struct esp_video *esp_video_device_get_object(const char *name)
     return NULL;
 }
 
+/**
+ * @brief Get video object by VFS path
+ *
+ * @param path The video device VFS path, e.g. "/dev/video0"
+ *
+ * @return Video object pointer if found by path
+ */
+struct esp_video *esp_video_device_get_object_by_path(const char *path)
+{
+    struct esp_video *video;
+    char vfs_path[16];
+
+    _lock_acquire(&s_video_lock);
+    SLIST_FOREACH(video, &s_video_list, node) {
+        snprintf(vfs_path, sizeof(vfs_path), "/dev/video%d", video->id);
+        if (!strcmp(vfs_path, path)) {
+            _lock_release(&s_video_lock);
+            return video;
+        }
+    }
+
+    _lock_release(&s_video_lock);
+    return NULL;
+}
+
 #if CONFIG_ESP_VIDEO_CHECK_PARAMETERS
 /**
  * @brief Check if video is valid
@@ -629,6 +666,9 @@ esp_err_t esp_video_close(struct esp_video *video)
                 int stream_count = video->caps & V4L2_CAP_VIDEO_M2M ? 2 : 1;
 
                 for (int i = 0; i < stream_count; i++) {
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+                    esp_video_release_stream_zsl(&video->stream[i]);
+#endif
                     esp_video_release_stream_buffer(&video->stream[i]);
                 }
 
@@ -686,6 +726,7 @@ esp_err_t esp_video_start_capture(struct esp_video *video, uint32_t type)
         for (int i = 0; i < stream_count; i++) {
             struct esp_video_stream *stream = &video->stream[i];
             stream->param.skip_count = 0;
+            stream->param.sequence = 0;
         }
 
         ret = video->ops->start(video, type);
@@ -862,6 +903,14 @@ esp_err_t esp_video_set_format(struct esp_video *video, const struct v4l2_format
         memcpy(&stream->format, format, sizeof(struct v4l2_format));
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+    /* Buffer size of frames compressed by M2M encoders may be estimated by the video device, so report it */
+    if ((video->caps & V4L2_CAP_VIDEO_M2M) && format->type == V4L2_BUF_TYPE_VIDEO_CAPTURE &&
+            (format->fmt.pix.pixelformat == V4L2_PIX_FMT_JPEG || format->fmt.pix.pixelformat == V4L2_PIX_FMT_H264)) {
+        stream->format.fmt.pix.sizeimage = STREAM_BUFFER_SIZE(stream);
+    }
+#endif
+
     return ESP_OK;
 }
 
@@ -902,6 +951,12 @@ esp_err_t esp_video_setup_buffer(struct esp_video *video, uint32_t type, uint32_
         return ESP_ERR_INVALID_STATE;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+    xSemaphoreTake(video->mutex, portMAX_DELAY);
+    esp_video_release_stream_zsl(stream);
+    xSemaphoreGive(video->mutex);
+#endif
+
     esp_video_release_stream_buffer(stream);
 
     info->count = count;
@@ -949,6 +1004,12 @@ esp_err_t esp_video_release_buffer(struct esp_video *video, uint32_t type)
         return ESP_ERR_INVALID_STATE;
     }
 
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+    xSemaphoreTake(video->mutex, portMAX_DELAY);
+    esp_video_release_stream_zsl(stream);
+    xSemaphoreGive(video->mutex);
+#endif
+
     esp_video_release_stream_buffer(stream);
     return ESP_OK;
 }
@@ -1078,6 +1139,7 @@ struct esp_video_buffer_element *esp_video_get_done_element(struct esp_video *vi
 esp_err_t IRAM_ATTR esp_video_done_element(struct esp_video *video, uint32_t type, struct esp_video_buffer_element *element)
 {
     struct esp_video_stream *stream;
+    int64_t timestamp = esp_timer_get_time();
 
     stream = esp_video_get_stream(video, type);
     if (!stream) {
@@ -1090,6 +1152,8 @@ esp_err_t IRAM_ATTR esp_video_done_element(struct esp_video *video, uint32_t typ
         return ESP_ERR_INVALID_ARG;
     }
 
+    element->timestamp = timestamp;
+    element->sequence = stream->param.sequence++;
     ELEMENT_SET_ALLOCATED(element);
     TAILQ_INSERT_TAIL(&stream->done_list, element, node);
     portEXIT_CRITICAL_SAFE(&video->stream_lock);
@@ -1171,6 +1235,7 @@ esp_err_t esp_video_queue_element(struct esp_video *video, uint32_t type, struct
         return ESP_ERR_INVALID_ARG;
     }
 
+    element->flags = 0;
     ELEMENT_SET_ALLOCATED(element);
     TAILQ_INSERT_TAIL(&stream->queued_list, element, node);
     portEXIT_CRITICAL_SAFE(&video->stream_lock);
@@ -1553,12 +1618,134 @@ struct esp_video_buffer_element *esp_video_clone_element(struct esp_video *video
     new_element = esp_video_get_done_element(video, type);
     if (new_element) {
         new_element->valid_size = element->valid_size;
+        new_element->timestamp = element->timestamp;
+        new_element->sequence = element->sequence;
         memcpy(new_element->buffer, element->buffer, element->valid_size);
     }
 
     return new_element;
 }
 
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+/**
+ * @brief Set zero shutter lag ring of video stream.
+ *
+ * @param video Video object
+ * @param ring  Zero shutter lag ring configuration
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_set_zsl_ring(struct esp_video *video, const struct v4l2_zsl_ring *ring)
+{
+    esp_err_t ret = ESP_OK;
+    struct esp_video_stream *stream;
+
+    if (ring->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stream = esp_video_get_stream(video, ring->type);
+    if (!stream) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(video->mutex, portMAX_DELAY);
+
+    esp_video_release_stream_zsl(stream);
+
+    if (ring->count) {
+        if (!stream->buf_info.count || !stream->buf_info.size) {
+            ESP_LOGE(TAG, "ZSL ring requires buffers");
+            ret = ESP_ERR_INVALID_STATE;
+        } else {
+            stream->zsl = esp_video_zsl_create(ring->count, stream->buf_info.size);
+            if (!stream->zsl) {
+                ret = ESP_ERR_NO_MEM;
+            }
+        }
+    }
+
+    xSemaphoreGive(video->mutex);
+
+    return ret;
+}
+
+/**
+ * @brief Copy a frame done before the trigger time out of zero shutter lag ring.
+ *
+ * @param video Video object
+ * @param frame Zero shutter lag frame request
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_get_zsl_frame(struct esp_video *video, struct v4l2_zsl_frame *frame)
+{
+    esp_err_t ret;
+    struct esp_video_stream *stream;
+
+    if (frame->type != V4L2_BUF_TYPE_VIDEO_CAPTURE || !frame->buffer) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    stream = esp_video_get_stream(video, frame->type);
+    if (!stream) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    xSemaphoreTake(video->mutex, portMAX_DELAY);
+    if (stream->zsl) {
+        ret = esp_video_zsl_get_frame(stream->zsl, frame);
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreGive(video->mutex);
+
+    return ret;
+}
+
+/**
+ * @brief Record a dequeued frame into zero shutter lag ring if the ring is enabled.
+ *
+ * @param video   Video object
+ * @param type    Video stream type
+ * @param element Video buffer element of the frame
+ *
+ * @return None
+ */
+void esp_video_record_zsl_frame(struct esp_video *video, uint32_t type, const struct esp_video_buffer_element *element)
+{
+    struct esp_video_zsl *zsl;
+    struct esp_video_zsl_frame *frame = NULL;
+    struct esp_video_stream *stream = esp_video_get_stream(video, type);
+
+    if (!stream || !stream->zsl) {
+        return;
+    }
+
+    xSemaphoreTake(video->mutex, portMAX_DELAY);
+    zsl = stream->zsl;
+    if (zsl) {
+        frame = esp_video_zsl_record_start(zsl, element);
+    }
+    xSemaphoreGive(video->mutex);
+
+    if (!frame) {
+        return;
+    }
+
+    /* Copying a whole frame to PSRAM takes long, so it doesn't block other operations of the video device */
+    memcpy(frame->buffer, element->buffer, element->valid_size);
+
+    xSemaphoreTake(video->mutex, portMAX_DELAY);
+    esp_video_zsl_record_done(zsl, frame, element);
+    xSemaphoreGive(video->mutex);
+}
+#endif
+
 /**
  * @brief Get buffer type from video
  *
@@ -2498,6 +2685,43 @@ esp_err_t esp_video_get_event(struct esp_video *video, struct v4l2_event *event)
     return ESP_OK;
 }
 
+/**
+ * @brief Send an event to video event queue if its type is subscribed, this is called in task context
+ *
+ * @param video     Video object
+ * @param event     Event buffer pointer, "timestamp" is set by this function
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NOT_FOUND if event type is not subscribed
+ *      - Others if failed
+ */
+esp_err_t esp_video_queue_event(struct esp_video *video, struct v4l2_event *event)
+{
+    int64_t timestamp;
+
+    CHECK_VIDEO_OBJ(video);
+
+    if (!event) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!video->event_queue || (video->event_sub.type != event->type)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    timestamp = esp_timer_get_time();
+    event->timestamp.tv_sec = timestamp / 1000000;
+    event->timestamp.tv_nsec = timestamp % 1000000 * 1000;
+
+    if (xQueueSend(video->event_queue, event, 0) != pdPASS) {
+        ESP_LOGD(TAG, "failed to send event to event queue");
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
 /**
  * @brief Restart video hardware
  *
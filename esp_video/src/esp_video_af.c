@@ -0,0 +1,269 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <string.h>
+#include "esp_video_af.h"
+
+/**
+ * Coarse scan stops after definition keeps dropping for this number of positions, one
+ * dropped position may be caused by noise
+ */
+#define AF_DROP_POSITIONS       2
+
+#define AF_ABS(x)               ((x) < 0 ? -(x) : (x))
+
+static bool af_value_changed(uint32_t cur, uint32_t ref, uint8_t percent)
+{
+    uint32_t diff = cur > ref ? cur - ref : ref - cur;
+
+    return (uint64_t)diff * 100 > (uint64_t)ref * percent;
+}
+
+static void af_lock(esp_video_af_t *af)
+{
+    af->state = af->best_def ? ESP_VIDEO_AF_STATE_LOCKED : ESP_VIDEO_AF_STATE_FAILED;
+    af->target = af->best_pos;
+    af->lock_def = 0;
+    af->change_count = 0;
+}
+
+/**
+ * Select the next hill climbing position from "from", the search is limited to one coarse
+ * interval around the coarse peak, because positions out of it have been scanned
+ */
+static bool af_fine_next(esp_video_af_t *af, int32_t from)
+{
+    int32_t next = from + af->dir * (int32_t)af->config.fine_step;
+
+    if ((next < af->config.min_pos) || (next > af->config.max_pos) ||
+            (AF_ABS(next - af->coarse_pos) >= af->coarse_interval)) {
+        return false;
+    }
+
+    af->target = next;
+    return true;
+}
+
+static void af_process_coarse(esp_video_af_t *af, uint32_t definition)
+{
+    int32_t end = af->dir > 0 ? af->config.max_pos : af->config.min_pos;
+
+    if (definition > af->best_def) {
+        af->best_def = definition;
+        af->best_pos = af->target;
+        af->drop_count = 0;
+    } else if (af_value_changed(definition, af->best_def, af->config.drop_percent)) {
+        af->drop_count++;
+    }
+
+    if ((af->target != end) && (af->drop_count < AF_DROP_POSITIONS)) {
+        int32_t next = af->target + af->dir * af->coarse_interval;
+
+        af->target = af->dir > 0 ? (next > end ? end : next) : (next < end ? end : next);
+        return;
+    }
+
+    if (!af->best_def) {
+        af_lock(af);
+        return;
+    }
+
+    /* The position after the peak in scan direction is the most likely side of the real peak */
+    af->state = ESP_VIDEO_AF_STATE_FINE;
+    af->coarse_pos = af->best_pos;
+    af->reversed = false;
+    af->climbed = false;
+    if (!af_fine_next(af, af->best_pos)) {
+        af->reversed = true;
+        af->dir = -af->dir;
+        if (!af_fine_next(af, af->best_pos)) {
+            af_lock(af);
+        }
+    }
+}
+
+static void af_process_fine(esp_video_af_t *af, uint32_t definition)
+{
+    if (definition > af->best_def) {
+        af->best_def = definition;
+        af->best_pos = af->target;
+        af->climbed = true;
+        if (af_fine_next(af, af->target)) {
+            return;
+        }
+    } else if (!af->climbed && !af->reversed) {
+        af->reversed = true;
+        af->dir = -af->dir;
+        if (af_fine_next(af, af->best_pos)) {
+            return;
+        }
+    }
+
+    af_lock(af);
+}
+
+static void af_process_locked(esp_video_af_t *af, uint32_t definition)
+{
+    if (!af->lock_def) {
+        af->lock_def = definition ? definition : 1;
+        return;
+    }
+
+    if (af->config.refocus_frames && af_value_changed(definition, af->lock_def, af->config.refocus_percent)) {
+        if (++af->change_count >= af->config.refocus_frames) {
+            esp_video_af_start(af);
+        }
+    } else {
+        af->change_count = 0;
+    }
+}
+
+/**
+ * @brief Initialize auto focus object.
+ *
+ * @param af     Auto focus object pointer
+ * @param config Auto focus configuration
+ * @param pos    Current lens position
+ *
+ * @return None
+ */
+void esp_video_af_init(esp_video_af_t *af, const esp_video_af_config_t *config, int32_t pos)
+{
+    memset(af, 0, sizeof(esp_video_af_t));
+
+    af->config = *config;
+    if (af->config.coarse_steps < 2) {
+        af->config.coarse_steps = 2;
+    }
+    if (!af->config.fine_step) {
+        af->config.fine_step = 1;
+    }
+    if (!af->config.codes_per_step) {
+        af->config.codes_per_step = 1;
+    }
+
+    af->state = ESP_VIDEO_AF_STATE_IDLE;
+    af->pos = pos;
+    af->target = pos;
+}
+
+/**
+ * @brief Start or restart focus search, the search runs in the following esp_video_af_process() calls.
+ *
+ * @param af Auto focus object pointer
+ *
+ * @return None
+ */
+void esp_video_af_start(esp_video_af_t *af)
+{
+    const esp_video_af_config_t *config = &af->config;
+    int32_t range = config->max_pos - config->min_pos;
+
+    af->coarse_interval = range / (int32_t)(config->coarse_steps - 1);
+    if (af->coarse_interval < 1) {
+        af->coarse_interval = 1;
+    }
+
+    /* Scan from the nearest end of the lens range, so the first move is short */
+    af->dir = (af->pos - config->min_pos) <= (config->max_pos - af->pos) ? 1 : -1;
+    af->target = af->dir > 0 ? config->min_pos : config->max_pos;
+
+    af->state = ESP_VIDEO_AF_STATE_COARSE;
+    af->best_pos = af->target;
+    af->best_def = 0;
+    af->drop_count = 0;
+    af->moves = 0;
+    af->frames = 0;
+    af->discarded = 0;
+}
+
+/**
+ * @brief Process the focus definition of one statistics frame.
+ *
+ * Frames whose exposure may overlap with a lens move or its ringing are discarded, so
+ * only definitions of a still lens drive the search.
+ *
+ * @param af         Auto focus object pointer
+ * @param definition Sum of AF statistics definition
+ * @param time_us    Time of statistics frame end in microseconds
+ * @param pos        Lens position to move to
+ *
+ * @return true if the lens should move to "pos", false if not
+ */
+bool esp_video_af_process(esp_video_af_t *af, uint32_t definition, int64_t time_us, int32_t *pos)
+{
+    bool searching = (af->state == ESP_VIDEO_AF_STATE_COARSE) || (af->state == ESP_VIDEO_AF_STATE_FINE);
+
+    if (af->stats_time && (time_us > af->stats_time)) {
+        int64_t period = time_us - af->stats_time;
+
+        af->frame_period = af->frame_period ? (af->frame_period * 3 + period) / 4 : period;
+    }
+    af->stats_time = time_us;
+
+    if ((af->state == ESP_VIDEO_AF_STATE_IDLE) || (af->state == ESP_VIDEO_AF_STATE_FAILED)) {
+        return false;
+    }
+
+    if (searching) {
+        af->frames++;
+    }
+
+    if (af->pos != af->target) {
+        *pos = af->target;
+        return true;
+    }
+
+    /* Statistics frame is exposed in one frame period before its end, lens must be still in whole period */
+    if (time_us - af->frame_period < af->settle_time) {
+        if (searching) {
+            af->discarded++;
+        }
+        return false;
+    }
+
+    switch (af->state) {
+    case ESP_VIDEO_AF_STATE_COARSE:
+        af_process_coarse(af, definition);
+        break;
+    case ESP_VIDEO_AF_STATE_FINE:
+        af_process_fine(af, definition);
+        break;
+    case ESP_VIDEO_AF_STATE_LOCKED:
+        af_process_locked(af, definition);
+        break;
+    default:
+        break;
+    }
+
+    if (af->pos != af->target) {
+        *pos = af->target;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Tell auto focus object that lens starts moving, the lens settle time is calculated from
+ *        the start time, motor step period and move distance.
+ *
+ * @param af            Auto focus object pointer
+ * @param pos           Lens target position
+ * @param start_time_us Time of lens starts moving in microseconds
+ *
+ * @return None
+ */
+void esp_video_af_moved(esp_video_af_t *af, int32_t pos, int64_t start_time_us)
+{
+    const esp_video_af_config_t *config = &af->config;
+    uint32_t distance = AF_ABS(pos - af->pos);
+    uint32_t steps = (distance + config->codes_per_step - 1) / config->codes_per_step;
+
+    af->settle_time = start_time_us + (int64_t)steps * config->period_in_us + config->settle_us;
+    af->pos = pos;
+    af->moves++;
+}
@@ -0,0 +1,524 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "driver/ppa.h"
+#include "linux/videodev2.h"
+#include "esp_video_ioctl.h"
+#include "esp_video_dual_stream.h"
+
+#define DUAL_STREAM_TASK_NAME           "dual_stream"
+#define DUAL_STREAM_TASK_STACK_SIZE     4096
+#define DUAL_STREAM_TASK_PRIORITY       5
+
+/* PPA scaling factor precision */
+#define DUAL_STREAM_SCALE_STEPS         16
+
+typedef struct dual_stream_encoder {
+    int fd;
+    uint32_t memory;                    /*!< Memory type of encoder input buffer */
+    uint8_t *input_buffer;              /*!< Encoder input buffer of V4L2_MEMORY_MMAP */
+    uint32_t input_length;
+    uint8_t *output_buffer;             /*!< Encoded frame buffer */
+} dual_stream_encoder_t;
+
+typedef struct esp_video_dual_stream {
+    dual_stream_encoder_t main;
+    dual_stream_encoder_t sub;
+    uint32_t frame_size;
+    uint32_t sub_frame_size;
+    uint8_t sub_interval;
+    esp_video_dual_stream_cb_t cb;
+    void *user_data;
+
+    ppa_client_handle_t ppa;
+    ppa_srm_oper_config_t srm;          /*!< Only input buffer changes from frame to frame */
+
+    TaskHandle_t task;
+    SemaphoreHandle_t sub_ready;        /*!< Given when a scaled frame is queued to sub stream encoder */
+    SemaphoreHandle_t sub_idle;         /*!< Given when sub stream task can take a new frame */
+    SemaphoreHandle_t sub_exit;         /*!< Given when sub stream task exits */
+    bool stop;
+
+    esp_video_dual_stream_stats_t stats;
+    uint32_t sub_errors;                /*!< Errors of sub stream task, they are counted apart to avoid locking */
+} esp_video_dual_stream_t;
+
+static const char *TAG = "dual_stream";
+
+static esp_err_t dual_stream_get_frame_format(uint32_t pixel_format, uint32_t *bpp, ppa_srm_color_mode_t *color_mode, uint32_t *align)
+{
+    switch (pixel_format) {
+    case V4L2_PIX_FMT_YUV420:
+        /* PPA YUV420 is ISP output and H.264 encoder input layout, size and offset must be even */
+        *bpp = 12;
+        *color_mode = PPA_SRM_COLOR_MODE_YUV420;
+        *align = 2;
+        break;
+    case V4L2_PIX_FMT_RGB565:
+        *bpp = 16;
+        *color_mode = PPA_SRM_COLOR_MODE_RGB565;
+        *align = 1;
+        break;
+    case V4L2_PIX_FMT_RGB24:
+        *bpp = 24;
+        *color_mode = PPA_SRM_COLOR_MODE_RGB888;
+        *align = 1;
+        break;
+    default:
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * Calculate PPA scaling factor in 1/DUAL_STREAM_SCALE_STEPS and source block which is scaled to
+ * exactly "dst" pixels. The factor is rounded up, so the block is a little smaller than "src"
+ * when the ratio is not a multiple of the precision, and it is put at the center.
+ */
+static esp_err_t dual_stream_calc_scale(uint32_t src, uint32_t dst, uint32_t align,
+                                        uint32_t *scale, uint32_t *block, uint32_t *offset)
+{
+    uint32_t steps = (dst * DUAL_STREAM_SCALE_STEPS + src - 1) / src;
+    uint32_t size = (dst * DUAL_STREAM_SCALE_STEPS + steps - 1) / steps;
+
+    size = (size + align - 1) / align * align;
+    for (int i = 0; i < 2; i++) {
+        if (size <= src && size * steps / DUAL_STREAM_SCALE_STEPS == dst) {
+            *scale = steps;
+            *block = size;
+            *offset = (src - size) / 2 / align * align;
+            return ESP_OK;
+        }
+
+        size -= align;
+    }
+
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+static esp_err_t dual_stream_init_encoder(dual_stream_encoder_t *encoder, const esp_video_dual_stream_encoder_t *config,
+        uint32_t width, uint32_t height, uint32_t pixel_format, uint32_t memory)
+{
+    int type;
+    struct v4l2_format format;
+    struct v4l2_requestbuffers req;
+    struct v4l2_buffer buf;
+
+    encoder->fd = config->fd;
+    encoder->memory = memory;
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = pixel_format;
+    ESP_RETURN_ON_FALSE(ioctl(encoder->fd, VIDIOC_S_FMT, &format) == 0, ESP_ERR_NOT_SUPPORTED, TAG, "failed to set encoder input format");
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = config->pixel_format;
+    ESP_RETURN_ON_FALSE(ioctl(encoder->fd, VIDIOC_S_FMT, &format) == 0, ESP_ERR_NOT_SUPPORTED, TAG, "failed to set encoder output format");
+
+    memset(&req, 0, sizeof(req));
+    req.count = 1;
+    req.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = memory;
+    ESP_RETURN_ON_FALSE(ioctl(encoder->fd, VIDIOC_REQBUFS, &req) == 0, ESP_FAIL, TAG, "failed to request encoder input buffer");
+
+    if (memory == V4L2_MEMORY_MMAP) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = 0;
+        ESP_RETURN_ON_FALSE(ioctl(encoder->fd, VIDIOC_QUERYBUF, &buf) == 0, ESP_FAIL, TAG, "failed to query encoder input buffer");
+
+        encoder->input_buffer = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, encoder->fd, buf.m.offset);
+        ESP_RETURN_ON_FALSE(encoder->input_buffer, ESP_ERR_NO_MEM, TAG, "failed to map encoder input buffer");
+        encoder->input_length = buf.length;
+    }
+
+    memset(&req, 0, sizeof(req));
+    req.count = 1;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    ESP_RETURN_ON_FALSE(ioctl(encoder->fd, VIDIOC_REQBUFS, &req) == 0, ESP_FAIL, TAG, "failed to request encoder output buffer");
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = 0;
+    ESP_RETURN_ON_FALSE(ioctl(encoder->fd, VIDIOC_QUERYBUF, &buf) == 0, ESP_FAIL, TAG, "failed to query encoder output buffer");
+
+    encoder->output_buffer = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, encoder->fd, buf.m.offset);
+    ESP_RETURN_ON_FALSE(encoder->output_buffer, ESP_ERR_NO_MEM, TAG, "failed to map encoder output buffer");
+    ESP_RETURN_ON_FALSE(ioctl(encoder->fd, VIDIOC_QBUF, &buf) == 0, ESP_FAIL, TAG, "failed to queue encoder output buffer");
+
+    type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ESP_RETURN_ON_FALSE(ioctl(encoder->fd, VIDIOC_STREAMON, &type) == 0, ESP_FAIL, TAG, "failed to start encoder output stream");
+    type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    ESP_RETURN_ON_FALSE(ioctl(encoder->fd, VIDIOC_STREAMON, &type) == 0, ESP_FAIL, TAG, "failed to start encoder input stream");
+
+    return ESP_OK;
+}
+
+static void dual_stream_deinit_encoder(dual_stream_encoder_t *encoder)
+{
+    int type;
+    struct v4l2_requestbuffers req;
+
+    if (encoder->fd < 0) {
+        return;
+    }
+
+    type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    ioctl(encoder->fd, VIDIOC_STREAMOFF, &type);
+    type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ioctl(encoder->fd, VIDIOC_STREAMOFF, &type);
+
+    memset(&req, 0, sizeof(req));
+    req.count = 0;
+    req.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = encoder->memory;
+    ioctl(encoder->fd, VIDIOC_REQBUFS, &req);
+
+    memset(&req, 0, sizeof(req));
+    req.count = 0;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    ioctl(encoder->fd, VIDIOC_REQBUFS, &req);
+
+    encoder->fd = -1;
+}
+
+/**
+ * Encode the frame queued to encoder input, the encoder works when its capture buffer is dequeued.
+ */
+static esp_err_t dual_stream_encode(esp_video_dual_stream_t *ds, dual_stream_encoder_t *encoder, esp_video_dual_stream_id_t id)
+{
+    esp_err_t ret = ESP_OK;
+    struct v4l2_buffer buf;
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (ioctl(encoder->fd, VIDIOC_DQBUF, &buf) != 0) {
+        ESP_LOGE(TAG, "failed to encode stream %d", id);
+        ret = ESP_FAIL;
+    } else {
+        if (!(buf.flags & V4L2_BUF_FLAG_ERROR) && ds->cb) {
+            ds->cb(ds->user_data, id, encoder->output_buffer, buf.bytesused, buf.flags);
+        }
+
+        if (ioctl(encoder->fd, VIDIOC_QBUF, &buf) != 0) {
+            ESP_LOGE(TAG, "failed to queue stream %d output buffer", id);
+            ret = ESP_FAIL;
+        }
+    }
+
+    /* Take input buffer back, it is done when the capture buffer is done */
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = encoder->memory;
+    if (ioctl(encoder->fd, VIDIOC_DQBUF, &buf) != 0) {
+        ESP_LOGE(TAG, "failed to dequeue stream %d input buffer", id);
+        ret = ESP_FAIL;
+    }
+
+    return ret;
+}
+
+static void dual_stream_task(void *arg)
+{
+    esp_video_dual_stream_t *ds = (esp_video_dual_stream_t *)arg;
+
+    while (1) {
+        xSemaphoreTake(ds->sub_ready, portMAX_DELAY);
+        if (ds->stop) {
+            break;
+        }
+
+        if (dual_stream_encode(ds, &ds->sub, ESP_VIDEO_DUAL_STREAM_SUB) == ESP_OK) {
+            ds->stats.sub_frames++;
+        } else {
+            ds->sub_errors++;
+        }
+
+        xSemaphoreGive(ds->sub_idle);
+    }
+
+    xSemaphoreGive(ds->sub_exit);
+    vTaskDelete(NULL);
+}
+
+/* Scale the frame into sub stream encoder input buffer and let sub stream task encode it */
+static esp_err_t dual_stream_start_sub(esp_video_dual_stream_t *ds, const uint8_t *frame)
+{
+    struct v4l2_buffer buf;
+
+    ds->srm.in.buffer = frame;
+    ESP_RETURN_ON_ERROR(ppa_do_scale_rotate_mirror(ds->ppa, &ds->srm), TAG, "failed to scale frame");
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = 0;
+    buf.bytesused = ds->sub_frame_size;
+    ESP_RETURN_ON_FALSE(ioctl(ds->sub.fd, VIDIOC_QBUF, &buf) == 0, ESP_FAIL, TAG, "failed to queue sub stream input buffer");
+
+    xSemaphoreGive(ds->sub_ready);
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Create dual stream object, it configures formats and buffers of both encoder video
+ *        devices and starts streaming of them.
+ *
+ * @param config Dual stream configuration
+ * @param handle Pointer to store dual stream handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NOT_SUPPORTED if pixel format or scaling ratio is not supported
+ *      - ESP_ERR_NO_MEM if failed to allocate memory
+ *      - Others if failed to configure encoder video devices or PPA
+ */
+esp_err_t esp_video_dual_stream_create(const esp_video_dual_stream_config_t *config, esp_video_dual_stream_handle_t *handle)
+{
+    esp_err_t ret;
+    uint32_t bpp;
+    uint32_t align;
+    uint32_t scale_x, scale_y;
+    uint32_t block_w, block_h;
+    uint32_t offset_x, offset_y;
+    ppa_srm_color_mode_t color_mode;
+    esp_video_dual_stream_t *ds;
+    ppa_client_config_t ppa_config = {
+        .oper_type = PPA_OPERATION_SRM,
+        .max_pending_trans_num = 1,
+    };
+
+    ESP_RETURN_ON_FALSE(config && handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->main.fd >= 0 && config->sub.fd >= 0 && config->main.fd != config->sub.fd,
+                        ESP_ERR_INVALID_ARG, TAG, "main and sub streams need two encoder video devices");
+    ESP_RETURN_ON_FALSE(config->sub_width && config->sub_height &&
+                        config->sub_width <= config->width && config->sub_height <= config->height,
+                        ESP_ERR_INVALID_ARG, TAG, "sub stream must not be larger than main stream");
+    ESP_RETURN_ON_ERROR(dual_stream_get_frame_format(config->pixel_format, &bpp, &color_mode, &align),
+                        TAG, "capture format is not supported");
+    ESP_RETURN_ON_FALSE(!(config->width % align) && !(config->height % align) &&
+                        !(config->sub_width % align) && !(config->sub_height % align),
+                        ESP_ERR_INVALID_ARG, TAG, "width and height must be even");
+    ESP_RETURN_ON_ERROR(dual_stream_calc_scale(config->width, config->sub_width, align, &scale_x, &block_w, &offset_x),
+                        TAG, "horizontal scaling ratio is not supported");
+    ESP_RETURN_ON_ERROR(dual_stream_calc_scale(config->height, config->sub_height, align, &scale_y, &block_h, &offset_y),
+                        TAG, "vertical scaling ratio is not supported");
+
+    ds = heap_caps_calloc(1, sizeof(esp_video_dual_stream_t), MALLOC_CAP_DEFAULT);
+    ESP_RETURN_ON_FALSE(ds, ESP_ERR_NO_MEM, TAG, "failed to malloc dual stream");
+    ds->main.fd = -1;
+    ds->sub.fd = -1;
+    ds->frame_size = config->width * config->height * bpp / 8;
+    ds->sub_frame_size = config->sub_width * config->sub_height * bpp / 8;
+    ds->sub_interval = config->sub_interval ? config->sub_interval : 1;
+    ds->cb = config->cb;
+    ds->user_data = config->user_data;
+
+    /* Main stream encoder reads capture buffers directly, and sub stream encoder owns its input buffer for PPA */
+    ESP_GOTO_ON_ERROR(dual_stream_init_encoder(&ds->main, &config->main, config->width, config->height,
+                                               config->pixel_format, V4L2_MEMORY_USERPTR),
+                      exit_0, TAG, "failed to initialize main stream encoder");
+    ESP_GOTO_ON_ERROR(dual_stream_init_encoder(&ds->sub, &config->sub, config->sub_width, config->sub_height,
+                                               config->pixel_format, V4L2_MEMORY_MMAP),
+                      exit_0, TAG, "failed to initialize sub stream encoder");
+    ESP_GOTO_ON_FALSE(ds->sub.input_length >= ds->sub_frame_size, ESP_ERR_INVALID_SIZE, exit_0, TAG,
+                      "sub stream encoder input buffer is too small");
+
+    ESP_GOTO_ON_ERROR(ppa_register_client(&ppa_config, &ds->ppa), exit_0, TAG, "failed to register PPA client");
+
+    ds->srm = (ppa_srm_oper_config_t) {
+        .in = {
+            .pic_w = config->width,
+            .pic_h = config->height,
+            .block_w = block_w,
+            .block_h = block_h,
+            .block_offset_x = offset_x,
+            .block_offset_y = offset_y,
+            .srm_cm = color_mode,
+        },
+        .out = {
+            .buffer = ds->sub.input_buffer,
+            .buffer_size = ds->sub.input_length,
+            .pic_w = config->sub_width,
+            .pic_h = config->sub_height,
+            .block_offset_x = 0,
+            .block_offset_y = 0,
+            .srm_cm = color_mode,
+        },
+        .rotation_angle = PPA_SRM_ROTATION_ANGLE_0,
+        .scale_x = (float)scale_x / DUAL_STREAM_SCALE_STEPS,
+        .scale_y = (float)scale_y / DUAL_STREAM_SCALE_STEPS,
+        .mode = PPA_TRANS_MODE_BLOCKING,
+    };
+    if (block_w != config->width || block_h != config->height) {
+        ESP_LOGW(TAG, "sub stream is scaled from %" PRIu32 "x%" PRIu32 " center block", block_w, block_h);
+    }
+
+    ds->sub_ready = xSemaphoreCreateBinary();
+    ds->sub_idle = xSemaphoreCreateBinary();
+    ds->sub_exit = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(ds->sub_ready && ds->sub_idle && ds->sub_exit, ESP_ERR_NO_MEM, exit_1, TAG, "failed to create semaphores");
+    xSemaphoreGive(ds->sub_idle);
+
+    ESP_GOTO_ON_FALSE(xTaskCreate(dual_stream_task, DUAL_STREAM_TASK_NAME, DUAL_STREAM_TASK_STACK_SIZE, ds,
+                                  config->sub_task_priority ? config->sub_task_priority : DUAL_STREAM_TASK_PRIORITY,
+                                  &ds->task) == pdPASS,
+                      ESP_ERR_NO_MEM, exit_1, TAG, "failed to create sub stream task");
+
+    *handle = ds;
+
+    return ESP_OK;
+
+exit_1:
+    if (ds->sub_exit) {
+        vSemaphoreDelete(ds->sub_exit);
+    }
+    if (ds->sub_idle) {
+        vSemaphoreDelete(ds->sub_idle);
+    }
+    if (ds->sub_ready) {
+        vSemaphoreDelete(ds->sub_ready);
+    }
+    ppa_unregister_client(ds->ppa);
+exit_0:
+    dual_stream_deinit_encoder(&ds->sub);
+    dual_stream_deinit_encoder(&ds->main);
+    heap_caps_free(ds);
+    return ret;
+}
+
+/**
+ * @brief Encode a capture frame into the main stream and, when it is due, the sub stream.
+ *
+ * @param handle Dual stream handle
+ * @param frame  Capture frame buffer pointer
+ * @param size   Capture frame size in bytes
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_SIZE if frame is smaller than the capture format
+ *      - Others if failed to encode the main stream
+ */
+esp_err_t esp_video_dual_stream_process(esp_video_dual_stream_handle_t handle, const uint8_t *frame, size_t size)
+{
+    esp_err_t ret;
+    struct v4l2_buffer buf;
+    esp_video_dual_stream_t *ds = handle;
+
+    ESP_RETURN_ON_FALSE(ds && frame, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(size >= ds->frame_size, ESP_ERR_INVALID_SIZE, TAG, "frame is too small");
+
+    /**
+     * PPA reads the frame before main stream encoder starts, so the sub stream encoder is kicked
+     * off first and runs together with the main stream encoder.
+     */
+    if (!(ds->stats.frames % ds->sub_interval)) {
+        if (xSemaphoreTake(ds->sub_idle, 0) == pdTRUE) {
+            if (dual_stream_start_sub(ds, frame) != ESP_OK) {
+                ds->stats.errors++;
+                xSemaphoreGive(ds->sub_idle);
+            }
+        } else {
+            ds->stats.sub_skipped++;
+        }
+    }
+    ds->stats.frames++;
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_USERPTR;
+    buf.index = 0;
+    buf.m.userptr = (unsigned long)frame;
+    buf.length = ds->frame_size;
+    ESP_GOTO_ON_FALSE(ioctl(ds->main.fd, VIDIOC_QBUF, &buf) == 0, ESP_FAIL, exit_0, TAG, "failed to queue main stream input buffer");
+
+    ESP_GOTO_ON_ERROR(dual_stream_encode(ds, &ds->main, ESP_VIDEO_DUAL_STREAM_MAIN), exit_0, TAG, "failed to encode main stream");
+    ds->stats.main_frames++;
+
+    return ESP_OK;
+
+exit_0:
+    ds->stats.errors++;
+    return ret;
+}
+
+/**
+ * @brief Get dual stream statistics.
+ *
+ * @param handle Dual stream handle
+ * @param stats  Pointer to store statistics
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_dual_stream_get_stats(esp_video_dual_stream_handle_t handle, esp_video_dual_stream_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    *stats = handle->stats;
+    stats->errors += handle->sub_errors;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Delete dual stream object, it waits for the sub stream frame being encoded and stops
+ *        streaming of both encoder video devices, the file descriptors are not closed.
+ *
+ * @param handle Dual stream handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_dual_stream_delete(esp_video_dual_stream_handle_t handle)
+{
+    esp_video_dual_stream_t *ds = handle;
+
+    ESP_RETURN_ON_FALSE(ds, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    /* Wait for the sub stream frame being encoded, and then let the task exit */
+    xSemaphoreTake(ds->sub_idle, portMAX_DELAY);
+    ds->stop = true;
+    xSemaphoreGive(ds->sub_ready);
+    xSemaphoreTake(ds->sub_exit, portMAX_DELAY);
+
+    vSemaphoreDelete(ds->sub_exit);
+    vSemaphoreDelete(ds->sub_idle);
+    vSemaphoreDelete(ds->sub_ready);
+    ppa_unregister_client(ds->ppa);
+    dual_stream_deinit_encoder(&ds->sub);
+    dual_stream_deinit_encoder(&ds->main);
+    heap_caps_free(ds);
+
+    return ESP_OK;
+}
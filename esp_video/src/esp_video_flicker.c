@@ -0,0 +1,252 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <string.h>
+#include <math.h>
+#include "esp_video_flicker.h"
+
+#define FLICKER_NS_PER_SEC          1000000000ULL
+#define FLICKER_2PI                 6.28318531f
+
+/* Rows darker than this have too much noise to measure flicker */
+#define FLICKER_MIN_LUMA            8
+
+/* Luminance changes more than this in one frame are scene or exposure changes, not flicker */
+#define FLICKER_MAX_CHANGE          0.25f
+
+/* Fit of the flicker wave must explain this part of luminance change energy */
+#define FLICKER_MIN_FIT             0.3f
+
+/* Detected frequency must be stronger than the other one by this ratio */
+#define FLICKER_MIN_RATIO           2.0f
+
+/* Frames in which the bands moved less than this part of a full cycle carry little information */
+#define FLICKER_MIN_MOVE            0.05f
+
+static const uint32_t s_flicker_freq[2] = {
+    2 * ESP_VIDEO_FLICKER_FREQ_50HZ,
+    2 * ESP_VIDEO_FLICKER_FREQ_60HZ,
+};
+
+/* Phase of a wave of "freq" Hz at "t" nanoseconds, in radians */
+static float flicker_phase(uint64_t t, uint32_t freq)
+{
+    uint64_t cycle = ((t % FLICKER_NS_PER_SEC) * freq) % FLICKER_NS_PER_SEC;
+
+    return FLICKER_2PI * (float)cycle / (float)FLICKER_NS_PER_SEC;
+}
+
+static void flicker_clear_window(esp_video_flicker_t *flicker)
+{
+    memset(flicker->sum_cos, 0, sizeof(flicker->sum_cos));
+    memset(flicker->sum_sin, 0, sizeof(flicker->sum_sin));
+    memset(flicker->weight, 0, sizeof(flicker->weight));
+    flicker->energy = 0;
+    flicker->frames = 0;
+}
+
+/**
+ * @brief Initialize flicker detection object.
+ *
+ * @param flicker Flicker detection object pointer
+ * @param config  Flicker detection configuration
+ *
+ * @return None
+ */
+void esp_video_flicker_init(esp_video_flicker_t *flicker, const esp_video_flicker_config_t *config)
+{
+    memset(flicker, 0, sizeof(esp_video_flicker_t));
+
+    flicker->config = *config;
+}
+
+/**
+ * @brief Drop accumulated data and the detected frequency.
+ *
+ * @param flicker Flicker detection object pointer
+ *
+ * @return None
+ */
+void esp_video_flicker_reset(esp_video_flicker_t *flicker)
+{
+    esp_video_flicker_init(flicker, &flicker->config);
+}
+
+static void flicker_decide(esp_video_flicker_t *flicker)
+{
+    float amplitude[2];
+    float fit[2];
+    uint32_t candidate = ESP_VIDEO_FLICKER_FREQ_UNKNOWN;
+    int best;
+
+    for (int i = 0; i < 2; i++) {
+        float weight = flicker->weight[i];
+        float norm2;
+
+        if (weight <= 0) {
+            amplitude[i] = 0;
+            fit[i] = 0;
+            continue;
+        }
+
+        norm2 = (flicker->sum_cos[i] * flicker->sum_cos[i] + flicker->sum_sin[i] * flicker->sum_sin[i]) / (weight * weight);
+        amplitude[i] = 2 * sqrtf(norm2);
+        fit[i] = flicker->energy > 0 ? 2 * norm2 * weight / flicker->energy : 0;
+    }
+
+    best = amplitude[1] > amplitude[0] ? 1 : 0;
+    if ((amplitude[best] * 1000 >= flicker->config.min_amplitude) &&
+            (fit[best] >= FLICKER_MIN_FIT) &&
+            (amplitude[best] >= amplitude[!best] * FLICKER_MIN_RATIO)) {
+        candidate = s_flicker_freq[best] / 2;
+    }
+
+    for (int i = 0; i < 2; i++) {
+        float value = amplitude[i] * 1000;
+
+        flicker->amplitude[i] = value > UINT16_MAX ? UINT16_MAX : (uint16_t)value;
+    }
+
+    if (candidate == ESP_VIDEO_FLICKER_FREQ_UNKNOWN) {
+        /* No flicker may mean anti-flicker exposure works well, so the detected frequency is kept */
+        flicker->candidate_count = 0;
+    } else if (candidate == flicker->candidate) {
+        if (flicker->candidate_count < UINT8_MAX) {
+            flicker->candidate_count++;
+        }
+    } else {
+        flicker->candidate = candidate;
+        flicker->candidate_count = 1;
+    }
+
+    if (flicker->candidate_count >= flicker->config.confirm_windows) {
+        flicker->freq = flicker->candidate;
+    }
+}
+
+/**
+ * @brief Process luminance profile of one frame.
+ *
+ * Rolling shutter sensors expose rows at different time, so flickering light makes horizontal
+ * bands which move between frames. The change of every row to the previous frame removes the
+ * scene, and it is correlated with 100Hz and 120Hz waves at the exposure time of the row.
+ *
+ * @note Bands don't move if the frame period is a multiple of the flicker period, e.g. 120Hz at
+ *       30fps, then this frequency can't be told from the scene and is not detected.
+ *
+ * @param flicker     Flicker detection object pointer
+ * @param timestamp   Frame timestamp in microseconds, it has a fixed offset to the first row
+ * @param row_period  Time between exposure of two neighboring rows of the profile in nanoseconds
+ * @param luma        Average luminance of rows from top to bottom
+ * @param rows        Number of rows, not larger than ESP_VIDEO_FLICKER_MAX_ROWS
+ *
+ * @return Detected power line frequency, ESP_VIDEO_FLICKER_FREQ_*
+ */
+uint32_t esp_video_flicker_process(esp_video_flicker_t *flicker, int64_t timestamp, uint32_t row_period,
+                                   const uint32_t *luma, uint32_t rows)
+{
+    float change[ESP_VIDEO_FLICKER_MAX_ROWS];
+    float mean = 0;
+    float energy = 0;
+    bool valid;
+    uint64_t frame_ns;
+    uint64_t period_ns;
+
+    if (!rows || (rows > ESP_VIDEO_FLICKER_MAX_ROWS)) {
+        return flicker->freq;
+    }
+
+    valid = (flicker->rows == rows) && (timestamp > flicker->prev_timestamp);
+    for (uint32_t i = 0; valid && (i < rows); i++) {
+        if ((luma[i] < FLICKER_MIN_LUMA) || (flicker->prev_luma[i] < FLICKER_MIN_LUMA)) {
+            valid = false;
+        } else {
+            change[i] = (float)luma[i] / flicker->prev_luma[i] - 1.0f;
+            mean += change[i];
+        }
+    }
+
+    if (valid) {
+        /* Global change is exposure or light level, only the shape of the profile is used */
+        mean /= rows;
+        valid = fabsf(mean) <= FLICKER_MAX_CHANGE;
+    }
+
+    frame_ns = (uint64_t)timestamp * 1000;
+    period_ns = (uint64_t)(timestamp - flicker->prev_timestamp) * 1000;
+
+    memcpy(flicker->prev_luma, luma, rows * sizeof(uint32_t));
+    flicker->prev_timestamp = timestamp;
+    flicker->rows = rows;
+
+    if (!valid) {
+        return flicker->freq;
+    }
+
+    for (uint32_t i = 0; i < rows; i++) {
+        change[i] -= mean;
+        energy += change[i] * change[i];
+    }
+
+    for (int f = 0; f < 2; f++) {
+        uint32_t freq = s_flicker_freq[f];
+        uint64_t move = ((period_ns % FLICKER_NS_PER_SEC) * freq) % FLICKER_NS_PER_SEC;
+        float wave_cos[ESP_VIDEO_FLICKER_MAX_ROWS];
+        float wave_sin[ESP_VIDEO_FLICKER_MAX_ROWS];
+        float mean_cos = 0;
+        float mean_sin = 0;
+        float norm = 0;
+        float corr_cos = 0;
+        float corr_sin = 0;
+        float move_cos;
+        float move_sin;
+        float phase;
+
+        /* Bands which don't move between frames are not in the luminance change */
+        if ((move < FLICKER_MIN_MOVE * FLICKER_NS_PER_SEC) ||
+                (move > (1.0f - FLICKER_MIN_MOVE) * FLICKER_NS_PER_SEC)) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i < rows; i++) {
+            phase = flicker_phase(frame_ns + (uint64_t)i * row_period, freq);
+            wave_cos[i] = cosf(phase);
+            wave_sin[i] = sinf(phase);
+            mean_cos += wave_cos[i];
+            mean_sin += wave_sin[i];
+        }
+
+        mean_cos /= rows;
+        mean_sin /= rows;
+        for (uint32_t i = 0; i < rows; i++) {
+            wave_cos[i] -= mean_cos;
+            wave_sin[i] -= mean_sin;
+            norm += wave_cos[i] * wave_cos[i] + wave_sin[i] * wave_sin[i];
+            corr_cos += change[i] * wave_cos[i];
+            corr_sin -= change[i] * wave_sin[i];
+        }
+
+        /**
+         * The change of a wave to the previous frame is the wave multiplied by "1 - e^(-j * phase)",
+         * where phase is how far the bands moved, remove it so all frames add up coherently
+         */
+        phase = flicker_phase(period_ns, freq);
+        move_cos = 1.0f - cosf(phase);
+        move_sin = sinf(phase);
+
+        flicker->sum_cos[f] += corr_cos * move_cos + corr_sin * move_sin;
+        flicker->sum_sin[f] += corr_sin * move_cos - corr_cos * move_sin;
+        flicker->weight[f] += (move_cos * move_cos + move_sin * move_sin) * norm;
+    }
+
+    flicker->energy += energy;
+    if (++flicker->frames >= flicker->config.window_frames) {
+        flicker_decide(flicker);
+        flicker_clear_window(flicker);
+    }
+
+    return flicker->freq;
+}
@@ -0,0 +1,250 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include <sys/ioctl.h>
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "linux/videodev2.h"
+#include "esp_video_ioctl.h"
+#include "esp_video_h264_abr.h"
+
+#define H264_ABR_HIGH_LEVEL_DEFAULT         50
+#define H264_ABR_LOW_LEVEL_DEFAULT          10
+#define H264_ABR_INCREASE_INTERVAL_DEFAULT  1000
+
+/* Bitrate is decreased to 3/4 when the queue is over high level, and to 1/2 when it is nearly full or data is dropped */
+#define H264_ABR_DECREASE_NUM               3
+#define H264_ABR_DECREASE_DEN               4
+#define H264_ABR_FULL_LEVEL                 90
+
+/* Every increase step is 1/20 of maximum bitrate */
+#define H264_ABR_INCREASE_STEPS             20
+
+/**
+ * Encoder rate control and the send queue take several frames to follow a new bitrate,
+ * so another decrease is not done within this time unless data is dropped. IDR frames
+ * are much larger than P frames, so they are not requested more often than this either.
+ */
+#define H264_ABR_DECREASE_HOLD_US           300000
+
+/* Step of V4L2_CID_MPEG_VIDEO_BITRATE of H.264 video device */
+#define H264_ABR_BITRATE_STEP               25000
+
+typedef struct esp_video_h264_abr {
+    int fd;
+    uint32_t min_bitrate;
+    uint32_t max_bitrate;
+    uint8_t high_level;
+    uint8_t low_level;
+    int64_t increase_interval_us;
+
+    uint32_t bitrate;
+    int64_t decrease_time;              /*!< Time of the last decrease */
+    int64_t idr_time;                   /*!< Time of the last IDR frame request */
+    bool idr_pending;                   /*!< Data is dropped after the last IDR frame request */
+    int64_t low_time;                   /*!< Time from which send queue stays below low level, 0 if it is not */
+} esp_video_h264_abr_t;
+
+static const char *TAG = "h264_abr";
+
+static esp_err_t h264_abr_set_ctrl(int fd, uint32_t id, int32_t value)
+{
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+
+    memset(&controls, 0, sizeof(controls));
+    memset(control, 0, sizeof(control));
+    controls.ctrl_class = V4L2_CTRL_CLASS_CODEC;
+    controls.count = 1;
+    controls.controls = control;
+    control[0].id = id;
+    control[0].value = value;
+    if (ioctl(fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t h264_abr_set_bitrate(esp_video_h264_abr_t *abr, uint64_t bitrate)
+{
+    bitrate = bitrate / H264_ABR_BITRATE_STEP * H264_ABR_BITRATE_STEP;
+    bitrate = MAX(bitrate, abr->min_bitrate);
+    bitrate = MIN(bitrate, abr->max_bitrate);
+    if (bitrate == abr->bitrate) {
+        return ESP_OK;
+    }
+
+    ESP_RETURN_ON_ERROR(h264_abr_set_ctrl(abr->fd, V4L2_CID_MPEG_VIDEO_BITRATE, bitrate), TAG, "failed to set bitrate");
+    ESP_LOGD(TAG, "bitrate %" PRIu32 " -> %" PRIu32, abr->bitrate, (uint32_t)bitrate);
+    abr->bitrate = bitrate;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Create H.264 adaptive bitrate object.
+ *
+ * @param config H.264 adaptive bitrate configuration
+ * @param handle Pointer to store H.264 adaptive bitrate handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_NO_MEM if failed to allocate memory
+ *      - Others if failed to get bitrate of the H.264 video device
+ */
+esp_err_t esp_video_h264_abr_create(const esp_video_h264_abr_config_t *config, esp_video_h264_abr_handle_t *handle)
+{
+    esp_err_t ret;
+    esp_video_h264_abr_t *abr;
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+
+    ESP_RETURN_ON_FALSE(config && handle && config->fd >= 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->min_bitrate && config->min_bitrate <= config->max_bitrate, ESP_ERR_INVALID_ARG,
+                        TAG, "invalid bitrate range");
+    ESP_RETURN_ON_FALSE(config->high_level <= 100 && config->low_level < 100, ESP_ERR_INVALID_ARG, TAG, "invalid level");
+
+    abr = heap_caps_calloc(1, sizeof(esp_video_h264_abr_t), MALLOC_CAP_DEFAULT);
+    ESP_RETURN_ON_FALSE(abr, ESP_ERR_NO_MEM, TAG, "failed to malloc H.264 ABR");
+
+    abr->fd = config->fd;
+    abr->min_bitrate = config->min_bitrate;
+    abr->max_bitrate = config->max_bitrate;
+    abr->high_level = config->high_level ? config->high_level : H264_ABR_HIGH_LEVEL_DEFAULT;
+    abr->low_level = config->low_level ? config->low_level : H264_ABR_LOW_LEVEL_DEFAULT;
+    abr->increase_interval_us = (int64_t)(config->increase_interval_ms ? config->increase_interval_ms :
+                                          H264_ABR_INCREASE_INTERVAL_DEFAULT) * 1000;
+    ESP_GOTO_ON_FALSE(abr->low_level < abr->high_level, ESP_ERR_INVALID_ARG, exit_0, TAG, "low level must be less than high level");
+
+    memset(&controls, 0, sizeof(controls));
+    memset(control, 0, sizeof(control));
+    controls.ctrl_class = V4L2_CTRL_CLASS_CODEC;
+    controls.count = 1;
+    controls.controls = control;
+    control[0].id = V4L2_CID_MPEG_VIDEO_BITRATE;
+    ESP_GOTO_ON_FALSE(ioctl(abr->fd, VIDIOC_G_EXT_CTRLS, &controls) == 0, ESP_FAIL, exit_0, TAG, "failed to get bitrate");
+    abr->bitrate = control[0].value;
+
+    /* Start from the device bitrate limited in the range */
+    ESP_GOTO_ON_ERROR(h264_abr_set_bitrate(abr, abr->bitrate), exit_0, TAG, "failed to limit bitrate");
+
+    *handle = abr;
+
+    return ESP_OK;
+
+exit_0:
+    heap_caps_free(abr);
+    return ret;
+}
+
+/**
+ * @brief Update bitrate of the H.264 video device by network feedback.
+ *
+ * @param handle   H.264 adaptive bitrate handle
+ * @param feedback Network feedback
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - Others if failed to set controls of the H.264 video device
+ */
+esp_err_t esp_video_h264_abr_update(esp_video_h264_abr_handle_t handle, const esp_video_h264_abr_feedback_t *feedback)
+{
+    uint32_t level;
+    uint64_t bitrate;
+    int64_t now = esp_timer_get_time();
+    esp_video_h264_abr_t *abr = handle;
+
+    ESP_RETURN_ON_FALSE(abr && feedback && feedback->queue_size, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    level = (uint64_t)MIN(feedback->queued_bytes, feedback->queue_size) * 100 / feedback->queue_size;
+    bitrate = abr->bitrate;
+
+    if (feedback->dropped) {
+        abr->idr_pending = true;
+        bitrate = bitrate / 2;
+        abr->decrease_time = now;
+        abr->low_time = 0;
+    } else if (level >= abr->high_level) {
+        if (!abr->decrease_time || now - abr->decrease_time >= H264_ABR_DECREASE_HOLD_US) {
+            if (level >= H264_ABR_FULL_LEVEL) {
+                bitrate = bitrate / 2;
+            } else {
+                bitrate = bitrate * H264_ABR_DECREASE_NUM / H264_ABR_DECREASE_DEN;
+            }
+            abr->decrease_time = now;
+        }
+        abr->low_time = 0;
+    } else if (level < abr->low_level) {
+        if (!abr->low_time) {
+            abr->low_time = now;
+        } else if (now - abr->low_time >= abr->increase_interval_us) {
+            bitrate += MAX(abr->max_bitrate / H264_ABR_INCREASE_STEPS, H264_ABR_BITRATE_STEP);
+            abr->low_time = now;
+        }
+    } else {
+        abr->low_time = 0;
+    }
+
+    ESP_RETURN_ON_ERROR(h264_abr_set_bitrate(abr, bitrate), TAG, "failed to set bitrate");
+
+    /*
+     * Decoder can't recover from lost references until next IDR frame, so don't wait for GOP. Data
+     * dropped within the hold time is recovered by one IDR frame after it, which is encoded by the
+     * bitrate decreased by then, instead of an IDR frame for every drop, which overflows the queue again.
+     */
+    if (abr->idr_pending && (!abr->idr_time || now - abr->idr_time >= H264_ABR_DECREASE_HOLD_US)) {
+        ESP_RETURN_ON_ERROR(h264_abr_set_ctrl(abr->fd, V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME, 1), TAG, "failed to force key frame");
+        abr->idr_pending = false;
+        abr->idr_time = now;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Get current bitrate.
+ *
+ * @param handle  H.264 adaptive bitrate handle
+ * @param bitrate Pointer to store bitrate in bits per second
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_h264_abr_get_bitrate(esp_video_h264_abr_handle_t handle, uint32_t *bitrate)
+{
+    ESP_RETURN_ON_FALSE(handle && bitrate, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    *bitrate = handle->bitrate;
+
+    return ESP_OK;
+}
+
+/**
+ * @brief Delete H.264 adaptive bitrate object, the bitrate of the H.264 video device is kept.
+ *
+ * @param handle H.264 adaptive bitrate handle
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ */
+esp_err_t esp_video_h264_abr_delete(esp_video_h264_abr_handle_t handle)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    heap_caps_free(handle);
+
+    return ESP_OK;
+}
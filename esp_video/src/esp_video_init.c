@@ -36,6 +36,12 @@
 #include "esp_video_pipeline_isp.h"
 #endif
 
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+#define ESP_VIDEO_H264_HW_CODEC     true
+#else
+#define ESP_VIDEO_H264_HW_CODEC     false
+#endif
+
 #if ESP_VIDEO_ENABLE_SCCB_DEVICE
 #include "esp_video_device_common.h"
 
@@ -119,7 +125,7 @@ static SemaphoreHandle_t s_usb_uvc_sem;
 #endif /* CONFIG_ESP_VIDEO_ENABLE_USB_UVC_VIDEO_DEVICE */
 
 #if CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE || \
-    CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE || \
+    CONFIG_ESP_VIDEO_ENABLE_H264_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_HW_JPEG_ENC_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_HW_JPEG_DEC_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_ISP_VIDEO_DEVICE || \
@@ -761,13 +767,13 @@ esp_err_t esp_video_deinit_with_flags(uint32_t flags)
     }
 #endif
 
-#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+#if CONFIG_ESP_VIDEO_ENABLE_H264_VIDEO_DEVICE
     if (flags & ESP_VIDEO_INIT_FLAGS_H264) {
         if (s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_H264) {
-            ESP_GOTO_ON_ERROR(esp_video_destroy_h264_video_device(true), fail0, TAG, "Failed to deinitialize hardware H.264 video device");
+            ESP_GOTO_ON_ERROR(esp_video_destroy_h264_video_device(ESP_VIDEO_H264_HW_CODEC), fail0, TAG, "Failed to deinitialize H.264 video device");
             s_video_device_inited_flags &= ~ESP_VIDEO_INIT_FLAGS_H264;
         } else {
-            ESP_LOGD(TAG, "hardware H.264 video device is not initialized");
+            ESP_LOGD(TAG, "H.264 video device is not initialized");
         }
     }
 #endif
@@ -834,7 +840,7 @@ esp_err_t esp_video_deinit_with_flags(uint32_t flags)
 
 #if CONFIG_ESP_VIDEO_ENABLE_HW_JPEG_ENC_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_HW_JPEG_DEC_VIDEO_DEVICE || \
-    CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE || \
+    CONFIG_ESP_VIDEO_ENABLE_H264_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE || \
@@ -1031,10 +1037,10 @@ esp_err_t esp_video_init_with_flags(const esp_video_init_config_t *config, uint3
 #endif /* CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE */
     }
 
-#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+#if CONFIG_ESP_VIDEO_ENABLE_H264_VIDEO_DEVICE
     if (flags & ESP_VIDEO_INIT_FLAGS_H264) {
         if (!(s_video_device_inited_flags & ESP_VIDEO_INIT_FLAGS_H264)) {
-            ESP_GOTO_ON_ERROR(esp_video_create_h264_video_device(true), fail1, TAG, "Failed to create hardware H.264 video device");
+            ESP_GOTO_ON_ERROR(esp_video_create_h264_video_device(ESP_VIDEO_H264_HW_CODEC), fail1, TAG, "Failed to create H.264 video device");
             s_video_device_inited_flags |= ESP_VIDEO_INIT_FLAGS_H264;
         } else {
             ESP_LOGW(TAG, "H.264 video device is already initialized");
@@ -1075,7 +1081,7 @@ esp_err_t esp_video_init_with_flags(const esp_video_init_config_t *config, uint3
     CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_DVP_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_SPI_VIDEO_DEVICE || \
-    CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE || \
+    CONFIG_ESP_VIDEO_ENABLE_H264_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_HW_JPEG_ENC_VIDEO_DEVICE || \
     CONFIG_ESP_VIDEO_ENABLE_HW_JPEG_DEC_VIDEO_DEVICE
 fail1:
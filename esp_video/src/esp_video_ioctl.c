@@ -220,9 +220,16 @@ static esp_err_t esp_video_ioctl_dqbuf(struct esp_video *video, struct v4l2_buff
         return ret;
     }
 
-    vbuf->flags     = 0;
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+    esp_video_record_zsl_frame(video, vbuf->type, element);
+#endif
+
+    vbuf->flags     = element->flags;
     vbuf->index     = element->index;
     vbuf->bytesused = element->valid_size;
+    vbuf->sequence  = element->sequence;
+    vbuf->timestamp.tv_sec  = element->timestamp / 1000000;
+    vbuf->timestamp.tv_usec = element->timestamp % 1000000;
     if (!vbuf->bytesused) {
         vbuf->flags |= V4L2_BUF_FLAG_ERROR;
     } else {
@@ -444,6 +451,14 @@ esp_err_t esp_video_ioctl(struct esp_video *video, int cmd, va_list args)
     case VIDIOC_RESTART:
         ret = esp_video_ioctl_restart(video, (struct v4l2_restart_config *)arg_ptr);
         break;
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+    case VIDIOC_S_ZSL_RING:
+        ret = esp_video_set_zsl_ring(video, (const struct v4l2_zsl_ring *)arg_ptr);
+        break;
+    case VIDIOC_G_ZSL_FRAME:
+        ret = esp_video_get_zsl_frame(video, (struct v4l2_zsl_frame *)arg_ptr);
+        break;
+#endif
     default:
         ret = ESP_ERR_INVALID_ARG;
         break;
@@ -30,6 +30,20 @@
 #include "esp_video_isp_pipeline.h"
 #include "esp_ipa.h"
 #include "esp_cam_sensor.h"
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_ENGINE
+#include "esp_timer.h"
+#include "esp_video_af.h"
+#endif
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_DETECT
+#include "esp_video.h"
+#include "esp_video_motion.h"
+#endif
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+#include "esp_video_flicker.h"
+#endif
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+#include "esp_video_isp_rate.h"
+#endif
 
 #define ISP_METADATA_BUFFER_COUNT   2
 #define ISP_TASK_PRIORITY           11
@@ -41,16 +55,92 @@
 #define TLINE_NS_UNIT               1000
 #define REG_TO_US(reg, isp)         ((reg) * (isp)->sensor_tline_ns / TLINE_NS_UNIT)
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+#define ISP_SCENE_THRESHOLD         CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_SCENE_THRESHOLD
+#define ISP_STABLE_FRAMES           CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_STABLE_FRAMES
+#define ISP_STABLE_DECIMATION       CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_STABLE_DECIMATION
+#define ISP_SCENE_RATIO_SCALE       1024
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_DETECT
+/**
+ * Changed cells of this percent of the grid are a scene change, e.g. the camera is moved or covered
+ */
+#define ISP_MOTION_SCENE_CHANGE_PERCENT 60
+
+_Static_assert(ISP_AE_BLOCK_X_NUM * ISP_AE_BLOCK_Y_NUM <= ESP_VIDEO_MOTION_MAX_CELLS,
+               "AE blocks should fit in motion map");
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+#define ISP_FLICKER_WINDOW_FRAMES       CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_WINDOW_FRAMES
+#define ISP_FLICKER_MIN_AMPLITUDE       10  /*!< Flicker weaker than 1% of luminance is not visible */
+#define ISP_FLICKER_CONFIRM_WINDOWS     2
+
+/**
+ * AC frequency of an IPA pipeline, which is created by the IPA configuration of application without change
+ */
+#define ISP_AC_FREQ_CONFIG              (-1)
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING
+#define ISP_BRACKETING_DELAY        CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING_DELAY
+#define ISP_BRACKETING_REF_RATIO    100
+
+/**
+ * Number of recent frames whose exposure is recorded, it covers the exposure latency and
+ * frames held by application for merging
+ */
+#define ISP_FRAME_INFO_NUM          8
+#endif
+
+/**
+ * ROI weights are in Q8, weight of image out of all ROIs is 1
+ */
+#define ISP_ROI_WEIGHT_SHIFT        8
+#define ISP_ROI_WEIGHT_BASE         (1 << ISP_ROI_WEIGHT_SHIFT)
+
+/**
+ * ISP controls of one meta data, they are applied to ISP video device by one VIDIOC_S_EXT_CTRLS
+ */
+#define ISP_CTRLS_MAX               16
+
+typedef struct esp_video_isp_ctrls {
+    struct v4l2_ext_control control[ISP_CTRLS_MAX];
+    uint32_t md_flags[ISP_CTRLS_MAX];   /*!< Meta data flags of every control */
+    uint32_t count;
+
+    esp_video_isp_wb_t wb;
+    esp_video_isp_bf_t bf;
+    esp_video_isp_demosaic_t demosaic;
+    esp_video_isp_sharpen_t sharpen;
+    esp_video_isp_gamma_ext_t gamma;
+    esp_video_isp_ccm_t ccm;
+#if ESP_VIDEO_ISP_DEVICE_LSC
+    esp_video_isp_lsc_t lsc;
+#endif
+    esp_video_isp_awb_t awb;
+    esp_video_isp_af_t af;
+#if ESP_VIDEO_ISP_DEVICE_BLC
+    esp_video_isp_blc_t blc;
+#endif
+} esp_video_isp_ctrls_t;
+
 typedef struct esp_video_isp {
     int isp_fd;
     esp_video_isp_stats_t *isp_stats[ISP_METADATA_BUFFER_COUNT];
 
     esp_ipa_stats_t ipa_stats;
     esp_ipa_metadata_t metadata;
+    esp_video_isp_ctrls_t ctrls;
 
     int cam_fd;
 
     esp_ipa_pipeline_handle_t ipa_pipeline;
+    /**
+     * IPA pipeline waiting to replace the running one, it is swapped by ISP task between frames
+     */
+    esp_ipa_pipeline_handle_t pending_ipa_pipeline;
 
     esp_ipa_sensor_t sensor;
 #if CONFIG_ESP_IPA_AF_ALGORITHM
@@ -88,6 +178,87 @@ typedef struct esp_video_isp {
      * Whether the ISP statistics queue is receiving data by the application layer
      */
     bool isp_stats_queue_is_receiving;
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+    /**
+     * Reduce IPA processing rate when the scene is stable
+     */
+    esp_video_isp_rate_t rate;
+
+    /**
+     * Meta data which has been applied to ISP and camera, it is used to skip unchanged parameters
+     */
+    esp_ipa_metadata_t applied_metadata;
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_ENGINE
+    /**
+     * Contrast detection auto focus engine, it drives the lens instead of IPA focus position
+     */
+    esp_video_af_t af;
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_DETECT
+    /**
+     * Motion detection by AE and AWB statistics grids, events are sent to the camera video device
+     */
+    esp_video_motion_t motion;
+    struct esp_video *cam_video;
+    uint32_t motion_sequence;
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+    /**
+     * Flicker detection by AE luminance rows, AGC anti-flicker follows the detected power line frequency
+     * by swapping IPA pipeline with a copy of the IPA configuration of application
+     */
+    esp_video_flicker_t flicker;
+    const esp_ipa_config_t *ipa_config;
+    esp_ipa_config_t flicker_ipa_config[2];
+    esp_ipa_agc_config_t flicker_agc_config[2];
+    uint8_t flicker_config_index;
+    int32_t ac_freq;
+    int32_t pending_ac_freq;
+    uint32_t reported_freq;
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING
+    /**
+     * Bracketing configuration set by application, it is applied by ISP task at the next frame
+     */
+    esp_video_isp_bracketing_config_t bracketing;
+    bool bracketing_changed;
+
+    /**
+     * Bracketing state of ISP task
+     */
+    esp_video_isp_bracketing_config_t bracketing_active;
+    uint32_t bracketing_frame;
+    uint32_t ae_exposure;
+    uint32_t frame_exposure[ISP_FRAME_INFO_NUM];
+
+    esp_video_isp_frame_info_t frame_info[ISP_FRAME_INFO_NUM];
+    uint32_t frame_info_count;
+    int64_t frame_period;
+#endif
+
+    /**
+     * Regions of interest set by application, AE and AWB statistics are weighted by them
+     */
+    esp_video_isp_roi_t roi[ESP_VIDEO_ISP_ROI_MAX_NUM];
+    uint32_t roi_num;
+    /**
+     * ROIs or statistics windows are changed, weights of statistics blocks should be calculated again
+     */
+    bool roi_changed;
+    uint32_t roi_width;
+    uint32_t roi_height;
+    isp_window_t ae_window;
+    isp_window_t awb_window;
+    uint32_t roi_ae_weight[ISP_AE_REGIONS];
+#if ESP_VIDEO_ISP_DEVICE_AWB_SUBWIN
+    uint32_t roi_awb_weight[ISP_AWB_SUBWIN_NUM];
+#endif
 } esp_video_isp_t;
 
 static const char *TAG = "ISP";
@@ -229,239 +400,215 @@ static void print_dev_info(int fd)
 #endif
 }
 
-static void config_white_balance(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+static void isp_ctrls_add_value(esp_video_isp_t *isp, uint32_t id, int32_t value, uint32_t md_flags)
+{
+    esp_video_isp_ctrls_t *ctrls = &isp->ctrls;
+    struct v4l2_ext_control *control = &ctrls->control[ctrls->count];
+
+    assert(ctrls->count < ISP_CTRLS_MAX);
+    ctrls->md_flags[ctrls->count++] = md_flags;
+    control->id = id;
+    control->value = value;
+}
+
+static void isp_ctrls_add_ptr(esp_video_isp_t *isp, uint32_t id, void *ptr, uint32_t size, uint32_t md_flags)
+{
+    esp_video_isp_ctrls_t *ctrls = &isp->ctrls;
+    struct v4l2_ext_control *control = &ctrls->control[ctrls->count];
+
+    assert(ctrls->count < ISP_CTRLS_MAX);
+    ctrls->md_flags[ctrls->count++] = md_flags;
+    control->id = id;
+    control->p_u8 = ptr;
+    control->size = size;
+}
+
+/**
+ * @brief Mark meta data parameters as not applied, so that they are written again with
+ *        the next meta data even if they are not changed.
+ *
+ * @param isp      ISP pipeline controller object pointer
+ * @param md_flags Meta data flags of parameters
+ *
+ * @return None
+ */
+static inline void isp_invalidate_metadata(esp_video_isp_t *isp, uint32_t md_flags)
+{
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+    isp->applied_metadata.flags &= ~md_flags;
+#endif
+}
+
+/**
+ * @brief Apply all ISP controls collected from one meta data by a single VIDIOC_S_EXT_CTRLS.
+ *
+ * If it fails, controls are applied one by one, so that a failed control doesn't drop the
+ * others, and the parameters of failed controls are written again with the next meta data.
+ *
+ * @param isp ISP pipeline controller object pointer
+ *
+ * @return None
+ */
+static void isp_ctrls_commit(esp_video_isp_t *isp)
 {
     struct v4l2_ext_controls controls;
-    struct v4l2_ext_control control[1];
+    esp_video_isp_ctrls_t *ctrls = &isp->ctrls;
+
+    if (ctrls->count) {
+        controls.ctrl_class = V4L2_CID_USER_CLASS;
+        controls.count      = ctrls->count;
+        controls.controls   = ctrls->control;
+        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+            ESP_LOGW(TAG, "failed to set ISP controls, set them one by one");
+
+            for (int i = 0; i < ctrls->count; i++) {
+                controls.count    = 1;
+                controls.controls = &ctrls->control[i];
+                if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+                    ESP_LOGE(TAG, "failed to set ISP control id=%" PRIx32, ctrls->control[i].id);
+                    isp_invalidate_metadata(isp, ctrls->md_flags[i]);
+                }
+            }
+        }
+
+        ctrls->count = 0;
+    }
+}
+
+static void config_white_balance(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+{
     bool rc = metadata->flags & IPA_METADATA_FLAGS_RG;
     bool bg = metadata->flags & IPA_METADATA_FLAGS_BG;
 
     if (rc && bg) {
-        esp_video_isp_wb_t wb = {
-            .enable = true,
-            .red_gain = metadata->red_gain,
-            .blue_gain = metadata->blue_gain
-        };
+        esp_video_isp_wb_t *wb = &isp->ctrls.wb;
 
-        controls.ctrl_class = V4L2_CTRL_CLASS_USER;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_WB;
-        control[0].p_u8     = (uint8_t *)&wb;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set white balance");
-        }
+        wb->enable = true;
+        wb->red_gain = metadata->red_gain;
+        wb->blue_gain = metadata->blue_gain;
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_WB, wb, sizeof(esp_video_isp_wb_t), IPA_METADATA_FLAGS_RG | IPA_METADATA_FLAGS_BG);
     } else if (rc) {
-        controls.ctrl_class = V4L2_CTRL_CLASS_USER;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_RED_BALANCE;
-        control[0].value    = metadata->red_gain * V4L2_CID_RED_BALANCE_DEN;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set red balance");
-        }
+        isp_ctrls_add_value(isp, V4L2_CID_RED_BALANCE, metadata->red_gain * V4L2_CID_RED_BALANCE_DEN, IPA_METADATA_FLAGS_RG);
     } else if (bg) {
-        controls.ctrl_class = V4L2_CTRL_CLASS_USER;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_BLUE_BALANCE;
-        control[0].value    = metadata->blue_gain * V4L2_CID_BLUE_BALANCE_DEN;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set blue balance");
-        }
+        isp_ctrls_add_value(isp, V4L2_CID_BLUE_BALANCE, metadata->blue_gain * V4L2_CID_BLUE_BALANCE_DEN, IPA_METADATA_FLAGS_BG);
     }
 }
 
 static void config_bayer_filter(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
-    struct v4l2_ext_controls controls;
-    struct v4l2_ext_control control[1];
-    esp_video_isp_bf_t bf;
+    esp_video_isp_bf_t *bf = &isp->ctrls.bf;
 
     if (metadata->flags & IPA_METADATA_FLAGS_BF) {
-        bf.enable = true;
-        bf.level = metadata->bf.level;
+        bf->enable = true;
+        bf->level = metadata->bf.level;
         for (int i = 0; i < ISP_BF_TEMPLATE_X_NUMS; i++) {
             for (int j = 0; j < ISP_BF_TEMPLATE_Y_NUMS; j++) {
-                bf.matrix[i][j] = metadata->bf.matrix[i][j];
+                bf->matrix[i][j] = metadata->bf.matrix[i][j];
             }
         }
 
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_BF;
-        control[0].p_u8     = (uint8_t *)&bf;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set bayer filter");
-        }
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_BF, bf, sizeof(esp_video_isp_bf_t), IPA_METADATA_FLAGS_BF);
     }
 }
 
 static void config_demosaic(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
-    struct v4l2_ext_controls controls;
-    struct v4l2_ext_control control[1];
-    esp_video_isp_demosaic_t demosaic;
+    esp_video_isp_demosaic_t *demosaic = &isp->ctrls.demosaic;
 
     if (metadata->flags & IPA_METADATA_FLAGS_DM) {
-        demosaic.enable = true;
-        demosaic.gradient_ratio = metadata->demosaic.gradient_ratio;
+        demosaic->enable = true;
+        demosaic->gradient_ratio = metadata->demosaic.gradient_ratio;
 
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_DEMOSAIC;
-        control[0].p_u8     = (uint8_t *)&demosaic;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set demosaic");
-        }
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_DEMOSAIC, demosaic, sizeof(esp_video_isp_demosaic_t), IPA_METADATA_FLAGS_DM);
     }
 }
 
 static void config_sharpen(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
-    struct v4l2_ext_controls controls;
-    struct v4l2_ext_control control[1];
-    esp_video_isp_sharpen_t sharpen;
+    esp_video_isp_sharpen_t *sharpen = &isp->ctrls.sharpen;
 
     if (metadata->flags & IPA_METADATA_FLAGS_SH) {
-        sharpen.enable = true;
-        sharpen.h_thresh = metadata->sharpen.h_thresh;
-        sharpen.l_thresh = metadata->sharpen.l_thresh;
-        sharpen.h_coeff = metadata->sharpen.h_coeff;
-        sharpen.m_coeff = metadata->sharpen.m_coeff;
+        sharpen->enable = true;
+        sharpen->h_thresh = metadata->sharpen.h_thresh;
+        sharpen->l_thresh = metadata->sharpen.l_thresh;
+        sharpen->h_coeff = metadata->sharpen.h_coeff;
+        sharpen->m_coeff = metadata->sharpen.m_coeff;
         for (int i = 0; i < ISP_SHARPEN_TEMPLATE_X_NUMS; i++) {
             for (int j = 0; j < ISP_SHARPEN_TEMPLATE_Y_NUMS; j++) {
-                sharpen.matrix[i][j] = metadata->sharpen.matrix[i][j];
+                sharpen->matrix[i][j] = metadata->sharpen.matrix[i][j];
             }
         }
 
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_SHARPEN;
-        control[0].p_u8     = (uint8_t *)&sharpen;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set sharpen");
-        }
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_SHARPEN, sharpen, sizeof(esp_video_isp_sharpen_t), IPA_METADATA_FLAGS_SH);
     }
 }
 
 static void config_gamma(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
     if (metadata->flags & IPA_METADATA_FLAGS_GAMMA) {
-        struct v4l2_ext_controls controls;
-        struct v4l2_ext_control control[1];
-        esp_video_isp_gamma_ext_t gamma = {0};
+        esp_video_isp_gamma_ext_t *gamma = &isp->ctrls.gamma;
         esp_ipa_gamma_t *ipa_gamma = &metadata->gamma;
 
-        gamma.enable = true;
+        memset(gamma, 0, sizeof(esp_video_isp_gamma_ext_t));
+        gamma->enable = true;
         if (ipa_gamma->flags & IPA_GAMMA_FLAGS_RED) {
             for (int i = 0; i < ISP_GAMMA_CURVE_POINTS_NUM; i++) {
-                gamma.red_points[i].x = ipa_gamma->red.x[i];
-                gamma.red_points[i].y = ipa_gamma->red.y[i];
+                gamma->red_points[i].x = ipa_gamma->red.x[i];
+                gamma->red_points[i].y = ipa_gamma->red.y[i];
             }
-            gamma.flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_RED;
+            gamma->flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_RED;
         }
         if (ipa_gamma->flags & IPA_GAMMA_FLAGS_GREEN) {
             for (int i = 0; i < ISP_GAMMA_CURVE_POINTS_NUM; i++) {
-                gamma.green_points[i].x = ipa_gamma->green.x[i];
-                gamma.green_points[i].y = ipa_gamma->green.y[i];
+                gamma->green_points[i].x = ipa_gamma->green.x[i];
+                gamma->green_points[i].y = ipa_gamma->green.y[i];
             }
-            gamma.flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_GREEN;
+            gamma->flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_GREEN;
         }
         if (ipa_gamma->flags & IPA_GAMMA_FLAGS_BLUE) {
             for (int i = 0; i < ISP_GAMMA_CURVE_POINTS_NUM; i++) {
-                gamma.blue_points[i].x = ipa_gamma->blue.x[i];
-                gamma.blue_points[i].y = ipa_gamma->blue.y[i];
+                gamma->blue_points[i].x = ipa_gamma->blue.x[i];
+                gamma->blue_points[i].y = ipa_gamma->blue.y[i];
             }
-            gamma.flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_BLUE;
+            gamma->flags |= ESP_VIDEO_ISP_GAMMA_EXT_FLAG_BLUE;
         }
 
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_GAMMA_EXT;
-        control[0].p_u8     = (uint8_t *)&gamma;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set GAMMA");
-        }
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_GAMMA_EXT, gamma, sizeof(esp_video_isp_gamma_ext_t), IPA_METADATA_FLAGS_GAMMA);
     }
 }
 
 static void config_ccm(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
-    struct v4l2_ext_controls controls;
-    struct v4l2_ext_control control[1];
-    esp_video_isp_ccm_t ccm;
+    esp_video_isp_ccm_t *ccm = &isp->ctrls.ccm;
 
     if (metadata->flags & IPA_METADATA_FLAGS_CCM) {
-        ccm.enable = true;
+        ccm->enable = true;
         for (int i = 0; i < ISP_CCM_DIMENSION; i++) {
             for (int j = 0; j < ISP_CCM_DIMENSION; j++) {
-                ccm.matrix[i][j] = metadata->ccm.matrix[i][j];
+                ccm->matrix[i][j] = metadata->ccm.matrix[i][j];
             }
         }
 
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_CCM;
-        control[0].p_u8     = (uint8_t *)&ccm;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set CCM");
-        }
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_CCM, ccm, sizeof(esp_video_isp_ccm_t), IPA_METADATA_FLAGS_CCM);
     }
 }
 
 static void config_color(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
-    struct v4l2_ext_controls controls;
-    struct v4l2_ext_control control[1];
-
     if (metadata->flags & IPA_METADATA_FLAGS_BR) {
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_BRIGHTNESS;
-        control[0].value    = metadata->brightness;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set brightness");
-        }
+        isp_ctrls_add_value(isp, V4L2_CID_BRIGHTNESS, metadata->brightness, IPA_METADATA_FLAGS_BR);
     }
 
     if (metadata->flags & IPA_METADATA_FLAGS_CN) {
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_CONTRAST;
-        control[0].value    = metadata->contrast;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set contrast");
-        }
+        isp_ctrls_add_value(isp, V4L2_CID_CONTRAST, metadata->contrast, IPA_METADATA_FLAGS_CN);
     }
 
     if (metadata->flags & IPA_METADATA_FLAGS_ST) {
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_SATURATION;
-        control[0].value    = metadata->saturation;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set saturation");
-        }
+        isp_ctrls_add_value(isp, V4L2_CID_SATURATION, metadata->saturation, IPA_METADATA_FLAGS_ST);
     }
 
     if (metadata->flags & IPA_METADATA_FLAGS_HUE) {
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_HUE;
-        control[0].value    = metadata->hue;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set hue");
-        }
+        isp_ctrls_add_value(isp, V4L2_CID_HUE, metadata->hue, IPA_METADATA_FLAGS_HUE);
     }
 }
 
@@ -678,26 +825,17 @@ static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *m
 #if ESP_VIDEO_ISP_DEVICE_LSC
 static void config_lsc(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
-    struct v4l2_ext_controls controls;
-    struct v4l2_ext_control control[1];
-    esp_video_isp_lsc_t lsc;
+    esp_video_isp_lsc_t *lsc = &isp->ctrls.lsc;
 
     if (metadata->flags & IPA_METADATA_FLAGS_LSC) {
-        lsc.enable = true;
-        lsc.gain_r = metadata->lsc.gain_r;
-        lsc.gain_gr = metadata->lsc.gain_gr;
-        lsc.gain_gb = metadata->lsc.gain_gb;
-        lsc.gain_b = metadata->lsc.gain_b;
-        lsc.lsc_gain_size = metadata->lsc.lsc_gain_array_size;
+        lsc->enable = true;
+        lsc->gain_r = metadata->lsc.gain_r;
+        lsc->gain_gr = metadata->lsc.gain_gr;
+        lsc->gain_gb = metadata->lsc.gain_gb;
+        lsc->gain_b = metadata->lsc.gain_b;
+        lsc->lsc_gain_size = metadata->lsc.lsc_gain_array_size;
 
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_LSC;
-        control[0].p_u8     = (uint8_t *)&lsc;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set LSC");
-        }
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_LSC, lsc, sizeof(esp_video_isp_lsc_t), IPA_METADATA_FLAGS_LSC);
     }
 }
 #endif
@@ -716,6 +854,7 @@ static void config_sensor_ae_target_level(esp_video_isp_t *isp, esp_ipa_metadata
         control[0].value    = metadata->ae_target_level;
         if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set sensor AE target level");
+            isp_invalidate_metadata(isp, IPA_METADATA_FLAGS_AETL);
         } else {
             isp->sensor.cur_ae_target_level = metadata->ae_target_level;
         }
@@ -724,35 +863,26 @@ static void config_sensor_ae_target_level(esp_video_isp_t *isp, esp_ipa_metadata
 
 static void config_awb(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
-    struct v4l2_ext_controls controls;
-    struct v4l2_ext_control control[1];
-    esp_video_isp_awb_t awb;
+    esp_video_isp_awb_t *awb = &isp->ctrls.awb;
 
     if (metadata->flags & IPA_METADATA_FLAGS_AWB) {
         esp_ipa_awb_range_t *range = &metadata->awb;
 
-        awb.enable = true;
-        awb.green_max = range->green_max;
-        awb.green_min = range->green_min;
-        awb.rg_max = range->rg_max;
-        awb.rg_min = range->rg_min;
-        awb.bg_max = range->bg_max;
-        awb.bg_min = range->bg_min;
+        awb->enable = true;
+        awb->green_max = range->green_max;
+        awb->green_min = range->green_min;
+        awb->rg_max = range->rg_max;
+        awb->rg_min = range->rg_min;
+        awb->bg_max = range->bg_max;
+        awb->bg_min = range->bg_min;
 
         /**
          * If the right and bottom of the window is 0, it means the window is not set, use the default window.
          */
-        awb.windows[0].btm_right.x = 0;
-        awb.windows[0].btm_right.y = 0;
+        awb->windows[0].btm_right.x = 0;
+        awb->windows[0].btm_right.y = 0;
 
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_AWB;
-        control[0].p_u8     = (uint8_t *)&awb;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set AWB");
-        }
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_AWB, awb, sizeof(esp_video_isp_awb_t), IPA_METADATA_FLAGS_AWB);
     }
 }
 
@@ -763,106 +893,431 @@ static void config_statistics_region(esp_video_isp_t *isp, esp_ipa_metadata_t *m
         uint32_t target_windows = ESP_VIDEO_ISP_AF_STATS_WIN | ESP_VIDEO_ISP_AWB_STATS_WIN |
                                   ESP_VIDEO_ISP_AE_STATS_WIN | ESP_VIDEO_ISP_HIST_STATS_WIN;
 
+        _lock_acquire(&s_isp_lock);
         if (isp_pipeline_set_statistics_window(isp, target_windows, sr->left, sr->top, sr->width, sr->height) != ESP_OK) {
             ESP_LOGE(TAG, "failed to set statistics window");
+            isp_invalidate_metadata(isp, IPA_METADATA_FLAGS_SR);
         }
+        _lock_release(&s_isp_lock);
     }
 }
 
 static void config_af(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
-    struct v4l2_ext_controls controls;
-    struct v4l2_ext_control control[1];
-    esp_video_isp_af_t af;
+    esp_video_isp_af_t *af = &isp->ctrls.af;
 
     if (metadata->flags & IPA_METADATA_FLAGS_AF) {
         esp_ipa_af_t *ipa_af = &metadata->af;
 
-        af.enable = true;
-        af.edge_thresh = ipa_af->edge_thresh;
-        memcpy(af.windows, ipa_af->windows, sizeof(isp_window_t) * ISP_AF_WINDOW_NUM);
+        af->enable = true;
+        af->edge_thresh = ipa_af->edge_thresh;
+        memcpy(af->windows, ipa_af->windows, sizeof(isp_window_t) * ISP_AF_WINDOW_NUM);
 
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_AF;
-        control[0].p_u8     = (uint8_t *)&af;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set AF");
-        }
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_AF, af, sizeof(esp_video_isp_af_t), IPA_METADATA_FLAGS_AF);
     }
 }
 
 #if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROL_CAMERA_MOTOR
-static void config_motor_position(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+static esp_err_t set_motor_position(esp_video_isp_t *isp, uint32_t focus_pos)
 {
     struct v4l2_ext_controls controls;
     struct v4l2_ext_control control[1];
+    int64_t strat_time;
+
+    controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
+    controls.count      = 1;
+    controls.controls   = control;
+    control[0].id       = V4L2_CID_FOCUS_ABSOLUTE;
+    control[0].value    = focus_pos;
+    if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        ESP_LOGE(TAG, "failed to set motor position");
+        isp->focus_info.start_time = 0;
+        return ESP_FAIL;
+    }
+
+    controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
+    controls.count      = 1;
+    controls.controls   = control;
+    control[0].id       = V4L2_CID_MOTOR_START_TIME;
+    control[0].p_u8     = (uint8_t *)&strat_time;
+    control[0].size     = sizeof(strat_time);
+    if (ioctl(isp->cam_fd, VIDIOC_G_EXT_CTRLS, &controls) != 0) {
+        ESP_LOGE(TAG, "failed to get motor start time");
+        isp->focus_info.start_time = 0;
+        return ESP_FAIL;
+    }
+
+    isp->focus_info.start_time = strat_time;
+    isp->focus_info.cur_pos = focus_pos;
 
-    if (metadata->flags & IPA_METADATA_FLAGS_FP) {
-        controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_FOCUS_ABSOLUTE;
-        control[0].value    = metadata->focus_pos;
-        if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set motor position");
-            isp->focus_info.start_time = 0;
-        } else {
-            int64_t strat_time;
+    return ESP_OK;
+}
 
-            controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
-            controls.count      = 1;
-            controls.controls   = control;
-            control[0].id       = V4L2_CID_MOTOR_START_TIME;
-            control[0].p_u8     = (uint8_t *)&strat_time;
-            control[0].size     = sizeof(strat_time);
-            if (ioctl(isp->cam_fd, VIDIOC_G_EXT_CTRLS, &controls) != 0) {
-                ESP_LOGE(TAG, "failed to get motor start time");
-                isp->focus_info.start_time = 0;
-            } else {
-                isp->focus_info.start_time = strat_time;
-                isp->focus_info.cur_pos = metadata->focus_pos;
-            }
-        }
+#if !CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_ENGINE
+static void config_motor_position(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+{
+    if (metadata->flags & IPA_METADATA_FLAGS_FP) {
+        set_motor_position(isp, metadata->focus_pos);
     }
 }
 #endif
+#endif
 
-#if ESP_VIDEO_ISP_DEVICE_BLC
-static void config_blc(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_ENGINE
+static void isp_af_init(esp_video_isp_t *isp)
 {
-    if (metadata->flags & IPA_METADATA_FLAGS_BLC) {
-        struct v4l2_ext_controls controls;
-        struct v4l2_ext_control control[1];
-        esp_video_isp_blc_t blc;
-        esp_ipa_blc_t *ipa_blc = &metadata->blc;
-
-        blc.enable = true;
-        blc.stretch_enable = ipa_blc->stretch;
-        blc.top_left_offset = ipa_blc->top_left_chan_offset;
-        blc.top_right_offset = ipa_blc->top_right_chan_offset;
-        blc.bottom_left_offset = ipa_blc->bottom_left_chan_offset;
-        blc.bottom_right_offset = ipa_blc->bottom_right_chan_offset;
+    const esp_video_af_config_t config = {
+        .min_pos = isp->focus_info.min_pos,
+        .max_pos = isp->focus_info.max_pos,
+        .coarse_steps = CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_COARSE_STEPS,
+        .fine_step = MAX(CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_FINE_STEP, isp->focus_info.step_pos),
+        .period_in_us = isp->focus_info.period_in_us,
+        .codes_per_step = isp->focus_info.codes_per_step,
+        .settle_us = CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_SETTLE_TIME_US,
+        .drop_percent = CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_DROP_PERCENT,
+        .refocus_percent = CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_REFOCUS_PERCENT,
+        .refocus_frames = CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_REFOCUS_FRAMES,
+    };
 
-        controls.ctrl_class = V4L2_CID_USER_CLASS;
-        controls.count      = 1;
-        controls.controls   = control;
-        control[0].id       = V4L2_CID_USER_ESP_ISP_BLC;
-        control[0].p_u8     = (uint8_t *)&blc;
-        if (ioctl(isp->isp_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
-            ESP_LOGE(TAG, "failed to set BLC");
-        }
+    esp_video_af_init(&isp->af, &config, isp->focus_info.cur_pos);
+    if (isp->sensor.focus_info) {
+        esp_video_af_start(&isp->af);
     }
 }
-#endif
 
-static void config_isp_and_camera(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+/**
+ * @brief Run auto focus engine with AF statistics and move the lens if needed.
+ *
+ * @note AF engine runs on every statistics frame even if IPA processing is skipped,
+ *       because every frame after the lens settles is needed by the search.
+ *
+ * @param isp   ISP pipeline controller object pointer
+ * @param stats ISP statistics for IPA
+ *
+ * @return None
+ */
+static void isp_af_process(esp_video_isp_t *isp, const esp_ipa_stats_t *stats)
 {
-    config_statistics_region(isp, metadata);
+    bool move;
+    int32_t pos;
+    int64_t start_time;
+    uint32_t definition = 0;
 
-    if (!isp->sensor_attr.awb) {
-        config_white_balance(isp, metadata);
+    if (!(stats->flags & IPA_STATS_FLAGS_AF)) {
+        return;
+    }
+
+    for (int i = 0; i < ISP_AF_WINDOW_NUM; i++) {
+        definition += stats->af_stats[i].definition;
+    }
+
+    _lock_acquire(&s_isp_lock);
+    move = esp_video_af_process(&isp->af, definition, esp_timer_get_time(), &pos);
+    _lock_release(&s_isp_lock);
+
+    if (move && (set_motor_position(isp, pos) == ESP_OK)) {
+        /* Motor driver start time is accurate, because the move may wait for the previous one */
+        start_time = isp->sensor_attr.af_stime ? isp->focus_info.start_time : esp_timer_get_time();
+
+        _lock_acquire(&s_isp_lock);
+        esp_video_af_moved(&isp->af, pos, start_time);
+        _lock_release(&s_isp_lock);
+
+        ESP_LOGD(TAG, "AF: state=%d, pos=%"PRIi32", definition=%"PRIu32, isp->af.state, pos, definition);
+    }
+}
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING || CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+static inline int64_t isp_timeval_to_us(const struct timeval *tv)
+{
+    return (int64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+}
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING
+
+/**
+ * @brief Set sensor exposure without IPA meta data.
+ *
+ * @param isp         ISP pipeline controller object pointer
+ * @param exposure_us Exposure time in microseconds
+ *
+ * @return Exposure time in microseconds after alignment and clamping by sensor
+ */
+static uint32_t isp_bracketing_set_exposure(esp_video_isp_t *isp, uint32_t exposure_us)
+{
+    uint32_t exposure_val;
+    struct v4l2_query_ext_ctrl qctrl;
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+
+    qctrl.id = V4L2_CID_EXPOSURE;
+    if (ioctl(isp->cam_fd, VIDIOC_QUERY_EXT_CTRL, &qctrl)) {
+        ESP_LOGE(TAG, "failed to query exposure");
+        return REG_TO_US(isp->prev_exposure_val, isp);
+    }
+
+    exposure_val = (uint32_t)((double)exposure_us * TLINE_NS_UNIT / isp->sensor_tline_ns + 0.5);
+    exposure_val = exposure_val / qctrl.step * qctrl.step;
+    exposure_val = MAX(exposure_val, qctrl.minimum);
+    exposure_val = MIN(exposure_val, qctrl.maximum);
+
+    if (exposure_val != isp->prev_exposure_val) {
+        controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
+        controls.count      = 1;
+        controls.controls   = control;
+        control[0].id       = V4L2_CID_EXPOSURE;
+        control[0].value    = exposure_val;
+        if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+            ESP_LOGE(TAG, "failed to set exposure time");
+        } else {
+            isp->prev_exposure_val = exposure_val;
+        }
+    }
+
+    return REG_TO_US(isp->prev_exposure_val, isp);
+}
+
+/**
+ * @brief Record exposure of the current statistics frame, and set exposure of the frame
+ *        which is exposed after the sensor exposure latency.
+ *
+ * @note Exposure of the frame N + ISP_BRACKETING_DELAY is set when statistics of frame N
+ *       arrive, the bracketing index of a frame is its number modulo bracketing number.
+ *
+ * @param isp       ISP pipeline controller object pointer
+ * @param timestamp Timestamp of statistics frame
+ *
+ * @return true if IPA should skip this frame because it is exposed by a bracketing ratio, false if not
+ */
+static bool isp_bracketing_process(esp_video_isp_t *isp, const struct timeval *timestamp)
+{
+    bool enabled;
+    bool changed;
+    uint32_t frame;
+    uint32_t exposure;
+    esp_video_isp_frame_info_t *info;
+    esp_video_isp_bracketing_config_t *active = &isp->bracketing_active;
+    uint8_t index = ESP_VIDEO_ISP_BRACKETING_INDEX_NONE;
+
+    enabled = active->num >= 2;
+
+    _lock_acquire(&s_isp_lock);
+    changed = isp->bracketing_changed;
+    if (changed) {
+        *active = isp->bracketing;
+        isp->bracketing_changed = false;
+    }
+    _lock_release(&s_isp_lock);
+
+    if (changed) {
+        if (active->num >= 2) {
+            if (!enabled) {
+                isp->ae_exposure = isp->sensor.cur_exposure;
+            }
+            isp->bracketing_frame = 0;
+        } else if (enabled) {
+            /* Go back to AE exposure, IPA controls exposure from the next frame */
+            isp->sensor.cur_exposure = isp_bracketing_set_exposure(isp, isp->ae_exposure);
+        }
+    }
+
+    exposure = isp->sensor.cur_exposure;
+    if (active->num >= 2) {
+        uint32_t next;
+
+        frame = isp->bracketing_frame++;
+        if (frame >= ISP_BRACKETING_DELAY) {
+            index = frame % active->num;
+            exposure = isp->frame_exposure[frame % ISP_FRAME_INFO_NUM];
+        }
+
+        next = frame + ISP_BRACKETING_DELAY;
+        isp->frame_exposure[next % ISP_FRAME_INFO_NUM] =
+            isp_bracketing_set_exposure(isp, (uint64_t)isp->ae_exposure * active->exposure_ratio[next % active->num] / ISP_BRACKETING_REF_RATIO);
+
+        /* IPA sees the exposure of the statistics frame it processes */
+        isp->sensor.cur_exposure = exposure;
+    }
+
+    _lock_acquire(&s_isp_lock);
+    if (isp->frame_info_count) {
+        const esp_video_isp_frame_info_t *last = &isp->frame_info[(isp->frame_info_count - 1) % ISP_FRAME_INFO_NUM];
+        int64_t period = isp_timeval_to_us(timestamp) - isp_timeval_to_us(&last->timestamp);
+
+        if (period > 0) {
+            isp->frame_period = isp->frame_period ? (isp->frame_period * 3 + period) / 4 : period;
+        }
+    }
+
+    info = &isp->frame_info[isp->frame_info_count % ISP_FRAME_INFO_NUM];
+    info->timestamp = *timestamp;
+    info->sequence = isp->ipa_stats.seq;
+    info->exposure_us = exposure;
+    info->gain = isp->sensor.cur_gain;
+    info->bracketing_index = index;
+    isp->frame_info_count++;
+    _lock_release(&s_isp_lock);
+
+    return (index != ESP_VIDEO_ISP_BRACKETING_INDEX_NONE) &&
+           (active->exposure_ratio[index] != ISP_BRACKETING_REF_RATIO);
+}
+#endif
+
+#if ESP_VIDEO_ISP_DEVICE_BLC
+static void config_blc(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+{
+    if (metadata->flags & IPA_METADATA_FLAGS_BLC) {
+        esp_video_isp_blc_t *blc = &isp->ctrls.blc;
+        esp_ipa_blc_t *ipa_blc = &metadata->blc;
+
+        blc->enable = true;
+        blc->stretch_enable = ipa_blc->stretch;
+        blc->top_left_offset = ipa_blc->top_left_chan_offset;
+        blc->top_right_offset = ipa_blc->top_right_chan_offset;
+        blc->bottom_left_offset = ipa_blc->bottom_left_chan_offset;
+        blc->bottom_right_offset = ipa_blc->bottom_right_chan_offset;
+
+        isp_ctrls_add_ptr(isp, V4L2_CID_USER_ESP_ISP_BLC, blc, sizeof(esp_video_isp_blc_t), IPA_METADATA_FLAGS_BLC);
+    }
+}
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+#define ISP_METADATA_FILTER(_isp, _md, _flag, _member)                                      \
+    do {                                                                                    \
+        esp_ipa_metadata_t *_applied = &(_isp)->applied_metadata;                           \
+                                                                                            \
+        if ((_md)->flags & (_flag)) {                                                       \
+            if ((_applied->flags & (_flag)) &&                                              \
+                    !memcmp(&(_md)->_member, &_applied->_member, sizeof((_md)->_member))) { \
+                (_md)->flags &= ~(_flag);                                                   \
+            } else {                                                                        \
+                memcpy(&_applied->_member, &(_md)->_member, sizeof((_md)->_member));        \
+                _applied->flags |= (_flag);                                                 \
+            }                                                                               \
+        }                                                                                   \
+    } while (0)
+
+/**
+ * @brief Remove parameters which are the same as the last applied ones from meta data,
+ *        so that unchanged ISP and camera parameters are not written again.
+ *
+ * @note Parameters are recorded as applied here, and the ones which fail to be written are
+ *       marked as not applied by isp_invalidate_metadata(), so they are written again.
+ *
+ * @note Exposure, gain and focus position are not filtered here, because exposure and gain
+ *       are compared in register unit by config_exposure_and_gain(), and focus position also
+ *       updates the motor start time.
+ *
+ * @param isp      ISP pipeline controller object pointer
+ * @param metadata Meta data calculated by IPA
+ *
+ * @return None
+ */
+static void isp_filter_metadata(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+{
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_RG, red_gain);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_BG, blue_gain);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_BF, bf);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_DM, demosaic);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_SH, sharpen);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_GAMMA, gamma);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_CCM, ccm);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_BR, brightness);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_CN, contrast);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_ST, saturation);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_HUE, hue);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_LSC, lsc);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_AWB, awb);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_AETL, ae_target_level);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_SR, stats_region);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_AF, af);
+    ISP_METADATA_FILTER(isp, metadata, IPA_METADATA_FLAGS_BLC, blc);
+}
+
+static void isp_get_scene(esp_video_isp_t *isp, const esp_ipa_stats_t *stats, esp_video_isp_scene_t *scene)
+{
+    memset(scene, 0, sizeof(esp_video_isp_scene_t));
+
+    if (stats->flags & IPA_STATS_FLAGS_AE) {
+        for (int i = 0; i < ISP_AE_REGIONS; i++) {
+            scene->luma += stats->ae_stats[i].luminance;
+        }
+    }
+
+    if (stats->flags & IPA_STATS_FLAGS_AWB) {
+        const esp_ipa_stats_awb_t *awb = &stats->awb_stats[0];
+
+        if (awb->sum_g) {
+            scene->rg = (uint64_t)awb->sum_r * ISP_SCENE_RATIO_SCALE / awb->sum_g;
+            scene->bg = (uint64_t)awb->sum_b * ISP_SCENE_RATIO_SCALE / awb->sum_g;
+        }
+    }
+
+    if (stats->flags & IPA_STATS_FLAGS_AF) {
+        for (int i = 0; i < ISP_AF_WINDOW_NUM; i++) {
+            scene->definition += stats->af_stats[i].definition;
+        }
+    }
+
+    scene->exposure = isp->sensor.cur_exposure;
+    scene->gain = isp->sensor.cur_gain * ISP_SCENE_RATIO_SCALE;
+}
+
+static void isp_rate_init(esp_video_isp_t *isp)
+{
+    const esp_video_isp_rate_config_t rate_config = {
+        .threshold = ISP_SCENE_THRESHOLD,
+        .stable_frames = ISP_STABLE_FRAMES,
+        .decimation = ISP_STABLE_DECIMATION,
+    };
+
+    esp_video_isp_rate_init(&isp->rate, &rate_config);
+}
+
+/**
+ * @brief Check if IPA processing can be skipped for this statistics frame.
+ *
+ * @param isp   ISP pipeline controller object pointer
+ * @param stats ISP statistics for IPA
+ *
+ * @return true if IPA processing is skipped, false if not
+ */
+static bool isp_skip_process(esp_video_isp_t *isp, const esp_ipa_stats_t *stats)
+{
+    esp_video_isp_scene_t scene;
+
+    isp_get_scene(isp, stats, &scene);
+
+    return esp_video_isp_rate_skip(&isp->rate, &scene);
+}
+
+/**
+ * @brief Return to processing every statistics frame, this is called when the application
+ *        changes IPA or ISP parameters.
+ *
+ * @param isp ISP pipeline controller object pointer
+ *
+ * @return None
+ */
+static inline void isp_reset_rate(esp_video_isp_t *isp)
+{
+    esp_video_isp_rate_reset(&isp->rate);
+}
+#endif
+
+static void config_isp_and_camera(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
+{
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+    isp_filter_metadata(isp, metadata);
+#endif
+
+    config_statistics_region(isp, metadata);
+
+    if (!isp->sensor_attr.awb) {
+        config_white_balance(isp, metadata);
     }
 
     config_bayer_filter(isp, metadata);
@@ -879,9 +1334,11 @@ static void config_isp_and_camera(esp_video_isp_t *isp, esp_ipa_metadata_t *meta
 #if ESP_VIDEO_ISP_DEVICE_BLC
     config_blc(isp, metadata);
 #endif
+    isp_ctrls_commit(isp);
+
     config_sensor_ae_target_level(isp, metadata);
     config_exposure_and_gain(isp, metadata);
-#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROL_CAMERA_MOTOR
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROL_CAMERA_MOTOR && !CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_ENGINE
     config_motor_position(isp, metadata);
 #endif
 }
@@ -939,25 +1396,460 @@ static void isp_stats_to_ipa_stats(esp_video_isp_stats_t *isp_stat, esp_ipa_stat
         ipa_stats->flags |= IPA_STATS_FLAGS_HIST;
     }
 
-    if (isp_stat->flags & ESP_VIDEO_ISP_STATS_FLAG_SHARPEN) {
-        esp_ipa_stats_sharpen_t *ipa_sharpen = &ipa_stats->sharpen_stats;
-        esp_isp_sharpen_evt_data_t *isp_sharpen = &isp_stat->sharpen;
+    if (isp_stat->flags & ESP_VIDEO_ISP_STATS_FLAG_SHARPEN) {
+        esp_ipa_stats_sharpen_t *ipa_sharpen = &ipa_stats->sharpen_stats;
+        esp_isp_sharpen_evt_data_t *isp_sharpen = &isp_stat->sharpen;
+
+        ipa_sharpen->value = isp_sharpen->high_freq_pixel_max;
+        ipa_stats->flags |= IPA_STATS_FLAGS_SHARPEN;
+    }
+
+    if (isp_stat->flags & ESP_VIDEO_ISP_STATS_FLAG_AF) {
+        esp_ipa_stats_af_t *ipa_af = ipa_stats->af_stats;
+        isp_af_result_t *isp_af = &isp_stat->af.af_result;
+
+        for (int i = 0; i < ISP_AF_WINDOW_NUM; i++) {
+            ipa_af[i].definition = isp_af->definition[i];
+            ipa_af[i].luminance = isp_af->luminance[i];
+        }
+        ipa_stats->flags |= IPA_STATS_FLAGS_AF;
+    }
+}
+
+/**
+ * @brief Get statistics window region, a window which is not set covers the whole image.
+ */
+static void isp_roi_get_window(esp_video_isp_t *isp, const isp_window_t *window, esp_ipa_region_t *region)
+{
+    if (window->btm_right.x && window->btm_right.y) {
+        region->left = window->top_left.x;
+        region->top = window->top_left.y;
+        region->width = window->btm_right.x - window->top_left.x + 1;
+        region->height = window->btm_right.y - window->top_left.y + 1;
+    } else {
+        region->left = 0;
+        region->top = 0;
+        region->width = isp->sensor.width;
+        region->height = isp->sensor.height;
+    }
+}
+
+static uint32_t isp_roi_overlap(const esp_ipa_region_t *roi, uint32_t left, uint32_t top, uint32_t right, uint32_t bottom)
+{
+    uint32_t l = MAX(roi->left, left);
+    uint32_t t = MAX(roi->top, top);
+    uint32_t r = MIN(roi->left + roi->width, right);
+    uint32_t b = MIN(roi->top + roi->height, bottom);
+
+    return (r > l && b > t) ? (r - l) * (b - t) : 0;
+}
+
+void esp_video_isp_roi_calc_weights(const esp_ipa_region_t *window, const esp_video_isp_roi_t *roi, uint32_t roi_num,
+                                    int x_num, int y_num, uint32_t *weights)
+{
+    for (int x = 0; x < x_num; x++) {
+        uint32_t left = window->left + window->width * x / x_num;
+        uint32_t right = window->left + window->width * (x + 1) / x_num;
+
+        for (int y = 0; y < y_num; y++) {
+            uint32_t top = window->top + window->height * y / y_num;
+            uint32_t bottom = window->top + window->height * (y + 1) / y_num;
+            uint64_t area = (uint64_t)(right - left) * (bottom - top);
+            uint64_t weight = area * ISP_ROI_WEIGHT_BASE;
+
+            for (uint32_t i = 0; i < roi_num; i++) {
+                weight += (uint64_t)roi[i].weight * ISP_ROI_WEIGHT_BASE * isp_roi_overlap(&roi[i].region, left, top, right, bottom);
+            }
+
+            /* Same order as IPA AE statistics and AWB sub-window statistics */
+            weights[x * y_num + y] = area ? weight / area : ISP_ROI_WEIGHT_BASE;
+        }
+    }
+}
+
+static void isp_roi_calc_weights(esp_video_isp_t *isp, const isp_window_t *window, int x_num, int y_num, uint32_t *weights)
+{
+    esp_ipa_region_t region;
+
+    isp_roi_get_window(isp, window, &region);
+    esp_video_isp_roi_calc_weights(&region, isp->roi, isp->roi_num, x_num, y_num, weights);
+}
+
+/**
+ * @brief Scale AE block luminance, so that the average of all blocks is the ROI weighted average.
+ *        The relative luminance between blocks is kept for IPA metering.
+ */
+static void isp_roi_apply_ae(esp_video_isp_t *isp, esp_ipa_stats_t *stats)
+{
+    uint64_t sum = 0;
+    uint64_t weight_sum = 0;
+    uint64_t weighted_sum = 0;
+    uint64_t scale;
+
+    if (!(stats->flags & IPA_STATS_FLAGS_AE)) {
+        return;
+    }
+
+    for (int i = 0; i < ISP_AE_REGIONS; i++) {
+        uint32_t luminance = stats->ae_stats[i].luminance;
+
+        sum += luminance;
+        weight_sum += isp->roi_ae_weight[i];
+        weighted_sum += (uint64_t)luminance * isp->roi_ae_weight[i];
+    }
+
+    if (!sum) {
+        return;
+    }
+
+    scale = weighted_sum * ISP_AE_REGIONS * ISP_ROI_WEIGHT_BASE / (weight_sum * sum);
+    for (int i = 0; i < ISP_AE_REGIONS; i++) {
+        uint64_t luminance = (stats->ae_stats[i].luminance * scale) >> ISP_ROI_WEIGHT_SHIFT;
+
+        stats->ae_stats[i].luminance = MIN(luminance, UINT8_MAX);
+    }
+}
+
+#if ESP_VIDEO_ISP_DEVICE_AWB_SUBWIN
+/**
+ * @brief Scale AWB sub-window statistics by normalized ROI weights, the global AWB statistics
+ *        is replaced by the sum of weighted sub-windows.
+ */
+static void isp_roi_apply_awb(esp_video_isp_t *isp, esp_ipa_stats_t *stats)
+{
+    uint64_t weight_sum = 0;
+    uint64_t total[4] = {0};
+
+    if (!(stats->flags & IPA_STATS_FLAGS_AWB_SUBWIN)) {
+        return;
+    }
+
+    for (int i = 0; i < ISP_AWB_SUBWIN_NUM; i++) {
+        weight_sum += isp->roi_awb_weight[i];
+    }
+
+    for (int xi = 0; xi < ISP_AWB_SUBWIN_X_NUM; xi++) {
+        for (int yj = 0; yj < ISP_AWB_SUBWIN_Y_NUM; yj++) {
+            esp_ipa_stats_awb_t *cell = &stats->awb_subwin[xi][yj];
+            uint64_t scale = (uint64_t)isp->roi_awb_weight[xi * ISP_AWB_SUBWIN_Y_NUM + yj] *
+                             ISP_AWB_SUBWIN_NUM * ISP_ROI_WEIGHT_BASE / weight_sum;
+
+            cell->counted = MIN((cell->counted * scale) >> ISP_ROI_WEIGHT_SHIFT, UINT32_MAX);
+            cell->sum_r = MIN((cell->sum_r * scale) >> ISP_ROI_WEIGHT_SHIFT, UINT32_MAX);
+            cell->sum_g = MIN((cell->sum_g * scale) >> ISP_ROI_WEIGHT_SHIFT, UINT32_MAX);
+            cell->sum_b = MIN((cell->sum_b * scale) >> ISP_ROI_WEIGHT_SHIFT, UINT32_MAX);
+
+            total[0] += cell->counted;
+            total[1] += cell->sum_r;
+            total[2] += cell->sum_g;
+            total[3] += cell->sum_b;
+        }
+    }
+
+    stats->awb_stats[0].counted = MIN(total[0], UINT32_MAX);
+    stats->awb_stats[0].sum_r = MIN(total[1], UINT32_MAX);
+    stats->awb_stats[0].sum_g = MIN(total[2], UINT32_MAX);
+    stats->awb_stats[0].sum_b = MIN(total[3], UINT32_MAX);
+}
+#endif
+
+/**
+ * @brief Weight AE and AWB statistics by regions of interest.
+ *
+ * @note Block weights are only calculated again when ROIs, statistics windows or image
+ *       resolution change, so the per-frame cost is one multiplication per block.
+ *
+ * @param isp   ISP pipeline controller object pointer
+ * @param stats ISP statistics for IPA
+ *
+ * @return None
+ */
+static void isp_roi_process(esp_video_isp_t *isp, esp_ipa_stats_t *stats)
+{
+    if (!isp->roi_num) {
+        return;
+    }
+
+    if (isp->roi_changed || (isp->roi_width != isp->sensor.width) || (isp->roi_height != isp->sensor.height)) {
+        isp_roi_calc_weights(isp, &isp->ae_window, ISP_AE_BLOCK_X_NUM, ISP_AE_BLOCK_Y_NUM, isp->roi_ae_weight);
+#if ESP_VIDEO_ISP_DEVICE_AWB_SUBWIN
+        isp_roi_calc_weights(isp, &isp->awb_window, ISP_AWB_SUBWIN_X_NUM, ISP_AWB_SUBWIN_Y_NUM, isp->roi_awb_weight);
+#endif
+        isp->roi_width = isp->sensor.width;
+        isp->roi_height = isp->sensor.height;
+        isp->roi_changed = false;
+    }
+
+    isp_roi_apply_ae(isp, stats);
+#if ESP_VIDEO_ISP_DEVICE_AWB_SUBWIN
+    isp_roi_apply_awb(isp, stats);
+#endif
+}
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_DETECT
+static void isp_motion_init(esp_video_isp_t *isp, const esp_video_isp_config_t *config)
+{
+    const esp_video_motion_config_t motion_config = {
+        .grid_width = ISP_AE_BLOCK_X_NUM,
+        .grid_height = ISP_AE_BLOCK_Y_NUM,
+        .threshold = CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_THRESHOLD * 256 / 100,
+        .min_cells = CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_MIN_CELLS,
+        .trigger_frames = CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_TRIGGER_FRAMES,
+        .hold_frames = CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_HOLD_FRAMES,
+        .scene_change_percent = ISP_MOTION_SCENE_CHANGE_PERCENT,
+    };
+
+    esp_video_motion_init(&isp->motion, &motion_config);
+
+    isp->cam_video = esp_video_device_get_object_by_path(config->cam_dev);
+    if (!isp->cam_video) {
+        ESP_LOGW(TAG, "failed to find %s, motion events are not sent", config->cam_dev);
+    }
+}
+
+/**
+ * @brief Detect motion by AE luminance and AWB sub-window grids, and send motion events to
+ *        the camera video device.
+ *
+ * @note This runs on every statistics frame before ROI weighting, so the grids are the raw ones.
+ *
+ * @param isp   ISP pipeline controller object pointer
+ * @param stats ISP statistics for IPA
+ *
+ * @return None
+ */
+static void isp_motion_process(esp_video_isp_t *isp, const esp_ipa_stats_t *stats)
+{
+    uint32_t luma[ESP_VIDEO_MOTION_MAX_CELLS];
+    esp_video_motion_chroma_t *chroma = NULL;
+    esp_video_motion_result_t result;
+    esp_video_motion_event_t motion_event;
+#if ESP_VIDEO_ISP_DEVICE_AWB_SUBWIN && (ISP_AWB_SUBWIN_X_NUM == ISP_AE_BLOCK_X_NUM) && (ISP_AWB_SUBWIN_Y_NUM == ISP_AE_BLOCK_Y_NUM)
+    esp_video_motion_chroma_t awb[ESP_VIDEO_MOTION_MAX_CELLS];
+#endif
+
+    if (!(stats->flags & IPA_STATS_FLAGS_AE)) {
+        return;
+    }
+
+    /* IPA statistics grids are in column order */
+    for (int x = 0; x < ISP_AE_BLOCK_X_NUM; x++) {
+        for (int y = 0; y < ISP_AE_BLOCK_Y_NUM; y++) {
+            luma[y * ISP_AE_BLOCK_X_NUM + x] = stats->ae_stats[x * ISP_AE_BLOCK_Y_NUM + y].luminance;
+        }
+    }
+
+#if ESP_VIDEO_ISP_DEVICE_AWB_SUBWIN && (ISP_AWB_SUBWIN_X_NUM == ISP_AE_BLOCK_X_NUM) && (ISP_AWB_SUBWIN_Y_NUM == ISP_AE_BLOCK_Y_NUM)
+    if (stats->flags & IPA_STATS_FLAGS_AWB_SUBWIN) {
+        for (int x = 0; x < ISP_AWB_SUBWIN_X_NUM; x++) {
+            for (int y = 0; y < ISP_AWB_SUBWIN_Y_NUM; y++) {
+                const esp_ipa_stats_awb_t *cell = &stats->awb_subwin[x][y];
+                esp_video_motion_chroma_t *c = &awb[y * ISP_AWB_SUBWIN_X_NUM + x];
+
+                c->counted = cell->counted;
+                c->sum_r = cell->sum_r;
+                c->sum_g = cell->sum_g;
+                c->sum_b = cell->sum_b;
+            }
+        }
+
+        chroma = awb;
+    }
+#endif
+
+    motion_event = esp_video_motion_process(&isp->motion, luma, chroma, &result);
+    if ((motion_event != ESP_VIDEO_MOTION_EVENT_NONE) && isp->cam_video) {
+        struct v4l2_event event = {
+            .type = V4L2_EVENT_ESP_MOTION_DETECT,
+            .sequence = isp->motion_sequence++,
+        };
+        v4l2_event_esp_motion_detect_t *data = (v4l2_event_esp_motion_detect_t *)event.u.data;
+
+        data->state = motion_event == ESP_VIDEO_MOTION_EVENT_START ? ESP_MOTION_DETECT_STATE_START : ESP_MOTION_DETECT_STATE_STOP;
+        data->map = result.map;
+        data->grid_width = ISP_AE_BLOCK_X_NUM;
+        data->grid_height = ISP_AE_BLOCK_Y_NUM;
+        data->scene_change = result.scene_change;
+        data->level = result.level;
+        data->frames = result.frames;
+
+        ESP_LOGD(TAG, "motion %s: map=0x%08"PRIx32" level=%"PRIu32, data->state ? "start" : "stop", data->map, data->level);
+
+        /* Event is dropped if it is not subscribed or application doesn't dequeue events in time */
+        esp_video_queue_event(isp->cam_video, &event);
+    }
+}
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+static void isp_flicker_init(esp_video_isp_t *isp, const esp_video_isp_config_t *config)
+{
+    const esp_video_flicker_config_t flicker_config = {
+        .window_frames = ISP_FLICKER_WINDOW_FRAMES,
+        .min_amplitude = ISP_FLICKER_MIN_AMPLITUDE,
+        .confirm_windows = ISP_FLICKER_CONFIRM_WINDOWS,
+    };
+
+    esp_video_flicker_init(&isp->flicker, &flicker_config);
+
+    isp->ipa_config = config->ipa_config;
+    isp->ac_freq = ISP_AC_FREQ_CONFIG;
+    isp->pending_ac_freq = ISP_AC_FREQ_CONFIG;
+}
+
+static int32_t isp_flicker_get_ac_freq(esp_video_isp_t *isp, uint32_t detected_freq)
+{
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+
+    controls.ctrl_class = V4L2_CID_USER_CLASS;
+    controls.count      = 1;
+    controls.controls   = control;
+    control[0].id       = V4L2_CID_POWER_LINE_FREQUENCY;
+    if (ioctl(isp->isp_fd, VIDIOC_G_EXT_CTRLS, &controls) != 0) {
+        control[0].value = V4L2_CID_POWER_LINE_FREQUENCY_AUTO;
+    }
+
+    switch (control[0].value) {
+    case V4L2_CID_POWER_LINE_FREQUENCY_DISABLED:
+        return 0;
+    case V4L2_CID_POWER_LINE_FREQUENCY_50HZ:
+        return ESP_VIDEO_FLICKER_FREQ_50HZ;
+    case V4L2_CID_POWER_LINE_FREQUENCY_60HZ:
+        return ESP_VIDEO_FLICKER_FREQ_60HZ;
+    default:
+        return detected_freq != ESP_VIDEO_FLICKER_FREQ_UNKNOWN ? detected_freq : ISP_AC_FREQ_CONFIG;
+    }
+}
+
+/**
+ * @brief Create IPA pipeline by the IPA configuration of application with AGC anti-flicker changed.
+ *
+ * @note Two copies of the configuration are used in turn, because the running IPA pipeline may
+ *       refer to the previous one until it is swapped out.
+ */
+static esp_err_t isp_flicker_create_ipa_pipeline(esp_video_isp_t *isp, const esp_ipa_config_t *ipa_config,
+        int32_t ac_freq, esp_ipa_pipeline_handle_t *ipa_pipeline)
+{
+    esp_err_t ret;
+    uint8_t index = isp->flicker_config_index ^ 1;
+    esp_ipa_agc_config_t *agc = &isp->flicker_agc_config[index];
+    esp_ipa_config_t *config = &isp->flicker_ipa_config[index];
+
+    if (ac_freq == ISP_AC_FREQ_CONFIG) {
+        return esp_ipa_pipeline_create(ipa_config, ipa_pipeline);
+    }
+
+    *agc = *ipa_config->agc;
+    if (ac_freq) {
+        /* Keep full or part mode of configuration, part mode still allows short exposure in bright scenes */
+        if (agc->anti_flicker_mode == ESP_IPA_AGC_ANTI_FLICKER_NONE) {
+            agc->anti_flicker_mode = ESP_IPA_AGC_ANTI_FLICKER_PART;
+        }
+        agc->ac_freq = ac_freq;
+    } else {
+        agc->anti_flicker_mode = ESP_IPA_AGC_ANTI_FLICKER_NONE;
+        agc->ac_freq = 0;
+    }
+
+    *config = *ipa_config;
+    config->agc = agc;
+
+    ret = esp_ipa_pipeline_create(config, ipa_pipeline);
+    if (ret == ESP_OK) {
+        isp->flicker_config_index = index;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Detect light flicker by rows of AE luminance grid, switch AGC anti-flicker to the
+ *        detected or forced power line frequency, and report the detected frequency.
+ *
+ * @param isp       ISP pipeline controller object pointer
+ * @param stats     ISP statistics for IPA, before ROI weighting
+ * @param timestamp Statistics frame timestamp
+ *
+ * @return None
+ */
+static void isp_flicker_process(esp_video_isp_t *isp, const esp_ipa_stats_t *stats, const struct timeval *timestamp)
+{
+    uint32_t luma[ISP_AE_BLOCK_Y_NUM];
+    esp_ipa_region_t window;
+    const esp_ipa_config_t *ipa_config;
+    esp_ipa_pipeline_handle_t ipa_pipeline;
+    esp_ipa_pipeline_handle_t replaced_ipa_pipeline;
+    uint32_t freq;
+    int32_t ac_freq;
+    int32_t target_ac_freq;
+    bool pending;
+
+    if (!(stats->flags & IPA_STATS_FLAGS_AE) || !isp->sensor_tline_ns) {
+        return;
+    }
+
+    for (int y = 0; y < ISP_AE_BLOCK_Y_NUM; y++) {
+        luma[y] = 0;
+        for (int x = 0; x < ISP_AE_BLOCK_X_NUM; x++) {
+            luma[y] += stats->ae_stats[x * ISP_AE_BLOCK_Y_NUM + y].luminance;
+        }
+        luma[y] /= ISP_AE_BLOCK_X_NUM;
+    }
+
+    _lock_acquire(&s_isp_lock);
+    isp_roi_get_window(isp, &isp->ae_window, &window);
+    _lock_release(&s_isp_lock);
+
+    /* AE block rows are exposed one block height of lines apart */
+    freq = esp_video_flicker_process(&isp->flicker, isp_timeval_to_us(timestamp),
+                                     window.height / ISP_AE_BLOCK_Y_NUM * isp->sensor_tline_ns,
+                                     luma, ISP_AE_BLOCK_Y_NUM);
+    if (freq != isp->reported_freq) {
+        /* Control is read-only to applications, so it is updated by the ISP video device internal API */
+        if (esp_video_isp_video_device_set_flicker(freq) == ESP_OK) {
+            isp->reported_freq = freq;
+            ESP_LOGD(TAG, "power line frequency: %"PRIu32"Hz", freq);
+        }
+    }
+
+    ac_freq = isp_flicker_get_ac_freq(isp, freq);
+
+    _lock_acquire(&s_isp_lock);
+    ipa_config = isp->ipa_config;
+    pending = isp->pending_ipa_pipeline != NULL;
+    target_ac_freq = pending ? isp->pending_ac_freq : isp->ac_freq;
+    _lock_release(&s_isp_lock);
+
+    /* Wait for the pending pipeline to be swapped, so only two copies of configuration are in use */
+    if ((ac_freq == target_ac_freq) || !ipa_config->agc || pending) {
+        return;
+    }
 
-        ipa_sharpen->value = isp_sharpen->high_freq_pixel_max;
-        ipa_stats->flags |= IPA_STATS_FLAGS_SHARPEN;
+    /* This only happens when detected frequency or application setting changes, so it is created in ISP task */
+    if (isp_flicker_create_ipa_pipeline(isp, ipa_config, ac_freq, &ipa_pipeline) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to create IPA pipeline for anti-flicker");
+        return;
     }
 
-    if (isp_stat->flags & ESP_VIDEO_ISP_STATS_FLAG_AF) {
-        esp_ipa_stats_af_t *ipa_af = ipa_stats->af_stats;
-        isp_af_result_t *isp_af = &isp_stat->af.af_result;
+    _lock_acquire(&s_isp_lock);
+    if ((isp->ipa_config == ipa_config) && !isp->pending_ipa_pipeline) {
+        isp->pending_ipa_pipeline = ipa_pipeline;
+        isp->pending_ac_freq = ac_freq;
+        replaced_ipa_pipeline = NULL;
+    } else {
+        /* Application swapped IPA configuration meanwhile, its pipeline is taken first */
+        replaced_ipa_pipeline = ipa_pipeline;
+    }
+    _lock_release(&s_isp_lock);
 
-        for (int i = 0; i < ISP_AF_WINDOW_NUM; i++) {
-            ipa_af[i].definition = isp_af->definition[i];
-            ipa_af[i].luminance = isp_af->luminance[i];
-        }
-        ipa_stats->flags |= IPA_STATS_FLAGS_AF;
+    if (replaced_ipa_pipeline) {
+        esp_ipa_pipeline_destroy(replaced_ipa_pipeline);
+    } else {
+        ESP_LOGD(TAG, "AGC anti-flicker: %"PRIi32"Hz", ac_freq);
     }
 }
+#endif
 
 static void get_sensor_state(esp_video_isp_t *isp, int index)
 {
@@ -1031,6 +1923,62 @@ static void isp_stats_to_queue(esp_video_isp_t *isp, esp_video_isp_stats_t *stat
     _lock_release(&s_isp_lock);
 }
 
+/**
+ * Sensor and lens state is kept when swapping IPA pipeline, so the new pipeline starts from the
+ * current exposure, white balance gains and focus position instead of its initial values
+ */
+#define ISP_SWAP_KEEP_METADATA_FLAGS    (IPA_METADATA_FLAGS_RG | IPA_METADATA_FLAGS_BG | \
+                                         IPA_METADATA_FLAGS_ET | IPA_METADATA_FLAGS_GN | \
+                                         IPA_METADATA_FLAGS_FP)
+
+static void isp_copy_ipa_state(esp_ipa_pipeline_handle_t src, esp_ipa_pipeline_handle_t dst)
+{
+    int status;
+    uint32_t exposure;
+
+    /* Runtime AGC settings set by application should survive the swap */
+    if (esp_ipa_pipeline_ioctl(src, ESP_IPA_AGC_G_STATUS, &status) == ESP_OK) {
+        esp_ipa_pipeline_ioctl(dst, ESP_IPA_AGC_S_STATUS, &status);
+    }
+
+    if (esp_ipa_pipeline_ioctl(src, ESP_IPA_AGC_G_MAX_EXPOSURE, &exposure) == ESP_OK) {
+        esp_ipa_pipeline_ioctl(dst, ESP_IPA_AGC_S_MAX_EXPOSURE, &exposure);
+    }
+
+    if (esp_ipa_pipeline_ioctl(src, ESP_IPA_AGC_G_MIN_EXPOSURE, &exposure) == ESP_OK) {
+        esp_ipa_pipeline_ioctl(dst, ESP_IPA_AGC_S_MIN_EXPOSURE, &exposure);
+    }
+}
+
+static void isp_swap_ipa_pipeline(esp_video_isp_t *isp, esp_ipa_pipeline_handle_t ipa_pipeline)
+{
+    esp_ipa_pipeline_handle_t old_ipa_pipeline;
+
+    /* Sensor state is up to date here, so the new pipeline is initialized from current exposure and gain */
+    isp->metadata.flags = 0;
+    if (esp_ipa_pipeline_init(ipa_pipeline, &isp->sensor, &isp->metadata) != ESP_OK) {
+        ESP_LOGE(TAG, "failed to initialize new IPA pipeline, keep the current one");
+        esp_ipa_pipeline_destroy(ipa_pipeline);
+        return;
+    }
+
+    _lock_acquire(&s_isp_lock);
+    old_ipa_pipeline = isp->ipa_pipeline;
+    isp_copy_ipa_state(old_ipa_pipeline, ipa_pipeline);
+    isp->ipa_pipeline = ipa_pipeline;
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+    isp_reset_rate(isp);
+#endif
+    _lock_release(&s_isp_lock);
+
+    isp->metadata.flags &= ~ISP_SWAP_KEEP_METADATA_FLAGS;
+    config_isp_and_camera(isp, &isp->metadata);
+
+    esp_ipa_pipeline_destroy(old_ipa_pipeline);
+
+    ESP_LOGD(TAG, "IPA pipeline is swapped");
+}
+
 static void isp_task(void *p)
 {
     esp_err_t ret;
@@ -1056,6 +2004,51 @@ static void isp_task(void *p)
         }
         print_stats_info(&isp->ipa_stats);
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_DETECT
+        isp_motion_process(isp, &isp->ipa_stats);
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+        isp_flicker_process(isp, &isp->ipa_stats, &buf.timestamp);
+#endif
+
+        _lock_acquire(&s_isp_lock);
+        isp_roi_process(isp, &isp->ipa_stats);
+        _lock_release(&s_isp_lock);
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_ENGINE
+        isp_af_process(isp, &isp->ipa_stats);
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING
+        if (isp_bracketing_process(isp, &buf.timestamp)) {
+            continue;
+        }
+#endif
+
+        _lock_acquire(&s_isp_lock);
+        esp_ipa_pipeline_handle_t pending_ipa_pipeline = isp->pending_ipa_pipeline;
+        isp->pending_ipa_pipeline = NULL;
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+        int32_t pending_ac_freq = isp->pending_ac_freq;
+#endif
+        _lock_release(&s_isp_lock);
+        if (pending_ipa_pipeline) {
+            isp_swap_ipa_pipeline(isp, pending_ipa_pipeline);
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+            isp->ac_freq = pending_ac_freq;
+#endif
+        }
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+        _lock_acquire(&s_isp_lock);
+        bool skip = isp_skip_process(isp, &isp->ipa_stats);
+        _lock_release(&s_isp_lock);
+        if (skip) {
+            continue;
+        }
+#endif
+
         isp->metadata.flags = 0;
         ret = esp_ipa_pipeline_process(isp->ipa_pipeline, &isp->ipa_stats, &isp->sensor, &isp->metadata);
         if (ret != ESP_OK) {
@@ -1063,6 +2056,14 @@ static void isp_task(void *p)
             continue;
         }
 
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING
+        /* Bracketing exposure is based on AE exposure, it is set by ISP task every frame */
+        if ((isp->bracketing_active.num >= 2) && (isp->metadata.flags & IPA_METADATA_FLAGS_ET)) {
+            isp->ae_exposure = isp->metadata.exposure;
+            isp->metadata.flags &= ~IPA_METADATA_FLAGS_ET;
+        }
+#endif
+
         config_isp_and_camera(isp, &isp->metadata);
     }
 
@@ -1412,6 +2413,18 @@ esp_err_t esp_video_isp_pipeline_init(const esp_video_isp_config_t *config)
 
     ESP_GOTO_ON_ERROR(init_cam_dev(config, isp), fail_1, TAG, "failed to initialize camera device");
     ESP_GOTO_ON_ERROR(init_isp_dev(config, isp), fail_2, TAG, "failed to initialize ISP device");
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_ENGINE
+    isp_af_init(isp);
+#endif
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_MOTION_DETECT
+    isp_motion_init(isp, config);
+#endif
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+    isp_flicker_init(isp, config);
+#endif
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+    isp_rate_init(isp);
+#endif
 
     metadata.flags = 0;
     ESP_GOTO_ON_ERROR(esp_ipa_pipeline_init(isp->ipa_pipeline, &isp->sensor, &metadata),
@@ -1499,6 +2512,10 @@ esp_err_t esp_video_isp_pipeline_deinit(void)
     ESP_GOTO_ON_FALSE(close(isp->isp_fd) == 0, ESP_FAIL, fail_0, TAG, "failed to close ISP");
     ESP_GOTO_ON_FALSE(close(isp->cam_fd) == 0, ESP_FAIL, fail_0, TAG, "failed to close camera sensor");
     ESP_GOTO_ON_ERROR(esp_ipa_pipeline_destroy(isp->ipa_pipeline), fail_0, TAG, "failed to destroy pipeline");
+    if (isp->pending_ipa_pipeline) {
+        esp_ipa_pipeline_destroy(isp->pending_ipa_pipeline);
+        isp->pending_ipa_pipeline = NULL;
+    }
 
     if (isp->isp_stats_queue) {
         vQueueDelete(isp->isp_stats_queue);
@@ -1532,6 +2549,51 @@ bool esp_video_isp_pipeline_is_initialized(void)
     return is_initialized;
 }
 
+/**
+ * @brief Swap IPA pipeline configuration without stopping ISP pipeline.
+ *
+ * @param ipa_config IPA configuration
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_swap_ipa_config(const esp_ipa_config_t *ipa_config)
+{
+    esp_err_t ret;
+    esp_ipa_pipeline_handle_t ipa_pipeline;
+    esp_ipa_pipeline_handle_t replaced_ipa_pipeline = NULL;
+
+    ESP_RETURN_ON_FALSE(ipa_config, ESP_ERR_INVALID_ARG, TAG, "ipa_config is NULL");
+
+    /* Creating the pipeline may allocate memory, do it out of the ISP task to keep frame processing on time */
+    ESP_RETURN_ON_ERROR(esp_ipa_pipeline_create(ipa_config, &ipa_pipeline), TAG, "failed to create IPA pipeline");
+
+    _lock_acquire(&s_isp_lock);
+    if (s_esp_video_isp) {
+        replaced_ipa_pipeline = s_esp_video_isp->pending_ipa_pipeline;
+        s_esp_video_isp->pending_ipa_pipeline = ipa_pipeline;
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+        /* Anti-flicker of the new configuration is applied again by ISP task if it is different */
+        s_esp_video_isp->ipa_config = ipa_config;
+        s_esp_video_isp->pending_ac_freq = ISP_AC_FREQ_CONFIG;
+#endif
+        ret = ESP_OK;
+    } else {
+        ESP_LOGD(TAG, "ISP controller is not initialized");
+        replaced_ipa_pipeline = ipa_pipeline;
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    _lock_release(&s_isp_lock);
+
+    /* A pipeline which has not been taken by the ISP task is overridden by the latest one */
+    if (replaced_ipa_pipeline) {
+        esp_ipa_pipeline_destroy(replaced_ipa_pipeline);
+    }
+
+    return ret;
+}
+
 /**
  * @brief Set AGC status.
  *
@@ -1550,6 +2612,9 @@ esp_err_t esp_video_isp_pipeline_set_agc_status(esp_video_isp_pipeline_agc_statu
         int value = status;
 
         ret = esp_ipa_pipeline_ioctl(s_esp_video_isp->ipa_pipeline, ESP_IPA_AGC_S_STATUS, &value);
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+        isp_reset_rate(s_esp_video_isp);
+#endif
     } else {
         ESP_LOGD(TAG, "ISP controller is not initialized");
     }
@@ -1630,6 +2695,9 @@ static esp_err_t isp_pipeline_set_statistics_window(esp_video_isp_t *isp, uint32
 
         isp_pipeline_fill_windows(ae.windows, ISP_AE_WINDOW_NUM, left, top, width, height);
         ESP_RETURN_ON_FALSE(ioctl(fd, VIDIOC_S_EXT_CTRLS, &controls) == 0, ESP_FAIL, TAG, "failed to set AE statistics window");
+
+        isp->ae_window = ae.windows[0];
+        isp->roi_changed = true;
     }
 
     if (target_windows & ESP_VIDEO_ISP_HIST_STATS_WIN) {
@@ -1652,6 +2720,9 @@ static esp_err_t isp_pipeline_set_statistics_window(esp_video_isp_t *isp, uint32
 
         isp_pipeline_fill_windows(awb.windows, ISP_AWB_WINDOW_NUM, left, top, width, height);
         ESP_RETURN_ON_FALSE(ioctl(fd, VIDIOC_S_EXT_CTRLS, &controls) == 0, ESP_FAIL, TAG, "failed to set AWB statistics window");
+
+        isp->awb_window = awb.windows[0];
+        isp->roi_changed = true;
     }
 
     return ESP_OK;
@@ -1815,6 +2886,10 @@ esp_err_t esp_video_isp_pipeline_set_statistics_window(uint32_t target_windows,
 
     if (s_esp_video_isp) {
         ret = isp_pipeline_set_statistics_window(s_esp_video_isp, target_windows, left, top, width, height);
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+        s_esp_video_isp->applied_metadata.flags &= ~IPA_METADATA_FLAGS_SR;
+        isp_reset_rate(s_esp_video_isp);
+#endif
     } else {
         ESP_LOGD(TAG, "ISP controller is not initialized");
         ret = ESP_ERR_INVALID_STATE;
@@ -1824,6 +2899,48 @@ esp_err_t esp_video_isp_pipeline_set_statistics_window(uint32_t target_windows,
     return ret;
 }
 
+/**
+ * @brief Set regions of interest of AE and AWB.
+ *
+ * @param roi ROI array
+ * @param num ROI number, 0 means clearing all ROIs
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_set_roi(const esp_video_isp_roi_t *roi, uint32_t num)
+{
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+
+    ESP_RETURN_ON_FALSE(num <= ESP_VIDEO_ISP_ROI_MAX_NUM, ESP_ERR_INVALID_ARG, TAG, "too many ROIs");
+    ESP_RETURN_ON_FALSE(!num || roi, ESP_ERR_INVALID_ARG, TAG, "roi is NULL");
+    for (uint32_t i = 0; i < num; i++) {
+        ESP_RETURN_ON_FALSE(roi[i].region.width > 0 && roi[i].region.height > 0,
+                            ESP_ERR_INVALID_ARG, TAG, "invalid ROI size");
+        ESP_RETURN_ON_FALSE(roi[i].weight <= ESP_VIDEO_ISP_ROI_WEIGHT_MAX,
+                            ESP_ERR_INVALID_ARG, TAG, "invalid ROI weight");
+    }
+
+    _lock_acquire(&s_isp_lock);
+    if (s_esp_video_isp) {
+        if (num) {
+            memcpy(s_esp_video_isp->roi, roi, num * sizeof(esp_video_isp_roi_t));
+        }
+        s_esp_video_isp->roi_num = num;
+        s_esp_video_isp->roi_changed = true;
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+        isp_reset_rate(s_esp_video_isp);
+#endif
+        ret = ESP_OK;
+    } else {
+        ESP_LOGD(TAG, "ISP controller is not initialized");
+    }
+    _lock_release(&s_isp_lock);
+
+    return ret;
+}
+
 /**
  * @brief Validate exposure against sensor range and align it to the exposure step.
  *
@@ -1879,6 +2996,9 @@ esp_err_t esp_video_isp_pipeline_set_agc_max_exposure(uint32_t exposure_us)
         if (ret == ESP_OK) {
             ret = esp_ipa_pipeline_ioctl(s_esp_video_isp->ipa_pipeline, ESP_IPA_AGC_S_MAX_EXPOSURE, &value);
             if (ret == ESP_OK) {
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+                isp_reset_rate(s_esp_video_isp);
+#endif
                 ESP_LOGD(TAG, "AGC maximum exposure: %" PRIu32 " us", value);
             }
         }
@@ -1937,6 +3057,9 @@ esp_err_t esp_video_isp_pipeline_set_agc_min_exposure(uint32_t exposure_us)
         if (ret == ESP_OK) {
             ret = esp_ipa_pipeline_ioctl(s_esp_video_isp->ipa_pipeline, ESP_IPA_AGC_S_MIN_EXPOSURE, &value);
             if (ret == ESP_OK) {
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+                isp_reset_rate(s_esp_video_isp);
+#endif
                 ESP_LOGD(TAG, "AGC minimum exposure: %" PRIu32 " us", value);
             }
         }
@@ -1973,3 +3096,223 @@ esp_err_t esp_video_isp_pipeline_get_agc_min_exposure(uint32_t *exposure_us)
 
     return ret;
 }
+
+/**
+ * @brief Get BF denoising level which is selected by the IPA auto denoising algorithm from
+ *        sensor gain and applied to ISP currently, e.g. to control software denoising stages.
+ *
+ * @param level Pointer to store BF denoising level
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ *      - ESP_ERR_NOT_FOUND if IPA has not enabled BF
+ */
+esp_err_t esp_video_isp_pipeline_get_denoise_level(uint8_t *level)
+{
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+
+    ESP_RETURN_ON_FALSE(level, ESP_ERR_INVALID_ARG, TAG, "level is NULL");
+
+    _lock_acquire(&s_isp_lock);
+    if (s_esp_video_isp) {
+        const esp_video_isp_bf_t *bf = &s_esp_video_isp->ctrls.bf;
+
+        if (bf->enable) {
+            *level = bf->level;
+            ret = ESP_OK;
+        } else {
+            ret = ESP_ERR_NOT_FOUND;
+        }
+    } else {
+        ESP_LOGD(TAG, "ISP controller is not initialized");
+    }
+    _lock_release(&s_isp_lock);
+
+    return ret;
+}
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_AF_ENGINE
+/**
+ * @brief Restart auto focus search, e.g. when the application knows the scene has changed.
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ *      - ESP_ERR_NOT_SUPPORTED if camera has no focus motor
+ */
+esp_err_t esp_video_isp_pipeline_af_trigger(void)
+{
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+
+    _lock_acquire(&s_isp_lock);
+    if (s_esp_video_isp) {
+        if (s_esp_video_isp->sensor.focus_info) {
+            esp_video_af_start(&s_esp_video_isp->af);
+            ret = ESP_OK;
+        } else {
+            ret = ESP_ERR_NOT_SUPPORTED;
+        }
+    } else {
+        ESP_LOGD(TAG, "ISP controller is not initialized");
+    }
+    _lock_release(&s_isp_lock);
+
+    return ret;
+}
+
+/**
+ * @brief Get auto focus engine state and lens position.
+ *
+ * @param state Pointer to store AF state
+ * @param pos   Pointer to store lens position, it can be NULL
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_get_af_state(esp_video_isp_pipeline_af_state_t *state, uint32_t *pos)
+{
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+
+    ESP_RETURN_ON_FALSE(state, ESP_ERR_INVALID_ARG, TAG, "state is NULL");
+
+    _lock_acquire(&s_isp_lock);
+    if (s_esp_video_isp) {
+        const esp_video_af_t *af = &s_esp_video_isp->af;
+
+        switch (af->state) {
+        case ESP_VIDEO_AF_STATE_COARSE:
+        case ESP_VIDEO_AF_STATE_FINE:
+            *state = ESP_VIDEO_ISP_PIPELINE_AF_SEARCHING;
+            break;
+        case ESP_VIDEO_AF_STATE_LOCKED:
+            /* Lens may still be moving to the sharpest position */
+            *state = af->pos == af->target ? ESP_VIDEO_ISP_PIPELINE_AF_LOCKED : ESP_VIDEO_ISP_PIPELINE_AF_SEARCHING;
+            break;
+        case ESP_VIDEO_AF_STATE_FAILED:
+            *state = ESP_VIDEO_ISP_PIPELINE_AF_FAILED;
+            break;
+        default:
+            *state = ESP_VIDEO_ISP_PIPELINE_AF_IDLE;
+            break;
+        }
+
+        if (pos) {
+            *pos = af->pos;
+        }
+        ret = ESP_OK;
+    } else {
+        ESP_LOGD(TAG, "ISP controller is not initialized");
+    }
+    _lock_release(&s_isp_lock);
+
+    return ret;
+}
+#endif
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING
+/**
+ * @brief Set exposure bracketing, frames are exposed by the ratios of the AE exposure in turn.
+ *
+ * @param config Bracketing configuration, NULL means disabling bracketing
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ *      - ESP_ERR_NOT_SUPPORTED if camera sensor exposure can't be set
+ */
+esp_err_t esp_video_isp_pipeline_set_bracketing(const esp_video_isp_bracketing_config_t *config)
+{
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+    esp_video_isp_bracketing_config_t bracketing = {0};
+
+    if (config && (config->num >= 2)) {
+        bool has_ref = false;
+
+        ESP_RETURN_ON_FALSE(config->num <= ESP_VIDEO_ISP_BRACKETING_MAX_NUM, ESP_ERR_INVALID_ARG, TAG, "too many exposures");
+        for (uint32_t i = 0; i < config->num; i++) {
+            ESP_RETURN_ON_FALSE(config->exposure_ratio[i], ESP_ERR_INVALID_ARG, TAG, "invalid exposure ratio");
+            if (config->exposure_ratio[i] == ISP_BRACKETING_REF_RATIO) {
+                has_ref = true;
+            }
+        }
+        ESP_RETURN_ON_FALSE(has_ref, ESP_ERR_INVALID_ARG, TAG, "no AE exposure in bracketing");
+
+        bracketing = *config;
+    }
+
+    _lock_acquire(&s_isp_lock);
+    if (s_esp_video_isp) {
+        if ((bracketing.num >= 2) && !s_esp_video_isp->sensor_attr.exposure) {
+            ret = ESP_ERR_NOT_SUPPORTED;
+        } else {
+            s_esp_video_isp->bracketing = bracketing;
+            s_esp_video_isp->bracketing_changed = true;
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_ADAPTIVE_RATE
+            isp_reset_rate(s_esp_video_isp);
+#endif
+            ret = ESP_OK;
+        }
+    } else {
+        ESP_LOGD(TAG, "ISP controller is not initialized");
+    }
+    _lock_release(&s_isp_lock);
+
+    return ret;
+}
+
+/**
+ * @brief Get exposure information of a captured frame by its timestamp, e.g. to pick frames
+ *        of different exposures for HDR merging.
+ *
+ * @param timestamp Timestamp of captured frame, e.g. "timestamp" of "struct v4l2_buffer"
+ * @param info      Pointer to store frame information
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if arguments are invalid
+ *      - ESP_ERR_INVALID_STATE if ISP pipeline is not initialized
+ *      - ESP_ERR_NOT_FOUND if the frame is too old or no statistics frame matches it
+ */
+esp_err_t esp_video_isp_pipeline_get_frame_info(const struct timeval *timestamp, esp_video_isp_frame_info_t *info)
+{
+    esp_err_t ret = ESP_ERR_INVALID_STATE;
+
+    ESP_RETURN_ON_FALSE(timestamp && info, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    _lock_acquire(&s_isp_lock);
+    if (s_esp_video_isp) {
+        esp_video_isp_t *isp = s_esp_video_isp;
+        uint32_t num = MIN(isp->frame_info_count, ISP_FRAME_INFO_NUM);
+        int64_t time_us = isp_timeval_to_us(timestamp);
+        const esp_video_isp_frame_info_t *match = NULL;
+        int64_t match_diff = 0;
+
+        /* Statistics and capture frames are done at nearly the same time, the closest one is the same frame */
+        for (uint32_t i = 0; i < num; i++) {
+            int64_t diff = isp_timeval_to_us(&isp->frame_info[i].timestamp) - time_us;
+
+            diff = diff < 0 ? -diff : diff;
+            if (!match || (diff < match_diff)) {
+                match = &isp->frame_info[i];
+                match_diff = diff;
+            }
+        }
+
+        if (match && isp->frame_period && (match_diff * 2 < isp->frame_period)) {
+            *info = *match;
+            ret = ESP_OK;
+        } else {
+            ret = ESP_ERR_NOT_FOUND;
+        }
+    } else {
+        ESP_LOGD(TAG, "ISP controller is not initialized");
+    }
+    _lock_release(&s_isp_lock);
+
+    return ret;
+}
+#endif
@@ -0,0 +1,51 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <string.h>
+#include <sys/param.h>
+#include "esp_video_isp_rate.h"
+
+static bool rate_value_changed(const esp_video_isp_rate_t *rate, uint32_t cur, uint32_t ref)
+{
+    uint32_t diff = cur > ref ? cur - ref : ref - cur;
+
+    return (uint64_t)diff * 100 > (uint64_t)MAX(ref, 1) * rate->config.threshold;
+}
+
+void esp_video_isp_rate_init(esp_video_isp_rate_t *rate, const esp_video_isp_rate_config_t *config)
+{
+    memset(rate, 0, sizeof(esp_video_isp_rate_t));
+    rate->config = *config;
+}
+
+void esp_video_isp_rate_reset(esp_video_isp_rate_t *rate)
+{
+    rate->stable_count = 0;
+    rate->skip_count = 0;
+}
+
+bool esp_video_isp_rate_skip(esp_video_isp_rate_t *rate, const esp_video_isp_scene_t *scene)
+{
+    esp_video_isp_scene_t *ref = &rate->scene;
+
+    if (rate_value_changed(rate, scene->luma, ref->luma) ||
+            rate_value_changed(rate, scene->rg, ref->rg) ||
+            rate_value_changed(rate, scene->bg, ref->bg) ||
+            rate_value_changed(rate, scene->definition, ref->definition) ||
+            (scene->exposure != ref->exposure) ||
+            (scene->gain != ref->gain)) {
+        esp_video_isp_rate_reset(rate);
+    } else if (rate->stable_count < rate->config.stable_frames) {
+        rate->stable_count++;
+    } else if (++rate->skip_count < rate->config.decimation) {
+        return true;
+    } else {
+        rate->skip_count = 0;
+    }
+
+    *ref = *scene;
+    return false;
+}
@@ -0,0 +1,226 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <sys/lock.h>
+#include <sys/param.h>
+#include <sys/queue.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include "esp_video_jpeg_engine.h"
+
+struct esp_video_jpeg_engine_client {
+    uint8_t priority;
+    uint32_t wait_jobs;                 /*!< Jobs encoded while waiting, it raises priority by the same levels */
+    SemaphoreHandle_t grant;            /*!< Given when the engine is handed over to this client */
+
+    TAILQ_ENTRY(esp_video_jpeg_engine_client) node;
+};
+
+typedef struct jpeg_engine {
+    jpeg_encoder_handle_t enc_handle;
+    bool enc_handle_external;           /*!< Encoder driver handle is not created by the engine */
+    uint32_t clients;
+    bool busy;                          /*!< A job is being encoded, or the engine is being handed over */
+
+    TAILQ_HEAD(jpeg_engine_wait_list, esp_video_jpeg_engine_client) wait_list;
+    esp_video_jpeg_engine_stats_t stats;
+} jpeg_engine_t;
+
+static const char *TAG = "jpeg_engine";
+
+static _lock_t s_engine_lock;
+static jpeg_engine_t s_engine;
+
+/**
+ * A waiting job is raised by one level for every job encoded before it, so it is encoded before
+ * any job submitted later after at most ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX jobs.
+ */
+static inline uint32_t jpeg_engine_client_priority(struct esp_video_jpeg_engine_client *client)
+{
+    return client->priority + client->wait_jobs;
+}
+
+/* Remove the waiting client to run next, earlier one wins when priorities are the same */
+static struct esp_video_jpeg_engine_client *jpeg_engine_pick_next(void)
+{
+    struct esp_video_jpeg_engine_client *client;
+    struct esp_video_jpeg_engine_client *next = NULL;
+
+    TAILQ_FOREACH(client, &s_engine.wait_list, node) {
+        if (!next || jpeg_engine_client_priority(client) > jpeg_engine_client_priority(next)) {
+            next = client;
+        }
+    }
+
+    if (next) {
+        TAILQ_REMOVE(&s_engine.wait_list, next, node);
+        s_engine.stats.max_wait_jobs = MAX(s_engine.stats.max_wait_jobs, next->wait_jobs);
+
+        TAILQ_FOREACH(client, &s_engine.wait_list, node) {
+            client->wait_jobs++;
+        }
+    }
+
+    return next;
+}
+
+esp_err_t esp_video_jpeg_engine_client_create(const esp_video_jpeg_engine_client_config_t *config,
+                                              esp_video_jpeg_engine_client_handle_t *handle)
+{
+    esp_err_t ret = ESP_OK;
+    struct esp_video_jpeg_engine_client *client;
+
+    ESP_RETURN_ON_FALSE(config && handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->priority <= ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX, ESP_ERR_INVALID_ARG,
+                        TAG, "priority=%d is out of range", config->priority);
+
+    client = heap_caps_calloc(1, sizeof(struct esp_video_jpeg_engine_client), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+    ESP_RETURN_ON_FALSE(client, ESP_ERR_NO_MEM, TAG, "failed to malloc client");
+
+    client->priority = config->priority;
+    client->grant = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(client->grant, ESP_ERR_NO_MEM, fail0, TAG, "failed to create semaphore");
+
+    _lock_acquire(&s_engine_lock);
+    if (!s_engine.clients) {
+        if (config->enc_handle) {
+            s_engine.enc_handle = config->enc_handle;
+            s_engine.enc_handle_external = true;
+        } else {
+            jpeg_encode_engine_cfg_t encode_eng_cfg = {
+                .intr_priority = 0,
+                .timeout_ms = CONFIG_ESP_VIDEO_JPEG_ENGINE_TIMEOUT_MS,
+            };
+
+            ret = jpeg_new_encoder_engine(&encode_eng_cfg, &s_engine.enc_handle);
+            if (ret != ESP_OK) {
+                _lock_release(&s_engine_lock);
+                ESP_LOGE(TAG, "failed to create JPEG encoder");
+                goto fail1;
+            }
+            s_engine.enc_handle_external = false;
+        }
+
+        s_engine.busy = false;
+        TAILQ_INIT(&s_engine.wait_list);
+        memset(&s_engine.stats, 0, sizeof(s_engine.stats));
+    } else if (config->enc_handle && config->enc_handle != s_engine.enc_handle) {
+        ESP_LOGW(TAG, "engine is created, enc_handle is not used");
+    }
+    s_engine.clients++;
+    _lock_release(&s_engine_lock);
+
+    *handle = client;
+
+    return ESP_OK;
+
+fail1:
+    vSemaphoreDelete(client->grant);
+fail0:
+    heap_caps_free(client);
+    return ret;
+}
+
+esp_err_t esp_video_jpeg_engine_encode(esp_video_jpeg_engine_client_handle_t handle, const jpeg_encode_cfg_t *config,
+                                       const uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size,
+                                       uint32_t *out_size)
+{
+    esp_err_t ret;
+    bool wait = false;
+    struct esp_video_jpeg_engine_client *next;
+
+    ESP_RETURN_ON_FALSE(handle && config && src && dst && out_size, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    _lock_acquire(&s_engine_lock);
+    if (s_engine.busy) {
+        /* The running job is counted as well */
+        handle->wait_jobs = 1;
+        TAILQ_INSERT_TAIL(&s_engine.wait_list, handle, node);
+        s_engine.stats.waited_jobs++;
+        wait = true;
+    } else {
+        s_engine.busy = true;
+    }
+    _lock_release(&s_engine_lock);
+
+    if (wait) {
+        /* The engine keeps busy when it is handed over, so no other job can take it */
+        xSemaphoreTake(handle->grant, portMAX_DELAY);
+    }
+
+    ret = jpeg_encoder_process(s_engine.enc_handle, config, src, src_size, dst, dst_size, out_size);
+
+    _lock_acquire(&s_engine_lock);
+    s_engine.stats.jobs++;
+    next = jpeg_engine_pick_next();
+    if (next) {
+        xSemaphoreGive(next->grant);
+    } else {
+        s_engine.busy = false;
+    }
+    _lock_release(&s_engine_lock);
+
+    return ret;
+}
+
+esp_err_t esp_video_jpeg_engine_client_set_priority(esp_video_jpeg_engine_client_handle_t handle, uint8_t priority)
+{
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(priority <= ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX, ESP_ERR_INVALID_ARG,
+                        TAG, "priority=%d is out of range", priority);
+
+    _lock_acquire(&s_engine_lock);
+    handle->priority = priority;
+    _lock_release(&s_engine_lock);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_video_jpeg_engine_get_stats(esp_video_jpeg_engine_stats_t *stats)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    _lock_acquire(&s_engine_lock);
+    if (s_engine.clients) {
+        *stats = s_engine.stats;
+    } else {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    _lock_release(&s_engine_lock);
+
+    return ret;
+}
+
+esp_err_t esp_video_jpeg_engine_client_delete(esp_video_jpeg_engine_client_handle_t handle)
+{
+    esp_err_t ret = ESP_OK;
+
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    _lock_acquire(&s_engine_lock);
+    s_engine.clients--;
+    if (!s_engine.clients) {
+        if (!s_engine.enc_handle_external) {
+            ret = jpeg_del_encoder_engine(s_engine.enc_handle);
+            if (ret != ESP_OK) {
+                ESP_LOGE(TAG, "failed to delete JPEG encoder");
+            }
+        }
+        s_engine.enc_handle = NULL;
+    }
+    _lock_release(&s_engine_lock);
+
+    vSemaphoreDelete(handle->grant);
+    heap_caps_free(handle);
+
+    return ret;
+}
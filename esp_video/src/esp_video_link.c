@@ -0,0 +1,112 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/ioctl.h>
+#include "esp_check.h"
+#include "linux/videodev2.h"
+#include "esp_video_ioctl.h"
+#include "esp_video_link.h"
+
+static const char *TAG = "video_link";
+
+static bool link_cap_support_format(int fd, uint32_t pixel_format)
+{
+    for (int i = 0; ; i++) {
+        struct v4l2_fmtdesc fmtdesc = {
+            .index = i,
+            .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        };
+
+        if (ioctl(fd, VIDIOC_ENUM_FMT, &fmtdesc) != 0) {
+            return false;
+        }
+
+        if (fmtdesc.pixelformat == pixel_format) {
+            return true;
+        }
+    }
+}
+
+/* Select the first encoder input format, which is the encoder native layout, that camera can capture */
+static esp_err_t link_select_format(const esp_video_link_config_t *config, uint32_t *pixel_format)
+{
+    for (int i = 0; ; i++) {
+        struct v4l2_fmtdesc fmtdesc = {
+            .index = i,
+            .type = V4L2_BUF_TYPE_VIDEO_OUTPUT,
+        };
+
+        if (ioctl(config->m2m_fd, VIDIOC_ENUM_FMT, &fmtdesc) != 0) {
+            break;
+        }
+
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+        /* Software H.264 encoder reads planar YUV420, but camera YUV420 is the ISP output layout */
+        if (config->pixel_format == V4L2_PIX_FMT_H264 && fmtdesc.pixelformat == V4L2_PIX_FMT_YUV420) {
+            continue;
+        }
+#endif
+
+        if (link_cap_support_format(config->cap_fd, fmtdesc.pixelformat)) {
+            *pixel_format = fmtdesc.pixelformat;
+            return ESP_OK;
+        }
+    }
+
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_video_link_set_format(const esp_video_link_config_t *config, uint32_t *pixel_format)
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t raw_format;
+    struct v4l2_format format;
+
+    ESP_RETURN_ON_FALSE(config && config->cap_fd >= 0 && config->m2m_fd >= 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->pixel_format == V4L2_PIX_FMT_H264 || config->pixel_format == V4L2_PIX_FMT_JPEG,
+                        ESP_ERR_INVALID_ARG, TAG, "encoded pixel format is not supported");
+
+    ESP_RETURN_ON_ERROR(link_select_format(config, &raw_format), TAG, "no common format of camera and encoder");
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ESP_RETURN_ON_FALSE(ioctl(config->cap_fd, VIDIOC_G_FMT, &format) == 0, ESP_FAIL, TAG, "failed to get camera format");
+    width = config->width ? config->width : format.fmt.pix.width;
+    height = config->height ? config->height : format.fmt.pix.height;
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = raw_format;
+    ESP_RETURN_ON_FALSE(ioctl(config->cap_fd, VIDIOC_S_FMT, &format) == 0, ESP_ERR_NOT_SUPPORTED, TAG, "failed to set camera format");
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = raw_format;
+    ESP_RETURN_ON_FALSE(ioctl(config->m2m_fd, VIDIOC_S_FMT, &format) == 0, ESP_ERR_NOT_SUPPORTED, TAG, "failed to set encoder input format");
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = config->pixel_format;
+    ESP_RETURN_ON_FALSE(ioctl(config->m2m_fd, VIDIOC_S_FMT, &format) == 0, ESP_ERR_NOT_SUPPORTED, TAG, "failed to set encoder output format");
+
+    ESP_LOGD(TAG, "linked format=" V4L2_FMT_STR " width=%" PRIu32 " height=%" PRIu32, V4L2_FMT_STR_ARG(raw_format), width, height);
+
+    if (pixel_format) {
+        *pixel_format = raw_format;
+    }
+
+    return ESP_OK;
+}
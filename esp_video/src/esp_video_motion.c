@@ -0,0 +1,256 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <sys/param.h>
+#include "esp_video_motion.h"
+
+/* Added to luminance before comparing, so noise of dark cells is not a large relative change */
+#define MOTION_LUMA_OFFSET          (16 << 8)
+/* Cells with fewer white pixels have no reliable white balance ratio */
+#define MOTION_CHROMA_MIN_COUNT     16
+
+/* Background of still cells follows the scene in about 8 frames, e.g. clouds and dawn */
+#define MOTION_LEARN_SHIFT          3
+/* Background of changed cells follows the scene in about 128 frames, e.g. a parked car */
+#define MOTION_ABSORB_SHIFT         7
+
+/* Global brightness change out of 1/2 ~ 2 in one frame is a light switch or the lens is covered */
+#define MOTION_GLOBAL_MIN           128
+#define MOTION_GLOBAL_MAX           512
+
+static uint32_t motion_median(const uint32_t *value, uint32_t num)
+{
+    uint32_t sorted[ESP_VIDEO_MOTION_MAX_CELLS];
+
+    for (uint32_t i = 0; i < num; i++) {
+        uint32_t v = value[i];
+        uint32_t j = i;
+
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+
+        sorted[j] = v;
+    }
+
+    return sorted[num / 2];
+}
+
+static bool motion_chroma_ratio(const esp_video_motion_chroma_t *chroma, uint32_t *rg, uint32_t *bg)
+{
+    if ((chroma->counted < MOTION_CHROMA_MIN_COUNT) || !chroma->sum_g) {
+        return false;
+    }
+
+    *rg = ((uint64_t)chroma->sum_r << 8) / chroma->sum_g;
+    *bg = ((uint64_t)chroma->sum_b << 8) / chroma->sum_g;
+
+    /* 0 means no white pixel in background */
+    *rg = *rg ? *rg : 1;
+    *bg = *bg ? *bg : 1;
+
+    return true;
+}
+
+static uint32_t motion_rel_diff(uint32_t cur, uint32_t ref)
+{
+    uint32_t diff = cur > ref ? cur - ref : ref - cur;
+
+    return ((uint64_t)diff << 8) / ref;
+}
+
+static inline void motion_follow(uint32_t *bg, uint32_t cur, int shift)
+{
+    *bg = (int32_t)*bg + (((int32_t)cur - (int32_t)*bg) >> shift);
+}
+
+static void motion_learn(esp_video_motion_t *motion, const uint32_t *luma, const esp_video_motion_chroma_t *chroma)
+{
+    for (uint32_t i = 0; i < motion->cells; i++) {
+        motion->bg_luma[i] = luma[i] << 8;
+
+        if (!chroma || !motion_chroma_ratio(&chroma[i], &motion->bg_rg[i], &motion->bg_bg[i])) {
+            motion->bg_rg[i] = 0;
+            motion->bg_bg[i] = 0;
+        }
+    }
+
+    motion->bg_valid = true;
+}
+
+/**
+ * @brief Initialize motion detection object.
+ *
+ * @param motion Motion detection object pointer
+ * @param config Motion detection configuration, grid_width * grid_height must not be larger
+ *               than ESP_VIDEO_MOTION_MAX_CELLS
+ *
+ * @return None
+ */
+void esp_video_motion_init(esp_video_motion_t *motion, const esp_video_motion_config_t *config)
+{
+    memset(motion, 0, sizeof(esp_video_motion_t));
+
+    motion->config = *config;
+    motion->cells = config->grid_width * config->grid_height;
+}
+
+/**
+ * @brief Drop the background and motion state, e.g. after stream restart.
+ *
+ * @param motion Motion detection object pointer
+ *
+ * @return None
+ */
+void esp_video_motion_reset(esp_video_motion_t *motion)
+{
+    motion->bg_valid = false;
+    motion->active = false;
+    motion->trigger_count = 0;
+    motion->quiet_count = 0;
+    memset(&motion->motion, 0, sizeof(esp_video_motion_result_t));
+}
+
+/**
+ * @brief Process statistics grids of one frame.
+ *
+ * Every cell is compared with its background, after the global brightness change is removed by
+ * the median ratio of all cells, so AE steps and lights dimming are not motion. Cells which are
+ * still slowly follow the scene, and changed cells are absorbed much slower, e.g. a parked car.
+ *
+ * @param motion Motion detection object pointer
+ * @param luma   Average luminance of cells in row order
+ * @param chroma White balance statistics of cells in row order, NULL if not available
+ * @param result Pointer to store result of this frame, or the accumulated result of the motion
+ *               if motion starts or stops
+ *
+ * @return Motion detection event
+ */
+esp_video_motion_event_t esp_video_motion_process(esp_video_motion_t *motion, const uint32_t *luma,
+                                                  const esp_video_motion_chroma_t *chroma,
+                                                  esp_video_motion_result_t *result)
+{
+    const esp_video_motion_config_t *config = &motion->config;
+    uint32_t ratio[ESP_VIDEO_MOTION_MAX_CELLS];
+    esp_video_motion_result_t frame = {0};
+    esp_video_motion_event_t event = ESP_VIDEO_MOTION_EVENT_NONE;
+    uint32_t global;
+    uint32_t changed = 0;
+    bool motion_frame;
+
+    if (!motion->bg_valid) {
+        motion_learn(motion, luma, chroma);
+        memset(result, 0, sizeof(esp_video_motion_result_t));
+        return ESP_VIDEO_MOTION_EVENT_NONE;
+    }
+
+    for (uint32_t i = 0; i < motion->cells; i++) {
+        ratio[i] = ((uint64_t)((luma[i] << 8) + MOTION_LUMA_OFFSET) << 8) / (motion->bg_luma[i] + MOTION_LUMA_OFFSET);
+    }
+
+    /* Exposure and lighting change all cells by the same ratio, moving objects only change some of them */
+    global = motion_median(ratio, motion->cells);
+    frame.scene_change = (global < MOTION_GLOBAL_MIN) || (global > MOTION_GLOBAL_MAX);
+
+    for (uint32_t i = 0; i < motion->cells; i++) {
+        uint32_t level = motion_rel_diff(ratio[i], global);
+        uint32_t rg;
+        uint32_t bg;
+
+        if (chroma && motion->bg_rg[i] && motion_chroma_ratio(&chroma[i], &rg, &bg)) {
+            uint32_t rg_level = motion_rel_diff(rg, motion->bg_rg[i]);
+            uint32_t bg_level = motion_rel_diff(bg, motion->bg_bg[i]);
+
+            level = MAX(level, MAX(rg_level, bg_level));
+        }
+
+        if (level > config->threshold) {
+            frame.map |= 1u << i;
+            changed++;
+        }
+
+        frame.level = MAX(frame.level, level);
+    }
+
+    if (changed * 100 >= motion->cells * config->scene_change_percent) {
+        frame.scene_change = true;
+    }
+
+    if (frame.scene_change) {
+        motion_learn(motion, luma, chroma);
+    } else {
+        for (uint32_t i = 0; i < motion->cells; i++) {
+            int shift = (frame.map & (1u << i)) ? MOTION_ABSORB_SHIFT : MOTION_LEARN_SHIFT;
+            uint32_t bg_luma = ((uint64_t)(motion->bg_luma[i] + MOTION_LUMA_OFFSET) * global) >> 8;
+            uint32_t rg;
+            uint32_t bg;
+
+            /* Background is scaled by the global change at once, only local changes are learned slowly */
+            motion->bg_luma[i] = bg_luma > MOTION_LUMA_OFFSET ? bg_luma - MOTION_LUMA_OFFSET : 0;
+            motion_follow(&motion->bg_luma[i], luma[i] << 8, shift);
+
+            if (chroma && motion_chroma_ratio(&chroma[i], &rg, &bg)) {
+                if (motion->bg_rg[i]) {
+                    motion_follow(&motion->bg_rg[i], rg, shift);
+                    motion_follow(&motion->bg_bg[i], bg, shift);
+                } else {
+                    motion->bg_rg[i] = rg;
+                    motion->bg_bg[i] = bg;
+                }
+            }
+        }
+    }
+
+    motion_frame = frame.scene_change || (changed >= config->min_cells);
+
+    if (!motion->active) {
+        if (motion_frame) {
+            motion->motion.map |= frame.map;
+            motion->motion.level = MAX(motion->motion.level, frame.level);
+            motion->motion.scene_change |= frame.scene_change;
+            motion->motion.frames++;
+            motion->trigger_count++;
+
+            /* A scene change, e.g. the camera is covered, starts motion at once */
+            if (frame.scene_change || (motion->trigger_count >= config->trigger_frames)) {
+                motion->active = true;
+                motion->quiet_count = 0;
+                event = ESP_VIDEO_MOTION_EVENT_START;
+            }
+        } else {
+            motion->trigger_count = 0;
+            memset(&motion->motion, 0, sizeof(esp_video_motion_result_t));
+        }
+    } else {
+        motion->motion.map |= frame.map;
+        motion->motion.level = MAX(motion->motion.level, frame.level);
+        motion->motion.scene_change |= frame.scene_change;
+        motion->motion.frames++;
+
+        if (motion_frame) {
+            motion->quiet_count = 0;
+        } else if (++motion->quiet_count >= config->hold_frames) {
+            motion->active = false;
+            motion->trigger_count = 0;
+            event = ESP_VIDEO_MOTION_EVENT_STOP;
+        }
+    }
+
+    if (event != ESP_VIDEO_MOTION_EVENT_NONE) {
+        *result = motion->motion;
+        if (event == ESP_VIDEO_MOTION_EVENT_STOP) {
+            memset(&motion->motion, 0, sizeof(esp_video_motion_result_t));
+        }
+    } else {
+        frame.frames = motion->active ? motion->motion.frames : 0;
+        *result = frame;
+    }
+
+    return event;
+}
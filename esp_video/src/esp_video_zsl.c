@@ -0,0 +1,171 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_video_zsl.h"
+
+#define ZSL_BUFFER_CAPS         (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+
+static const char *TAG = "esp_video_zsl";
+
+/**
+ * @brief Create zero shutter lag ring, frame buffers are allocated from PSRAM.
+ *
+ * @param count Number of frames
+ * @param size  Buffer size of every frame
+ *
+ * @return
+ *      - Zero shutter lag ring object pointer on success
+ *      - NULL if failed
+ */
+struct esp_video_zsl *esp_video_zsl_create(uint32_t count, uint32_t size)
+{
+    struct esp_video_zsl *zsl;
+
+    zsl = heap_caps_calloc(1, sizeof(struct esp_video_zsl) + sizeof(struct esp_video_zsl_frame) * count, MALLOC_CAP_DEFAULT);
+    if (!zsl) {
+        ESP_LOGE(TAG, "Failed to malloc for ZSL ring");
+        return NULL;
+    }
+
+    /* One block for all frames, so the ring doesn't fragment PSRAM */
+    zsl->buffer = heap_caps_malloc((size_t)count * size, ZSL_BUFFER_CAPS);
+    if (!zsl->buffer) {
+        ESP_LOGE(TAG, "Failed to malloc %" PRIu32 " frames of %" PRIu32 " bytes from PSRAM", count, size);
+        goto exit_0;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        zsl->frame[i].buffer = zsl->buffer + (size_t)i * size;
+    }
+    zsl->count = count;
+    zsl->size = size;
+
+    return zsl;
+
+exit_0:
+    heap_caps_free(zsl);
+    return NULL;
+}
+
+static void esp_video_zsl_destroy(struct esp_video_zsl *zsl)
+{
+    heap_caps_free(zsl->buffer);
+    heap_caps_free(zsl);
+}
+
+/**
+ * @brief Release zero shutter lag ring, it is destroyed at once, or by esp_video_zsl_record_done()
+ *        if frames are being copied into it.
+ *
+ * @param zsl Zero shutter lag ring object pointer
+ *
+ * @return None
+ */
+void esp_video_zsl_release(struct esp_video_zsl *zsl)
+{
+    if (zsl->writers) {
+        zsl->released = true;
+    } else {
+        esp_video_zsl_destroy(zsl);
+    }
+}
+
+/**
+ * @brief Take the oldest frame of zero shutter lag ring to copy a done frame into, the frame is
+ *        empty until esp_video_zsl_record_done() is called.
+ *
+ * @param zsl     Zero shutter lag ring object pointer
+ * @param element Video buffer element of the done frame
+ *
+ * @return
+ *      - Frame to copy data of element into on success
+ *      - NULL if the done frame doesn't fit the ring
+ */
+struct esp_video_zsl_frame *esp_video_zsl_record_start(struct esp_video_zsl *zsl, const struct esp_video_buffer_element *element)
+{
+    struct esp_video_zsl_frame *frame;
+
+    if (!element->valid_size || (element->valid_size > zsl->size)) {
+        return NULL;
+    }
+
+    /* Empty frame is skipped by esp_video_zsl_get_frame() while it is being copied */
+    frame = &zsl->frame[zsl->next];
+    frame->valid_size = 0;
+    zsl->next = (zsl->next + 1) % zsl->count;
+    zsl->writers++;
+
+    return frame;
+}
+
+/**
+ * @brief Finish copying a done frame into zero shutter lag ring.
+ *
+ * @note The ring may be destroyed by this function if it has been released.
+ *
+ * @param zsl     Zero shutter lag ring object pointer
+ * @param frame   Frame returned by esp_video_zsl_record_start()
+ * @param element Video buffer element of the done frame
+ *
+ * @return None
+ */
+void esp_video_zsl_record_done(struct esp_video_zsl *zsl, struct esp_video_zsl_frame *frame,
+                               const struct esp_video_buffer_element *element)
+{
+    frame->valid_size = element->valid_size;
+    frame->timestamp = element->timestamp;
+    frame->sequence = element->sequence;
+
+    zsl->writers--;
+    if (zsl->released && !zsl->writers) {
+        esp_video_zsl_destroy(zsl);
+    }
+}
+
+/**
+ * @brief Copy the frame matching the trigger timestamp out of zero shutter lag ring.
+ *
+ * @param zsl   Zero shutter lag ring object pointer
+ * @param frame Frame request, refer to struct v4l2_zsl_frame
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_NOT_FOUND if all frames are done after the trigger timestamp
+ *      - ESP_ERR_INVALID_SIZE if the buffer is smaller than the frame
+ */
+esp_err_t esp_video_zsl_get_frame(struct esp_video_zsl *zsl, struct v4l2_zsl_frame *frame)
+{
+    esp_err_t ret = ESP_OK;
+    const struct esp_video_zsl_frame *match = NULL;
+    int64_t trigger = (int64_t)frame->timestamp.tv_sec * 1000000 + frame->timestamp.tv_usec;
+
+    /* The latest frame done before the trigger is the one shown when the shutter is pressed */
+    for (uint32_t i = 0; i < zsl->count; i++) {
+        const struct esp_video_zsl_frame *f = &zsl->frame[i];
+
+        if (f->valid_size && (f->timestamp <= trigger) && (!match || (f->timestamp > match->timestamp))) {
+            match = f;
+        }
+    }
+
+    if (!match) {
+        ret = ESP_ERR_NOT_FOUND;
+    } else if (match->valid_size > frame->length) {
+        ret = ESP_ERR_INVALID_SIZE;
+    } else {
+        memcpy(frame->buffer, match->buffer, match->valid_size);
+        frame->bytesused = match->valid_size;
+        frame->sequence = match->sequence;
+        frame->timestamp.tv_sec = match->timestamp / 1000000;
+        frame->timestamp.tv_usec = match->timestamp % 1000000;
+    }
+
+    return ret;
+}
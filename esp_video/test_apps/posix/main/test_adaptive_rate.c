@@ -0,0 +1,87 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "unity.h"
+#include "sdkconfig.h"
+#include "esp_video_isp_rate.h"
+
+#define TEST_RATE_STABLE_FRAMES     10
+#define TEST_RATE_DECIMATION        4
+
+static const esp_video_isp_rate_config_t s_default_config = {
+    .threshold = 3,
+    .stable_frames = TEST_RATE_STABLE_FRAMES,
+    .decimation = TEST_RATE_DECIMATION,
+};
+
+static const esp_video_isp_scene_t s_default_scene = {
+    .luma = 2500,
+    .rg = 700,
+    .bg = 600,
+    .definition = 10000,
+    .exposure = 10000,
+    .gain = 1024,
+};
+
+/* Return number of processed frames */
+static int test_rate_run(esp_video_isp_rate_t *rate, const esp_video_isp_scene_t *scene, int frames)
+{
+    int processed = 0;
+
+    for (int i = 0; i < frames; i++) {
+        if (!esp_video_isp_rate_skip(rate, scene)) {
+            processed++;
+        }
+    }
+
+    return processed;
+}
+
+TEST_CASE("Adaptive rate reduces rate after 3A converges", "[isp_rate]")
+{
+    esp_video_isp_rate_t rate;
+    esp_video_isp_scene_t scene = s_default_scene;
+
+    esp_video_isp_rate_init(&rate, &s_default_config);
+
+    /* The first frame differs from the empty reference, then stable frames are counted at full rate */
+    TEST_ASSERT_EQUAL_INT(TEST_RATE_STABLE_FRAMES + 1, test_rate_run(&rate, &scene, TEST_RATE_STABLE_FRAMES + 1));
+
+    /* Converged, one of every TEST_RATE_DECIMATION frames is processed */
+    TEST_ASSERT_EQUAL_INT(10, test_rate_run(&rate, &scene, 10 * TEST_RATE_DECIMATION));
+
+    /* Changes within the threshold keep the reduced rate */
+    scene.luma = s_default_scene.luma * 101 / 100;
+    TEST_ASSERT_EQUAL_INT(10, test_rate_run(&rate, &scene, 10 * TEST_RATE_DECIMATION));
+}
+
+TEST_CASE("Adaptive rate returns to full rate after scene change", "[isp_rate]")
+{
+    esp_video_isp_rate_t rate;
+    esp_video_isp_scene_t scene = s_default_scene;
+
+    esp_video_isp_rate_init(&rate, &s_default_config);
+    test_rate_run(&rate, &scene, TEST_RATE_STABLE_FRAMES + 1 + TEST_RATE_DECIMATION * 2);
+
+    /* Luminance, white balance and sensor changes are all processed from the first frame */
+    scene.luma = s_default_scene.luma * 2;
+    TEST_ASSERT_FALSE(esp_video_isp_rate_skip(&rate, &scene));
+    TEST_ASSERT_EQUAL_INT(TEST_RATE_STABLE_FRAMES, test_rate_run(&rate, &scene, TEST_RATE_STABLE_FRAMES));
+    TEST_ASSERT_EQUAL_INT(1, test_rate_run(&rate, &scene, TEST_RATE_DECIMATION));
+
+    scene.rg = s_default_scene.rg * 110 / 100;
+    TEST_ASSERT_EQUAL_INT(TEST_RATE_STABLE_FRAMES + 1, test_rate_run(&rate, &scene, TEST_RATE_STABLE_FRAMES + 1));
+
+    scene.exposure++;
+    TEST_ASSERT_EQUAL_INT(TEST_RATE_STABLE_FRAMES + 1, test_rate_run(&rate, &scene, TEST_RATE_STABLE_FRAMES + 1));
+
+    /* Application changes parameters */
+    TEST_ASSERT_EQUAL_INT(1, test_rate_run(&rate, &scene, TEST_RATE_DECIMATION));
+    esp_video_isp_rate_reset(&rate);
+    TEST_ASSERT_EQUAL_INT(TEST_RATE_STABLE_FRAMES, test_rate_run(&rate, &scene, TEST_RATE_STABLE_FRAMES));
+    TEST_ASSERT_EQUAL_INT(1, test_rate_run(&rate, &scene, TEST_RATE_DECIMATION));
+}
@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "sdkconfig.h"
+#include "esp_video_af.h"
+
+#define TEST_AF_MAX_POS         1023
+#define TEST_AF_FRAME_PERIOD    33333
+#define TEST_AF_MAX_FRAMES      200
+
+static const esp_video_af_config_t s_default_config = {
+    .min_pos = 0,
+    .max_pos = TEST_AF_MAX_POS,
+    .coarse_steps = 16,
+    .fine_step = 16,
+    .period_in_us = 152,
+    .codes_per_step = 2,
+    .settle_us = 8000,
+    .drop_percent = 10,
+    .refocus_percent = 30,
+    .refocus_frames = 3,
+};
+
+/* Synthetic focus curve, a triangle peak on a flat background */
+static uint32_t test_af_definition(int32_t pos, int32_t focus)
+{
+    int32_t diff = abs(pos - focus);
+
+    return 1000 + (diff < 200 ? (200 - diff) * 100 : 0);
+}
+
+static int test_af_run(esp_video_af_t *af, int32_t focus, int64_t *time_us)
+{
+    for (int frame = 1; frame <= TEST_AF_MAX_FRAMES; frame++) {
+        int32_t pos;
+
+        *time_us += TEST_AF_FRAME_PERIOD;
+        if (esp_video_af_process(af, test_af_definition(af->pos, focus), *time_us, &pos)) {
+            esp_video_af_moved(af, pos, *time_us);
+        }
+
+        if ((af->state == ESP_VIDEO_AF_STATE_LOCKED || af->state == ESP_VIDEO_AF_STATE_FAILED) &&
+                af->pos == af->target) {
+            return frame;
+        }
+    }
+
+    return -1;
+}
+
+TEST_CASE("AF engine locks at focus curve peak", "[af]")
+{
+    const int32_t focus[] = {30, 333, 512, 777, 1000};
+
+    for (int i = 0; i < sizeof(focus) / sizeof(focus[0]); i++) {
+        esp_video_af_t af;
+        int64_t time_us = 0;
+        int frames;
+
+        esp_video_af_init(&af, &s_default_config, 0);
+        esp_video_af_start(&af);
+        frames = test_af_run(&af, focus[i], &time_us);
+
+        printf("focus %"PRIi32": locked at %"PRIi32" in %d frames, %"PRIu32" moves, %"PRIu32" discarded\n",
+               focus[i], af.pos, frames, af.moves, af.discarded);
+
+        TEST_ASSERT_GREATER_THAN(0, frames);
+        TEST_ASSERT_EQUAL(ESP_VIDEO_AF_STATE_LOCKED, af.state);
+        TEST_ASSERT_INT32_WITHIN(s_default_config.fine_step / 2, focus[i], af.pos);
+        /* Every move discards the frame exposed while the lens is moving */
+        TEST_ASSERT_EQUAL_UINT32(af.moves - 1, af.discarded);
+    }
+}
+
+TEST_CASE("AF engine discards frames before lens settles", "[af]")
+{
+    esp_video_af_t af;
+    esp_video_af_config_t config = s_default_config;
+    int32_t pos;
+
+    /* Settle time longer than 2 frames, lens starts at upper half so scan starts from the maximum position */
+    config.settle_us = TEST_AF_FRAME_PERIOD * 2;
+    esp_video_af_init(&af, &config, 600);
+    esp_video_af_start(&af);
+
+    TEST_ASSERT_TRUE(esp_video_af_process(&af, 1000, TEST_AF_FRAME_PERIOD, &pos));
+    TEST_ASSERT_EQUAL_INT32(TEST_AF_MAX_POS, pos);
+    esp_video_af_moved(&af, pos, TEST_AF_FRAME_PERIOD);
+
+    for (int i = 2; i <= 4; i++) {
+        TEST_ASSERT_FALSE(esp_video_af_process(&af, 1000, TEST_AF_FRAME_PERIOD * i, &pos));
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, af.discarded);
+
+    /* Lens is still after this frame starts, so the definition is used and lens moves to the next position */
+    TEST_ASSERT_TRUE(esp_video_af_process(&af, 1000, TEST_AF_FRAME_PERIOD * 5, &pos));
+    TEST_ASSERT_EQUAL_UINT32(3, af.discarded);
+    TEST_ASSERT_LESS_THAN_INT32(TEST_AF_MAX_POS, pos);
+}
+
+TEST_CASE("AF engine refocuses when scene changes", "[af]")
+{
+    esp_video_af_t af;
+    int64_t time_us = 0;
+    int32_t pos;
+
+    esp_video_af_init(&af, &s_default_config, 0);
+    esp_video_af_start(&af);
+    TEST_ASSERT_GREATER_THAN(0, test_af_run(&af, 200, &time_us));
+    TEST_ASSERT_INT32_WITHIN(s_default_config.fine_step / 2, 200, af.pos);
+
+    /* Stable scene keeps lens locked */
+    for (int i = 0; i < 10; i++) {
+        time_us += TEST_AF_FRAME_PERIOD;
+        TEST_ASSERT_FALSE(esp_video_af_process(&af, test_af_definition(af.pos, 200), time_us, &pos));
+    }
+    TEST_ASSERT_EQUAL(ESP_VIDEO_AF_STATE_LOCKED, af.state);
+
+    /* Object moves, definition drops and search restarts */
+    for (int i = 0; i < s_default_config.refocus_frames; i++) {
+        time_us += TEST_AF_FRAME_PERIOD;
+        esp_video_af_process(&af, test_af_definition(af.pos, 800), time_us, &pos);
+    }
+    TEST_ASSERT_EQUAL(ESP_VIDEO_AF_STATE_COARSE, af.state);
+
+    TEST_ASSERT_GREATER_THAN(0, test_af_run(&af, 800, &time_us));
+    TEST_ASSERT_EQUAL(ESP_VIDEO_AF_STATE_LOCKED, af.state);
+    TEST_ASSERT_INT32_WITHIN(s_default_config.fine_step / 2, 800, af.pos);
+}
+
+TEST_CASE("AF engine fails in flat scene", "[af]")
+{
+    esp_video_af_t af;
+    int64_t time_us = 0;
+
+    esp_video_af_init(&af, &s_default_config, 0);
+    esp_video_af_start(&af);
+
+    for (int i = 0; i < TEST_AF_MAX_FRAMES && af.state != ESP_VIDEO_AF_STATE_FAILED; i++) {
+        int32_t pos;
+
+        time_us += TEST_AF_FRAME_PERIOD;
+        if (esp_video_af_process(&af, 0, time_us, &pos)) {
+            esp_video_af_moved(&af, pos, time_us);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(ESP_VIDEO_AF_STATE_FAILED, af.state);
+}
@@ -0,0 +1,172 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "esp_heap_caps.h"
+#include "esp_video_init.h"
+#include "esp_video_device.h"
+#include "esp_video_ioctl.h"
+#include "esp_video_dual_stream.h"
+
+#define TEST_DUAL_STREAM_WIDTH      320
+#define TEST_DUAL_STREAM_HEIGHT     240
+#define TEST_DUAL_STREAM_FRAMES     8
+
+typedef struct {
+    uint32_t frames[2];
+    uint32_t bad_frames;
+} test_dual_stream_result_t;
+
+static void test_dual_stream_cb(void *user_data, esp_video_dual_stream_id_t id,
+                                const uint8_t *data, uint32_t size, uint32_t flags)
+{
+    test_dual_stream_result_t *result = (test_dual_stream_result_t *)user_data;
+
+    if (id == ESP_VIDEO_DUAL_STREAM_MAIN) {
+        /* H.264 Annex B start code */
+        if (size < 4 || data[0] != 0 || data[1] != 0 || (data[2] != 1 && data[3] != 1)) {
+            result->bad_frames++;
+        }
+    } else {
+        /* JPEG SOI marker */
+        if (size < 2 || data[0] != 0xff || data[1] != 0xd8) {
+            result->bad_frames++;
+        }
+    }
+
+    result->frames[id]++;
+}
+
+static void test_dual_stream_run(uint32_t sub_width, uint32_t sub_height, uint8_t sub_interval)
+{
+    int h264_fd;
+    int jpeg_fd;
+    uint8_t *frame;
+    uint32_t frame_size = TEST_DUAL_STREAM_WIDTH * TEST_DUAL_STREAM_HEIGHT * 3 / 2;
+    test_dual_stream_result_t result;
+    esp_video_dual_stream_stats_t stats;
+    esp_video_dual_stream_handle_t handle;
+
+    h264_fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, h264_fd);
+    jpeg_fd = open(ESP_VIDEO_JPEG_ENC_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, jpeg_fd);
+
+    frame = heap_caps_aligned_calloc(64, 1, frame_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_CACHE_ALIGNED);
+    TEST_ASSERT_NOT_NULL(frame);
+    for (int i = 0; i < frame_size; i++) {
+        frame[i] = (i * 7) & 0xff;
+    }
+
+    memset(&result, 0, sizeof(result));
+    esp_video_dual_stream_config_t config = {
+        .width = TEST_DUAL_STREAM_WIDTH,
+        .height = TEST_DUAL_STREAM_HEIGHT,
+        .pixel_format = V4L2_PIX_FMT_YUV420,
+        .main = {
+            .fd = h264_fd,
+            .pixel_format = V4L2_PIX_FMT_H264,
+        },
+        .sub = {
+            .fd = jpeg_fd,
+            .pixel_format = V4L2_PIX_FMT_JPEG,
+        },
+        .sub_width = sub_width,
+        .sub_height = sub_height,
+        .sub_interval = sub_interval,
+        .cb = test_dual_stream_cb,
+        .user_data = &result,
+    };
+    TEST_ESP_OK(esp_video_dual_stream_create(&config, &handle));
+
+    for (int i = 0; i < TEST_DUAL_STREAM_FRAMES; i++) {
+        TEST_ESP_OK(esp_video_dual_stream_process(handle, frame, frame_size));
+    }
+
+    /* Deleting waits for the last sub stream frame */
+    TEST_ESP_OK(esp_video_dual_stream_get_stats(handle, &stats));
+    TEST_ESP_OK(esp_video_dual_stream_delete(handle));
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_DUAL_STREAM_FRAMES, stats.frames);
+    TEST_ASSERT_EQUAL_UINT32(TEST_DUAL_STREAM_FRAMES, stats.main_frames);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.errors);
+    TEST_ASSERT_EQUAL_UINT32(TEST_DUAL_STREAM_FRAMES, result.frames[ESP_VIDEO_DUAL_STREAM_MAIN]);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, result.frames[ESP_VIDEO_DUAL_STREAM_SUB]);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_DUAL_STREAM_FRAMES / sub_interval, result.frames[ESP_VIDEO_DUAL_STREAM_SUB]);
+    TEST_ASSERT_EQUAL_UINT32(TEST_DUAL_STREAM_FRAMES / sub_interval,
+                             result.frames[ESP_VIDEO_DUAL_STREAM_SUB] + stats.sub_skipped);
+    TEST_ASSERT_EQUAL_UINT32(0, result.bad_frames);
+
+    heap_caps_free(frame);
+    close(jpeg_fd);
+    close(h264_fd);
+}
+
+TEST_CASE("Dual stream H.264 main stream and JPEG sub stream", "[video][dual_stream]")
+{
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_H264 | ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+
+    /* Exact 1/2 scaling on every frame */
+    test_dual_stream_run(TEST_DUAL_STREAM_WIDTH / 2, TEST_DUAL_STREAM_HEIGHT / 2, 1);
+
+    /* 1/3 scaling is not a multiple of PPA precision, and sub stream is encoded every other frame */
+    test_dual_stream_run(TEST_DUAL_STREAM_WIDTH / 3 / 2 * 2, TEST_DUAL_STREAM_HEIGHT / 3 / 2 * 2, 2);
+
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264 | ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+}
+
+TEST_CASE("Dual stream invalid configuration", "[video][dual_stream]")
+{
+    int h264_fd;
+    esp_video_dual_stream_handle_t handle;
+
+    setUp();
+
+    esp_video_init_config_t init_config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&init_config, ESP_VIDEO_INIT_FLAGS_H264));
+
+    h264_fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, h264_fd);
+
+    esp_video_dual_stream_config_t config = {
+        .width = TEST_DUAL_STREAM_WIDTH,
+        .height = TEST_DUAL_STREAM_HEIGHT,
+        .pixel_format = V4L2_PIX_FMT_YUV420,
+        .main = {
+            .fd = h264_fd,
+            .pixel_format = V4L2_PIX_FMT_H264,
+        },
+        .sub = {
+            .fd = h264_fd,
+            .pixel_format = V4L2_PIX_FMT_H264,
+        },
+        .sub_width = TEST_DUAL_STREAM_WIDTH / 2,
+        .sub_height = TEST_DUAL_STREAM_HEIGHT / 2,
+    };
+
+    /* One encoder can't encode both streams */
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_video_dual_stream_create(&config, &handle));
+
+    /* Sub stream can't be larger than main stream */
+    config.sub.fd = h264_fd + 1;
+    config.sub_width = TEST_DUAL_STREAM_WIDTH * 2;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_video_dual_stream_create(&config, &handle));
+
+    /* PPA can't scale YUYV */
+    config.sub_width = TEST_DUAL_STREAM_WIDTH / 2;
+    config.pixel_format = V4L2_PIX_FMT_YUYV;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, esp_video_dual_stream_create(&config, &handle));
+
+    close(h264_fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
+}
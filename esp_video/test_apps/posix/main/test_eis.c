@@ -0,0 +1,233 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "sdkconfig.h"
+#include "linux/videodev2.h"
+#include "esp_video_eis.h"
+
+#define TEST_EIS_SENSOR_WIDTH   200
+#define TEST_EIS_SENSOR_HEIGHT  150
+#define TEST_EIS_CROP_WIDTH     160
+#define TEST_EIS_CROP_HEIGHT    120
+#define TEST_EIS_SCENE_WIDTH    (TEST_EIS_SENSOR_WIDTH + 64)
+#define TEST_EIS_SCENE_HEIGHT   (TEST_EIS_SENSOR_HEIGHT + 64)
+#define TEST_EIS_FRAME_SIZE     (TEST_EIS_CROP_WIDTH * TEST_EIS_CROP_HEIGHT)
+
+static uint32_t s_seed;
+
+static uint8_t *test_eis_scene(void)
+{
+    uint8_t *noise = malloc(TEST_EIS_SCENE_WIDTH * TEST_EIS_SCENE_HEIGHT);
+    uint8_t *scene = malloc(TEST_EIS_SCENE_WIDTH * TEST_EIS_SCENE_HEIGHT);
+
+    TEST_ASSERT_NOT_NULL(noise);
+    TEST_ASSERT_NOT_NULL(scene);
+
+    s_seed = 1;
+    for (int i = 0; i < TEST_EIS_SCENE_WIDTH * TEST_EIS_SCENE_HEIGHT; i++) {
+        s_seed = s_seed * 1103515245 + 12345;
+        noise[i] = s_seed >> 24;
+    }
+
+    /* Blurred noise has texture at the downscaled resolution of block matching */
+    for (int y = 0; y < TEST_EIS_SCENE_HEIGHT; y++) {
+        for (int x = 0; x < TEST_EIS_SCENE_WIDTH; x++) {
+            int sum = 0;
+            int n = 0;
+
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    if (x + dx >= 0 && x + dx < TEST_EIS_SCENE_WIDTH && y + dy >= 0 && y + dy < TEST_EIS_SCENE_HEIGHT) {
+                        sum += noise[(y + dy) * TEST_EIS_SCENE_WIDTH + x + dx];
+                        n++;
+                    }
+                }
+            }
+
+            scene[y * TEST_EIS_SCENE_WIDTH + x] = sum / n;
+        }
+    }
+
+    free(noise);
+    return scene;
+}
+
+/* Frame captured by the crop window, when the scene is moved by "shift" on sensor */
+static void test_eis_capture(const uint8_t *scene, int shift_x, int shift_y, const struct v4l2_rect *crop, uint8_t *frame)
+{
+    for (int y = 0; y < TEST_EIS_CROP_HEIGHT; y++) {
+        const uint8_t *src = scene + (32 - shift_y + crop->top + y) * TEST_EIS_SCENE_WIDTH + 32 - shift_x + crop->left;
+
+        memcpy(frame + y * TEST_EIS_CROP_WIDTH, src, TEST_EIS_CROP_WIDTH);
+    }
+}
+
+static const esp_video_eis_config_t s_test_eis_config = {
+    .sensor_width = TEST_EIS_SENSOR_WIDTH,
+    .sensor_height = TEST_EIS_SENSOR_HEIGHT,
+    .crop_width = TEST_EIS_CROP_WIDTH,
+    .crop_height = TEST_EIS_CROP_HEIGHT,
+    .pixel_format = V4L2_PIX_FMT_GREY,
+};
+
+TEST_CASE("EIS estimates motion and moves crop window", "[video][eis]")
+{
+    uint8_t *scene = test_eis_scene();
+    uint8_t *frame = malloc(TEST_EIS_FRAME_SIZE);
+    esp_video_eis_handle_t eis;
+    esp_video_eis_result_t result;
+    struct v4l2_rect crop;
+    struct v4l2_rect origin;
+
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ESP_OK(esp_video_eis_create(&s_test_eis_config, &eis));
+    TEST_ESP_OK(esp_video_eis_get_crop(eis, &origin));
+    TEST_ASSERT_EQUAL_INT32(20, origin.left);
+    TEST_ASSERT_EQUAL_INT32(14, origin.top);
+    TEST_ASSERT_EQUAL_UINT32(TEST_EIS_CROP_WIDTH, origin.width);
+    TEST_ASSERT_EQUAL_UINT32(TEST_EIS_CROP_HEIGHT, origin.height);
+
+    /* The first frame has no reference */
+    test_eis_capture(scene, 0, 0, &origin, frame);
+    TEST_ESP_OK(esp_video_eis_process(eis, frame, TEST_EIS_FRAME_SIZE, 0, &result));
+    TEST_ASSERT_FALSE(result.valid);
+    TEST_ASSERT_EQUAL_MEMORY(&origin, &result.crop, sizeof(struct v4l2_rect));
+    crop = result.crop;
+
+    /* Camera shakes, and the crop window follows the scene */
+    test_eis_capture(scene, 8, -4, &crop, frame);
+    TEST_ESP_OK(esp_video_eis_process(eis, frame, TEST_EIS_FRAME_SIZE, 33333, &result));
+    printf("motion %"PRId32", %"PRId32" crop %"PRId32", %"PRId32"\n", result.motion_x, result.motion_y,
+           result.crop.left, result.crop.top);
+    TEST_ASSERT_TRUE(result.valid);
+    TEST_ASSERT_INT32_WITHIN(8, 8 * 16, result.motion_x);
+    TEST_ASSERT_INT32_WITHIN(8, -4 * 16, result.motion_y);
+    TEST_ASSERT_GREATER_THAN_INT32(origin.left, result.crop.left);
+    TEST_ASSERT_LESS_THAN_INT32(origin.top, result.crop.top);
+    crop = result.crop;
+
+    /* This frame is captured by the moved window, and the scene is still */
+    test_eis_capture(scene, 8, -4, &crop, frame);
+    TEST_ESP_OK(esp_video_eis_process(eis, frame, TEST_EIS_FRAME_SIZE, 66666, &result));
+    TEST_ASSERT_TRUE(result.valid);
+    TEST_ASSERT_INT32_WITHIN(8, 0, result.motion_x);
+    TEST_ASSERT_INT32_WITHIN(8, 0, result.motion_y);
+
+    /* Reset moves the window back to the center */
+    TEST_ESP_OK(esp_video_eis_reset(eis));
+    TEST_ESP_OK(esp_video_eis_get_crop(eis, &crop));
+    TEST_ASSERT_EQUAL_MEMORY(&origin, &crop, sizeof(struct v4l2_rect));
+
+    TEST_ESP_OK(esp_video_eis_delete(eis));
+    free(frame);
+    free(scene);
+}
+
+TEST_CASE("EIS keeps crop window inside sensor", "[video][eis]")
+{
+    uint8_t *scene = test_eis_scene();
+    uint8_t *frame = malloc(TEST_EIS_FRAME_SIZE);
+    esp_video_eis_handle_t eis;
+    esp_video_eis_result_t result;
+    struct v4l2_rect crop;
+
+    TEST_ASSERT_NOT_NULL(frame);
+    TEST_ESP_OK(esp_video_eis_create(&s_test_eis_config, &eis));
+
+    /* Flat scene gives no motion */
+    TEST_ESP_OK(esp_video_eis_get_crop(eis, &crop));
+    memset(frame, 128, TEST_EIS_FRAME_SIZE);
+    for (int i = 0; i < 2; i++) {
+        TEST_ESP_OK(esp_video_eis_process(eis, frame, TEST_EIS_FRAME_SIZE, 0, &result));
+        TEST_ASSERT_FALSE(result.valid);
+        TEST_ASSERT_EQUAL_MEMORY(&crop, &result.crop, sizeof(struct v4l2_rect));
+    }
+
+    /* Camera pans far beyond the margin */
+    TEST_ESP_OK(esp_video_eis_reset(eis));
+    for (int i = 0; i < 8; i++) {
+        test_eis_capture(scene, i * 4, 0, &crop, frame);
+        TEST_ESP_OK(esp_video_eis_process(eis, frame, TEST_EIS_FRAME_SIZE, 0, &result));
+        TEST_ASSERT_GREATER_OR_EQUAL_INT32(0, result.crop.left);
+        TEST_ASSERT_LESS_OR_EQUAL_INT32(TEST_EIS_SENSOR_WIDTH - TEST_EIS_CROP_WIDTH, result.crop.left);
+        TEST_ASSERT_EQUAL_INT32(0, result.crop.left & 1);
+        crop = result.crop;
+    }
+    TEST_ASSERT_EQUAL_INT32(TEST_EIS_SENSOR_WIDTH - TEST_EIS_CROP_WIDTH, crop.left);
+
+    TEST_ESP_OK(esp_video_eis_delete(eis));
+    free(frame);
+    free(scene);
+}
+
+TEST_CASE("EIS integrates gyroscope samples", "[video][eis]")
+{
+    esp_video_eis_handle_t eis;
+    esp_video_eis_result_t result;
+    esp_video_eis_config_t config = s_test_eis_config;
+    esp_video_eis_imu_sample_t samples[5];
+
+    config.motion_source = ESP_VIDEO_EIS_MOTION_SOURCE_IMU;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_eis_create(&config, &eis));
+    config.focal_length = 400;
+    TEST_ESP_OK(esp_video_eis_create(&config, &eis));
+
+    /* 0.05 rad/s for 30 ms at 400 pixels focal length is 0.6 pixels */
+    for (int i = 0; i < 5; i++) {
+        samples[i].timestamp_us = 1000000 + i * 10000;
+        samples[i].rate_x = 0.05f;
+        samples[i].rate_y = -0.1f;
+    }
+    TEST_ESP_OK(esp_video_eis_feed_imu(eis, samples, 5));
+
+    /* Samples after the frame are kept for the next frame */
+    TEST_ESP_OK(esp_video_eis_process(eis, NULL, 0, 1030000, &result));
+    TEST_ASSERT_TRUE(result.valid);
+    TEST_ASSERT_INT32_WITHIN(1, 0.05 * 0.03 * 400 * 16, result.motion_x);
+    TEST_ASSERT_INT32_WITHIN(1, -0.1 * 0.03 * 400 * 16, result.motion_y);
+
+    TEST_ESP_OK(esp_video_eis_process(eis, NULL, 0, 1050000, &result));
+    TEST_ASSERT_TRUE(result.valid);
+    TEST_ASSERT_INT32_WITHIN(1, 0.05 * 0.01 * 400 * 16, result.motion_x);
+
+    TEST_ESP_OK(esp_video_eis_process(eis, NULL, 0, 1080000, &result));
+    TEST_ASSERT_FALSE(result.valid);
+
+    TEST_ESP_OK(esp_video_eis_delete(eis));
+}
+
+TEST_CASE("EIS invalid arguments", "[video][eis]")
+{
+    uint8_t frame[TEST_EIS_FRAME_SIZE];
+    esp_video_eis_handle_t eis;
+    esp_video_eis_result_t result;
+    esp_video_eis_imu_sample_t sample = {0};
+    esp_video_eis_config_t config = s_test_eis_config;
+
+    config.crop_width = TEST_EIS_SENSOR_WIDTH + 2;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_eis_create(&config, &eis));
+    config.crop_width = TEST_EIS_CROP_WIDTH;
+
+    /* Too small to match blocks */
+    config.downscale = 8;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_eis_create(&config, &eis));
+    config.downscale = 0;
+
+    config.pixel_format = V4L2_PIX_FMT_RGB565;
+    TEST_ESP_ERR(ESP_ERR_NOT_SUPPORTED, esp_video_eis_create(&config, &eis));
+    config.pixel_format = V4L2_PIX_FMT_GREY;
+
+    TEST_ESP_OK(esp_video_eis_create(&config, &eis));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_eis_process(eis, NULL, sizeof(frame), 0, &result));
+    TEST_ESP_ERR(ESP_ERR_INVALID_SIZE, esp_video_eis_process(eis, frame, sizeof(frame) - 1, 0, &result));
+    TEST_ESP_ERR(ESP_ERR_NOT_SUPPORTED, esp_video_eis_feed_imu(eis, &sample, 1));
+    TEST_ESP_OK(esp_video_eis_delete(eis));
+}
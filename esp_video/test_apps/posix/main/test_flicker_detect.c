@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "sdkconfig.h"
+#include "esp_video_flicker.h"
+
+#define TEST_FLICKER_ROWS           5
+#define TEST_FLICKER_LINES          720
+#define TEST_FLICKER_TLINE_NS       29600
+#define TEST_FLICKER_WINDOW         16
+#define TEST_FLICKER_FRAMES         (TEST_FLICKER_WINDOW * 4)
+
+static const esp_video_flicker_config_t s_default_config = {
+    .window_frames = TEST_FLICKER_WINDOW,
+    .min_amplitude = 10,
+    .confirm_windows = 2,
+};
+
+/**
+ * Rows of a rolling shutter frame exposed under light of "1 + depth * cos(2 * pi * 2 * mains * t)",
+ * every profile row averages the lines of one AE block
+ */
+static void test_flicker_frame(uint32_t *luma, double frame_time, uint32_t mains, double depth, double exposure)
+{
+    const int lines_per_row = TEST_FLICKER_LINES / TEST_FLICKER_ROWS;
+    const double w = 2 * M_PI * 2 * mains;
+
+    for (int row = 0; row < TEST_FLICKER_ROWS; row++) {
+        double sum = 0;
+
+        for (int line = row * lines_per_row; line < (row + 1) * lines_per_row; line += 8) {
+            double end = frame_time + line * TEST_FLICKER_TLINE_NS * 1e-9;
+            double light = 1;
+
+            if (mains) {
+                /* Average of the light over exposure time */
+                light += depth * (sin(w * end) - sin(w * (end - exposure))) / (w * exposure);
+            }
+
+            /* Scene texture changes from line to line */
+            sum += (80 + 60 * sin(line * 0.05)) * light * (1 + (rand() % 100 - 50) * 0.0002);
+        }
+
+        luma[row] = (uint32_t)(sum / (lines_per_row / 8) + 0.5);
+    }
+}
+
+static uint32_t test_flicker_run(esp_video_flicker_t *flicker, uint32_t mains, double fps, double exposure, int frames)
+{
+    uint32_t luma[TEST_FLICKER_ROWS];
+    uint32_t freq = ESP_VIDEO_FLICKER_FREQ_UNKNOWN;
+    const uint32_t row_period = TEST_FLICKER_LINES / TEST_FLICKER_ROWS * TEST_FLICKER_TLINE_NS;
+
+    for (int i = 0; i < frames; i++) {
+        double frame_time = 1.0 + i / fps;
+
+        test_flicker_frame(luma, frame_time, mains, 0.8, exposure);
+        freq = esp_video_flicker_process(flicker, (int64_t)(frame_time * 1000000), row_period, luma, TEST_FLICKER_ROWS);
+    }
+
+    return freq;
+}
+
+TEST_CASE("Flicker detection finds 50Hz and 60Hz power line", "[flicker]")
+{
+    esp_video_flicker_t flicker;
+
+    srand(1);
+
+    esp_video_flicker_init(&flicker, &s_default_config);
+    TEST_ASSERT_EQUAL(ESP_VIDEO_FLICKER_FREQ_50HZ, test_flicker_run(&flicker, 50, 30, 0.004, TEST_FLICKER_FRAMES));
+    TEST_ASSERT_GREATER_THAN(flicker.amplitude[1], flicker.amplitude[0]);
+
+    esp_video_flicker_init(&flicker, &s_default_config);
+    TEST_ASSERT_EQUAL(ESP_VIDEO_FLICKER_FREQ_60HZ, test_flicker_run(&flicker, 60, 25, 0.004, TEST_FLICKER_FRAMES));
+
+    /* Frame rate is not exactly the nominal one */
+    esp_video_flicker_init(&flicker, &s_default_config);
+    TEST_ASSERT_EQUAL(ESP_VIDEO_FLICKER_FREQ_60HZ, test_flicker_run(&flicker, 60, 15.2, 0.006, TEST_FLICKER_FRAMES));
+}
+
+TEST_CASE("Flicker detection reports nothing without flicker", "[flicker]")
+{
+    esp_video_flicker_t flicker;
+
+    srand(2);
+
+    esp_video_flicker_init(&flicker, &s_default_config);
+    TEST_ASSERT_EQUAL(ESP_VIDEO_FLICKER_FREQ_UNKNOWN, test_flicker_run(&flicker, 0, 30, 0.004, TEST_FLICKER_FRAMES));
+
+    /* 120Hz bands stand still at 30fps, it must not be taken as 100Hz */
+    esp_video_flicker_init(&flicker, &s_default_config);
+    TEST_ASSERT_EQUAL(ESP_VIDEO_FLICKER_FREQ_UNKNOWN, test_flicker_run(&flicker, 60, 30, 0.004, TEST_FLICKER_FRAMES));
+}
+
+TEST_CASE("Flicker detection keeps result when anti-flicker exposure removes bands", "[flicker]")
+{
+    esp_video_flicker_t flicker;
+
+    srand(3);
+
+    esp_video_flicker_init(&flicker, &s_default_config);
+    TEST_ASSERT_EQUAL(ESP_VIDEO_FLICKER_FREQ_50HZ, test_flicker_run(&flicker, 50, 30, 0.004, TEST_FLICKER_FRAMES));
+
+    /* Exposure of one flicker period has no bands */
+    TEST_ASSERT_EQUAL(ESP_VIDEO_FLICKER_FREQ_50HZ, test_flicker_run(&flicker, 50, 30, 0.010, TEST_FLICKER_FRAMES));
+
+    /* Light source changes to 60Hz */
+    TEST_ASSERT_EQUAL(ESP_VIDEO_FLICKER_FREQ_60HZ, test_flicker_run(&flicker, 60, 25, 0.010, TEST_FLICKER_FRAMES));
+
+    esp_video_flicker_reset(&flicker);
+    TEST_ASSERT_EQUAL(ESP_VIDEO_FLICKER_FREQ_UNKNOWN, flicker.freq);
+}
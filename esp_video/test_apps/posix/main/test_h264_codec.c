@@ -4,26 +4,46 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdio.h>
 #include <string.h>
+#include <inttypes.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "unity.h"
+#include "esp_timer.h"
 #include "esp_video_init.h"
 #include "esp_video_device.h"
 #include "esp_video_ioctl.h"
+#if CONFIG_ESP_VIDEO_ENABLE_H264_ABR
+#include "esp_video_h264_abr.h"
+#endif
 
 #define TEST_H264_WIDTH         128
 #define TEST_H264_HEIGHT        128
 #define TEST_H264_BUFFER_NUM    1
 
 #define H264_DEFAULT_I_PERIOD   30
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+#define H264_DEFAULT_MIN_QP     CONFIG_ESP_VIDEO_SW_H264_DEFAULT_MIN_QP
+#define H264_DEFAULT_MAX_QP     CONFIG_ESP_VIDEO_SW_H264_DEFAULT_MAX_QP
+#define H264_DEFAULT_BITRATE    1000000
+#else
 #define H264_DEFAULT_MIN_QP     25
 #define H264_DEFAULT_MAX_QP     26
 #define H264_DEFAULT_BITRATE    10000000
+#endif
 #define H264_DEFAULT_FPS        30
+#define H264_DEFAULT_QUALITY    50
+
+#define TEST_H264_BENCH_FRAMES  60
+
+/* Longer than the time H.264 adaptive bitrate holds IDR frame requests */
+#define TEST_H264_ABR_IDR_HOLD_MS   350
 
 typedef struct {
     int32_t i_period;
@@ -107,7 +127,8 @@ static void h264_verify_ctrl_values(int fd, const h264_ctrl_values_t *values)
     TEST_ASSERT_EQUAL_INT32(values->max_qp, actual);
 }
 
-static void h264_setup_m2m_stream(int fd)
+static void h264_setup_m2m_stream_with_format(int fd, uint32_t width, uint32_t height, uint32_t pixelformat,
+                                             uint8_t **input, uint32_t *input_size)
 {
     int ret;
     int val;
@@ -117,9 +138,9 @@ static void h264_setup_m2m_stream(int fd)
 
     memset(&format, 0, sizeof(format));
     format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
-    format.fmt.pix.width = TEST_H264_WIDTH;
-    format.fmt.pix.height = TEST_H264_HEIGHT;
-    format.fmt.pix.pixelformat = V4L2_PIX_FMT_YUV420;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = pixelformat;
     ret = ioctl(fd, VIDIOC_S_FMT, &format);
     TEST_ESP_OK(ret);
 
@@ -140,6 +161,10 @@ static void h264_setup_m2m_stream(int fd)
 
         void *mapped = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
         TEST_ASSERT_NOT_EQUAL(MAP_FAILED, mapped);
+        if (input) {
+            *input = mapped;
+            *input_size = buf.length;
+        }
 
         ret = ioctl(fd, VIDIOC_QBUF, &buf);
         TEST_ESP_OK(ret);
@@ -147,8 +172,8 @@ static void h264_setup_m2m_stream(int fd)
 
     memset(&format, 0, sizeof(format));
     format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    format.fmt.pix.width = TEST_H264_WIDTH;
-    format.fmt.pix.height = TEST_H264_HEIGHT;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
     format.fmt.pix.pixelformat = V4L2_PIX_FMT_H264;
     ret = ioctl(fd, VIDIOC_S_FMT, &format);
     TEST_ESP_OK(ret);
@@ -184,6 +209,11 @@ static void h264_setup_m2m_stream(int fd)
     TEST_ESP_OK(ret);
 }
 
+static void h264_setup_m2m_stream(int fd)
+{
+    h264_setup_m2m_stream_with_format(fd, TEST_H264_WIDTH, TEST_H264_HEIGHT, V4L2_PIX_FMT_YUV420, NULL, NULL);
+}
+
 static void h264_stop_m2m_stream(int fd)
 {
     int val;
@@ -306,10 +336,12 @@ TEST_CASE("H.264 video device set/get FPS", "[video][h264]")
     TEST_ESP_OK(h264_set_fps(fd, 25));
     h264_verify_fps(fd, 25);
 
-    /* After stream on: get FPS is allowed, set FPS must fail */
+    /* After stream on: FPS is changed without restarting stream */
     h264_setup_m2m_stream(fd);
     h264_verify_fps(fd, 25);
-    TEST_ASSERT_EQUAL_INT(-1, h264_set_fps(fd, 20));
+    TEST_ESP_OK(h264_set_fps(fd, 20));
+    h264_verify_fps(fd, 20);
+    TEST_ESP_OK(h264_set_fps(fd, 25));
     h264_verify_fps(fd, 25);
 
     /* After stream off: read/write FPS */
@@ -323,3 +355,567 @@ TEST_CASE("H.264 video device set/get FPS", "[video][h264]")
     close(fd);
     TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
 }
+
+/* Moving gradient with some texture, so encoder does real motion search and residual coding */
+static void h264_fill_bench_frame(uint8_t *buf, uint32_t size, uint32_t width, int frame)
+{
+    for (uint32_t i = 0; i < size; i++) {
+        uint32_t x = i % width;
+        uint32_t y = i / width;
+
+        buf[i] = (uint8_t)(x + y + frame * 2 + ((x * y) & 0x0f));
+    }
+}
+
+static void h264_encode_benchmark(uint32_t width, uint32_t height, uint32_t pixelformat, const char *name)
+{
+    int fd;
+    uint8_t *input = NULL;
+    uint32_t input_size = 0;
+    uint64_t total_bytes = 0;
+    int64_t total_us = 0;
+    struct v4l2_buffer buf;
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_H264));
+
+    fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    h264_setup_m2m_stream_with_format(fd, width, height, pixelformat, &input, &input_size);
+
+    for (int i = 0; i < TEST_H264_BENCH_FRAMES; i++) {
+        int64_t start_us;
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+
+        h264_fill_bench_frame(input, input_size, width, i);
+
+        start_us = esp_timer_get_time();
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+        total_us += esp_timer_get_time() - start_us;
+        total_bytes += buf.bytesused;
+
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+
+    printf("%s %" PRIu32 "x%" PRIu32 ": %lld fps, %lld kbps at %d fps\n", name, width, height,
+           TEST_H264_BENCH_FRAMES * 1000000LL / total_us,
+           (long long)(total_bytes * 8 * H264_DEFAULT_FPS / TEST_H264_BENCH_FRAMES / 1000),
+           H264_DEFAULT_FPS);
+
+    h264_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
+}
+
+TEST_CASE("H.264 video device encode throughput", "[video][h264][benchmark]")
+{
+    setUp();
+
+    h264_encode_benchmark(320, 240, V4L2_PIX_FMT_YUV420, "YUV420");
+    h264_encode_benchmark(640, 480, V4L2_PIX_FMT_YUV420, "YUV420");
+
+#if CONFIG_ESP_VIDEO_ENABLE_SW_H264_VIDEO_DEVICE
+    h264_encode_benchmark(320, 240, V4L2_PIX_FMT_YUYV, "YUYV");
+    h264_encode_benchmark(640, 480, V4L2_PIX_FMT_YUYV, "YUYV");
+#endif
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+TEST_CASE("H.264 video device NAL unit output", "[video][h264]")
+{
+    int fd;
+    int32_t value;
+    int nal_num = 0;
+    uint32_t nal_types = 0;
+    struct v4l2_buffer buf;
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_H264));
+
+    fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    h264_query_and_verify_ext_ctrl(fd, V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT, 0, 1, 1, 0);
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT, 1));
+    TEST_ESP_OK(h264_get_ext_ctrl(fd, V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT, &value));
+    TEST_ASSERT_EQUAL_INT32(1, value);
+
+    h264_setup_m2m_stream(fd);
+    TEST_ASSERT_EQUAL_INT(-1, h264_set_ext_ctrl(fd, V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT, 0));
+
+    /* The first access unit is IDR, it must carry SPS, PPS and IDR slice in separated buffers */
+    for (int i = 0; i < 16; i++) {
+        const uint8_t *data;
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+        TEST_ASSERT_GREATER_THAN_UINT32(0, buf.bytesused);
+        TEST_ASSERT_TRUE(buf.flags & V4L2_BUF_FLAG_KEYFRAME);
+
+        data = (const uint8_t *)buf.m.userptr;
+        if (buf.flags & V4L2_BUF_FLAG_ESP_NAL_START) {
+            const uint8_t *header = data[2] == 1 ? &data[3] : &data[4];
+
+            TEST_ASSERT_EQUAL_UINT8(0, data[0]);
+            TEST_ASSERT_EQUAL_UINT8(0, data[1]);
+            TEST_ASSERT_TRUE(data[2] == 1 || (data[2] == 0 && data[3] == 1));
+
+            nal_types |= 1 << (*header & 0x1f);
+            nal_num++;
+        }
+
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+
+        if (buf.flags & V4L2_BUF_FLAG_ESP_FRAME_END) {
+            TEST_ASSERT_TRUE(buf.flags & V4L2_BUF_FLAG_ESP_NAL_END);
+            break;
+        }
+    }
+
+    TEST_ASSERT_TRUE(buf.flags & V4L2_BUF_FLAG_ESP_FRAME_END);
+    TEST_ASSERT_GREATER_OR_EQUAL_INT(3, nal_num);
+    TEST_ASSERT_TRUE(nal_types & (1 << 7));         /* SPS */
+    TEST_ASSERT_TRUE(nal_types & (1 << 8));         /* PPS */
+    TEST_ASSERT_TRUE(nal_types & (1 << 5));         /* IDR slice */
+
+    h264_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
+}
+#endif
+
+static void h264_encode_frames(int fd, int count)
+{
+    struct v4l2_buffer buf;
+
+    for (int i = 0; i < count; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+        TEST_ASSERT_GREATER_THAN_UINT32(0, buf.bytesused);
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+}
+
+TEST_CASE("H.264 video device rate control while streaming", "[video][h264]")
+{
+    int fd;
+    int32_t value;
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_H264));
+
+    fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    h264_query_and_verify_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_BITRATE_MODE, V4L2_MPEG_VIDEO_BITRATE_MODE_CBR,
+                                   V4L2_MPEG_VIDEO_BITRATE_MODE_CQ, 1, V4L2_MPEG_VIDEO_BITRATE_MODE_CBR);
+    h264_query_and_verify_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_CONSTANT_QUALITY, 1, 100, 1, H264_DEFAULT_QUALITY);
+    TEST_ASSERT_EQUAL_INT(-1, h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_BITRATE_MODE, V4L2_MPEG_VIDEO_BITRATE_MODE_VBR));
+
+    h264_setup_m2m_stream(fd);
+    h264_encode_frames(fd, 2);
+
+    /* Every change takes effect from the next frame without STREAMOFF */
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME, 1));
+    h264_encode_frames(fd, 2);
+
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_H264_MIN_QP, 30));
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_H264_MAX_QP, 40));
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_BITRATE, 500000));
+    h264_encode_frames(fd, 2);
+
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_BITRATE_MODE, V4L2_MPEG_VIDEO_BITRATE_MODE_CQ));
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_CONSTANT_QUALITY, 80));
+    h264_encode_frames(fd, 2);
+
+    TEST_ESP_OK(h264_get_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_BITRATE_MODE, &value));
+    TEST_ASSERT_EQUAL_INT32(V4L2_MPEG_VIDEO_BITRATE_MODE_CQ, value);
+    TEST_ESP_OK(h264_get_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_CONSTANT_QUALITY, &value));
+    TEST_ASSERT_EQUAL_INT32(80, value);
+
+    h264_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+/* Noise has no spatial correlation, so its IDR frames are far larger than the size estimated by a low bitrate */
+static void h264_fill_noise_frame(uint8_t *buf, uint32_t size, uint32_t *seed)
+{
+    for (uint32_t i = 0; i < size; i++) {
+        *seed = *seed * 1103515245 + 12345;
+        buf[i] = (uint8_t)(*seed >> 16);
+    }
+}
+
+TEST_CASE("H.264 video device keeps encoding frames larger than estimated buffer", "[video][h264]")
+{
+    int fd;
+    int32_t value;
+    uint32_t seed = 1;
+    uint8_t *input = NULL;
+    uint32_t input_size = 0;
+    struct v4l2_buffer buf;
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_H264));
+
+    fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    /* Capture buffer size is estimated by the minimum bitrate */
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_BITRATE, 25000));
+    h264_setup_m2m_stream_with_format(fd, TEST_H264_WIDTH, TEST_H264_HEIGHT, V4L2_PIX_FMT_YUV420, &input, &input_size);
+
+    /* Frames of more than 2 GOPs keep coming out, including IDR frames after the maximum QP is restored */
+    for (int i = 0; i < H264_DEFAULT_I_PERIOD * 2 + 2; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+
+        h264_fill_noise_frame(input, input_size, &seed);
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+        TEST_ASSERT_FALSE(buf.flags & V4L2_BUF_FLAG_ERROR);
+        TEST_ASSERT_GREATER_THAN_UINT32(0, buf.bytesused);
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+
+    TEST_ESP_OK(h264_get_ext_ctrl(fd, V4L2_CID_CODEC_ESP_H264_OVERFLOW_FRAMES, &value));
+    TEST_ASSERT_GREATER_THAN_INT32(0, value);
+
+    h264_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
+}
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+static uint32_t h264_dequeue_access_unit(int fd)
+{
+    uint32_t flags = 0;
+    struct v4l2_buffer buf;
+
+    do {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+        flags |= buf.flags;
+    } while (!(buf.flags & V4L2_BUF_FLAG_ESP_FRAME_END));
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+    TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+
+    return flags;
+}
+
+TEST_CASE("H.264 video device force key frame", "[video][h264]")
+{
+    int fd;
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_H264));
+
+    fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT, 1));
+    h264_setup_m2m_stream(fd);
+
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_KEYFRAME);
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_PFRAME);
+
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME, 1));
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_KEYFRAME);
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_PFRAME);
+
+    h264_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
+}
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_H264_ABR
+TEST_CASE("H.264 adaptive bitrate", "[video][h264]")
+{
+    int fd;
+    int32_t value;
+    uint32_t bitrate;
+    esp_video_h264_abr_handle_t abr;
+    esp_video_h264_abr_config_t abr_config = {
+        .min_bitrate = 200000,
+        .max_bitrate = 4000000,
+        .increase_interval_ms = 10,
+    };
+    esp_video_h264_abr_feedback_t congested = {
+        .queued_bytes = 60000,
+        .queue_size = 100000,
+    };
+    esp_video_h264_abr_feedback_t idle = {
+        .queued_bytes = 0,
+        .queue_size = 100000,
+    };
+    esp_video_h264_abr_feedback_t dropped = {
+        .queued_bytes = 100000,
+        .queue_size = 100000,
+        .dropped = true,
+    };
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_H264));
+
+    fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_BITRATE, 2000000));
+    h264_setup_m2m_stream(fd);
+
+    abr_config.fd = fd;
+    TEST_ESP_OK(esp_video_h264_abr_create(&abr_config, &abr));
+    TEST_ESP_OK(esp_video_h264_abr_get_bitrate(abr, &bitrate));
+    TEST_ASSERT_EQUAL_UINT32(2000000, bitrate);
+
+    /* Queue over high level: decrease once, then hold until encoder follows */
+    TEST_ESP_OK(esp_video_h264_abr_update(abr, &congested));
+    TEST_ESP_OK(esp_video_h264_abr_get_bitrate(abr, &bitrate));
+    TEST_ASSERT_EQUAL_UINT32(1500000, bitrate);
+    TEST_ESP_OK(h264_get_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_BITRATE, &value));
+    TEST_ASSERT_EQUAL_INT32(1500000, value);
+    TEST_ESP_OK(esp_video_h264_abr_update(abr, &congested));
+    TEST_ESP_OK(esp_video_h264_abr_get_bitrate(abr, &bitrate));
+    TEST_ASSERT_EQUAL_UINT32(1500000, bitrate);
+
+    /* Dropped data: halve bitrate and request IDR frame at once */
+    TEST_ESP_OK(esp_video_h264_abr_update(abr, &dropped));
+    TEST_ESP_OK(esp_video_h264_abr_get_bitrate(abr, &bitrate));
+    TEST_ASSERT_EQUAL_UINT32(750000, bitrate);
+    h264_encode_frames(fd, 1);
+
+    /* Queue keeps empty: increase step by step up to maximum */
+    for (int i = 0; i < 100; i++) {
+        TEST_ESP_OK(esp_video_h264_abr_update(abr, &idle));
+        vTaskDelay(pdMS_TO_TICKS(20));
+    }
+    TEST_ESP_OK(esp_video_h264_abr_get_bitrate(abr, &bitrate));
+    TEST_ASSERT_EQUAL_UINT32(4000000, bitrate);
+    TEST_ESP_OK(h264_get_ext_ctrl(fd, V4L2_CID_MPEG_VIDEO_BITRATE, &value));
+    TEST_ASSERT_EQUAL_INT32(4000000, value);
+
+    TEST_ESP_OK(esp_video_h264_abr_delete(abr));
+
+    h264_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_H264_NAL_OUTPUT
+TEST_CASE("H.264 adaptive bitrate limits IDR frame requests", "[video][h264]")
+{
+    int fd;
+    esp_video_h264_abr_handle_t abr;
+    esp_video_h264_abr_config_t abr_config = {
+        .min_bitrate = 200000,
+        .max_bitrate = 4000000,
+    };
+    esp_video_h264_abr_feedback_t idle = {
+        .queued_bytes = 0,
+        .queue_size = 100000,
+    };
+    esp_video_h264_abr_feedback_t dropped = {
+        .queued_bytes = 100000,
+        .queue_size = 100000,
+        .dropped = true,
+    };
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_H264));
+
+    fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    TEST_ESP_OK(h264_set_ext_ctrl(fd, V4L2_CID_CODEC_ESP_H264_NAL_OUTPUT, 1));
+    h264_setup_m2m_stream(fd);
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_KEYFRAME);
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_PFRAME);
+
+    abr_config.fd = fd;
+    TEST_ESP_OK(esp_video_h264_abr_create(&abr_config, &abr));
+
+    /* The first drop requests an IDR frame at once */
+    TEST_ESP_OK(esp_video_h264_abr_update(abr, &dropped));
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_KEYFRAME);
+
+    /* Drops within hold time don't request more IDR frames */
+    TEST_ESP_OK(esp_video_h264_abr_update(abr, &dropped));
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_PFRAME);
+    TEST_ESP_OK(esp_video_h264_abr_update(abr, &dropped));
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_PFRAME);
+
+    /* After hold time, the pending drop is recovered by one IDR frame */
+    vTaskDelay(pdMS_TO_TICKS(TEST_H264_ABR_IDR_HOLD_MS));
+    TEST_ESP_OK(esp_video_h264_abr_update(abr, &idle));
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_KEYFRAME);
+    TEST_ESP_OK(esp_video_h264_abr_update(abr, &idle));
+    TEST_ASSERT_TRUE(h264_dequeue_access_unit(fd) & V4L2_BUF_FLAG_PFRAME);
+
+    TEST_ESP_OK(esp_video_h264_abr_delete(abr));
+
+    h264_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
+}
+#endif
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE
+static int h264_set_roi(int fd, const esp_video_h264_roi_t *roi)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl;
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    memset(&ctrl, 0, sizeof(ctrl));
+    ctrls.ctrl_class = V4L2_CID_CODEC_CLASS;
+    ctrls.count = 1;
+    ctrls.controls = &ctrl;
+    ctrl.id = V4L2_CID_CODEC_ESP_H264_ROI;
+    ctrl.p_u8 = (uint8_t *)roi;
+    ctrl.size = sizeof(esp_video_h264_roi_t);
+
+    return ioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls);
+}
+
+static int h264_get_roi(int fd, esp_video_h264_roi_t *roi)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl;
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    memset(&ctrl, 0, sizeof(ctrl));
+    ctrls.ctrl_class = V4L2_CID_CODEC_CLASS;
+    ctrls.count = 1;
+    ctrls.controls = &ctrl;
+    ctrl.id = V4L2_CID_CODEC_ESP_H264_ROI;
+    ctrl.p_u8 = (uint8_t *)roi;
+    ctrl.size = sizeof(esp_video_h264_roi_t);
+
+    return ioctl(fd, VIDIOC_G_EXT_CTRLS, &ctrls);
+}
+
+TEST_CASE("H.264 video device regions of interest", "[video][h264]")
+{
+    int fd;
+    struct v4l2_query_ext_ctrl qctrl;
+    esp_video_h264_roi_t roi;
+    esp_video_h264_roi_t actual;
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_H264));
+
+    fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&qctrl, 0, sizeof(qctrl));
+    qctrl.id = V4L2_CID_CODEC_ESP_H264_ROI;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_QUERY_EXT_CTRL, &qctrl));
+    TEST_ASSERT_EQUAL_UINT32(V4L2_CTRL_TYPE_U8, qctrl.type);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(esp_video_h264_roi_t), qctrl.elems);
+
+    h264_setup_m2m_stream(fd);
+    h264_encode_frames(fd, 1);
+
+    /* Follow a moving object frame by frame, the object costs more bits than background */
+    for (int i = 0; i < 4; i++) {
+        memset(&roi, 0, sizeof(roi));
+        roi.num = 2;
+        roi.background_delta_qp = 6;
+        roi.regions[0].left = i * 16 + 5;
+        roi.regions[0].top = i * 8;
+        roi.regions[0].width = 40;
+        roi.regions[0].height = 30;
+        roi.regions[0].delta_qp = -8;
+        roi.regions[1].left = 0;
+        roi.regions[1].top = TEST_H264_HEIGHT - 16;
+        roi.regions[1].width = TEST_H264_WIDTH;
+        roi.regions[1].height = 16;
+        roi.regions[1].delta_qp = -2;
+        TEST_ESP_OK(h264_set_roi(fd, &roi));
+
+        memset(&actual, 0, sizeof(actual));
+        TEST_ESP_OK(h264_get_roi(fd, &actual));
+        TEST_ASSERT_EQUAL_MEMORY(&roi, &actual, sizeof(roi));
+
+        h264_encode_frames(fd, 1);
+    }
+
+    /* Region out of image or QP offset out of range is rejected, and the last ROI is kept */
+    actual = roi;
+    actual.regions[0].left = TEST_H264_WIDTH - 8;
+    actual.regions[0].width = 16;
+    TEST_ASSERT_EQUAL_INT(-1, h264_set_roi(fd, &actual));
+
+    actual = roi;
+    actual.regions[1].delta_qp = ESP_VIDEO_H264_ROI_MAX_DELTA_QP + 1;
+    TEST_ASSERT_EQUAL_INT(-1, h264_set_roi(fd, &actual));
+
+    actual = roi;
+    actual.num = ESP_VIDEO_H264_ROI_MAX_NUM + 1;
+    TEST_ASSERT_EQUAL_INT(-1, h264_set_roi(fd, &actual));
+
+    TEST_ESP_OK(h264_get_roi(fd, &actual));
+    TEST_ASSERT_EQUAL_MEMORY(&roi, &actual, sizeof(roi));
+
+    /* Disable ROI */
+    memset(&roi, 0, sizeof(roi));
+    TEST_ESP_OK(h264_set_roi(fd, &roi));
+    h264_encode_frames(fd, 2);
+
+    h264_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_H264));
+}
+#endif
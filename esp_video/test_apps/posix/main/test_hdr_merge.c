@@ -0,0 +1,183 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "sdkconfig.h"
+#include "linux/videodev2.h"
+#include "esp_video_hdr_merge.h"
+
+#define TEST_HDR_MERGE_WIDTH        256
+#define TEST_HDR_MERGE_HEIGHT       4
+#define TEST_HDR_MERGE_RATIO        4
+
+/* Scene radiance rises along the line, the short exposure frame keeps the highlights */
+static void fill_exposure(uint8_t *buffer, uint32_t bpp, uint32_t exposure)
+{
+    for (int y = 0; y < TEST_HDR_MERGE_HEIGHT; y++) {
+        for (int x = 0; x < TEST_HDR_MERGE_WIDTH; x++) {
+            uint32_t value = x * exposure;
+            uint8_t *p = buffer + (y * TEST_HDR_MERGE_WIDTH + x) * bpp;
+
+            if (bpp == 1) {
+                p[0] = value > 255 ? 255 : value;
+            } else {
+                /* YUYV, U and V tell which frame the chroma comes from */
+                p[0] = value > 255 ? 255 : value;
+                p[1] = exposure;
+            }
+        }
+    }
+}
+
+TEST_CASE("HDR merge keeps shadows and highlights", "[video][hdr_merge]")
+{
+    size_t size = TEST_HDR_MERGE_WIDTH * TEST_HDR_MERGE_HEIGHT;
+    uint8_t *frames[2];
+    uint8_t *out = malloc(size);
+    esp_video_hdr_merge_config_t config = {
+        .width = TEST_HDR_MERGE_WIDTH,
+        .height = TEST_HDR_MERGE_HEIGHT,
+        .pixel_format = V4L2_PIX_FMT_SBGGR8,
+        .num = 2,
+        .exposure = {TEST_HDR_MERGE_RATIO, 1},
+    };
+
+    TEST_ASSERT_NOT_NULL(out);
+    for (int i = 0; i < 2; i++) {
+        frames[i] = malloc(size);
+        TEST_ASSERT_NOT_NULL(frames[i]);
+        fill_exposure(frames[i], 1, config.exposure[i]);
+    }
+
+    TEST_ESP_OK(esp_video_hdr_merge_process(&config, (const uint8_t *const *)frames, size, out));
+
+    /* Output is monotonic, and highlights saturated in the long exposure frame are still distinguished */
+    for (int x = 1; x < TEST_HDR_MERGE_WIDTH; x++) {
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT8(out[x - 1], out[x]);
+    }
+    TEST_ASSERT_GREATER_THAN_UINT8(out[255 / TEST_HDR_MERGE_RATIO], out[128]);
+    TEST_ASSERT_GREATER_THAN_UINT8(out[128], out[240]);
+    TEST_ASSERT_GREATER_THAN_UINT8(0, out[1]);
+    TEST_ASSERT_EQUAL_UINT8(255, out[TEST_HDR_MERGE_WIDTH - 1]);
+    TEST_ASSERT_EQUAL_MEMORY(out, out + TEST_HDR_MERGE_WIDTH, TEST_HDR_MERGE_WIDTH);
+
+    /* Merging in place gives the same result */
+    TEST_ESP_OK(esp_video_hdr_merge_process(&config, (const uint8_t *const *)frames, size, frames[0]));
+    TEST_ASSERT_EQUAL_MEMORY(out, frames[0], size);
+
+    for (int i = 0; i < 2; i++) {
+        free(frames[i]);
+    }
+    free(out);
+}
+
+TEST_CASE("HDR merge applies tone lookup table", "[video][hdr_merge]")
+{
+    size_t size = TEST_HDR_MERGE_WIDTH * TEST_HDR_MERGE_HEIGHT;
+    uint8_t *frames[2];
+    uint8_t *out = malloc(size);
+    uint8_t *ref = malloc(size);
+    uint8_t tone_lut[ESP_VIDEO_HDR_MERGE_LUT_SIZE];
+    esp_video_hdr_merge_config_t config = {
+        .width = TEST_HDR_MERGE_WIDTH,
+        .height = TEST_HDR_MERGE_HEIGHT,
+        .pixel_format = V4L2_PIX_FMT_GREY,
+        .num = 2,
+        .exposure = {1, TEST_HDR_MERGE_RATIO},
+    };
+
+    TEST_ASSERT_NOT_NULL(out);
+    TEST_ASSERT_NOT_NULL(ref);
+    for (int i = 0; i < 2; i++) {
+        frames[i] = malloc(size);
+        TEST_ASSERT_NOT_NULL(frames[i]);
+        fill_exposure(frames[i], 1, config.exposure[i]);
+    }
+
+    for (int i = 0; i < ESP_VIDEO_HDR_MERGE_LUT_SIZE; i++) {
+        tone_lut[i] = 255 - i;
+    }
+
+    TEST_ESP_OK(esp_video_hdr_merge_process(&config, (const uint8_t *const *)frames, size, ref));
+    config.tone_lut = tone_lut;
+    TEST_ESP_OK(esp_video_hdr_merge_process(&config, (const uint8_t *const *)frames, size, out));
+
+    for (int i = 0; i < size; i++) {
+        TEST_ASSERT_EQUAL_UINT8(255 - ref[i], out[i]);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        free(frames[i]);
+    }
+    free(ref);
+    free(out);
+}
+
+TEST_CASE("HDR merge copies chroma from the best exposed frame", "[video][hdr_merge]")
+{
+    size_t size = TEST_HDR_MERGE_WIDTH * TEST_HDR_MERGE_HEIGHT * 2;
+    uint8_t *frames[2];
+    uint8_t *out = malloc(size);
+    esp_video_hdr_merge_config_t config = {
+        .width = TEST_HDR_MERGE_WIDTH,
+        .height = TEST_HDR_MERGE_HEIGHT,
+        .pixel_format = V4L2_PIX_FMT_YUYV,
+        .num = 2,
+        .exposure = {1, TEST_HDR_MERGE_RATIO},
+    };
+
+    TEST_ASSERT_NOT_NULL(out);
+    for (int i = 0; i < 2; i++) {
+        frames[i] = malloc(size);
+        TEST_ASSERT_NOT_NULL(frames[i]);
+        fill_exposure(frames[i], 2, config.exposure[i]);
+    }
+
+    TEST_ESP_OK(esp_video_hdr_merge_process(&config, (const uint8_t *const *)frames, size, out));
+
+    /* Dark pixels are well exposed in the long exposure frame, bright ones in the short exposure frame */
+    TEST_ASSERT_EQUAL_UINT8(TEST_HDR_MERGE_RATIO, out[16 * 2 + 1]);
+    TEST_ASSERT_EQUAL_UINT8(1, out[200 * 2 + 1]);
+    for (int x = 1; x < TEST_HDR_MERGE_WIDTH; x++) {
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT8(out[(x - 1) * 2], out[x * 2]);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        free(frames[i]);
+    }
+    free(out);
+}
+
+TEST_CASE("HDR merge invalid arguments", "[video][hdr_merge]")
+{
+    uint8_t frame[16];
+    const uint8_t *frames[2] = {frame, frame};
+    esp_video_hdr_merge_config_t config = {
+        .width = 4,
+        .height = 4,
+        .pixel_format = V4L2_PIX_FMT_GREY,
+        .num = 2,
+        .exposure = {1, 2},
+    };
+
+    TEST_ESP_OK(esp_video_hdr_merge_process(&config, frames, sizeof(frame), frame));
+    TEST_ESP_ERR(ESP_ERR_INVALID_SIZE, esp_video_hdr_merge_process(&config, frames, sizeof(frame) - 1, frame));
+
+    config.num = 1;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_hdr_merge_process(&config, frames, sizeof(frame), frame));
+    config.num = 2;
+
+    config.exposure[1] = 0;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_hdr_merge_process(&config, frames, sizeof(frame), frame));
+    config.exposure[1] = 2;
+
+    config.pixel_format = V4L2_PIX_FMT_RGB565;
+    TEST_ESP_ERR(ESP_ERR_NOT_SUPPORTED, esp_video_hdr_merge_process(&config, frames, sizeof(frame), frame));
+}
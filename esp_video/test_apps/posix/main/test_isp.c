@@ -183,6 +183,81 @@ TEST_CASE("V4L2 set/get GAMMA_EXT", "[video]")
     TEST_ESP_OK(example_video_deinit());
 }
 
+TEST_CASE("V4L2 ISP applies controls after a failed one", "[video]")
+{
+    int fd;
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl[2];
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    fd = open(ESP_VIDEO_ISP1_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    /* ISP doesn't support auto gain, but brightness after it is still applied */
+    memset(&ctrls, 0, sizeof(ctrls));
+    memset(ctrl, 0, sizeof(ctrl));
+    ctrls.ctrl_class = V4L2_CID_USER_CLASS;
+    ctrls.count      = 2;
+    ctrls.controls   = ctrl;
+    ctrl[0].id       = V4L2_CID_AUTOGAIN;
+    ctrl[0].value    = 1;
+    ctrl[1].id       = V4L2_CID_BRIGHTNESS;
+    ctrl[1].value    = 10;
+    TEST_ASSERT_NOT_EQUAL(0, ioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls));
+
+    ctrls.count      = 1;
+    ctrls.controls   = &ctrl[1];
+    ctrl[1].value    = 0;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_G_EXT_CTRLS, &ctrls));
+    TEST_ASSERT_EQUAL_INT32(10, ctrl[1].value);
+
+    close(fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_FLICKER_DETECT
+TEST_CASE("V4L2 ISP query power line frequency menu", "[video]")
+{
+    int fd;
+    struct v4l2_query_ext_ctrl qctrl;
+    struct v4l2_querymenu qmenu;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    fd = open(ESP_VIDEO_ISP1_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&qctrl, 0, sizeof(qctrl));
+    qctrl.id = V4L2_CID_POWER_LINE_FREQUENCY;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_QUERY_EXT_CTRL, &qctrl));
+    TEST_ASSERT_EQUAL_UINT32(V4L2_CTRL_TYPE_MENU, qctrl.type);
+    TEST_ASSERT_EQUAL_INT64(V4L2_CID_POWER_LINE_FREQUENCY_DISABLED, qctrl.minimum);
+    TEST_ASSERT_EQUAL_INT64(V4L2_CID_POWER_LINE_FREQUENCY_AUTO, qctrl.maximum);
+    TEST_ASSERT_EQUAL_INT64(V4L2_CID_POWER_LINE_FREQUENCY_AUTO, qctrl.default_value);
+
+    for (int i = qctrl.minimum; i <= qctrl.maximum; i++) {
+        memset(&qmenu, 0, sizeof(qmenu));
+        qmenu.id = V4L2_CID_POWER_LINE_FREQUENCY;
+        qmenu.index = i;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QUERYMENU, &qmenu));
+        TEST_ASSERT_NOT_EQUAL(0, qmenu.name[0]);
+    }
+
+    qmenu.index = qctrl.maximum + 1;
+    TEST_ASSERT_NOT_EQUAL(0, ioctl(fd, VIDIOC_QUERYMENU, &qmenu));
+
+    close(fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+#endif
+
 TEST_CASE("V4L2 set/get AWB/AE/AF/HIST statistics windows", "[video]")
 {
     int fd;
@@ -459,3 +534,254 @@ TEST_CASE("ISP pipeline set/get statistics window around MIPI-CSI stream", "[vid
 }
 #endif /* CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE */
 #endif /* CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER */
+
+#if CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG && CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE
+#define TEST_ISP_SHADOW_BUFFER_COUNT    2
+#define TEST_ISP_SHADOW_MAX_FRAMES      8
+
+static void set_isp_ext_ctrl(int isp_fd, uint32_t id, void *data, uint32_t size)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl[1];
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    ctrls.ctrl_class = V4L2_CID_USER_CLASS;
+    ctrls.count = 1;
+    ctrls.controls = ctrl;
+    ctrl[0].id = id;
+    ctrl[0].size = size;
+    ctrl[0].p_u8 = (uint8_t *)data;
+    TEST_ESP_OK(ioctl(isp_fd, VIDIOC_S_EXT_CTRLS, &ctrls));
+}
+
+static int32_t get_isp_commit_seq(int isp_fd)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl[1];
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    ctrls.ctrl_class = V4L2_CID_USER_CLASS;
+    ctrls.count = 1;
+    ctrls.controls = ctrl;
+    ctrl[0].id = V4L2_CID_USER_ESP_ISP_COMMIT_SEQ;
+    TEST_ESP_OK(ioctl(isp_fd, VIDIOC_G_EXT_CTRLS, &ctrls));
+
+    return ctrl[0].value;
+}
+
+static void set_isp_ccm(int isp_fd, float gain)
+{
+    esp_video_isp_ccm_t ccm;
+
+    memset(&ccm, 0, sizeof(ccm));
+    ccm.enable = true;
+    for (int i = 0; i < ISP_CCM_DIMENSION; i++) {
+        ccm.matrix[i][i] = gain;
+    }
+
+    set_isp_ext_ctrl(isp_fd, V4L2_CID_USER_ESP_ISP_CCM, &ccm, sizeof(ccm));
+}
+
+static void start_isp_shadow_stream(int csi_fd, int isp_fd, esp_video_isp_stats_t **stats)
+{
+    int type;
+    struct v4l2_buffer buf;
+    struct v4l2_requestbuffers req;
+    esp_video_isp_ae_t ae;
+    esp_video_isp_hist_t hist;
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl[1];
+
+    /* Statistics frames are done when both AE and histogram statistics are done */
+    memset(&ctrls, 0, sizeof(ctrls));
+    ctrls.ctrl_class = V4L2_CID_USER_CLASS;
+    ctrls.count = 1;
+    ctrls.controls = ctrl;
+    ctrl[0].id = V4L2_CID_USER_ESP_ISP_AE;
+    ctrl[0].size = sizeof(ae);
+    ctrl[0].p_u8 = (uint8_t *)&ae;
+    TEST_ESP_OK(ioctl(isp_fd, VIDIOC_G_EXT_CTRLS, &ctrls));
+    ae.enable = true;
+    set_isp_ext_ctrl(isp_fd, V4L2_CID_USER_ESP_ISP_AE, &ae, sizeof(ae));
+
+    ctrl[0].id = V4L2_CID_USER_ESP_ISP_HIST;
+    ctrl[0].size = sizeof(hist);
+    ctrl[0].p_u8 = (uint8_t *)&hist;
+    TEST_ESP_OK(ioctl(isp_fd, VIDIOC_G_EXT_CTRLS, &ctrls));
+    hist.enable = true;
+    set_isp_ext_ctrl(isp_fd, V4L2_CID_USER_ESP_ISP_HIST, &hist, sizeof(hist));
+
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_META_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count = TEST_ISP_SHADOW_BUFFER_COUNT;
+    TEST_ESP_OK(ioctl(isp_fd, VIDIOC_REQBUFS, &req));
+
+    for (int i = 0; i < TEST_ISP_SHADOW_BUFFER_COUNT; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_META_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        TEST_ESP_OK(ioctl(isp_fd, VIDIOC_QUERYBUF, &buf));
+        stats[i] = (esp_video_isp_stats_t *)mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, isp_fd, buf.m.offset);
+        TEST_ASSERT_NOT_NULL(stats[i]);
+        TEST_ESP_OK(ioctl(isp_fd, VIDIOC_QBUF, &buf));
+    }
+
+    type = V4L2_BUF_TYPE_META_CAPTURE;
+    TEST_ESP_OK(ioctl(isp_fd, VIDIOC_STREAMON, &type));
+
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count = TEST_ISP_SHADOW_BUFFER_COUNT;
+    TEST_ESP_OK(ioctl(csi_fd, VIDIOC_REQBUFS, &req));
+
+    for (int i = 0; i < TEST_ISP_SHADOW_BUFFER_COUNT; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        TEST_ESP_OK(ioctl(csi_fd, VIDIOC_QUERYBUF, &buf));
+        TEST_ESP_OK(ioctl(csi_fd, VIDIOC_QBUF, &buf));
+    }
+
+    type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(csi_fd, VIDIOC_STREAMON, &type));
+}
+
+static void stop_isp_shadow_stream(int csi_fd, int isp_fd)
+{
+    int type;
+
+    type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(csi_fd, VIDIOC_STREAMOFF, &type));
+
+    type = V4L2_BUF_TYPE_META_CAPTURE;
+    TEST_ESP_OK(ioctl(isp_fd, VIDIOC_STREAMOFF, &type));
+}
+
+/* Wait for one camera frame and its statistics, and return the statistics sequence number */
+static uint64_t wait_isp_shadow_frame(int csi_fd, int isp_fd, esp_video_isp_stats_t **stats)
+{
+    uint64_t seq;
+    struct v4l2_buffer buf;
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(csi_fd, VIDIOC_DQBUF, &buf));
+    TEST_ESP_OK(ioctl(csi_fd, VIDIOC_QBUF, &buf));
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_META_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(isp_fd, VIDIOC_DQBUF, &buf));
+    seq = stats[buf.index]->seq;
+    TEST_ESP_OK(ioctl(isp_fd, VIDIOC_QBUF, &buf));
+
+    return seq;
+}
+
+/* Wait until the commit sequence number is changed, and return the new one */
+static int32_t wait_isp_shadow_commit(int csi_fd, int isp_fd, esp_video_isp_stats_t **stats, int32_t commit_seq)
+{
+    for (int i = 0; i < TEST_ISP_SHADOW_MAX_FRAMES; i++) {
+        int32_t seq;
+
+        wait_isp_shadow_frame(csi_fd, isp_fd, stats);
+        seq = get_isp_commit_seq(isp_fd);
+        if (seq != commit_seq) {
+            return seq;
+        }
+    }
+
+    TEST_FAIL_MESSAGE("ISP configuration is not committed");
+    return commit_seq;
+}
+
+static void open_isp_shadow_devices(int *csi_fd, int *isp_fd)
+{
+    TEST_ESP_OK(example_video_init());
+
+#if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER
+    /* Test captures statistics and sets controls in place of ISP pipeline controller */
+    if (esp_video_isp_pipeline_is_initialized()) {
+        TEST_ESP_OK(esp_video_isp_pipeline_deinit());
+    }
+#endif
+
+    *csi_fd = open(ESP_VIDEO_MIPI_CSI_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, *csi_fd);
+
+    *isp_fd = open(ESP_VIDEO_ISP1_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, *isp_fd);
+}
+
+TEST_CASE("ISP commits image processing controls at frame boundary", "[video]")
+{
+    int csi_fd;
+    int isp_fd;
+    uint64_t seq;
+    int32_t commit_seq;
+    esp_video_isp_stats_t *stats[TEST_ISP_SHADOW_BUFFER_COUNT];
+
+    setUp();
+
+    open_isp_shadow_devices(&csi_fd, &isp_fd);
+    start_isp_shadow_stream(csi_fd, isp_fd, stats);
+
+    commit_seq = get_isp_commit_seq(isp_fd);
+    seq = wait_isp_shadow_frame(csi_fd, isp_fd, stats);
+
+    /**
+     * Control is committed when statistics of a frame later than "seq" are done, the next frame
+     * has started then, so the one after it is the first frame processed completely with it.
+     */
+    set_isp_ccm(isp_fd, 1.5f);
+    commit_seq = wait_isp_shadow_commit(csi_fd, isp_fd, stats, commit_seq);
+    TEST_ASSERT_GREATER_THAN_INT64((int64_t)seq + 2, commit_seq);
+
+    stop_isp_shadow_stream(csi_fd, isp_fd);
+
+    close(isp_fd);
+    close(csi_fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+TEST_CASE("ISP skips image processing controls which are not changed", "[video]")
+{
+    int csi_fd;
+    int isp_fd;
+    int32_t commit_seq;
+    esp_video_isp_stats_t *stats[TEST_ISP_SHADOW_BUFFER_COUNT];
+
+    setUp();
+
+    open_isp_shadow_devices(&csi_fd, &isp_fd);
+    start_isp_shadow_stream(csi_fd, isp_fd, stats);
+
+    commit_seq = get_isp_commit_seq(isp_fd);
+    set_isp_ccm(isp_fd, 1.5f);
+    commit_seq = wait_isp_shadow_commit(csi_fd, isp_fd, stats, commit_seq);
+
+    /* The same control is not written to ISP again, so nothing is committed */
+    set_isp_ccm(isp_fd, 1.5f);
+    for (int i = 0; i < TEST_ISP_SHADOW_MAX_FRAMES; i++) {
+        wait_isp_shadow_frame(csi_fd, isp_fd, stats);
+    }
+    TEST_ASSERT_EQUAL_INT32(commit_seq, get_isp_commit_seq(isp_fd));
+
+    /* A changed control is committed */
+    set_isp_ccm(isp_fd, 1.0f);
+    wait_isp_shadow_commit(csi_fd, isp_fd, stats, commit_seq);
+
+    stop_isp_shadow_stream(csi_fd, isp_fd);
+
+    close(isp_fd);
+    close(csi_fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+#endif /* CONFIG_ESP_VIDEO_ISP_DEVICE_SHADOW_CONFIG && CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE */
@@ -21,6 +21,9 @@
 #include "esp_video_isp_pipeline.h"
 #include "esp_video_isp_ioctl.h"
 #include "esp_video_pipeline_isp.h"
+#include "esp_video_device_common.h"
+#include "esp_video_device_internal.h"
+#include "esp_ipa.h"
 
 #if CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER && CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE
 
@@ -301,4 +304,212 @@ TEST_CASE("ISP pipeline set/get AGC max/min exposure", "[video][isp_pipeline]")
 
     TEST_ESP_OK(example_video_deinit());
 }
+
+TEST_CASE("ISP pipeline swap IPA configuration", "[video][isp_pipeline]")
+{
+    int fd;
+    int type;
+    uint32_t max_us;
+    uint32_t value;
+    struct v4l2_buffer buf;
+    struct v4l2_requestbuffers req;
+    esp_video_cam_t video_cam;
+    esp_video_isp_pipeline_agc_status_t status;
+
+    setUp();
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_swap_ipa_config(NULL));
+
+    TEST_ESP_OK(example_video_init());
+    TEST_ASSERT_TRUE(esp_video_isp_pipeline_is_initialized());
+
+    TEST_ESP_OK(esp_video_device_common_get_video_cam(CSI_NAME, &video_cam));
+    const esp_ipa_config_t *ipa_config = esp_ipa_pipeline_get_config(video_cam.sensor->name);
+    TEST_ASSERT_NOT_NULL(ipa_config);
+
+    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = TEST_VIDEO_BUFFER_COUNT;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_REQBUFS, &req));
+
+    for (int i = 0; i < TEST_VIDEO_BUFFER_COUNT; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index  = i;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QUERYBUF, &buf));
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+
+    type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMON, &type));
+
+    /* Application AGC settings should be kept by the new IPA pipeline */
+    TEST_ESP_OK(esp_video_isp_pipeline_get_agc_max_exposure(&max_us));
+    TEST_ESP_OK(esp_video_isp_pipeline_set_agc_status(ESP_VIDEO_ISP_PIPELINE_AGC_DISABLE));
+
+    /* Swap twice in a row, the first pending one should be released */
+    TEST_ESP_OK(esp_video_isp_pipeline_swap_ipa_config(ipa_config));
+    TEST_ESP_OK(esp_video_isp_pipeline_swap_ipa_config(ipa_config));
+
+    for (int i = 0; i < TEST_ISP_STATS_DUMP_COUNT; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+
+    TEST_ESP_OK(esp_video_isp_pipeline_get_agc_status(&status));
+    TEST_ASSERT_EQUAL_INT(ESP_VIDEO_ISP_PIPELINE_AGC_DISABLE, status);
+    TEST_ESP_OK(esp_video_isp_pipeline_get_agc_max_exposure(&value));
+    TEST_ASSERT_EQUAL_UINT32(max_us, value);
+
+    TEST_ESP_OK(esp_video_isp_pipeline_set_agc_status(ESP_VIDEO_ISP_PIPELINE_AGC_ENABLE));
+
+    type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMOFF, &type));
+
+    close(fd);
+
+    TEST_ESP_OK(example_video_deinit());
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_STATE, esp_video_isp_pipeline_swap_ipa_config(ipa_config));
+}
+
+TEST_CASE("ISP pipeline set ROI", "[video][isp_pipeline]")
+{
+    esp_video_isp_roi_t roi[ESP_VIDEO_ISP_ROI_MAX_NUM + 1] = {
+        {
+            .region = {.left = 100, .top = 80, .width = 120, .height = 160},
+            .weight = 16,
+        },
+        {
+            .region = {.left = 400, .top = 200, .width = 64, .height = 64},
+            .weight = ESP_VIDEO_ISP_ROI_WEIGHT_MAX,
+        },
+    };
+
+    setUp();
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_STATE, esp_video_isp_pipeline_set_roi(roi, 2));
+
+    TEST_ESP_OK(example_video_init());
+    TEST_ASSERT_TRUE(esp_video_isp_pipeline_is_initialized());
+
+    TEST_ESP_OK(esp_video_isp_pipeline_set_roi(roi, 2));
+    TEST_ESP_OK(esp_video_isp_pipeline_set_roi(NULL, 0));
+
+    /* Invalid arguments */
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_set_roi(NULL, 1));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_set_roi(roi, ESP_VIDEO_ISP_ROI_MAX_NUM + 1));
+
+    roi[0].weight = ESP_VIDEO_ISP_ROI_WEIGHT_MAX + 1;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_set_roi(roi, 1));
+
+    roi[0].weight = 16;
+    roi[0].region.width = 0;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_set_roi(roi, 1));
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+TEST_CASE("ISP pipeline ROI block weights", "[video][isp_pipeline]")
+{
+    const int x_num = 4;
+    const int y_num = 2;
+    uint32_t weights[4 * 2];
+    const esp_ipa_region_t window = {.left = 0, .top = 0, .width = 400, .height = 300};
+    /* Top right block only, it is not on the diagonal, so transposed weights are detected */
+    const esp_video_isp_roi_t roi = {
+        .region = {.left = 300, .top = 0, .width = 100, .height = 150},
+        .weight = 3,
+    };
+
+    esp_video_isp_roi_calc_weights(&window, &roi, 1, x_num, y_num, weights);
+
+    for (int x = 0; x < x_num; x++) {
+        for (int y = 0; y < y_num; y++) {
+            /* Block weight is 1 + ROI weight in Q8 */
+            uint32_t expected = (x == 3 && y == 0) ? (1 + roi.weight) * 256 : 256;
+
+            TEST_ASSERT_EQUAL_UINT32(expected, weights[x * y_num + y]);
+        }
+    }
+
+    /* Half of the block is covered by ROI */
+    const esp_video_isp_roi_t half_roi = {
+        .region = {.left = 350, .top = 150, .width = 50, .height = 150},
+        .weight = 2,
+    };
+
+    esp_video_isp_roi_calc_weights(&window, &half_roi, 1, x_num, y_num, weights);
+    TEST_ASSERT_EQUAL_UINT32(2 * 256, weights[3 * y_num + 1]);
+    TEST_ASSERT_EQUAL_UINT32(256, weights[3 * y_num + 0]);
+}
+
+TEST_CASE("ISP pipeline get denoise level", "[video][isp_pipeline]")
+{
+    uint8_t level;
+    esp_err_t ret;
+
+    setUp();
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_STATE, esp_video_isp_pipeline_get_denoise_level(&level));
+
+    TEST_ESP_OK(example_video_init());
+    TEST_ASSERT_TRUE(esp_video_isp_pipeline_is_initialized());
+
+    /* BF is enabled only when IPA has auto denoising algorithm */
+    ret = esp_video_isp_pipeline_get_denoise_level(&level);
+    TEST_ASSERT_TRUE(ret == ESP_OK || ret == ESP_ERR_NOT_FOUND);
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_get_denoise_level(NULL));
+
+    TEST_ESP_OK(example_video_deinit());
+}
+
+#if CONFIG_ESP_VIDEO_ISP_PIPELINE_CONTROLLER_BRACKETING
+TEST_CASE("ISP pipeline set bracketing", "[video][isp_pipeline]")
+{
+    struct timeval timestamp = {0};
+    esp_video_isp_frame_info_t info;
+    esp_video_isp_bracketing_config_t config = {
+        .num = 3,
+        .exposure_ratio = {25, 100, 400},
+    };
+
+    setUp();
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_STATE, esp_video_isp_pipeline_set_bracketing(&config));
+    TEST_ESP_ERR(ESP_ERR_INVALID_STATE, esp_video_isp_pipeline_get_frame_info(&timestamp, &info));
+
+    TEST_ESP_OK(example_video_init());
+    TEST_ASSERT_TRUE(esp_video_isp_pipeline_is_initialized());
+
+    /* No frame is captured before stream on */
+    TEST_ESP_ERR(ESP_ERR_NOT_FOUND, esp_video_isp_pipeline_get_frame_info(&timestamp, &info));
+    TEST_ESP_OK(esp_video_isp_pipeline_set_bracketing(NULL));
+
+    /* Invalid arguments */
+    config.num = ESP_VIDEO_ISP_BRACKETING_MAX_NUM + 1;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_set_bracketing(&config));
+
+    config.num = 2;
+    config.exposure_ratio[1] = 400;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_set_bracketing(&config));
+
+    config.exposure_ratio[0] = 0;
+    config.exposure_ratio[1] = 100;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_set_bracketing(&config));
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_get_frame_info(NULL, &info));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_isp_pipeline_get_frame_info(&timestamp, NULL));
+
+    TEST_ESP_OK(example_video_deinit());
+}
+#endif
 #endif /* CONFIG_ESP_VIDEO_ENABLE_ISP_PIPELINE_CONTROLLER && CONFIG_ESP_VIDEO_ENABLE_MIPI_CSI_VIDEO_DEVICE */
@@ -0,0 +1,279 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "esp_heap_caps.h"
+#include "esp_video_init.h"
+#include "esp_video_device.h"
+#include "esp_video_ioctl.h"
+#include "esp_video_jpeg_engine.h"
+
+#define TEST_JPEG_DEC_WIDTH         128
+#define TEST_JPEG_DEC_HEIGHT        128
+#define TEST_JPEG_DEC_QUALITY       90
+
+/* JPEG is lossy, and PPA interpolates pixels at the edges of quadrants */
+#define TEST_JPEG_DEC_COLOR_DIFF    48
+
+/* Colors of the top-left, top-right, bottom-left and bottom-right quadrants in RGB565 */
+static const uint16_t s_quadrant_color[4] = {
+    0xf800,
+    0x07e0,
+    0x001f,
+    0xffff,
+};
+
+static void jpeg_dec_fill_quadrants(uint16_t *buf)
+{
+    for (int y = 0; y < TEST_JPEG_DEC_HEIGHT; y++) {
+        for (int x = 0; x < TEST_JPEG_DEC_WIDTH; x++) {
+            int quadrant = (y >= TEST_JPEG_DEC_HEIGHT / 2) * 2 + (x >= TEST_JPEG_DEC_WIDTH / 2);
+
+            buf[y * TEST_JPEG_DEC_WIDTH + x] = s_quadrant_color[quadrant];
+        }
+    }
+}
+
+static void jpeg_dec_check_color(uint16_t pixel, uint16_t color)
+{
+    int r = (pixel >> 11) << 3;
+    int g = ((pixel >> 5) & 0x3f) << 2;
+    int b = (pixel & 0x1f) << 3;
+
+    TEST_ASSERT_INT_WITHIN(TEST_JPEG_DEC_COLOR_DIFF, (color >> 11) << 3, r);
+    TEST_ASSERT_INT_WITHIN(TEST_JPEG_DEC_COLOR_DIFF, ((color >> 5) & 0x3f) << 2, g);
+    TEST_ASSERT_INT_WITHIN(TEST_JPEG_DEC_COLOR_DIFF, (color & 0x1f) << 3, b);
+}
+
+static uint8_t *jpeg_dec_encode_image(uint32_t *jpeg_size)
+{
+    size_t src_size;
+    size_t jpeg_buf_size;
+    esp_video_jpeg_engine_client_handle_t client;
+    esp_video_jpeg_engine_client_config_t client_config = {
+        .priority = ESP_VIDEO_JPEG_ENGINE_PRIORITY_DEFAULT,
+    };
+    jpeg_encode_memory_alloc_cfg_t src_mem_cfg = {
+        .buffer_direction = JPEG_ENC_ALLOC_INPUT_BUFFER,
+    };
+    jpeg_encode_memory_alloc_cfg_t jpeg_mem_cfg = {
+        .buffer_direction = JPEG_ENC_ALLOC_OUTPUT_BUFFER,
+    };
+    jpeg_encode_cfg_t enc_config = {
+        .src_type = JPEG_ENCODE_IN_FORMAT_RGB565,
+        .sub_sample = JPEG_DOWN_SAMPLING_YUV420,
+        .image_quality = TEST_JPEG_DEC_QUALITY,
+        .width = TEST_JPEG_DEC_WIDTH,
+        .height = TEST_JPEG_DEC_HEIGHT,
+    };
+
+    uint16_t *src = jpeg_alloc_encoder_mem(TEST_JPEG_DEC_WIDTH * TEST_JPEG_DEC_HEIGHT * 2, &src_mem_cfg, &src_size);
+    TEST_ASSERT_NOT_NULL(src);
+    uint8_t *jpeg_buf = jpeg_alloc_encoder_mem(TEST_JPEG_DEC_WIDTH * TEST_JPEG_DEC_HEIGHT * 2, &jpeg_mem_cfg, &jpeg_buf_size);
+    TEST_ASSERT_NOT_NULL(jpeg_buf);
+
+    jpeg_dec_fill_quadrants(src);
+
+    TEST_ESP_OK(esp_video_jpeg_engine_client_create(&client_config, &client));
+    TEST_ESP_OK(esp_video_jpeg_engine_encode(client, &enc_config, (uint8_t *)src, src_size,
+                                             jpeg_buf, jpeg_buf_size, jpeg_size));
+    TEST_ESP_OK(esp_video_jpeg_engine_client_delete(client));
+
+    heap_caps_free(src);
+
+    return jpeg_buf;
+}
+
+/**
+ * Decode the JPEG image into a capture image of the given size and crop rectangle,
+ * return the decoded image or NULL if the decoder video device fails to start.
+ */
+static uint16_t *jpeg_dec_decode_image(int fd, uint8_t *jpeg_buf, uint32_t jpeg_size, uint32_t pixelformat,
+                                       uint32_t width, uint32_t height, const struct v4l2_rect *crop)
+{
+    int type;
+    int ret;
+    struct v4l2_format format;
+    struct v4l2_requestbuffers req;
+    struct v4l2_buffer buf;
+    struct v4l2_selection selection;
+    uint32_t size = width * height * 3;
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    format.fmt.pix.width = TEST_JPEG_DEC_WIDTH;
+    format.fmt.pix.height = TEST_JPEG_DEC_HEIGHT;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_JPEG;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_S_FMT, &format));
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = width;
+    format.fmt.pix.height = height;
+    format.fmt.pix.pixelformat = pixelformat;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_S_FMT, &format));
+
+    memset(&selection, 0, sizeof(selection));
+    selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    selection.target = V4L2_SEL_TGT_CROP;
+    if (crop) {
+        selection.r = *crop;
+    } else {
+        selection.r.width = TEST_JPEG_DEC_WIDTH;
+        selection.r.height = TEST_JPEG_DEC_HEIGHT;
+    }
+    TEST_ESP_OK(ioctl(fd, VIDIOC_S_SELECTION, &selection));
+
+    memset(&req, 0, sizeof(req));
+    req.count = 1;
+    req.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = V4L2_MEMORY_USERPTR;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_REQBUFS, &req));
+
+    memset(&req, 0, sizeof(req));
+    req.count = 1;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_USERPTR;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_REQBUFS, &req));
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_USERPTR;
+    buf.index = 0;
+    buf.length = jpeg_size;
+    buf.m.userptr = (unsigned long)jpeg_buf;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+
+    uint16_t *image = heap_caps_malloc(size, MALLOC_CAP_CACHE_ALIGNED | MALLOC_CAP_SPIRAM);
+    TEST_ASSERT_NOT_NULL(image);
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_USERPTR;
+    buf.index = 0;
+    buf.length = size;
+    buf.m.userptr = (unsigned long)image;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+
+    type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMON, &type));
+
+    type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMON, &type);
+    if (ret == 0) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_USERPTR;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+        if (pixelformat == V4L2_PIX_FMT_RGB565) {
+            TEST_ASSERT_EQUAL_UINT32(width * height * 2, buf.bytesused);
+        }
+
+        TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMOFF, &type));
+    } else {
+        heap_caps_free(image);
+        image = NULL;
+    }
+
+    type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMOFF, &type));
+
+    return image;
+}
+
+TEST_CASE("JPEG decoder video device scaled and cropped decoding", "[video][jpeg]")
+{
+    int fd;
+    uint32_t jpeg_size;
+    uint16_t *image;
+    struct v4l2_selection selection;
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_JPEG_DEC));
+
+    uint8_t *jpeg_buf = jpeg_dec_encode_image(&jpeg_size);
+
+    fd = open(ESP_VIDEO_JPEG_DEC_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    /* 1/2 scaled image keeps quadrants */
+    image = jpeg_dec_decode_image(fd, jpeg_buf, jpeg_size, V4L2_PIX_FMT_RGB565,
+                                  TEST_JPEG_DEC_WIDTH / 2, TEST_JPEG_DEC_HEIGHT / 2, NULL);
+    TEST_ASSERT_NOT_NULL(image);
+    for (int i = 0; i < 4; i++) {
+        int x = (i % 2) * TEST_JPEG_DEC_WIDTH / 4 + TEST_JPEG_DEC_WIDTH / 8;
+        int y = (i / 2) * TEST_JPEG_DEC_HEIGHT / 4 + TEST_JPEG_DEC_HEIGHT / 8;
+
+        jpeg_dec_check_color(image[y * TEST_JPEG_DEC_WIDTH / 2 + x], s_quadrant_color[i]);
+    }
+    heap_caps_free(image);
+
+    /* Bottom-left quadrant is cropped without scaling */
+    struct v4l2_rect crop = {
+        .left = 0,
+        .top = TEST_JPEG_DEC_HEIGHT / 2,
+        .width = TEST_JPEG_DEC_WIDTH / 2,
+        .height = TEST_JPEG_DEC_HEIGHT / 2,
+    };
+    image = jpeg_dec_decode_image(fd, jpeg_buf, jpeg_size, V4L2_PIX_FMT_RGB565,
+                                  crop.width, crop.height, &crop);
+    TEST_ASSERT_NOT_NULL(image);
+    jpeg_dec_check_color(image[0], s_quadrant_color[2]);
+    jpeg_dec_check_color(image[crop.width * crop.height / 2 + crop.width / 2], s_quadrant_color[2]);
+    jpeg_dec_check_color(image[crop.width * crop.height - 1], s_quadrant_color[2]);
+    heap_caps_free(image);
+
+    memset(&selection, 0, sizeof(selection));
+    selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_G_SELECTION, &selection));
+    TEST_ASSERT_EQUAL_INT(0, memcmp(&crop, &selection.r, sizeof(crop)));
+
+    /* Right half is cropped and scaled to 1/2 */
+    crop = (struct v4l2_rect) {
+        .left = TEST_JPEG_DEC_WIDTH / 2,
+        .top = 0,
+        .width = TEST_JPEG_DEC_WIDTH / 2,
+        .height = TEST_JPEG_DEC_HEIGHT,
+    };
+    image = jpeg_dec_decode_image(fd, jpeg_buf, jpeg_size, V4L2_PIX_FMT_RGB565,
+                                  crop.width, crop.height / 2, &crop);
+    TEST_ASSERT_NOT_NULL(image);
+    jpeg_dec_check_color(image[crop.width * 8 + crop.width / 2], s_quadrant_color[1]);
+    jpeg_dec_check_color(image[crop.width * (crop.height / 2 - 8) + crop.width / 2], s_quadrant_color[3]);
+    heap_caps_free(image);
+
+    /* Scaling ratio must be exact in 1/16 */
+    image = jpeg_dec_decode_image(fd, jpeg_buf, jpeg_size, V4L2_PIX_FMT_RGB565, 100, 100, NULL);
+    TEST_ASSERT_NULL(image);
+
+    /* PPA can't scale GREY */
+    image = jpeg_dec_decode_image(fd, jpeg_buf, jpeg_size, V4L2_PIX_FMT_GREY,
+                                  TEST_JPEG_DEC_WIDTH / 2, TEST_JPEG_DEC_HEIGHT / 2, NULL);
+    TEST_ASSERT_NULL(image);
+
+    /* Crop rectangle must be in JPEG image */
+    memset(&selection, 0, sizeof(selection));
+    selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    selection.target = V4L2_SEL_TGT_CROP;
+    selection.r.left = TEST_JPEG_DEC_WIDTH / 2;
+    selection.r.width = TEST_JPEG_DEC_WIDTH;
+    selection.r.height = TEST_JPEG_DEC_HEIGHT;
+    TEST_ASSERT_EQUAL_INT(-1, ioctl(fd, VIDIOC_S_SELECTION, &selection));
+
+    TEST_ESP_OK(close(fd));
+    heap_caps_free(jpeg_buf);
+
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_JPEG_DEC));
+}
@@ -0,0 +1,473 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+#include "esp_video_init.h"
+#include "esp_video_device.h"
+#include "esp_video_ioctl.h"
+#include "esp_video_jpeg_engine.h"
+
+#define TEST_JPEG_ENC_WIDTH         128
+#define TEST_JPEG_ENC_HEIGHT        128
+#define TEST_JPEG_ENC_BUFFER_NUM    2
+#define TEST_JPEG_ENC_FRAMES        8
+#define TEST_JPEG_ENC_RAW_SIZE      (TEST_JPEG_ENC_WIDTH * TEST_JPEG_ENC_HEIGHT)
+
+#define TEST_JPEG_ENC_TARGET_SIZE   4096
+#define TEST_JPEG_ENC_CHUNK_SIZE    1024
+
+static int jpeg_enc_set_ext_ctrl(int fd, uint32_t id, int32_t value)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl;
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    memset(&ctrl, 0, sizeof(ctrl));
+    ctrls.ctrl_class = V4L2_CTRL_CLASS_JPEG;
+    ctrls.count = 1;
+    ctrls.controls = &ctrl;
+    ctrl.id = id;
+    ctrl.value = value;
+
+    return ioctl(fd, VIDIOC_S_EXT_CTRLS, &ctrls);
+}
+
+static int jpeg_enc_get_ext_ctrl(int fd, uint32_t id, int32_t *value)
+{
+    struct v4l2_ext_controls ctrls;
+    struct v4l2_ext_control ctrl;
+
+    memset(&ctrls, 0, sizeof(ctrls));
+    memset(&ctrl, 0, sizeof(ctrl));
+    ctrls.ctrl_class = V4L2_CTRL_CLASS_JPEG;
+    ctrls.count = 1;
+    ctrls.controls = &ctrl;
+    ctrl.id = id;
+
+    int ret = ioctl(fd, VIDIOC_G_EXT_CTRLS, &ctrls);
+    if (ret == 0 && value) {
+        *value = ctrl.value;
+    }
+
+    return ret;
+}
+
+/* Noise is hard to compress, so frame size is sensitive to quality */
+static void jpeg_enc_fill_frame(uint8_t *buf, uint32_t size)
+{
+    uint32_t seed = 0x12345678;
+
+    for (uint32_t i = 0; i < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        buf[i] = seed >> 16;
+    }
+}
+
+static void jpeg_enc_setup_m2m_stream(int fd, uint32_t sizeimage, uint8_t **cap_buf)
+{
+    int val;
+    struct v4l2_format format;
+    struct v4l2_requestbuffers req;
+    struct v4l2_buffer buf;
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    format.fmt.pix.width = TEST_JPEG_ENC_WIDTH;
+    format.fmt.pix.height = TEST_JPEG_ENC_HEIGHT;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB565;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_S_FMT, &format));
+
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count = TEST_JPEG_ENC_BUFFER_NUM;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_REQBUFS, &req));
+
+    for (int i = 0; i < TEST_JPEG_ENC_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QUERYBUF, &buf));
+
+        uint8_t *mapped = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+        TEST_ASSERT_NOT_NULL(mapped);
+        jpeg_enc_fill_frame(mapped, buf.length);
+
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    format.fmt.pix.width = TEST_JPEG_ENC_WIDTH;
+    format.fmt.pix.height = TEST_JPEG_ENC_HEIGHT;
+    format.fmt.pix.pixelformat = V4L2_PIX_FMT_JPEG;
+    format.fmt.pix.sizeimage = sizeimage;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_S_FMT, &format));
+
+    memset(&req, 0, sizeof(req));
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count = TEST_JPEG_ENC_BUFFER_NUM;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_REQBUFS, &req));
+
+    for (int i = 0; i < TEST_JPEG_ENC_BUFFER_NUM; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QUERYBUF, &buf));
+        if (sizeimage) {
+            TEST_ASSERT_EQUAL_UINT32(sizeimage, buf.length);
+        }
+
+        cap_buf[i] = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+        TEST_ASSERT_NOT_NULL(cap_buf[i]);
+
+        TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMON, &val));
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMON, &val));
+}
+
+static void jpeg_enc_stop_m2m_stream(int fd)
+{
+    int val;
+
+    val = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMOFF, &val));
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_STREAMOFF, &val));
+}
+
+static void jpeg_enc_requeue_output(int fd)
+{
+    struct v4l2_buffer buf;
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_OUTPUT;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+    TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+}
+
+static uint32_t jpeg_enc_encode_frame(int fd, uint8_t **cap_buf)
+{
+    uint32_t size;
+    struct v4l2_buffer buf;
+
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+    TEST_ASSERT_EQUAL_HEX8(0xff, cap_buf[buf.index][0]);
+    TEST_ASSERT_EQUAL_HEX8(0xd8, cap_buf[buf.index][1]);
+    size = buf.bytesused;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+
+    jpeg_enc_requeue_output(fd);
+
+    return size;
+}
+
+TEST_CASE("JPEG encoder video device target frame size", "[video][jpeg]")
+{
+    int fd;
+    int32_t value;
+    uint32_t size;
+    uint32_t full_size;
+    uint8_t *cap_buf[TEST_JPEG_ENC_BUFFER_NUM];
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+
+    fd = open(ESP_VIDEO_JPEG_ENC_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    TEST_ESP_OK(jpeg_enc_get_ext_ctrl(fd, V4L2_CID_JPEG_ESP_TARGET_SIZE, &value));
+    TEST_ASSERT_EQUAL_INT32(0, value);
+    TEST_ASSERT_EQUAL_INT(-1, jpeg_enc_set_ext_ctrl(fd, V4L2_CID_JPEG_ESP_TARGET_SIZE, -1));
+
+    jpeg_enc_setup_m2m_stream(fd, TEST_JPEG_ENC_RAW_SIZE, cap_buf);
+
+    full_size = jpeg_enc_encode_frame(fd, cap_buf);
+    TEST_ASSERT_GREATER_THAN_UINT32(TEST_JPEG_ENC_TARGET_SIZE * 2, full_size);
+
+    /* Target size can be changed while streaming, quality is adjusted from the next frame */
+    TEST_ESP_OK(jpeg_enc_set_ext_ctrl(fd, V4L2_CID_JPEG_ESP_TARGET_SIZE, TEST_JPEG_ENC_TARGET_SIZE));
+    for (int i = 0; i < TEST_JPEG_ENC_FRAMES; i++) {
+        size = jpeg_enc_encode_frame(fd, cap_buf);
+        TEST_ASSERT_LESS_THAN_UINT32(full_size, size);
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_JPEG_ENC_TARGET_SIZE * 2, size);
+
+    /* Quality of the last frame is lower than the configured quality ceiling */
+    TEST_ESP_OK(jpeg_enc_get_ext_ctrl(fd, V4L2_CID_JPEG_COMPRESSION_QUALITY, &value));
+    TEST_ASSERT_LESS_THAN_INT32(80, value);
+
+    TEST_ESP_OK(jpeg_enc_set_ext_ctrl(fd, V4L2_CID_JPEG_ESP_TARGET_SIZE, 0));
+    TEST_ESP_OK(jpeg_enc_get_ext_ctrl(fd, V4L2_CID_JPEG_COMPRESSION_QUALITY, &value));
+    TEST_ASSERT_EQUAL_INT32(80, value);
+    TEST_ASSERT_EQUAL_UINT32(full_size, jpeg_enc_encode_frame(fd, cap_buf));
+
+    jpeg_enc_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+}
+
+#if CONFIG_ESP_VIDEO_ENABLE_JPEG_CHUNK_OUTPUT
+TEST_CASE("JPEG encoder video device chunk output", "[video][jpeg]")
+{
+    int fd;
+    int32_t value;
+    uint32_t full_size;
+    uint8_t *cap_buf[TEST_JPEG_ENC_BUFFER_NUM];
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+
+    fd = open(ESP_VIDEO_JPEG_ENC_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    /* Size of the whole frame is the reference of chunks */
+    jpeg_enc_setup_m2m_stream(fd, TEST_JPEG_ENC_RAW_SIZE, cap_buf);
+    full_size = jpeg_enc_encode_frame(fd, cap_buf);
+    jpeg_enc_stop_m2m_stream(fd);
+    TEST_ASSERT_GREATER_THAN_UINT32(TEST_JPEG_ENC_CHUNK_SIZE, full_size);
+
+    TEST_ESP_OK(jpeg_enc_set_ext_ctrl(fd, V4L2_CID_JPEG_ESP_CHUNK_OUTPUT, 1));
+    TEST_ESP_OK(jpeg_enc_get_ext_ctrl(fd, V4L2_CID_JPEG_ESP_CHUNK_OUTPUT, &value));
+    TEST_ASSERT_EQUAL_INT32(1, value);
+
+    jpeg_enc_setup_m2m_stream(fd, TEST_JPEG_ENC_CHUNK_SIZE, cap_buf);
+    TEST_ASSERT_EQUAL_INT(-1, jpeg_enc_set_ext_ctrl(fd, V4L2_CID_JPEG_ESP_CHUNK_OUTPUT, 0));
+
+    for (int i = 0; i < 2; i++) {
+        int chunks = 0;
+        uint32_t size = 0;
+        struct v4l2_buffer buf;
+
+        do {
+            memset(&buf, 0, sizeof(buf));
+            buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buf.memory = V4L2_MEMORY_MMAP;
+            TEST_ESP_OK(ioctl(fd, VIDIOC_DQBUF, &buf));
+            TEST_ASSERT_GREATER_THAN_UINT32(0, buf.bytesused);
+            TEST_ASSERT_LESS_OR_EQUAL_UINT32(TEST_JPEG_ENC_CHUNK_SIZE, buf.bytesused);
+
+            /* Only the first chunk starts with SOI marker */
+            if (!chunks) {
+                TEST_ASSERT_EQUAL_HEX8(0xff, cap_buf[buf.index][0]);
+                TEST_ASSERT_EQUAL_HEX8(0xd8, cap_buf[buf.index][1]);
+            }
+            if (buf.flags & V4L2_BUF_FLAG_ESP_FRAME_END) {
+                TEST_ASSERT_EQUAL_HEX8(0xff, cap_buf[buf.index][buf.bytesused - 2]);
+                TEST_ASSERT_EQUAL_HEX8(0xd9, cap_buf[buf.index][buf.bytesused - 1]);
+            } else {
+                TEST_ASSERT_EQUAL_UINT32(TEST_JPEG_ENC_CHUNK_SIZE, buf.bytesused);
+            }
+
+            size += buf.bytesused;
+            chunks++;
+            TEST_ESP_OK(ioctl(fd, VIDIOC_QBUF, &buf));
+        } while (!(buf.flags & V4L2_BUF_FLAG_ESP_FRAME_END));
+
+        TEST_ASSERT_EQUAL_UINT32(full_size, size);
+        TEST_ASSERT_EQUAL_INT((full_size + TEST_JPEG_ENC_CHUNK_SIZE - 1) / TEST_JPEG_ENC_CHUNK_SIZE, chunks);
+
+        jpeg_enc_requeue_output(fd);
+    }
+
+    jpeg_enc_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+}
+#endif
+
+#if CONFIG_ESP_VIDEO_ENABLE_COMPRESSED_BUFFER_ESTIMATION
+TEST_CASE("JPEG encoder video device estimated buffer size", "[video][jpeg]")
+{
+    int fd;
+    int32_t value;
+    uint32_t size;
+    uint32_t full_size;
+    struct v4l2_format format;
+    uint8_t *cap_buf[TEST_JPEG_ENC_BUFFER_NUM];
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+
+    fd = open(ESP_VIDEO_JPEG_ENC_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    /* Noise frame is the reference of the worst case */
+    jpeg_enc_setup_m2m_stream(fd, TEST_JPEG_ENC_RAW_SIZE, cap_buf);
+    full_size = jpeg_enc_encode_frame(fd, cap_buf);
+    jpeg_enc_stop_m2m_stream(fd);
+
+    TEST_ESP_OK(jpeg_enc_get_ext_ctrl(fd, V4L2_CID_JPEG_ESP_OVERFLOW_FRAMES, &value));
+    TEST_ASSERT_EQUAL_INT32(0, value);
+    TEST_ASSERT_EQUAL_INT(-1, jpeg_enc_set_ext_ctrl(fd, V4L2_CID_JPEG_ESP_OVERFLOW_FRAMES, 0));
+
+    jpeg_enc_setup_m2m_stream(fd, 0, cap_buf);
+
+    /* Estimated size is reported by G_FMT */
+    memset(&format, 0, sizeof(format));
+    format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_G_FMT, &format));
+    TEST_ASSERT_GREATER_THAN_UINT32(0, format.fmt.pix.sizeimage);
+    TEST_ASSERT_LESS_THAN_UINT32(TEST_JPEG_ENC_RAW_SIZE, format.fmt.pix.sizeimage);
+    TEST_ASSERT_LESS_THAN_UINT32(full_size, format.fmt.pix.sizeimage);
+
+    /* Frames larger than the estimated size are encoded again instead of being truncated */
+    for (int i = 0; i < TEST_JPEG_ENC_FRAMES; i++) {
+        size = jpeg_enc_encode_frame(fd, cap_buf);
+        TEST_ASSERT_LESS_THAN_UINT32(format.fmt.pix.sizeimage, size);
+    }
+
+    TEST_ESP_OK(jpeg_enc_get_ext_ctrl(fd, V4L2_CID_JPEG_ESP_OVERFLOW_FRAMES, &value));
+    TEST_ASSERT_EQUAL_INT32(TEST_JPEG_ENC_FRAMES, value);
+
+    /* Quality of frames which fit the buffer is not changed */
+    TEST_ESP_OK(jpeg_enc_get_ext_ctrl(fd, V4L2_CID_JPEG_COMPRESSION_QUALITY, &value));
+    TEST_ASSERT_EQUAL_INT32(80, value);
+
+    jpeg_enc_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+}
+#endif
+
+typedef struct {
+    esp_video_jpeg_engine_client_handle_t client;
+    SemaphoreHandle_t done;
+    uint32_t frames;
+    uint32_t errors;
+} jpeg_engine_test_task_t;
+
+static void jpeg_engine_test_task(void *arg)
+{
+    uint8_t *src;
+    uint8_t *dst;
+    size_t src_size;
+    size_t dst_size;
+    uint32_t out_size;
+    jpeg_engine_test_task_t *task = (jpeg_engine_test_task_t *)arg;
+    jpeg_encode_memory_alloc_cfg_t src_mem_cfg = {
+        .buffer_direction = JPEG_ENC_ALLOC_INPUT_BUFFER,
+    };
+    jpeg_encode_memory_alloc_cfg_t dst_mem_cfg = {
+        .buffer_direction = JPEG_ENC_ALLOC_OUTPUT_BUFFER,
+    };
+    jpeg_encode_cfg_t enc_cfg = {
+        .src_type = JPEG_ENCODE_IN_FORMAT_RGB565,
+        .sub_sample = JPEG_DOWN_SAMPLING_YUV422,
+        .image_quality = 80,
+        .width = TEST_JPEG_ENC_WIDTH,
+        .height = TEST_JPEG_ENC_HEIGHT,
+    };
+
+    src = jpeg_alloc_encoder_mem(TEST_JPEG_ENC_WIDTH * TEST_JPEG_ENC_HEIGHT * 2, &src_mem_cfg, &src_size);
+    dst = jpeg_alloc_encoder_mem(TEST_JPEG_ENC_WIDTH * TEST_JPEG_ENC_HEIGHT * 2, &dst_mem_cfg, &dst_size);
+    if (src && dst) {
+        jpeg_enc_fill_frame(src, src_size);
+        for (int i = 0; i < TEST_JPEG_ENC_FRAMES * 4; i++) {
+            if (esp_video_jpeg_engine_encode(task->client, &enc_cfg, src, src_size, dst, dst_size, &out_size) == ESP_OK &&
+                    dst[0] == 0xff && dst[1] == 0xd8) {
+                task->frames++;
+            } else {
+                task->errors++;
+            }
+        }
+    } else {
+        task->errors++;
+    }
+
+    free(src);
+    free(dst);
+    xSemaphoreGive(task->done);
+    vTaskDelete(NULL);
+}
+
+TEST_CASE("JPEG engine shared by video device and application", "[video][jpeg]")
+{
+    int fd;
+    int32_t value;
+    esp_video_jpeg_engine_stats_t stats;
+    uint8_t *cap_buf[TEST_JPEG_ENC_BUFFER_NUM];
+    jpeg_engine_test_task_t tasks[2];
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+
+    fd = open(ESP_VIDEO_JPEG_ENC_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    TEST_ESP_OK(jpeg_enc_get_ext_ctrl(fd, V4L2_CID_JPEG_ESP_ENGINE_PRIORITY, &value));
+    TEST_ASSERT_EQUAL_INT32(ESP_VIDEO_JPEG_ENGINE_PRIORITY_DEFAULT, value);
+    TEST_ASSERT_EQUAL_INT(-1, jpeg_enc_set_ext_ctrl(fd, V4L2_CID_JPEG_ESP_ENGINE_PRIORITY, ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX + 1));
+    TEST_ESP_OK(jpeg_enc_set_ext_ctrl(fd, V4L2_CID_JPEG_ESP_ENGINE_PRIORITY, ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX));
+
+    jpeg_enc_setup_m2m_stream(fd, TEST_JPEG_ENC_RAW_SIZE, cap_buf);
+
+    /* A highest priority stream must not starve the lowest priority client, e.g. snapshot */
+    memset(tasks, 0, sizeof(tasks));
+    for (int i = 0; i < 2; i++) {
+        esp_video_jpeg_engine_client_config_t client_cfg = {
+            .priority = i ? 0 : ESP_VIDEO_JPEG_ENGINE_PRIORITY_DEFAULT,
+        };
+
+        TEST_ESP_OK(esp_video_jpeg_engine_client_create(&client_cfg, &tasks[i].client));
+        tasks[i].done = xSemaphoreCreateBinary();
+        TEST_ASSERT_NOT_NULL(tasks[i].done);
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(jpeg_engine_test_task, "jpeg_engine_test", 4096, &tasks[i], 5, NULL));
+    }
+
+    for (int i = 0; i < TEST_JPEG_ENC_FRAMES * 4; i++) {
+        jpeg_enc_encode_frame(fd, cap_buf);
+    }
+
+    for (int i = 0; i < 2; i++) {
+        TEST_ASSERT_TRUE(xSemaphoreTake(tasks[i].done, pdMS_TO_TICKS(10000)));
+        TEST_ASSERT_EQUAL_UINT32(TEST_JPEG_ENC_FRAMES * 4, tasks[i].frames);
+        TEST_ASSERT_EQUAL_UINT32(0, tasks[i].errors);
+    }
+
+    TEST_ESP_OK(esp_video_jpeg_engine_get_stats(&stats));
+    TEST_ASSERT_EQUAL_UINT32(TEST_JPEG_ENC_FRAMES * 4 * 3, stats.jobs);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32((ESP_VIDEO_JPEG_ENGINE_PRIORITY_MAX + 1) * 2, stats.max_wait_jobs);
+
+    for (int i = 0; i < 2; i++) {
+        TEST_ESP_OK(esp_video_jpeg_engine_client_delete(tasks[i].client));
+        vSemaphoreDelete(tasks[i].done);
+    }
+
+    jpeg_enc_stop_m2m_stream(fd);
+    close(fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(ESP_VIDEO_INIT_FLAGS_JPEG_ENC));
+}
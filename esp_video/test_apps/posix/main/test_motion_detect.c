@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "sdkconfig.h"
+#include "esp_video_motion.h"
+
+#define TEST_MOTION_GRID_W      5
+#define TEST_MOTION_GRID_H      5
+#define TEST_MOTION_CELLS       (TEST_MOTION_GRID_W * TEST_MOTION_GRID_H)
+#define TEST_MOTION_HOLD        10
+
+static const esp_video_motion_config_t s_default_config = {
+    .grid_width = TEST_MOTION_GRID_W,
+    .grid_height = TEST_MOTION_GRID_H,
+    .threshold = 51,
+    .min_cells = 1,
+    .trigger_frames = 2,
+    .hold_frames = TEST_MOTION_HOLD,
+    .scene_change_percent = 60,
+};
+
+/* Textured scene, luminance of cells is different from each other */
+static void test_motion_scene(uint32_t *luma, uint32_t gain_percent)
+{
+    for (int i = 0; i < TEST_MOTION_CELLS; i++) {
+        luma[i] = (60 + (i * 37) % 120) * gain_percent / 100;
+    }
+}
+
+static void test_motion_chroma(esp_video_motion_chroma_t *chroma, uint32_t r, uint32_t b)
+{
+    for (int i = 0; i < TEST_MOTION_CELLS; i++) {
+        chroma[i].counted = 1000;
+        chroma[i].sum_g = 1000 * 100;
+        chroma[i].sum_r = 1000 * r;
+        chroma[i].sum_b = 1000 * b;
+    }
+}
+
+TEST_CASE("Motion detection ignores static scene and global brightness change", "[motion]")
+{
+    esp_video_motion_t motion;
+    esp_video_motion_result_t result;
+    uint32_t luma[TEST_MOTION_CELLS];
+    esp_video_motion_chroma_t chroma[TEST_MOTION_CELLS];
+    const uint32_t gain[] = {100, 100, 110, 125, 140, 150, 140, 120, 100, 85, 70};
+
+    esp_video_motion_init(&motion, &s_default_config);
+    test_motion_chroma(chroma, 80, 70);
+
+    for (int i = 0; i < sizeof(gain) / sizeof(gain[0]); i++) {
+        test_motion_scene(luma, gain[i]);
+        TEST_ASSERT_EQUAL(ESP_VIDEO_MOTION_EVENT_NONE, esp_video_motion_process(&motion, luma, chroma, &result));
+        TEST_ASSERT_EQUAL_HEX32(0, result.map);
+        TEST_ASSERT_FALSE(result.scene_change);
+    }
+}
+
+TEST_CASE("Motion detection reports changed cells and stops after hold frames", "[motion]")
+{
+    esp_video_motion_t motion;
+    esp_video_motion_result_t result;
+    uint32_t luma[TEST_MOTION_CELLS];
+    esp_video_motion_chroma_t chroma[TEST_MOTION_CELLS];
+    const int cell = 2 * TEST_MOTION_GRID_W + 3;
+    int start_frame = -1;
+    int stop_frame = -1;
+
+    esp_video_motion_init(&motion, &s_default_config);
+    test_motion_chroma(chroma, 80, 70);
+    test_motion_scene(luma, 100);
+    esp_video_motion_process(&motion, luma, chroma, &result);
+
+    /* An object passes cell (3, 2) and its right neighbor for 5 frames */
+    for (int frame = 0; frame < 5 + TEST_MOTION_HOLD + 5; frame++) {
+        esp_video_motion_event_t event;
+
+        test_motion_scene(luma, 100);
+        if (frame < 5) {
+            luma[cell] = 230;
+            luma[cell + 1] = 10;
+        }
+
+        event = esp_video_motion_process(&motion, luma, chroma, &result);
+        if (event == ESP_VIDEO_MOTION_EVENT_START) {
+            TEST_ASSERT_EQUAL_INT(-1, start_frame);
+            TEST_ASSERT_EQUAL_HEX32((1u << cell) | (1u << (cell + 1)), result.map);
+            TEST_ASSERT_FALSE(result.scene_change);
+            start_frame = frame;
+        } else if (event == ESP_VIDEO_MOTION_EVENT_STOP) {
+            TEST_ASSERT_EQUAL_INT(-1, stop_frame);
+            TEST_ASSERT_EQUAL_HEX32((1u << cell) | (1u << (cell + 1)), result.map);
+            stop_frame = frame;
+        }
+    }
+
+    /* Second motion frame starts motion, the last one is followed by hold frames */
+    TEST_ASSERT_EQUAL_INT(1, start_frame);
+    TEST_ASSERT_EQUAL_INT(4 + TEST_MOTION_HOLD, stop_frame);
+}
+
+TEST_CASE("Motion detection reports color change of same luminance", "[motion]")
+{
+    esp_video_motion_t motion;
+    esp_video_motion_result_t result;
+    uint32_t luma[TEST_MOTION_CELLS];
+    esp_video_motion_chroma_t chroma[TEST_MOTION_CELLS];
+    esp_video_motion_event_t event = ESP_VIDEO_MOTION_EVENT_NONE;
+
+    esp_video_motion_init(&motion, &s_default_config);
+    test_motion_chroma(chroma, 80, 70);
+    test_motion_scene(luma, 100);
+    esp_video_motion_process(&motion, luma, chroma, &result);
+
+    for (int frame = 0; frame < 2; frame++) {
+        chroma[7].sum_r = 1000 * 140;
+        chroma[7].sum_b = 1000 * 40;
+        event = esp_video_motion_process(&motion, luma, chroma, &result);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_VIDEO_MOTION_EVENT_START, event);
+    TEST_ASSERT_EQUAL_HEX32(1u << 7, result.map);
+}
+
+TEST_CASE("Motion detection treats covered lens as scene change", "[motion]")
+{
+    esp_video_motion_t motion;
+    esp_video_motion_result_t result;
+    uint32_t luma[TEST_MOTION_CELLS];
+    esp_video_motion_event_t event;
+
+    esp_video_motion_init(&motion, &s_default_config);
+    test_motion_scene(luma, 100);
+    esp_video_motion_process(&motion, luma, NULL, &result);
+
+    memset(luma, 0, sizeof(luma));
+    event = esp_video_motion_process(&motion, luma, NULL, &result);
+    TEST_ASSERT_EQUAL(ESP_VIDEO_MOTION_EVENT_START, event);
+    TEST_ASSERT_TRUE(result.scene_change);
+
+    /* Background is learned again, the covered scene is still */
+    for (int frame = 0; frame < TEST_MOTION_HOLD; frame++) {
+        event = esp_video_motion_process(&motion, luma, NULL, &result);
+        if (event == ESP_VIDEO_MOTION_EVENT_NONE) {
+            TEST_ASSERT_EQUAL_HEX32(0, result.map);
+        }
+    }
+
+    TEST_ASSERT_EQUAL(ESP_VIDEO_MOTION_EVENT_STOP, event);
+}
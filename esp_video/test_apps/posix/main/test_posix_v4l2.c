@@ -364,6 +364,120 @@ TEST_CASE("V4L2 Video Buffer Sequence", "[video]")
     TEST_ESP_OK(example_video_deinit());
 }
 
+#if CONFIG_ESP_VIDEO_ENABLE_ZSL_RING
+TEST_CASE("V4L2 zero shutter lag frame ring", "[video]")
+{
+    int fd;
+    int ret;
+    int val;
+    struct v4l2_buffer buf;
+    struct v4l2_requestbuffers req;
+    struct v4l2_zsl_ring ring;
+    struct v4l2_zsl_frame frame;
+    struct timeval timestamp[6];
+    uint32_t sequence[6];
+    const int buffer_count = 2;
+    const int frame_count = 6;
+    const int ring_count = 3;
+
+    setUp();
+
+    TEST_ESP_OK(example_video_init());
+
+    fd = open(TEST_APP_VIDEO_DEVICE, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, fd);
+
+    /* Ring size depends on buffer size, so it can't be created before buffers */
+    memset(&ring, 0, sizeof(ring));
+    ring.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ring.count = ring_count;
+    TEST_ASSERT_NOT_EQUAL(0, ioctl(fd, VIDIOC_S_ZSL_RING, &ring));
+
+    memset(&req, 0, sizeof(req));
+    req.type   = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    req.count  = buffer_count;
+    ret = ioctl(fd, VIDIOC_REQBUFS, &req);
+    TEST_ESP_OK(ret);
+
+    ret = ioctl(fd, VIDIOC_S_ZSL_RING, &ring);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < buffer_count; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        ret = ioctl(fd, VIDIOC_QUERYBUF, &buf);
+        TEST_ESP_OK(ret);
+
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMON, &val);
+    TEST_ESP_OK(ret);
+
+    for (int i = 0; i < frame_count; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        ret = ioctl(fd, VIDIOC_DQBUF, &buf);
+        TEST_ESP_OK(ret);
+
+        timestamp[i] = buf.timestamp;
+        sequence[i] = buf.sequence;
+        if (i) {
+            TEST_ASSERT_GREATER_THAN_UINT32(sequence[i - 1], sequence[i]);
+        }
+
+        ret = ioctl(fd, VIDIOC_QBUF, &buf);
+        TEST_ESP_OK(ret);
+    }
+
+    val = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    ret = ioctl(fd, VIDIOC_STREAMOFF, &val);
+    TEST_ESP_OK(ret);
+
+    /* Trigger at the time of a frame in the ring returns that frame */
+    memset(&frame, 0, sizeof(frame));
+    frame.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    frame.timestamp = timestamp[frame_count - 2];
+    frame.buffer = heap_caps_malloc(buf.length, MALLOC_CAP_SPIRAM);
+    frame.length = buf.length;
+    TEST_ASSERT_NOT_NULL(frame.buffer);
+    ret = ioctl(fd, VIDIOC_G_ZSL_FRAME, &frame);
+    TEST_ESP_OK(ret);
+    TEST_ASSERT_EQUAL_UINT32(sequence[frame_count - 2], frame.sequence);
+    TEST_ASSERT_EQUAL_UINT32(buf.bytesused, frame.bytesused);
+
+    /* Trigger after the last frame returns the last frame */
+    frame.timestamp = timestamp[frame_count - 1];
+    frame.timestamp.tv_sec += 1;
+    ret = ioctl(fd, VIDIOC_G_ZSL_FRAME, &frame);
+    TEST_ESP_OK(ret);
+    TEST_ASSERT_EQUAL_UINT32(sequence[frame_count - 1], frame.sequence);
+
+    /* Trigger time is in the clock of frame timestamp */
+    int64_t now = esp_timer_get_time();
+    frame.timestamp.tv_sec = now / 1000000;
+    frame.timestamp.tv_usec = now % 1000000;
+    ret = ioctl(fd, VIDIOC_G_ZSL_FRAME, &frame);
+    TEST_ESP_OK(ret);
+    TEST_ASSERT_EQUAL_UINT32(sequence[frame_count - 1], frame.sequence);
+
+    /* Frames older than the ring are dropped */
+    frame.timestamp = timestamp[frame_count - ring_count - 1];
+    TEST_ASSERT_NOT_EQUAL(0, ioctl(fd, VIDIOC_G_ZSL_FRAME, &frame));
+
+    heap_caps_free(frame.buffer);
+    close(fd);
+
+    TEST_ESP_OK(example_video_deinit());
+}
+#endif /* CONFIG_ESP_VIDEO_ENABLE_ZSL_RING */
+
 #if CONFIG_ESP_VIDEO_ENABLE_JPEG_ENC_VIDEO_DEVICE
 TEST_CASE("V4L2 M2M device", "[video]")
 {
@@ -0,0 +1,193 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+#include "unity.h"
+#include "sdkconfig.h"
+#include "linux/videodev2.h"
+#include "esp_video_sw_stats.h"
+
+#define TEST_SW_STATS_WIDTH         640
+#define TEST_SW_STATS_HEIGHT        480
+/* Single core RISC-V targets at 160MHz are about 2 times slower than ESP32-P4 */
+#if CONFIG_IDF_TARGET_ESP32P4 || CONFIG_IDF_TARGET_ESP32S3
+#define TEST_SW_STATS_MAX_TIME_US   1000
+#else
+#define TEST_SW_STATS_MAX_TIME_US   2500
+#endif
+
+static const esp_video_sw_stats_config_t s_default_config = {
+    .width = TEST_SW_STATS_WIDTH,
+    .height = TEST_SW_STATS_HEIGHT,
+    .pixel_format = V4L2_PIX_FMT_YUYV,
+    .awb_min_luma = 16,
+    .awb_max_luma = 240,
+    .awb_max_chroma = 24,
+};
+
+static void fill_yuyv(uint8_t *buffer, uint8_t y, uint8_t u, uint8_t v)
+{
+    for (int i = 0; i < TEST_SW_STATS_WIDTH * TEST_SW_STATS_HEIGHT * 2; i += 4) {
+        buffer[i + 0] = y;
+        buffer[i + 1] = u;
+        buffer[i + 2] = y;
+        buffer[i + 3] = v;
+    }
+}
+
+TEST_CASE("Software statistics on uniform gray frame", "[video][sw_stats]")
+{
+    esp_video_sw_stats_t stats;
+    size_t size = TEST_SW_STATS_WIDTH * TEST_SW_STATS_HEIGHT * 2;
+    uint8_t *buffer = malloc(size);
+    TEST_ASSERT_NOT_NULL(buffer);
+
+    fill_yuyv(buffer, 100, 128, 128);
+    TEST_ESP_OK(esp_video_sw_stats_process(&s_default_config, buffer, size, &stats));
+
+    TEST_ASSERT_EQUAL_HEX32(ESP_VIDEO_SW_STATS_FLAG_AE | ESP_VIDEO_SW_STATS_FLAG_AWB | ESP_VIDEO_SW_STATS_FLAG_HIST, stats.flags);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, stats.sample_num);
+    for (int i = 0; i < ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM; i++) {
+        for (int j = 0; j < ESP_VIDEO_SW_STATS_AE_BLOCK_X_NUM; j++) {
+            TEST_ASSERT_EQUAL_UINT32(100, stats.ae_luma[i][j]);
+        }
+    }
+
+    /* All samples are in one histogram bin and are white patches */
+    TEST_ASSERT_EQUAL_UINT32(stats.sample_num, stats.hist[100 >> 4]);
+    TEST_ASSERT_EQUAL_UINT32(stats.sample_num, stats.awb.counted);
+    TEST_ASSERT_EQUAL_UINT32(stats.awb.sum_g, stats.awb.sum_r);
+    TEST_ASSERT_EQUAL_UINT32(stats.awb.sum_g, stats.awb.sum_b);
+
+    /* Strong color cast should not be counted as white patch */
+    fill_yuyv(buffer, 100, 60, 200);
+    TEST_ESP_OK(esp_video_sw_stats_process(&s_default_config, buffer, size, &stats));
+    TEST_ASSERT_EQUAL_UINT32(0, stats.awb.counted);
+
+    free(buffer);
+}
+
+TEST_CASE("Software statistics AE blocks and histogram", "[video][sw_stats]")
+{
+    esp_video_sw_stats_t stats;
+    esp_video_sw_stats_config_t config = s_default_config;
+    size_t size = TEST_SW_STATS_WIDTH * TEST_SW_STATS_HEIGHT * 2;
+    uint8_t *buffer = malloc(size);
+    TEST_ASSERT_NOT_NULL(buffer);
+
+    /* Left 2 block columns are black and right 2 block columns are white in RGB565 */
+    config.pixel_format = V4L2_PIX_FMT_RGB565;
+    for (int y = 0; y < TEST_SW_STATS_HEIGHT; y++) {
+        for (int x = 0; x < TEST_SW_STATS_WIDTH; x++) {
+            uint16_t val = x < TEST_SW_STATS_WIDTH / 2 ? 0x0000 : 0xffff;
+            uint8_t *p = buffer + (y * TEST_SW_STATS_WIDTH + x) * 2;
+
+            p[0] = val & 0xff;
+            p[1] = val >> 8;
+        }
+    }
+
+    TEST_ESP_OK(esp_video_sw_stats_process(&config, buffer, size, &stats));
+    for (int i = 0; i < ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM; i++) {
+        TEST_ASSERT_EQUAL_UINT32(0, stats.ae_luma[i][0]);
+        TEST_ASSERT_EQUAL_UINT32(0, stats.ae_luma[i][1]);
+        TEST_ASSERT_EQUAL_UINT32(255, stats.ae_luma[i][3]);
+        TEST_ASSERT_EQUAL_UINT32(255, stats.ae_luma[i][4]);
+    }
+    TEST_ASSERT_EQUAL_UINT32(stats.sample_num, stats.hist[0] + stats.hist[ESP_VIDEO_SW_STATS_HIST_NUM - 1]);
+    TEST_ASSERT_EQUAL_UINT32(stats.hist[0], stats.hist[ESP_VIDEO_SW_STATS_HIST_NUM - 1]);
+
+    free(buffer);
+}
+
+TEST_CASE("Software statistics invalid arguments", "[video][sw_stats]")
+{
+    esp_video_sw_stats_t stats;
+    esp_video_sw_stats_config_t config = s_default_config;
+    uint8_t buffer[16];
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_sw_stats_process(NULL, buffer, sizeof(buffer), &stats));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_sw_stats_process(&config, NULL, sizeof(buffer), &stats));
+    TEST_ESP_ERR(ESP_ERR_INVALID_SIZE, esp_video_sw_stats_process(&config, buffer, sizeof(buffer), &stats));
+
+    config.pixel_format = V4L2_PIX_FMT_JPEG;
+    TEST_ESP_ERR(ESP_ERR_NOT_SUPPORTED, esp_video_sw_stats_process(&config, buffer, sizeof(buffer), &stats));
+}
+
+#if ESP_VIDEO_SW_STATS_IPA_SUPPORTED
+TEST_CASE("Software statistics convert to IPA statistics", "[video][sw_stats]")
+{
+    esp_video_sw_stats_t stats;
+    esp_ipa_stats_t ipa_stats;
+    size_t size = TEST_SW_STATS_WIDTH * TEST_SW_STATS_HEIGHT * 2;
+    uint8_t *buffer = malloc(size);
+    TEST_ASSERT_NOT_NULL(buffer);
+
+    fill_yuyv(buffer, 100, 128, 128);
+    TEST_ESP_OK(esp_video_sw_stats_process(&s_default_config, buffer, size, &stats));
+
+    memset(&ipa_stats, 0xff, sizeof(ipa_stats));
+    esp_video_sw_stats_to_ipa_stats(&stats, 10, &ipa_stats);
+    TEST_ASSERT_EQUAL_HEX32(IPA_STATS_FLAGS_AE | IPA_STATS_FLAGS_AWB | IPA_STATS_FLAGS_HIST, ipa_stats.flags);
+    TEST_ASSERT_EQUAL_UINT64(10, ipa_stats.seq);
+    for (int i = 0; i < ISP_AE_REGIONS; i++) {
+        TEST_ASSERT_EQUAL_UINT32(100, ipa_stats.ae_stats[i].luminance);
+    }
+    TEST_ASSERT_EQUAL_UINT32(stats.awb.counted, ipa_stats.awb_stats[0].counted);
+    TEST_ASSERT_EQUAL_UINT32(stats.awb.sum_g, ipa_stats.awb_stats[0].sum_g);
+    TEST_ASSERT_EQUAL_UINT32(stats.sample_num, ipa_stats.hist_stats[100 >> 4].value);
+
+    /* Right half is white, IPA AE statistics are in [column][row] order */
+    for (int y = 0; y < TEST_SW_STATS_HEIGHT; y++) {
+        for (int x = 0; x < TEST_SW_STATS_WIDTH; x++) {
+            buffer[(y * TEST_SW_STATS_WIDTH + x) * 2] = x < TEST_SW_STATS_WIDTH / 2 ? 16 : 235;
+        }
+    }
+    TEST_ESP_OK(esp_video_sw_stats_process(&s_default_config, buffer, size, &stats));
+    esp_video_sw_stats_to_ipa_stats(&stats, 11, &ipa_stats);
+    for (int y = 0; y < ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM; y++) {
+        TEST_ASSERT_EQUAL_UINT32(16, ipa_stats.ae_stats[0 * ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM + y].luminance);
+        TEST_ASSERT_EQUAL_UINT32(16, ipa_stats.ae_stats[1 * ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM + y].luminance);
+        TEST_ASSERT_EQUAL_UINT32(235, ipa_stats.ae_stats[3 * ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM + y].luminance);
+        TEST_ASSERT_EQUAL_UINT32(235, ipa_stats.ae_stats[4 * ESP_VIDEO_SW_STATS_AE_BLOCK_Y_NUM + y].luminance);
+    }
+
+    free(buffer);
+}
+#endif
+
+TEST_CASE("Software statistics performance", "[video][sw_stats]")
+{
+    int64_t min_time_us = INT64_MAX;
+    int64_t max_time_us = 0;
+    esp_video_sw_stats_t stats;
+    size_t size = TEST_SW_STATS_WIDTH * TEST_SW_STATS_HEIGHT * 2;
+    uint8_t *buffer = malloc(size);
+    TEST_ASSERT_NOT_NULL(buffer);
+
+    for (int i = 0; i < size; i++) {
+        buffer[i] = rand() % 256;
+    }
+
+    for (int i = 0; i < 10; i++) {
+        int64_t t = esp_timer_get_time();
+        TEST_ESP_OK(esp_video_sw_stats_process(&s_default_config, buffer, size, &stats));
+        t = esp_timer_get_time() - t;
+        min_time_us = t < min_time_us ? t : min_time_us;
+        max_time_us = t > max_time_us ? t : max_time_us;
+    }
+
+    /* The fastest run is the cost of statistics, others may include interrupts and cache misses */
+    printf("Software statistics %dx%d: min=%" PRIi64 "us max=%" PRIi64 "us\n", TEST_SW_STATS_WIDTH, TEST_SW_STATS_HEIGHT,
+           min_time_us, max_time_us);
+    TEST_ASSERT_LESS_THAN_INT64(TEST_SW_STATS_MAX_TIME_US, min_time_us);
+
+    free(buffer);
+}
@@ -0,0 +1,243 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "unity.h"
+#include "sdkconfig.h"
+#include "linux/videodev2.h"
+#include "esp_video_tnr.h"
+
+#define TEST_TNR_WIDTH          64
+#define TEST_TNR_HEIGHT         32
+#define TEST_TNR_NOISE          6
+#define TEST_TNR_FRAMES         8
+
+static uint32_t s_seed;
+
+static int test_tnr_noise(void)
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return (int)((s_seed >> 16) % (TEST_TNR_NOISE * 2 + 1)) - TEST_TNR_NOISE;
+}
+
+static uint8_t test_tnr_scene(int x, int y)
+{
+    return 64 + x + y;
+}
+
+static void fill_grey(uint8_t *frame)
+{
+    for (int y = 0; y < TEST_TNR_HEIGHT; y++) {
+        for (int x = 0; x < TEST_TNR_WIDTH; x++) {
+            frame[y * TEST_TNR_WIDTH + x] = test_tnr_scene(x, y) + test_tnr_noise();
+        }
+    }
+}
+
+static uint32_t test_tnr_error(const uint8_t *frame)
+{
+    uint32_t sum = 0;
+
+    for (int y = 0; y < TEST_TNR_HEIGHT; y++) {
+        for (int x = 0; x < TEST_TNR_WIDTH; x++) {
+            sum += abs((int)frame[y * TEST_TNR_WIDTH + x] - test_tnr_scene(x, y));
+        }
+    }
+
+    return sum;
+}
+
+TEST_CASE("TNR reduces noise of static scene", "[video][tnr]")
+{
+    size_t size = TEST_TNR_WIDTH * TEST_TNR_HEIGHT;
+    uint8_t *in = malloc(size);
+    uint8_t *out = malloc(size);
+    esp_video_tnr_handle_t tnr;
+    esp_video_tnr_config_t config = {
+        .width = TEST_TNR_WIDTH,
+        .height = TEST_TNR_HEIGHT,
+        .pixel_format = V4L2_PIX_FMT_GREY,
+        .strength = ESP_VIDEO_TNR_STRENGTH_MAX,
+    };
+    uint32_t in_error = 0;
+    uint32_t out_error = 0;
+
+    TEST_ASSERT_NOT_NULL(in);
+    TEST_ASSERT_NOT_NULL(out);
+    TEST_ESP_OK(esp_video_tnr_create(&config, &tnr));
+
+    s_seed = 1;
+    for (int i = 0; i < TEST_TNR_FRAMES; i++) {
+        fill_grey(in);
+        TEST_ESP_OK(esp_video_tnr_process(tnr, in, size, out));
+
+        /* The first frame has no reference */
+        if (i == 0) {
+            TEST_ASSERT_EQUAL_MEMORY(in, out, size);
+        }
+    }
+
+    in_error = test_tnr_error(in);
+    out_error = test_tnr_error(out);
+    printf("noise %"PRIu32" -> %"PRIu32"\n", in_error, out_error);
+    TEST_ASSERT_LESS_THAN_UINT32(in_error / 2, out_error);
+
+    /* Filtering in place gives the same result */
+    TEST_ESP_OK(esp_video_tnr_reset(tnr));
+    s_seed = 1;
+    for (int i = 0; i < TEST_TNR_FRAMES; i++) {
+        fill_grey(in);
+        TEST_ESP_OK(esp_video_tnr_process(tnr, in, size, in));
+    }
+    TEST_ASSERT_EQUAL_MEMORY(out, in, size);
+
+    TEST_ESP_OK(esp_video_tnr_delete(tnr));
+    free(in);
+    free(out);
+}
+
+TEST_CASE("TNR keeps moving tiles and chroma", "[video][tnr]")
+{
+    /* YUV420 of ISP output, every 2 pixels take 3 bytes "U/V Y Y" */
+    uint32_t line_size = TEST_TNR_WIDTH / 2 * 3;
+    size_t size = line_size * TEST_TNR_HEIGHT;
+    uint8_t *in = malloc(size);
+    uint8_t *out = malloc(size);
+    esp_video_tnr_handle_t tnr;
+    esp_video_tnr_config_t config = {
+        .width = TEST_TNR_WIDTH,
+        .height = TEST_TNR_HEIGHT,
+        .pixel_format = V4L2_PIX_FMT_YUV420,
+        .tile_size = 16,
+        .strength = ESP_VIDEO_TNR_STRENGTH_MAX,
+    };
+
+    TEST_ASSERT_NOT_NULL(in);
+    TEST_ASSERT_NOT_NULL(out);
+    TEST_ESP_OK(esp_video_tnr_create(&config, &tnr));
+
+    s_seed = 1;
+    for (int i = 0; i < TEST_TNR_FRAMES; i++) {
+        for (int y = 0; y < TEST_TNR_HEIGHT; y++) {
+            for (int x = 0; x < TEST_TNR_WIDTH; x += 2) {
+                uint8_t *p = in + y * line_size + x / 2 * 3;
+
+                p[0] = i;
+                p[1] = test_tnr_scene(x, y) + test_tnr_noise();
+                p[2] = test_tnr_scene(x + 1, y) + test_tnr_noise();
+            }
+        }
+
+        /* An object appears in the first tile at the last frame */
+        if (i == TEST_TNR_FRAMES - 1) {
+            for (int y = 0; y < 16; y++) {
+                for (int x = 0; x < 16; x += 2) {
+                    uint8_t *p = in + y * line_size + x / 2 * 3;
+
+                    p[1] += 100;
+                    p[2] += 100;
+                }
+            }
+        }
+
+        TEST_ESP_OK(esp_video_tnr_process(tnr, in, size, out));
+    }
+
+    for (int y = 0; y < TEST_TNR_HEIGHT; y++) {
+        for (int x = 0; x < TEST_TNR_WIDTH; x += 2) {
+            size_t offset = y * line_size + x / 2 * 3;
+
+            TEST_ASSERT_EQUAL_UINT8(in[offset], out[offset]);
+            if (x < 16 && y < 16) {
+                TEST_ASSERT_EQUAL_UINT8(in[offset + 1], out[offset + 1]);
+                TEST_ASSERT_EQUAL_UINT8(in[offset + 2], out[offset + 2]);
+            }
+        }
+    }
+
+    /* Static tiles are still filtered */
+    TEST_ASSERT_NOT_EQUAL(0, memcmp(in + 16 * line_size, out + 16 * line_size, size - 16 * line_size));
+
+    TEST_ESP_OK(esp_video_tnr_delete(tnr));
+    free(in);
+    free(out);
+}
+
+TEST_CASE("TNR strength follows denoising level", "[video][tnr]")
+{
+    size_t size = TEST_TNR_WIDTH * TEST_TNR_HEIGHT;
+    uint8_t *in = malloc(size);
+    uint8_t *out = malloc(size);
+    uint32_t error[2];
+    esp_video_tnr_handle_t tnr;
+    esp_video_tnr_config_t config = {
+        .width = TEST_TNR_WIDTH,
+        .height = TEST_TNR_HEIGHT,
+        .pixel_format = V4L2_PIX_FMT_GREY,
+    };
+
+    TEST_ASSERT_NOT_NULL(in);
+    TEST_ASSERT_NOT_NULL(out);
+    TEST_ESP_OK(esp_video_tnr_create(&config, &tnr));
+
+    /* Level 0 disables filtering */
+    TEST_ESP_OK(esp_video_tnr_set_denoise_level(tnr, 0));
+    s_seed = 1;
+    for (int i = 0; i < 2; i++) {
+        fill_grey(in);
+        TEST_ESP_OK(esp_video_tnr_process(tnr, in, size, out));
+        TEST_ASSERT_EQUAL_MEMORY(in, out, size);
+    }
+
+    /* Higher level removes more noise */
+    for (int n = 0; n < 2; n++) {
+        TEST_ESP_OK(esp_video_tnr_reset(tnr));
+        TEST_ESP_OK(esp_video_tnr_set_denoise_level(tnr, n ? ESP_VIDEO_TNR_DENOISE_LEVEL_MAX : 4));
+        s_seed = 1;
+        for (int i = 0; i < TEST_TNR_FRAMES; i++) {
+            fill_grey(in);
+            TEST_ESP_OK(esp_video_tnr_process(tnr, in, size, out));
+        }
+        error[n] = test_tnr_error(out);
+    }
+    TEST_ASSERT_LESS_THAN_UINT32(error[0], error[1]);
+
+    TEST_ESP_OK(esp_video_tnr_delete(tnr));
+    free(in);
+    free(out);
+}
+
+TEST_CASE("TNR invalid arguments", "[video][tnr]")
+{
+    uint8_t frame[16];
+    esp_video_tnr_handle_t tnr;
+    esp_video_tnr_config_t config = {
+        .width = 4,
+        .height = 4,
+        .pixel_format = V4L2_PIX_FMT_GREY,
+    };
+
+    config.width = 3;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_tnr_create(&config, &tnr));
+    config.width = 4;
+
+    config.tile_size = 3;
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_tnr_create(&config, &tnr));
+    config.tile_size = 0;
+
+    config.pixel_format = V4L2_PIX_FMT_RGB565;
+    TEST_ESP_ERR(ESP_ERR_NOT_SUPPORTED, esp_video_tnr_create(&config, &tnr));
+    config.pixel_format = V4L2_PIX_FMT_GREY;
+
+    TEST_ESP_OK(esp_video_tnr_create(&config, &tnr));
+    TEST_ESP_OK(esp_video_tnr_process(tnr, frame, sizeof(frame), frame));
+    TEST_ESP_ERR(ESP_ERR_INVALID_SIZE, esp_video_tnr_process(tnr, frame, sizeof(frame) - 1, frame));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_video_tnr_process(tnr, NULL, sizeof(frame), frame));
+    TEST_ESP_OK(esp_video_tnr_delete(tnr));
+}
@@ -0,0 +1,93 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "unity.h"
+#include "esp_video_init.h"
+#include "esp_video_device.h"
+#include "esp_video_ioctl.h"
+#include "esp_video_caps.h"
+#include "esp_video_link.h"
+
+#define TEST_VIDEO_LINK_WIDTH       128
+#define TEST_VIDEO_LINK_HEIGHT      128
+
+#define TEST_VIDEO_LINK_FLAGS       (ESP_VIDEO_INIT_FLAGS_JPEG_DEC | ESP_VIDEO_INIT_FLAGS_JPEG_ENC | ESP_VIDEO_INIT_FLAGS_H264)
+
+static void test_video_link_check_format(int fd, uint32_t type, uint32_t pixel_format)
+{
+    struct v4l2_format format;
+
+    memset(&format, 0, sizeof(format));
+    format.type = type;
+    TEST_ESP_OK(ioctl(fd, VIDIOC_G_FMT, &format));
+    TEST_ASSERT_EQUAL_UINT32(TEST_VIDEO_LINK_WIDTH, format.fmt.pix.width);
+    TEST_ASSERT_EQUAL_UINT32(TEST_VIDEO_LINK_HEIGHT, format.fmt.pix.height);
+    TEST_ASSERT_EQUAL_HEX32(pixel_format, format.fmt.pix.pixelformat);
+}
+
+/* JPEG decoder capture stream takes the place of camera, both of them output raw frames */
+TEST_CASE("Video link negotiates camera and encoder format", "[video][link]")
+{
+    int src_fd;
+    int jpeg_fd;
+    uint32_t pixel_format;
+
+    setUp();
+
+    esp_video_init_config_t config = { 0 };
+    TEST_ESP_OK(esp_video_init_with_flags(&config, TEST_VIDEO_LINK_FLAGS));
+
+    src_fd = open(ESP_VIDEO_JPEG_DEC_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, src_fd);
+    jpeg_fd = open(ESP_VIDEO_JPEG_ENC_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, jpeg_fd);
+
+    esp_video_link_config_t link_config = {
+        .cap_fd = src_fd,
+        .m2m_fd = jpeg_fd,
+        .width = TEST_VIDEO_LINK_WIDTH,
+        .height = TEST_VIDEO_LINK_HEIGHT,
+        .pixel_format = V4L2_PIX_FMT_RGB565,
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_video_link_set_format(&link_config, &pixel_format));
+
+    /* The first JPEG encoder input format is selected */
+    link_config.pixel_format = V4L2_PIX_FMT_JPEG;
+    TEST_ESP_OK(esp_video_link_set_format(&link_config, &pixel_format));
+    TEST_ASSERT_EQUAL_HEX32(V4L2_PIX_FMT_RGB565, pixel_format);
+    test_video_link_check_format(src_fd, V4L2_BUF_TYPE_VIDEO_CAPTURE, pixel_format);
+    test_video_link_check_format(jpeg_fd, V4L2_BUF_TYPE_VIDEO_OUTPUT, pixel_format);
+    test_video_link_check_format(jpeg_fd, V4L2_BUF_TYPE_VIDEO_CAPTURE, V4L2_PIX_FMT_JPEG);
+
+#if CONFIG_ESP_VIDEO_ENABLE_HW_H264_VIDEO_DEVICE && ESP_VIDEO_JPEG_DEVICE_YUV420
+    int h264_fd = open(ESP_VIDEO_H264_DEVICE_NAME, O_RDWR);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, h264_fd);
+
+    /* Decoded frames are in the H.264 encoder input layout, so nothing is converted */
+    link_config.m2m_fd = h264_fd;
+    link_config.pixel_format = V4L2_PIX_FMT_H264;
+    TEST_ESP_OK(esp_video_link_set_format(&link_config, &pixel_format));
+    TEST_ASSERT_EQUAL_HEX32(V4L2_PIX_FMT_YUV420, pixel_format);
+    test_video_link_check_format(src_fd, V4L2_BUF_TYPE_VIDEO_CAPTURE, pixel_format);
+    test_video_link_check_format(h264_fd, V4L2_BUF_TYPE_VIDEO_OUTPUT, pixel_format);
+    test_video_link_check_format(h264_fd, V4L2_BUF_TYPE_VIDEO_CAPTURE, V4L2_PIX_FMT_H264);
+
+    /* JPEG encoder captures JPEG frames only, which H.264 encoder can't read */
+    link_config.cap_fd = jpeg_fd;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED, esp_video_link_set_format(&link_config, NULL));
+
+    close(h264_fd);
+#endif
+
+    close(jpeg_fd);
+    close(src_fd);
+    TEST_ESP_OK(esp_video_deinit_with_flags(TEST_VIDEO_LINK_FLAGS));
+}
@@ -0,0 +1,167 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+/*
+ * Host simulation of the ISP pipeline controller contrast detection auto focus engine.
+ *
+ * A lens with a synthetic focus curve, motor step timing and ringing after every move is
+ * driven by "src/esp_video_af.c" frame by frame, and the search time of every focus distance
+ * is printed, so that the engine parameters can be tuned and benchmarked without hardware.
+ *
+ * Build and run on host:
+ *
+ *     cc -O2 -I ../../private_include esp_video_af_sim.c ../../src/esp_video_af.c -lm -o af_sim
+ *     ./af_sim [frame_period_us] [settle_us] [noise_percent]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "esp_video_af.h"
+
+#define SIM_MIN_POS             0
+#define SIM_MAX_POS             1023
+#define SIM_COARSE_STEPS        16
+#define SIM_FINE_STEP           16
+#define SIM_PERIOD_IN_US        152     /* DW9714 LSC mode */
+#define SIM_CODES_PER_STEP      2
+#define SIM_RINGING_US          4000    /* Lens ringing time constant after a move */
+#define SIM_RINGING_CODES       24      /* Lens overshoot of a full range move */
+#define SIM_CURVE_WIDTH         90.0    /* Focus curve half width in lens position */
+#define SIM_MAX_FRAMES          300
+
+typedef struct sim_lens {
+    int32_t from;
+    int32_t to;
+    int64_t start_time;
+    int64_t end_time;
+} sim_lens_t;
+
+static double sim_lens_position(const sim_lens_t *lens, int64_t t)
+{
+    if (t <= lens->start_time) {
+        return lens->from;
+    } else if (t < lens->end_time) {
+        return lens->from + (double)(lens->to - lens->from) * (t - lens->start_time) / (lens->end_time - lens->start_time);
+    } else {
+        double overshoot = (double)(lens->to - lens->from) * SIM_RINGING_CODES / (SIM_MAX_POS - SIM_MIN_POS);
+        double dt = (double)(t - lens->end_time);
+
+        return lens->to + overshoot * exp(-dt / SIM_RINGING_US) * cos(dt * 2 * M_PI / SIM_RINGING_US);
+    }
+}
+
+static uint32_t sim_definition(double pos, int32_t focus, double noise)
+{
+    double x = (pos - focus) / SIM_CURVE_WIDTH;
+    double def = 2000.0 + 60000.0 * exp(-x * x);
+
+    def *= 1.0 + noise * ((double)rand() / RAND_MAX * 2.0 - 1.0);
+    return def > 0 ? (uint32_t)def : 0;
+}
+
+/* The definition of a frame is averaged over its exposure, so a moving lens blurs the result */
+static uint32_t sim_frame_definition(const sim_lens_t *lens, int64_t frame_end, int64_t frame_period, int32_t focus, double noise)
+{
+    const int samples = 8;
+    uint64_t sum = 0;
+
+    for (int i = 0; i < samples; i++) {
+        int64_t t = frame_end - frame_period + frame_period * (2 * i + 1) / (2 * samples);
+
+        sum += sim_definition(sim_lens_position(lens, t), focus, noise);
+    }
+
+    return sum / samples;
+}
+
+static int sim_run(int32_t focus, int64_t frame_period, uint32_t settle_us, double noise, esp_video_af_t *af)
+{
+    int64_t t = 0;
+    sim_lens_t lens = {
+        .from = SIM_MIN_POS,
+        .to = SIM_MIN_POS,
+    };
+    const esp_video_af_config_t config = {
+        .min_pos = SIM_MIN_POS,
+        .max_pos = SIM_MAX_POS,
+        .coarse_steps = SIM_COARSE_STEPS,
+        .fine_step = SIM_FINE_STEP,
+        .period_in_us = SIM_PERIOD_IN_US,
+        .codes_per_step = SIM_CODES_PER_STEP,
+        .settle_us = settle_us,
+        .drop_percent = 10,
+        .refocus_percent = 30,
+        .refocus_frames = 0,
+    };
+
+    esp_video_af_init(af, &config, SIM_MIN_POS);
+    esp_video_af_start(af);
+
+    for (int frame = 1; frame <= SIM_MAX_FRAMES; frame++) {
+        int32_t pos;
+
+        t += frame_period;
+        if (esp_video_af_process(af, sim_frame_definition(&lens, t, frame_period, focus, noise), t, &pos)) {
+            uint32_t steps = (abs(pos - lens.to) + SIM_CODES_PER_STEP - 1) / SIM_CODES_PER_STEP;
+
+            lens.from = lens.to;
+            lens.to = pos;
+            lens.start_time = t;
+            lens.end_time = t + (int64_t)steps * SIM_PERIOD_IN_US;
+            esp_video_af_moved(af, pos, t);
+        }
+
+        if ((af->state == ESP_VIDEO_AF_STATE_LOCKED || af->state == ESP_VIDEO_AF_STATE_FAILED) && af->pos == af->target) {
+            return frame;
+        }
+    }
+
+    return -1;
+}
+
+int main(int argc, char *argv[])
+{
+    int64_t frame_period = argc > 1 ? atoll(argv[1]) : 33333;
+    uint32_t settle_us = argc > 2 ? atoi(argv[2]) : 8000;
+    double noise = (argc > 3 ? atof(argv[3]) : 2.0) / 100.0;
+    int total_frames = 0;
+    int max_frames = 0;
+    int max_error = 0;
+    int runs = 0;
+
+    srand(1);
+
+    printf("frame period %lld us, settle %u us, noise %.1f%%\n\n", (long long)frame_period, settle_us, noise * 100);
+    printf(" focus   lock  error  frames  discarded  moves   time(ms)\n");
+
+    for (int32_t focus = 40; focus < SIM_MAX_POS; focus += 60) {
+        esp_video_af_t af;
+        int frames = sim_run(focus, frame_period, settle_us, noise, &af);
+        int error = abs(af.best_pos - focus);
+
+        if (frames < 0) {
+            printf("%6d   not locked in %d frames\n", (int)focus, SIM_MAX_FRAMES);
+            continue;
+        }
+
+        printf("%6d  %5d  %5d  %6d  %9u  %5u  %9.1f\n", (int)focus, (int)af.best_pos, error, frames,
+               (unsigned)af.discarded, (unsigned)af.moves, frames * frame_period / 1000.0);
+
+        total_frames += frames;
+        max_frames = frames > max_frames ? frames : max_frames;
+        max_error = error > max_error ? error : max_error;
+        runs++;
+    }
+
+    if (runs) {
+        printf("\naverage %.1f frames (%.1f ms), worst %d frames (%.1f ms), max error %d\n",
+               (double)total_frames / runs, (double)total_frames / runs * frame_period / 1000.0,
+               max_frames, max_frames * frame_period / 1000.0, max_error);
+    }
+
+    return 0;
+}
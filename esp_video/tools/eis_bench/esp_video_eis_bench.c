@@ -0,0 +1,265 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+/*
+ * Host benchmark of the electronic image stabilization core.
+ *
+ * Full sensor frames are cut by the crop window which "src/data_reprocessing/esp_video_eis_core.c"
+ * outputs, with the same one frame latency as the ISP crop, and the cropped frames are fed back
+ * to the core. Processing time per frame and the remaining jitter of the output are printed.
+ *
+ * Without a clip, a textured scene is captured by a camera panning slowly with vibration. A
+ * recorded clip is a file of 8-bit grey frames at sensor resolution, e.g. converted by:
+ *
+ *     ffmpeg -i clip.mp4 -vf scale=800:600 -pix_fmt gray -f rawvideo clip.gray
+ *
+ * Build and run on host:
+ *
+ *     cc -O2 -I ../../private_include esp_video_eis_bench.c ../../src/data_reprocessing/esp_video_eis_core.c -lm -o eis_bench
+ *     ./eis_bench [clip.gray width height [output.gray]]
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_video_eis_core.h"
+
+#define BENCH_WIDTH             800
+#define BENCH_HEIGHT            600
+#define BENCH_MARGIN_PERCENT    10      /* Crop window is smaller than sensor by this percent on every side */
+#define BENCH_FRAMES            300
+#define BENCH_FPS               30.0
+#define BENCH_PAN_SPEED         1.0     /* Camera pan in pixels per frame */
+#define BENCH_SHAKE_AMPLITUDE   14.0    /* Vibration amplitude in pixels */
+#define BENCH_SCENE_WIDTH       (BENCH_WIDTH + BENCH_FRAMES * 2 + 64)
+#define BENCH_SCENE_HEIGHT      (BENCH_HEIGHT + 64)
+#define BENCH_JITTER_WINDOW     7       /* Half window of the moving average which the jitter is measured against */
+
+typedef struct bench_scene {
+    uint8_t *pixels;
+    int width;
+    int height;
+} bench_scene_t;
+
+static double bench_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Blurred random texture, like foliage or gravel which is the common background of outdoor cameras */
+static void bench_scene_init(bench_scene_t *scene)
+{
+    int w = BENCH_SCENE_WIDTH;
+    int h = BENCH_SCENE_HEIGHT;
+    uint8_t *tmp = malloc(w * h);
+
+    scene->width = w;
+    scene->height = h;
+    scene->pixels = malloc(w * h);
+    for (int i = 0; i < w * h; i++) {
+        tmp[i] = rand() & 0xff;
+    }
+
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int sum = 0;
+            int n = 0;
+
+            for (int dy = -2; dy <= 2; dy++) {
+                for (int dx = -2; dx <= 2; dx++) {
+                    if (x + dx >= 0 && x + dx < w && y + dy >= 0 && y + dy < h) {
+                        sum += tmp[(y + dy) * w + x + dx];
+                        n++;
+                    }
+                }
+            }
+
+            scene->pixels[y * w + x] = sum / n;
+        }
+    }
+
+    free(tmp);
+}
+
+static void bench_camera_position(int frame, int pos[2])
+{
+    double t = frame / BENCH_FPS;
+
+    pos[0] = (int)lround(32 + frame * BENCH_PAN_SPEED + BENCH_SHAKE_AMPLITUDE * sin(2 * M_PI * 1.3 * t) +
+                         BENCH_SHAKE_AMPLITUDE / 3 * sin(2 * M_PI * 2.9 * t));
+    pos[1] = (int)lround(32 + BENCH_SHAKE_AMPLITUDE * 0.7 * sin(2 * M_PI * 1.7 * t + 1.0) +
+                         BENCH_SHAKE_AMPLITUDE / 4 * sin(2 * M_PI * 3.7 * t));
+}
+
+static void bench_cut(const uint8_t *src, int src_width, int left, int top, int width, int height, uint8_t *dst)
+{
+    for (int y = 0; y < height; y++) {
+        memcpy(dst + y * width, src + (top + y) * src_width + left, width);
+    }
+}
+
+/* RMS distance of a trajectory to its moving average, which is the shake seen in the video */
+static double bench_jitter(const double *pos, int num)
+{
+    double sum = 0;
+    int count = 0;
+
+    for (int i = BENCH_JITTER_WINDOW; i < num - BENCH_JITTER_WINDOW; i++) {
+        double avg = 0;
+
+        for (int j = -BENCH_JITTER_WINDOW; j <= BENCH_JITTER_WINDOW; j++) {
+            avg += pos[i + j];
+        }
+
+        avg /= BENCH_JITTER_WINDOW * 2 + 1;
+        sum += (pos[i] - avg) * (pos[i] - avg);
+        count++;
+    }
+
+    return count ? sqrt(sum / count) : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *clip = NULL;
+    FILE *output = NULL;
+    int width = BENCH_WIDTH;
+    int height = BENCH_HEIGHT;
+    bench_scene_t scene = {0};
+    esp_video_eis_core_t core;
+    esp_video_eis_core_config_t config = {0};
+    uint8_t *buffer;
+    uint8_t *sensor;
+    uint8_t *frame;
+    double *raw_pos[2];
+    double *out_pos[2];
+    double total_us = 0;
+    double max_us = 0;
+    int crop[2];
+    int frames = 0;
+    int valid = 0;
+
+    if (argc > 1) {
+        if (argc < 4) {
+            printf("usage: %s [clip.gray width height [output.gray]]\n", argv[0]);
+            return 1;
+        }
+
+        clip = fopen(argv[1], "rb");
+        width = atoi(argv[2]);
+        height = atoi(argv[3]);
+        if (!clip || width <= 0 || height <= 0) {
+            printf("failed to open %s\n", argv[1]);
+            return 1;
+        }
+
+        if (argc > 4) {
+            output = fopen(argv[4], "wb");
+        }
+    } else {
+        srand(1);
+        bench_scene_init(&scene);
+    }
+
+    config.sensor_width = width;
+    config.sensor_height = height;
+    config.crop_width = (width - width * BENCH_MARGIN_PERCENT * 2 / 100) & ~1;
+    config.crop_height = (height - height * BENCH_MARGIN_PERCENT * 2 / 100) & ~1;
+    config.group = 2;
+    config.y_offset[0] = 0;
+    config.y_offset[1] = 1;
+    config.line_size = config.crop_width;
+    config.downscale = 4;
+    config.search_range = 6;
+    config.smoothing = 240;
+    config.crop_latency = 1;
+
+    buffer = malloc(esp_video_eis_core_buffer_size(&config));
+    sensor = malloc(width * height);
+    frame = malloc(config.crop_width * config.crop_height);
+    for (int k = 0; k < 2; k++) {
+        raw_pos[k] = calloc(BENCH_FRAMES * 10, sizeof(double));
+        out_pos[k] = calloc(BENCH_FRAMES * 10, sizeof(double));
+    }
+    if (!buffer || !sensor || !frame) {
+        printf("frame is too small\n");
+        return 1;
+    }
+
+    esp_video_eis_core_init(&core, &config, buffer);
+    crop[0] = core.origin[0];
+    crop[1] = core.origin[1];
+
+    printf("sensor %dx%d, crop %"PRIu32"x%"PRIu32", downscale %"PRIu32", search range %"PRIu32"\n\n",
+           width, height, config.crop_width, config.crop_height, config.downscale, config.search_range);
+
+    for (frames = 0; frames < (clip ? BENCH_FRAMES * 10 : BENCH_FRAMES); frames++) {
+        int32_t motion[2];
+        int32_t next[2];
+        double start;
+        double us;
+
+        if (clip) {
+            if (fread(sensor, 1, width * height, clip) != (size_t)(width * height)) {
+                break;
+            }
+        } else {
+            int pos[2];
+
+            bench_camera_position(frames, pos);
+            bench_cut(scene.pixels, scene.width, pos[0], pos[1], width, height, sensor);
+            for (int k = 0; k < 2; k++) {
+                raw_pos[k][frames] = pos[k] + core.origin[k];
+                out_pos[k][frames] = pos[k] + crop[k];
+            }
+        }
+
+        /* ISP crop of this frame is the window output by the previous frame */
+        bench_cut(sensor, width, crop[0], crop[1], config.crop_width, config.crop_height, frame);
+        if (output) {
+            fwrite(frame, 1, config.crop_width * config.crop_height, output);
+        }
+
+        start = bench_now_us();
+        valid += esp_video_eis_core_estimate(&core, frame, motion);
+        esp_video_eis_core_update(&core, motion, next);
+        us = bench_now_us() - start;
+
+        total_us += us;
+        max_us = us > max_us ? us : max_us;
+        if (clip) {
+            for (int k = 0; k < 2; k++) {
+                raw_pos[k][frames] = (frames ? raw_pos[k][frames - 1] : 0) + motion[k] / 16.0;
+                out_pos[k][frames] = raw_pos[k][frames] - crop[k];
+            }
+        }
+
+        crop[0] = next[0];
+        crop[1] = next[1];
+    }
+
+    if (frames) {
+        printf("frames %d, estimated %d, average %.1f us, max %.1f us per frame\n", frames, valid,
+               total_us / frames, max_us);
+        printf("jitter without EIS: x %.2f px, y %.2f px\n", bench_jitter(raw_pos[0], frames), bench_jitter(raw_pos[1], frames));
+        printf("jitter with EIS:    x %.2f px, y %.2f px\n", bench_jitter(out_pos[0], frames), bench_jitter(out_pos[1], frames));
+    }
+
+    if (clip) {
+        fclose(clip);
+    }
+    if (output) {
+        fclose(output);
+    }
+
+    return 0;
+}